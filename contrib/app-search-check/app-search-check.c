@@ -0,0 +1,246 @@
+// app-search-check: checks the ranking of the Activities search and times it
+// per keystroke.
+//
+//   app-search-check [-n entries] [-b budget us]
+//
+// ranking: small hand written sets of applications, each query must return
+// them in the expected order:
+//
+// - a word matched from the start of the name beats one matched at a word
+//   boundary inside it, which beats one scattered over the name.
+// - a word found in the name beats the same word found in a keyword.
+// - a query typed one character at a time, which only rescans the previous
+//   matches, returns what the same query does on a fresh search.
+//
+// timing: `entries` synthetic applications, 5000 by default, shaped like
+// desktop files with a name, a generic name, keywords and an executable.
+// Several queries are typed one character at a time, as in the Activities
+// search entry, and every app_search_query call is timed. The run fails if
+// any keystroke takes longer than `budget`, 1000us by default.
+#include <adwaita.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/activities/app_search.h"
+
+#define FAIL(...)                      \
+    do {                               \
+        printf("[Fail] " __VA_ARGS__); \
+        printf("\n");                  \
+        exit(1);                       \
+    } while (0)
+
+// Appends an application to `entries` with search keys laid out as
+// desktop_entry_init_from_app_info does, the name first and then
+// `other_keys` one per line. Strings live in `chunk`.
+static void add_entry(GArray *entries, GStringChunk *chunk, const char *name,
+                      const char *const *other_keys) {
+    GString *keys = g_string_new(NULL);
+    char *folded = desktop_entry_fold(name);
+    g_string_append(keys, folded);
+    g_free(folded);
+
+    for (; other_keys && *other_keys; other_keys++) {
+        folded = desktop_entry_fold(*other_keys);
+        g_string_append_c(keys, '\n');
+        g_string_append(keys, folded);
+        g_free(folded);
+    }
+
+    DesktopEntry entry = {
+        .id = g_string_chunk_insert_const(chunk, name),
+        .name = g_string_chunk_insert_const(chunk, name),
+        .search_keys = g_string_chunk_insert_const(chunk, keys->str),
+        .application = TRUE,
+    };
+    g_array_append_val(entries, entry);
+    g_string_free(keys, TRUE);
+}
+
+// Checks that `query` returns exactly `expected`, by name and in order.
+static void expect(AppSearch *search, const char *query,
+                   const char *const *expected) {
+    GPtrArray *results = app_search_query(search, query);
+    guint n = g_strv_length((char **)expected);
+
+    for (guint i = 0; i < MAX(n, results->len); i++) {
+        const char *got =
+            i < results->len
+                ? ((DesktopEntry *)g_ptr_array_index(results, i))->name
+                : "(none)";
+        const char *want = i < n ? expected[i] : "(none)";
+        if (g_strcmp0(got, want))
+            FAIL("'%s': result %u is %s, expected %s", query, i, got, want);
+    }
+    printf("[Pass] '%s'\n", query);
+}
+
+static void check_ranking(void) {
+    GArray *entries = g_array_new(FALSE, TRUE, sizeof(DesktopEntry));
+    GStringChunk *chunk = g_string_chunk_new(256);
+
+    // added worst first, so the order can only come from the scores
+    add_entry(entries, chunk, "Butter Game", NULL);
+    add_entry(entries, chunk, "Xfce Terminal", NULL);
+    add_entry(entries, chunk, "Terminal", NULL);
+    add_entry(entries, chunk, "Web", (const char *const[]){"Browser", NULL});
+    add_entry(entries, chunk, "Browser", NULL);
+
+    AppSearch *search = app_search_new(entries);
+
+    expect(search, "term",
+           (const char *const[]){"Terminal", "Xfce Terminal", "Butter Game",
+                                 NULL});
+    expect(search, "browser", (const char *const[]){"Browser", "Web", NULL});
+    expect(search, "xfce term", (const char *const[]){"Xfce Terminal", NULL});
+    expect(search, "zzz", (const char *const[]){NULL});
+    app_search_free(search);
+
+    // typed, each query narrows the previous one's matches
+    AppSearch *typed = app_search_new(entries);
+    AppSearch *fresh = NULL;
+    const char *word = "terminal";
+    for (gsize len = 1; len <= strlen(word); len++) {
+        char *query = g_strndup(word, len);
+        GPtrArray *got = app_search_query(typed, query);
+
+        fresh = app_search_new(entries);
+        GPtrArray *want = app_search_query(fresh, query);
+        if (got->len != want->len)
+            FAIL("typed '%s': %u results, fresh search %u", query, got->len,
+                 want->len);
+        for (guint i = 0; i < got->len; i++)
+            if (g_ptr_array_index(got, i) != g_ptr_array_index(want, i))
+                FAIL("typed '%s': result %u differs from a fresh search",
+                     query, i);
+
+        app_search_free(fresh);
+        g_free(query);
+    }
+    printf("[Pass] typed 'terminal' matches fresh searches\n");
+    app_search_free(typed);
+
+    g_array_unref(entries);
+    g_string_chunk_free(chunk);
+}
+
+static const char *syllables[] = {
+    "fire", "fox",  "term", "in",   "al",   "sys",  "tem", "set",
+    "ting", "vlc",  "me",   "dia",  "play", "er",   "text", "edit",
+    "or",   "calc", "ul",   "at",   "mail", "chat", "web",  "brow",
+    "ser",  "file", "man",  "age",  "sound", "vol", "ume", "disk",
+};
+
+static char *synthetic_word(GRand *rand) {
+    GString *word = g_string_new(NULL);
+    int n = g_rand_int_range(rand, 1, 4);
+    for (int i = 0; i < n; i++)
+        g_string_append(word, syllables[g_rand_int_range(
+                                  rand, 0, G_N_ELEMENTS(syllables))]);
+    return g_string_free(word, FALSE);
+}
+
+static char *synthetic_words(GRand *rand, int n) {
+    GString *words = g_string_new(NULL);
+    for (int i = 0; i < n; i++) {
+        char *word = synthetic_word(rand);
+        if (i) g_string_append_c(words, ' ');
+        g_string_append(words, word);
+        g_free(word);
+    }
+    return g_string_free(words, FALSE);
+}
+
+static gint compare_gint64(gconstpointer a, gconstpointer b) {
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int check_timing(guint n, gint64 budget) {
+    GRand *rand = g_rand_new_with_seed(1);
+    GArray *entries = g_array_new(FALSE, TRUE, sizeof(DesktopEntry));
+    GStringChunk *chunk = g_string_chunk_new(64 * 1024);
+
+    for (guint i = 0; i < n; i++) {
+        char *name = synthetic_words(rand, g_rand_int_range(rand, 1, 4));
+        char *generic = synthetic_words(rand, 2);
+        char *keyword1 = synthetic_word(rand);
+        char *keyword2 = synthetic_word(rand);
+        char *exec = synthetic_word(rand);
+
+        add_entry(entries, chunk, name,
+                  (const char *const[]){generic, keyword1, keyword2, exec,
+                                        NULL});
+
+        g_free(name);
+        g_free(generic);
+        g_free(keyword1);
+        g_free(keyword2);
+        g_free(exec);
+    }
+
+    AppSearch *search = app_search_new(entries);
+    GArray *times = g_array_new(FALSE, FALSE, sizeof(gint64));
+    const char *queries[] = {"firefox",   "terminal", "system settings",
+                             "text edit", "vlc",      "qqq",
+                             "mail chat", "e"};
+
+    for (guint q = 0; q < G_N_ELEMENTS(queries); q++) {
+        // typed from an empty entry
+        app_search_query(search, "");
+        for (gsize len = 1; len <= strlen(queries[q]); len++) {
+            char *query = g_strndup(queries[q], len);
+            gint64 start = g_get_monotonic_time();
+            app_search_query(search, query);
+            gint64 elapsed = g_get_monotonic_time() - start;
+            g_array_append_val(times, elapsed);
+            g_free(query);
+        }
+    }
+
+    g_array_sort(times, compare_gint64);
+    gint64 median = g_array_index(times, gint64, times->len / 2);
+    gint64 max = g_array_index(times, gint64, times->len - 1);
+    printf("timing %u entries, %u keystrokes: median %" G_GINT64_FORMAT
+           "us, max %" G_GINT64_FORMAT "us\n",
+           n, times->len, median, max);
+
+    app_search_free(search);
+    g_array_unref(times);
+    g_array_unref(entries);
+    g_string_chunk_free(chunk);
+    g_rand_free(rand);
+
+    if (max > budget) {
+        printf("[Fail] a keystroke took over %" G_GINT64_FORMAT "us\n",
+               budget);
+        return 1;
+    }
+    printf("[Pass] every keystroke under %" G_GINT64_FORMAT "us\n", budget);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    guint n = 5000;
+    gint64 budget = 1000;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:b:")) != -1) {
+        switch (opt) {
+            case 'n':
+                n = MAX(1, atoi(optarg));
+                break;
+            case 'b':
+                budget = MAX(1, atoi(optarg));
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n entries] [-b budget us]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    check_ranking();
+    return check_timing(n, budget);
+}
@@ -0,0 +1,166 @@
+// colorramp-bench: checks colorramp_fill_profile against the floating point
+// ramps it replaced and times both.
+//
+//   colorramp-bench [-n iterations] [-s kelvin step]
+//
+// The reference is gammastep's computation, as colorramp.h did it before:
+// every entry of an identity ramp goes through
+//
+//   pow(Y * brightness * white_point[C], 1 / gamma)
+//
+// with the white point interpolated from blackbody_color at the exact
+// temperature.
+//
+// accuracy: temperatures from 1000K to 25000K, `kelvin step` apart, every
+// Kelvin by default, are filled at 256, 1024 and 4096 entries, plain and with
+// a few brightness and gamma profiles. The largest difference to the
+// reference, in 16 bit ramp units, is printed per size and the run fails if
+// it exceeds MAX_ERROR, or MAX_ERROR_GAMMA for profiles with a gamma, whose
+// curve and multiplier are rounded separately.
+//
+// speed: a fill of each size is timed while sweeping the temperature, as a
+// night light transition does, for both implementations.
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../src/services/wayland_service/colorramp.h"
+
+#define MAX_ERROR 1
+#define MAX_ERROR_GAMMA 2
+
+static const int sizes[] = {256, 1024, 4096};
+
+static const struct {
+    double brightness;
+    double gamma;
+} profiles[] = {
+    {1.0, 1.0},
+    {0.5, 1.0},
+    {1.0, 0.8},
+    {0.7, 1.2},
+};
+
+static void reference_fill(uint16_t *ramps[3], int size, int temperature,
+                           double brightness, double gamma) {
+    float white_point[3];
+    float alpha = (temperature % 100) / 100.0;
+    int temp_index = ((temperature - 1000) / 100) * 3;
+    interpolate_color(alpha, &blackbody_color[temp_index],
+                      &blackbody_color[temp_index + 3], white_point);
+
+    for (int c = 0; c < 3; c++) {
+        for (int i = 0; i < size; i++) {
+            double y = (double)(((uint32_t)i << 16) / size) / (UINT16_MAX + 1);
+            ramps[c][i] =
+                pow(y * brightness * white_point[c], 1.0 / gamma) *
+                (UINT16_MAX + 1);
+        }
+    }
+}
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int check_accuracy(int step) {
+    int failed = 0;
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int size = sizes[s];
+        uint16_t *buff = malloc(size * 6 * sizeof(uint16_t));
+        uint16_t *ref[3] = {buff, buff + size, buff + 2 * size};
+        uint16_t *out[3] = {buff + 3 * size, buff + 4 * size, buff + 5 * size};
+        int worst = 0, worst_temperature = 0;
+        int worst_gamma = 0, worst_gamma_temperature = 0;
+
+        for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++) {
+            int *w = profiles[p].gamma == 1.0 ? &worst : &worst_gamma;
+            int *wt = profiles[p].gamma == 1.0 ? &worst_temperature
+                                               : &worst_gamma_temperature;
+
+            for (int t = COLORRAMP_LUT_MIN; t < COLORRAMP_LUT_MAX; t += step) {
+                reference_fill(ref, size, t, profiles[p].brightness,
+                               profiles[p].gamma);
+                colorramp_fill_profile(out[0], out[1], out[2], size, t,
+                                       profiles[p].brightness,
+                                       profiles[p].gamma);
+
+                for (int c = 0; c < 3; c++) {
+                    for (int i = 0; i < size; i++) {
+                        int d = abs((int)out[c][i] - (int)ref[c][i]);
+                        if (d > *w) {
+                            *w = d;
+                            *wt = t;
+                        }
+                    }
+                }
+            }
+        }
+
+        printf(
+            "accuracy %4d entries: max error %d (at %dK), with gamma %d "
+            "(at %dK)\n",
+            size, worst, worst_temperature, worst_gamma,
+            worst_gamma_temperature);
+        if (worst > MAX_ERROR || worst_gamma > MAX_ERROR_GAMMA) failed = 1;
+        free(buff);
+    }
+
+    return failed;
+}
+
+static void bench(int iterations) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        int size = sizes[s];
+        uint16_t *buff = malloc(size * 3 * sizeof(uint16_t));
+        uint16_t *ramps[3] = {buff, buff + size, buff + 2 * size};
+
+        double start = now_us();
+        for (int n = 0; n < iterations; n++)
+            reference_fill(ramps, size, 1000 + n % 24000, 1.0, 1.0);
+        double reference = (now_us() - start) / iterations;
+
+        start = now_us();
+        for (int n = 0; n < iterations; n++)
+            colorramp_fill(ramps[0], ramps[1], ramps[2], size,
+                           1000 + n % 24000);
+        double fixed = (now_us() - start) / iterations;
+
+        printf("speed    %4d entries: reference %8.2fus  colorramp %6.2fus\n",
+               size, reference, fixed);
+        free(buff);
+    }
+}
+
+int main(int argc, char **argv) {
+    int iterations = 20000;
+    int step = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:s:")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atoi(optarg);
+                if (iterations < 1) iterations = 1;
+                break;
+            case 's':
+                step = atoi(optarg);
+                if (step < 1) step = 1;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n iterations] [-s step]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    int failed = check_accuracy(step);
+    bench(iterations);
+
+    if (failed) printf("[Fail] ramps differ from the reference\n");
+    return failed;
+}
@@ -0,0 +1,182 @@
+// desktop-entry-bench: times how long the desktop entry service takes to have
+// every installed application ready, with and without its cache.
+//
+//   desktop-entry-bench [-n runs]
+//
+// Each run is a fresh process, GLib keeps parsed applications directories
+// in memory and a second scan in the same process would be nearly free.
+//
+// - scan: what a start without a cache does, g_app_info_get_all and building
+//   the entries from every GAppInfo.
+// - cache: what a start with a valid cache does, mapping the cache file,
+//   validating it and checking the directories' modification times.
+//
+// Both end by touching every entry's name and search keys, as the first
+// Activities search would. The cache is written to a temporary
+// XDG_CACHE_HOME, the user's own is left alone. The page cache is warm in
+// both cases, a first start after boot pays disk reads on top of the scan.
+#include <adwaita.h>
+#include <getopt.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/services/desktop_entry_service/desktop_entry_cache.h"
+
+static gsize touch_entries(GArray *entries) {
+    gsize bytes = 0;
+    for (guint i = 0; i < entries->len; i++) {
+        DesktopEntry *entry = &g_array_index(entries, DesktopEntry, i);
+        if (entry->name) bytes += strlen(entry->name);
+        if (entry->search_keys) bytes += strlen(entry->search_keys);
+    }
+    return bytes;
+}
+
+static DesktopEntryCache *scan(void) {
+    GBytes *stamps = desktop_entry_cache_stamp();
+    GPtrArray *app_infos = g_ptr_array_new_with_free_func(g_object_unref);
+
+    GList *apps = g_app_info_get_all();
+    for (GList *l = apps; l; l = l->next) g_ptr_array_add(app_infos, l->data);
+    g_list_free(apps);
+
+    DesktopEntryCache *cache =
+        desktop_entry_cache_new_from_app_infos(app_infos, stamps);
+
+    g_ptr_array_unref(app_infos);
+    g_bytes_unref(stamps);
+    return cache;
+}
+
+// Runs in a child, prints the microseconds until the entries were ready.
+static int run_child(const char *mode) {
+    gint64 start = g_get_monotonic_time();
+    DesktopEntryCache *cache = NULL;
+
+    if (strcmp(mode, "scan") == 0) {
+        cache = scan();
+    } else {
+        // stamped as the service does, the check is part of every start
+        cache = desktop_entry_cache_open();
+        GBytes *stamps = desktop_entry_cache_stamp();
+        gboolean stale =
+            cache &&
+            !g_bytes_equal(stamps, desktop_entry_cache_get_stamps(cache));
+        g_bytes_unref(stamps);
+        if (!cache || stale) {
+            fprintf(stderr, "no valid cache\n");
+            return 1;
+        }
+    }
+    if (!cache) return 1;
+
+    gsize bytes = touch_entries(desktop_entry_cache_get_entries(cache));
+    gint64 elapsed = g_get_monotonic_time() - start;
+
+    printf("%" G_GINT64_FORMAT " %u %zu\n", elapsed,
+           desktop_entry_cache_get_entries(cache)->len, bytes);
+    return 0;
+}
+
+// Writes the cache the "cache" runs open.
+static void prepare_cache(void) {
+    DesktopEntryCache *cache = scan();
+    desktop_entry_cache_save(cache);
+
+    // the save completes on the main context
+    char *path = g_build_filename(g_get_user_cache_dir(), "way-shell",
+                                  "desktop-entries.cache", NULL);
+    while (!g_file_test(path, G_FILE_TEST_EXISTS))
+        g_main_context_iteration(NULL, TRUE);
+    while (g_main_context_iteration(NULL, FALSE));
+
+    g_free(path);
+    desktop_entry_cache_free(cache);
+}
+
+static gint compare_gint64(gconstpointer a, gconstpointer b) {
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static int run(const char *self, const char *mode, int runs) {
+    GArray *times = g_array_new(FALSE, FALSE, sizeof(gint64));
+    guint entries = 0;
+
+    for (int i = 0; i < runs; i++) {
+        const char *argv[] = {self, "-c", mode, NULL};
+        char *out = NULL;
+        gint status = 0;
+        GError *error = NULL;
+
+        if (!g_spawn_sync(NULL, (char **)argv, NULL, G_SPAWN_DEFAULT, NULL,
+                          NULL, &out, NULL, &status, &error) ||
+            !g_spawn_check_wait_status(status, &error)) {
+            fprintf(stderr, "%s run failed: %s\n", mode, error->message);
+            g_error_free(error);
+            g_free(out);
+            return 1;
+        }
+
+        gint64 us = g_ascii_strtoll(out, NULL, 10);
+        char *rest = strchr(out, ' ');
+        if (rest) entries = strtoul(rest + 1, NULL, 10);
+        g_array_append_val(times, us);
+        g_free(out);
+    }
+
+    g_array_sort(times, compare_gint64);
+    printf("%-5s  %u entries  min %8" G_GINT64_FORMAT
+           "us  median %8" G_GINT64_FORMAT "us  max %8" G_GINT64_FORMAT "us\n",
+           mode, entries, g_array_index(times, gint64, 0),
+           g_array_index(times, gint64, times->len / 2),
+           g_array_index(times, gint64, times->len - 1));
+
+    g_array_unref(times);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *child = NULL;
+    int runs = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:")) != -1) {
+        switch (opt) {
+            case 'n':
+                runs = MAX(1, atoi(optarg));
+                break;
+            case 'c':
+                child = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-n runs]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    if (child) return run_child(child);
+
+    // children inherit it
+    char *cache_home = g_dir_make_tmp("desktop-entry-bench-XXXXXX", NULL);
+    g_setenv("XDG_CACHE_HOME", cache_home, TRUE);
+
+    prepare_cache();
+
+    char *self = g_file_read_link("/proc/self/exe", NULL);
+    int ret = run(self, "scan", runs) || run(self, "cache", runs);
+
+    char *path = g_build_filename(cache_home, "way-shell",
+                                  "desktop-entries.cache", NULL);
+    char *dir = g_path_get_dirname(path);
+    g_remove(path);
+    g_rmdir(dir);
+    g_rmdir(cache_home);
+    g_free(path);
+    g_free(dir);
+    g_free(self);
+    g_free(cache_home);
+    return ret;
+}
@@ -0,0 +1,431 @@
+// gamma-pacing: measures how evenly night light transitions reach an output
+// and how many of its refreshes they drop.
+//
+//   gamma-pacing [-o output] [-d duration ms] [-n transitions] [-l load us]
+//                [-b max dropped percent]
+//
+// Transitions swing the output between 6500K and 3500K through
+// zwlr_gamma_control_v1, paced as wayland_service.c paces them: the
+// production gamma_transition.c steps them once per refresh of the output, a
+// table is followed by a wl_display_sync and steps are skipped until the
+// compositor answers it.
+//
+// Per transition it reports the tables sent against the refreshes spanned,
+// refreshes dropped because the timer fired late or a table was still in
+// flight, and the CPU time the process used. Over all transitions it reports
+// percentiles of the interval between tables and of the time from a table to
+// its acknowledgment.
+//
+// `load` makes the main loop spend that long on other work every millisecond,
+// as a busy shell would. The run fails if any transition drops more than
+// `max dropped percent` of its refreshes, 10 by default.
+//
+// Only one client may hold an output's gamma, stop way-shell's night light
+// first. The output is handed back unfiltered on exit.
+//
+//   make bench
+//
+// runs the default transitions and again under 500us/ms of load.
+
+// memfd_create
+#define _GNU_SOURCE
+#include <adwaita.h>
+#include <errno.h>
+#include <getopt.h>
+#include <glib-unix.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+#include "../../src/services/wayland_service/colorramp.h"
+#include "../../src/services/wayland_service/gamma_transition.h"
+#include "../../src/services/wayland_service/wlr-gamma-control-unstable-v1.h"
+
+#define DAY_TEMPERATURE 6500
+#define NIGHT_TEMPERATURE 3500
+
+typedef struct _Output {
+    struct wl_output *output;
+    char *name;
+    // refresh rate of the current mode in mHz
+    int32_t refresh;
+} Output;
+
+static struct {
+    struct wl_display *display;
+    struct zwlr_gamma_control_manager_v1 *manager;
+    GPtrArray *outputs;
+
+    struct zwlr_gamma_control_v1 *control;
+    uint32_t gamma_size;
+    gboolean failed;
+    int fds[2];
+    uint16_t *tables[2];
+    guint next;
+
+    GammaTransition transition;
+    struct wl_callback *in_flight;
+    int temperature;
+    guint interval_ms;
+    gint64 duration_us;
+    gint64 load_us;
+    int remaining;
+    gint64 cpu_start_us;
+
+    GArray *intervals;
+    GArray *acks;
+    gint64 last_frame_us;
+    int dropped_worst;
+    GMainLoop *loop;
+} state;
+
+static void output_handle_geometry(void *data, struct wl_output *wl_output,
+                                   int32_t x, int32_t y, int32_t physical_width,
+                                   int32_t physical_height, int32_t subpixel,
+                                   const char *make, const char *model,
+                                   int32_t transform) {}
+
+static void output_handle_mode(void *data, struct wl_output *wl_output,
+                               uint32_t flags, int32_t width, int32_t height,
+                               int32_t refresh) {
+    Output *output = data;
+    if (flags & WL_OUTPUT_MODE_CURRENT) output->refresh = refresh;
+}
+
+static void output_handle_done(void *data, struct wl_output *wl_output) {}
+
+static void output_handle_scale(void *data, struct wl_output *wl_output,
+                                int32_t factor) {}
+
+static void output_handle_name(void *data, struct wl_output *wl_output,
+                               const char *name) {
+    Output *output = data;
+    g_free(output->name);
+    output->name = g_strdup(name);
+}
+
+static void output_handle_description(void *data, struct wl_output *wl_output,
+                                      const char *description) {}
+
+static const struct wl_output_listener output_listener = {
+    .geometry = output_handle_geometry,
+    .mode = output_handle_mode,
+    .done = output_handle_done,
+    .scale = output_handle_scale,
+    .name = output_handle_name,
+    .description = output_handle_description,
+};
+
+static void registry_global(void *data, struct wl_registry *registry,
+                            uint32_t name, const char *interface,
+                            uint32_t version) {
+    if (strcmp(interface, wl_output_interface.name) == 0) {
+        Output *output = g_new0(Output, 1);
+        output->output = wl_registry_bind(registry, name, &wl_output_interface,
+                                          MIN(version, 4));
+        wl_output_add_listener(output->output, &output_listener, output);
+        g_ptr_array_add(state.outputs, output);
+    } else if (strcmp(interface,
+                      zwlr_gamma_control_manager_v1_interface.name) == 0) {
+        state.manager = wl_registry_bind(
+            registry, name, &zwlr_gamma_control_manager_v1_interface, 1);
+    }
+}
+
+static void registry_global_remove(void *data, struct wl_registry *registry,
+                                   uint32_t name) {}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = registry_global,
+    .global_remove = registry_global_remove,
+};
+
+static void gamma_handle_size(void *data,
+                              struct zwlr_gamma_control_v1 *control,
+                              uint32_t size) {
+    state.gamma_size = size;
+}
+
+static void gamma_handle_failed(void *data,
+                                struct zwlr_gamma_control_v1 *control) {
+    state.failed = TRUE;
+}
+
+static const struct zwlr_gamma_control_v1_listener gamma_listener = {
+    .gamma_size = gamma_handle_size,
+    .failed = gamma_handle_failed,
+};
+
+// Two tables alternated as wayland_gamma_pool_get does.
+static void tables_init(void) {
+    size_t table_size = state.gamma_size * 3 * sizeof(uint16_t);
+    for (int i = 0; i < 2; i++) {
+        state.fds[i] = memfd_create("gamma-pacing", MFD_CLOEXEC);
+        if (state.fds[i] < 0 || ftruncate(state.fds[i], table_size) < 0)
+            g_error("memfd: %s", strerror(errno));
+        state.tables[i] = mmap(NULL, table_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, state.fds[i], 0);
+        if (state.tables[i] == MAP_FAILED) g_error("mmap: %s", strerror(errno));
+    }
+}
+
+static void set_gamma(int temperature) {
+    uint16_t *table = state.tables[state.next];
+    int fd = state.fds[state.next];
+    state.next = !state.next;
+
+    colorramp_fill(table, table + state.gamma_size,
+                   table + state.gamma_size * 2, state.gamma_size,
+                   temperature);
+    lseek(fd, 0, SEEK_SET);
+    zwlr_gamma_control_v1_set_gamma(state.control, fd);
+}
+
+static void sync_handle_done(void *data, struct wl_callback *callback,
+                             uint32_t serial) {
+    gint64 now = g_get_monotonic_time();
+
+    wl_callback_destroy(callback);
+    state.in_flight = NULL;
+    gamma_transition_acked(&state.transition, now);
+
+    if (!state.transition.frame_us) return;
+    gint64 latency = now - state.transition.frame_us;
+    g_array_append_val(state.acks, latency);
+}
+
+static const struct wl_callback_listener sync_listener = {
+    .done = sync_handle_done,
+};
+
+static void flush(void) {
+    int ret = wl_display_flush(state.display);
+    while (ret == -1 && errno == EAGAIN) ret = wl_display_flush(state.display);
+}
+
+static gint64 cpu_time_us(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * G_USEC_PER_SEC +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+static void transition_report(void) {
+    GammaTransitionStats *stats = &state.transition.stats;
+    guint dropped = gamma_transition_dropped(stats);
+    int percent = stats->expected ? dropped * 100 / stats->expected : 0;
+
+    printf("%5dK -> %5dK  frames %4u/%-4u  dropped %3u (late %u, skipped %u)"
+           "  cpu %6" G_GINT64_FORMAT "us  busy %6" G_GINT64_FORMAT "us\n",
+           (int)state.transition.from, state.transition.target, stats->frames,
+           stats->expected, dropped, stats->missed, stats->skipped,
+           cpu_time_us() - state.cpu_start_us, stats->busy_us);
+    state.dropped_worst = MAX(state.dropped_worst, percent);
+}
+
+static void transition_start(void);
+
+// Mirrors wayland_wlr_gamma_control_tick.
+static gboolean on_tick(gpointer data) {
+    GammaTransition *transition = &state.transition;
+    gint64 now = g_get_monotonic_time();
+    int temperature = 0;
+    gboolean done = FALSE;
+
+    if (!gamma_transition_step(transition, now, state.in_flight != NULL,
+                               &temperature, &done))
+        return G_SOURCE_CONTINUE;
+
+    if (temperature != state.temperature) {
+        state.temperature = temperature;
+        set_gamma(temperature);
+
+        state.in_flight = wl_display_sync(state.display);
+        wl_callback_add_listener(state.in_flight, &sync_listener, NULL);
+        flush();
+
+        if (state.last_frame_us) {
+            gint64 interval = now - state.last_frame_us;
+            g_array_append_val(state.intervals, interval);
+        }
+        state.last_frame_us = now;
+        gamma_transition_sent(transition, now, g_get_monotonic_time() - now);
+    }
+
+    if (!done) return G_SOURCE_CONTINUE;
+
+    transition_report();
+    if (--state.remaining > 0)
+        transition_start();
+    else
+        g_main_loop_quit(state.loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void transition_start(void) {
+    int target = state.temperature == DAY_TEMPERATURE ? NIGHT_TEMPERATURE
+                                                      : DAY_TEMPERATURE;
+
+    // as wayland_wlr_gamma_control_animate, a sync of the last transition
+    // is not waited for.
+    if (state.in_flight) {
+        wl_callback_destroy(state.in_flight);
+        state.in_flight = NULL;
+    }
+
+    state.cpu_start_us = cpu_time_us();
+    state.last_frame_us = 0;
+    gamma_transition_start(&state.transition, state.temperature, target,
+                           state.duration_us, state.interval_ms * 1000,
+                           g_get_monotonic_time());
+
+    if (on_tick(NULL) == G_SOURCE_CONTINUE)
+        g_timeout_add(state.interval_ms, on_tick, NULL);
+}
+
+static gboolean on_load(gpointer data) {
+    gint64 until = g_get_monotonic_time() + state.load_us;
+    while (g_get_monotonic_time() < until);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_display_readable(gint fd, GIOCondition condition,
+                                    gpointer data) {
+    if (wl_display_dispatch(state.display) == -1) g_error("dispatch failed");
+    flush();
+    return G_SOURCE_CONTINUE;
+}
+
+static gint compare_gint64(gconstpointer a, gconstpointer b) {
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static gint64 percentile(GArray *sorted, double p) {
+    if (!sorted->len) return 0;
+    guint i = MIN(sorted->len - 1, (guint)(p * sorted->len));
+    return g_array_index(sorted, gint64, i);
+}
+
+static void print_percentiles(const char *what, GArray *samples) {
+    g_array_sort(samples, compare_gint64);
+    printf("%-14s us: p50 %6" G_GINT64_FORMAT "  p99 %6" G_GINT64_FORMAT
+           "  max %6" G_GINT64_FORMAT "\n",
+           what, percentile(samples, 0.5), percentile(samples, 0.99),
+           percentile(samples, 1.0));
+}
+
+int main(int argc, char **argv) {
+    const char *name = NULL;
+    guint duration_ms = 1000;
+    int transitions = 4;
+    int max_dropped = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:d:n:l:b:")) != -1) {
+        switch (opt) {
+            case 'o':
+                name = optarg;
+                break;
+            case 'd':
+                duration_ms = MAX(0, atoi(optarg));
+                break;
+            case 'n':
+                transitions = MAX(1, atoi(optarg));
+                break;
+            case 'l':
+                state.load_us = CLAMP(atoi(optarg), 0, 900);
+                break;
+            case 'b':
+                max_dropped = MAX(0, atoi(optarg));
+                break;
+            default:
+                fprintf(stderr,
+                        "usage: %s [-o output] [-d duration ms] "
+                        "[-n transitions] [-l load us] "
+                        "[-b max dropped percent]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+
+    state.display = wl_display_connect(NULL);
+    if (!state.display) {
+        fprintf(stderr, "no Wayland display\n");
+        return 1;
+    }
+    state.outputs = g_ptr_array_new();
+    state.intervals = g_array_new(FALSE, FALSE, sizeof(gint64));
+    state.acks = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    struct wl_registry *registry = wl_display_get_registry(state.display);
+    wl_registry_add_listener(registry, &registry_listener, NULL);
+    // globals, then the outputs' names and modes
+    wl_display_roundtrip(state.display);
+    wl_display_roundtrip(state.display);
+
+    if (!state.manager) {
+        fprintf(stderr, "compositor lacks zwlr_gamma_control_manager_v1\n");
+        return 1;
+    }
+
+    Output *output = NULL;
+    for (guint i = 0; i < state.outputs->len && !output; i++) {
+        Output *o = g_ptr_array_index(state.outputs, i);
+        if (!name || g_strcmp0(o->name, name) == 0) output = o;
+    }
+    if (!output) {
+        fprintf(stderr, "no output %s\n", name ? name : "");
+        return 1;
+    }
+
+    state.control = zwlr_gamma_control_manager_v1_get_gamma_control(
+        state.manager, output->output);
+    zwlr_gamma_control_v1_add_listener(state.control, &gamma_listener, NULL);
+    while (!state.gamma_size && !state.failed)
+        if (wl_display_roundtrip(state.display) == -1) return 1;
+    if (state.failed) {
+        fprintf(stderr, "gamma control failed, is a night light running?\n");
+        return 1;
+    }
+    tables_init();
+
+    // as wayland_wlr_gamma_control_animate paces to the refresh rate
+    state.interval_ms = 16;
+    if (output->refresh > 0)
+        state.interval_ms = MAX(1, 1000000 / output->refresh);
+    state.duration_us = (gint64)duration_ms * 1000;
+    state.remaining = transitions;
+    state.temperature = DAY_TEMPERATURE;
+
+    printf("%s: %u entries, %.2fHz, a step every %ums, load %" G_GINT64_FORMAT
+           "us/ms\n",
+           output->name ? output->name : "output", state.gamma_size,
+           output->refresh / 1000.0, state.interval_ms, state.load_us);
+
+    g_unix_fd_add(wl_display_get_fd(state.display), G_IO_IN,
+                  on_display_readable, NULL);
+    if (state.load_us) g_timeout_add(1, on_load, NULL);
+
+    state.loop = g_main_loop_new(NULL, FALSE);
+    transition_start();
+    g_main_loop_run(state.loop);
+
+    print_percentiles("frame interval", state.intervals);
+    print_percentiles("ack latency", state.acks);
+
+    zwlr_gamma_control_v1_destroy(state.control);
+    wl_display_roundtrip(state.display);
+
+    if (state.dropped_worst > max_dropped) {
+        printf("[Fail] a transition dropped %d%% of its refreshes\n",
+               state.dropped_worst);
+        return 1;
+    }
+    printf("[Pass] every transition dropped at most %d%% of its refreshes\n",
+           max_dropped);
+    return 0;
+}
@@ -0,0 +1,309 @@
+// sway-client-stress: exercises sway_client's non-blocking framing over a
+// socketpair.
+//
+//   sway-client-stress [-n frames] [-s seed]
+//
+// Three checks run in turn, each exits non-zero on the first mismatch:
+//
+// - reads: frames of random sizes, from empty to several ring sizes, are
+//   written in random chunks interleaved with sway_client_ipc_read, so
+//   headers and payloads split and wrap around the reader's ring at every
+//   offset. Every frame must come back whole, in order and byte exact.
+// - writes: frames are sent with sway_client_ipc_send to a peer which is not
+//   reading, well past the socket buffer. Sending must never block, the
+//   unsent bytes queue and are flushed by the GLib main loop as the peer
+//   drains, in order.
+// - limits: a header advertising a payload over SWAY_CLIENT_IPC_MAX_PAYLOAD
+//   and a bad magic must be rejected without allocating the payload.
+#include <adwaita.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../../src/services/window_manager_service/sway/sway_client.h"
+
+// referenced by sway_client.c, only used for debug output.
+char *WMWorkspaceEventStringTbl[WMWORKSPACE_EVENT_LEN] = {0};
+
+#define FAIL(...)                     \
+    do {                              \
+        printf("[Fail] " __VA_ARGS__); \
+        printf("\n");                 \
+        exit(1);                      \
+    } while (0)
+
+static void set_nonblocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Fills `buff` with bytes derived from the frame's index, so a frame
+// delivered out of order or shifted by a byte is caught.
+static void fill_payload(guint8 *buff, gsize size, guint index) {
+    for (gsize i = 0; i < size; i++) buff[i] = (guint8)(index * 31 + i * 7);
+}
+
+static gsize random_size(GRand *rand) {
+    switch (g_rand_int_range(rand, 0, 4)) {
+        case 0:
+            return 0;
+        case 1:
+            return g_rand_int_range(rand, 1, 64);
+        case 2:
+            // straddles the ring's initial size.
+            return g_rand_int_range(rand, SWAY_CLIENT_IPC_READ_CHUNK - 32,
+                                    SWAY_CLIENT_IPC_READ_CHUNK + 32);
+        default:
+            return g_rand_int_range(rand, 1, 256 * 1024);
+    }
+}
+
+static guint8 *encode_frame(guint32 type, const guint8 *payload, guint32 size,
+                            gsize *len) {
+    guint8 *frame = g_malloc(SWAY_CLIENT_IPC_HEADER_SIZE + size);
+
+    memcpy(frame, sway_client_ipc_magic, SWAY_CLIENT_IPC_MAGIC_SIZE);
+    memcpy(frame + SWAY_CLIENT_IPC_MAGIC_SIZE, &size, 4);
+    memcpy(frame + SWAY_CLIENT_IPC_MAGIC_SIZE + 4, &type, 4);
+    if (size) memcpy(frame + SWAY_CLIENT_IPC_HEADER_SIZE, payload, size);
+
+    *len = SWAY_CLIENT_IPC_HEADER_SIZE + size;
+    return frame;
+}
+
+typedef struct _expect {
+    GRand *rand;
+    guint next;
+    guint frames;
+} expect;
+
+// Pops every complete frame from `r` and checks it against the next expected
+// one, the sizes are replayed from a generator seeded like the sender's.
+static void check_frames(sway_client_ipc_reader *r, expect *e) {
+    sway_client_ipc_msg msg;
+    int ret = 0;
+
+    while ((ret = sway_client_ipc_recv(r, &msg)) > 0) {
+        gsize size = random_size(e->rand);
+        guint8 *want = g_malloc(size + 1);
+
+        fill_payload(want, size, e->next);
+        if (msg.type != e->next)
+            FAIL("frame %u arrived with type %u", e->next, msg.type);
+        if (msg.size != size)
+            FAIL("frame %u is %u bytes, expected %zu", e->next, msg.size,
+                 size);
+        if (size && memcmp(msg.payload, want, size) != 0)
+            FAIL("frame %u payload differs", e->next);
+
+        g_free(want);
+        g_free(msg.payload);
+        e->next++;
+    }
+    if (ret < 0) FAIL("frame %u rejected with %d", e->next, ret);
+}
+
+static void check_reads(guint frames, guint32 seed) {
+    int fds[2];
+    sway_client_ipc_reader r;
+    GRand *rand = g_rand_new_with_seed(seed);
+    GRand *chunks = g_rand_new_with_seed(seed ^ 0x5a5a5a5a);
+    expect e = {.rand = g_rand_new_with_seed(seed), .frames = frames};
+    gsize bytes = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        FAIL("socketpair: %s", strerror(errno));
+    set_nonblocking(fds[0]);
+    set_nonblocking(fds[1]);
+    sway_client_ipc_reader_init(&r);
+
+    for (guint i = 0; i < frames; i++) {
+        gsize size = random_size(rand);
+        guint8 *payload = g_malloc(size + 1);
+        gsize len = 0, off = 0;
+
+        fill_payload(payload, size, i);
+        guint8 *frame = encode_frame(i, payload, size, &len);
+        bytes += len;
+
+        // dribble the frame out, reading between chunks so frames split at
+        // every possible offset.
+        while (off < len) {
+            // MIN evaluates its arguments twice, draw once
+            gsize step = g_rand_int_range(chunks, 1, 9000);
+            gsize chunk = MIN(len - off, step);
+            gssize n = write(fds[1], frame + off, chunk);
+            if (n < 0 && errno != EAGAIN) FAIL("write: %s", strerror(errno));
+            if (n > 0) off += n;
+
+            if (sway_client_ipc_read(fds[0], &r) < 0) FAIL("read failed");
+            check_frames(&r, &e);
+        }
+
+        g_free(frame);
+        g_free(payload);
+    }
+
+    if (sway_client_ipc_read(fds[0], &r) < 0) FAIL("read failed");
+    check_frames(&r, &e);
+    if (e.next != frames)
+        FAIL("received %u of %u frames", e.next, frames);
+
+    printf("[Ok] reads: %u frames, %zu bytes, ring grew to %zu bytes\n",
+           frames, bytes, r.cap);
+
+    sway_client_ipc_reader_clear(&r);
+    close(fds[0]);
+    close(fds[1]);
+    g_rand_free(rand);
+    g_rand_free(chunks);
+    g_rand_free(e.rand);
+}
+
+static void check_writes(guint frames, guint32 seed) {
+    int fds[2];
+    sway_client_ipc_reader r;
+    GRand *rand = g_rand_new_with_seed(seed);
+    expect e = {.rand = g_rand_new_with_seed(seed), .frames = frames};
+    gint64 worst_send_us = 0;
+    gsize peak_backlog = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        FAIL("socketpair: %s", strerror(errno));
+    set_nonblocking(fds[0]);
+    set_nonblocking(fds[1]);
+    sway_client_ipc_reader_init(&r);
+
+    // the peer only reads when the backlog nears its cap, everything past the
+    // socket buffer queues meanwhile.
+    for (guint i = 0; i < frames; i++) {
+        gsize size = random_size(rand);
+        sway_client_ipc_msg msg = {.type = i, .size = size};
+
+        msg.payload = g_malloc(size + 1);
+        fill_payload((guint8 *)msg.payload, size, i);
+
+        // the backlog is capped, let the peer catch up before it overflows.
+        while (sway_client_ipc_backlog(fds[1]) + SWAY_CLIENT_IPC_HEADER_SIZE +
+                   size >
+               SWAY_CLIENT_IPC_MAX_BACKLOG) {
+            g_main_context_iteration(NULL, FALSE);
+            if (sway_client_ipc_read(fds[0], &r) < 0) FAIL("read failed");
+            check_frames(&r, &e);
+        }
+
+        gint64 start = g_get_monotonic_time();
+        if (sway_client_ipc_send(fds[1], &msg) != 0)
+            FAIL("send of frame %u failed", i);
+        gint64 took = g_get_monotonic_time() - start;
+        gsize backlog = sway_client_ipc_backlog(fds[1]);
+        worst_send_us = MAX(worst_send_us, took);
+        peak_backlog = MAX(peak_backlog, backlog);
+    }
+
+    if (peak_backlog == 0)
+        FAIL("the socket never filled, raise -n to exercise the backlog");
+
+    // drain: the main loop flushes the backlog as the peer reads.
+    while (e.next < frames) {
+        g_main_context_iteration(NULL, FALSE);
+        if (sway_client_ipc_read(fds[0], &r) < 0) FAIL("read failed");
+        check_frames(&r, &e);
+    }
+    if (sway_client_ipc_backlog(fds[1]))
+        FAIL("%zu bytes left queued", sway_client_ipc_backlog(fds[1]));
+
+    printf(
+        "[Ok] writes: %u frames, peak backlog %zu bytes, slowest send "
+        "%" G_GINT64_FORMAT " us\n",
+        frames, peak_backlog, worst_send_us);
+
+    sway_client_ipc_reader_clear(&r);
+    sway_client_ipc_close(fds[1]);
+    close(fds[0]);
+    g_rand_free(rand);
+    g_rand_free(e.rand);
+}
+
+static void check_limits() {
+    int fds[2];
+    sway_client_ipc_reader r;
+    sway_client_ipc_msg msg;
+    guint8 hdr[SWAY_CLIENT_IPC_HEADER_SIZE];
+    guint32 size = SWAY_CLIENT_IPC_MAX_PAYLOAD + 1, type = 0;
+    int ret = 0;
+
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        FAIL("socketpair: %s", strerror(errno));
+    set_nonblocking(fds[0]);
+
+    sway_client_ipc_reader_init(&r);
+    memcpy(hdr, sway_client_ipc_magic, SWAY_CLIENT_IPC_MAGIC_SIZE);
+    memcpy(hdr + SWAY_CLIENT_IPC_MAGIC_SIZE, &size, 4);
+    memcpy(hdr + SWAY_CLIENT_IPC_MAGIC_SIZE + 4, &type, 4);
+    if (write(fds[1], hdr, sizeof(hdr)) != sizeof(hdr)) FAIL("write failed");
+    sway_client_ipc_read(fds[0], &r);
+    ret = sway_client_ipc_recv(&r, &msg);
+    if (ret != -SWAY_CLIENT_ERR_PROTOCOL_FRAME_TOO_BIG)
+        FAIL("oversized frame returned %d", ret);
+    if (r.cap > 2 * SWAY_CLIENT_IPC_READ_CHUNK)
+        FAIL("oversized frame grew the ring to %zu bytes", r.cap);
+    sway_client_ipc_reader_clear(&r);
+
+    sway_client_ipc_reader_init(&r);
+    memcpy(hdr, "i3-ipx", SWAY_CLIENT_IPC_MAGIC_SIZE);
+    if (write(fds[1], hdr, sizeof(hdr)) != sizeof(hdr)) FAIL("write failed");
+    sway_client_ipc_read(fds[0], &r);
+    ret = sway_client_ipc_recv(&r, &msg);
+    if (ret != -SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC)
+        FAIL("bad magic returned %d", ret);
+    sway_client_ipc_reader_clear(&r);
+
+    printf("[Ok] limits: oversized frames and bad magic rejected\n");
+
+    close(fds[0]);
+    close(fds[1]);
+}
+
+static void usage() {
+    printf(
+        "usage: sway-client-stress [-n frames] [-s seed]\n"
+        "  -n frames  frames per check (default 2000)\n"
+        "  -s seed    random seed (default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    guint frames = 2000;
+    guint32 seed = 1;
+    int opt = 0;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while ((opt = getopt(argc, argv, "n:s:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                frames = atoi(optarg);
+                break;
+            case 's':
+                seed = strtoul(optarg, NULL, 10);
+                break;
+            default:
+                usage();
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (frames == 0) {
+        usage();
+        return 1;
+    }
+
+    check_reads(frames, seed);
+    check_writes(frames, seed);
+    check_limits();
+
+    return 0;
+}
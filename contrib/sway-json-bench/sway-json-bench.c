@@ -0,0 +1,319 @@
+// sway-json-bench: compares the streaming sway_json decoder against the
+// json-glib parse path it replaced.
+//
+//   sway-json-bench [-n iterations] [-w workspaces] [-c windows]
+//   sway-json-bench [-n iterations] -t workspaces|tree <payload.json>
+//
+// Without a payload, synthetic get_workspaces and get_tree replies shaped like
+// sway's are generated, `windows` spread over `workspaces`. A real payload can
+// be captured with `swaymsg -r -t get_tree > tree.json`.
+//
+// The streaming path runs the production sway_client_ipc_get_*_resp
+// functions. The json-glib path is the decoder sway_client.c used before,
+// JsonParser building a tree that is then walked for the same members. Both
+// decode into the same structures and copy the payload each iteration, as a
+// received frame would be.
+#include <adwaita.h>
+#include <getopt.h>
+#include <json-glib/json-glib.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../src/services/window_manager_service/sway/sway_client.h"
+
+// referenced by sway_client.c, only used for debug output.
+char *WMWorkspaceEventStringTbl[WMWORKSPACE_EVENT_LEN] = {0};
+
+typedef enum { PAYLOAD_WORKSPACES, PAYLOAD_TREE } payload_type;
+
+static void append_rect(GString *s) {
+    g_string_append(
+        s, "\"rect\":{\"x\":0,\"y\":0,\"width\":2560,\"height\":1440},"
+           "\"window_rect\":{\"x\":0,\"y\":0,\"width\":0,\"height\":0},"
+           "\"deco_rect\":{\"x\":0,\"y\":0,\"width\":0,\"height\":0},"
+           "\"geometry\":{\"x\":0,\"y\":0,\"width\":0,\"height\":0},");
+}
+
+static void append_window(GString *s, guint id) {
+    g_string_append_printf(
+        s,
+        "{\"id\":%u,\"type\":\"con\",\"orientation\":\"none\","
+        "\"percent\":0.5,\"urgent\":false,\"marks\":[],\"focused\":false,"
+        "\"layout\":\"none\",\"border\":\"pixel\",\"current_border_width\":2,",
+        id);
+    append_rect(s);
+    g_string_append_printf(
+        s,
+        "\"name\":\"~/src/way-shell: vim window %u \\u2014 terminal\","
+        "\"window\":null,\"nodes\":[],\"floating_nodes\":[],"
+        "\"focus\":[],\"fullscreen_mode\":0,\"sticky\":false,"
+        "\"pid\":%u,\"app_id\":\"org.example.App%u\",\"visible\":true,"
+        "\"max_render_time\":0,\"shell\":\"xdg_shell\","
+        "\"inhibit_idle\":false,\"idle_inhibitors\":{\"user\":\"none\","
+        "\"application\":\"none\"}}",
+        id, 1000 + id, id % 7);
+}
+
+static void append_workspace(GString *s, guint n, guint first_window,
+                             guint windows) {
+    g_string_append_printf(
+        s,
+        "{\"id\":%u,\"type\":\"workspace\",\"orientation\":\"horizontal\","
+        "\"percent\":null,\"urgent\":false,\"marks\":[],\"focused\":%s,"
+        "\"layout\":\"splith\",\"border\":\"none\","
+        "\"current_border_width\":0,",
+        100 + n, n == 1 ? "true" : "false");
+    append_rect(s);
+    g_string_append_printf(
+        s,
+        "\"name\":\"%u\",\"num\":%u,\"output\":\"DP-%u\","
+        "\"representation\":\"H[App]\",\"visible\":%s,\"fullscreen_mode\":1,"
+        "\"floating_nodes\":[],\"focus\":[],\"nodes\":[",
+        n, n, n % 2, n <= 2 ? "true" : "false");
+    for (guint i = 0; i < windows; i++) {
+        if (i) g_string_append_c(s, ',');
+        append_window(s, first_window + i);
+    }
+    g_string_append(s, "]}");
+}
+
+static gchar *synthetic_payload(payload_type type, guint workspaces,
+                                guint windows, gsize *len) {
+    GString *s = g_string_new(NULL);
+    guint per_ws = workspaces ? windows / workspaces : 0;
+    guint next_window = 1000;
+
+    if (type == PAYLOAD_TREE)
+        g_string_append(s,
+                        "{\"id\":1,\"type\":\"root\",\"name\":\"root\","
+                        "\"nodes\":[{\"id\":2,\"type\":\"output\","
+                        "\"name\":\"DP-1\",\"nodes\":");
+    g_string_append_c(s, '[');
+    for (guint i = 1; i <= workspaces; i++) {
+        guint n = type == PAYLOAD_TREE ? per_ws : 0;
+        if (type == PAYLOAD_TREE && i == workspaces)
+            n = windows - per_ws * (workspaces - 1);
+        if (i > 1) g_string_append_c(s, ',');
+        append_workspace(s, i, next_window, n);
+        next_window += n;
+    }
+    g_string_append_c(s, ']');
+    if (type == PAYLOAD_TREE) g_string_append(s, "}]}");
+
+    *len = s->len;
+    return g_string_free(s, FALSE);
+}
+
+// json-glib path //
+
+static void free_workspace(gpointer data) {
+    WMWorkspace *ws = data;
+    g_free(ws->name);
+    g_free((gchar *)ws->output);
+    g_free(ws);
+}
+
+static GPtrArray *json_glib_workspaces(const gchar *payload, gsize len) {
+    JsonParser *parser = json_parser_new();
+    GPtrArray *out = NULL;
+
+    if (!json_parser_load_from_data(parser, payload, len, NULL)) goto done;
+
+    JsonArray *arr = json_node_get_array(json_parser_get_root(parser));
+    out = g_ptr_array_new_full(0, free_workspace);
+    for (guint i = 0; i < json_array_get_length(arr); i++) {
+        JsonObject *obj = json_array_get_object_element(arr, i);
+        WMWorkspace *ws = g_malloc0(sizeof(WMWorkspace));
+
+        ws->id = json_object_get_int_member(obj, "id");
+        ws->num = json_object_get_int_member(obj, "num");
+        ws->name = g_strdup(json_object_get_string_member(obj, "name"));
+        ws->urgent = json_object_get_boolean_member(obj, "urgent");
+        ws->output = g_strdup(json_object_get_string_member(obj, "output"));
+        ws->focused = json_object_get_boolean_member(obj, "focused");
+        ws->visible = json_object_get_boolean_member(obj, "visible");
+        g_ptr_array_add(out, ws);
+    }
+
+done:
+    g_object_unref(parser);
+    return out;
+}
+
+static void json_glib_tree_node(JsonObject *obj, guint32 workspace_id,
+                                GPtrArray *out) {
+    const gchar *type = json_object_get_string_member_with_default(
+        obj, "type", NULL);
+    guint32 id = json_object_get_int_member_with_default(obj, "id", 0);
+    guint32 child_ws = g_strcmp0(type, "workspace") == 0 ? id : workspace_id;
+    guint children = 0;
+    const gchar *lists[] = {"nodes", "floating_nodes"};
+
+    for (guint l = 0; l < G_N_ELEMENTS(lists); l++) {
+        if (!json_object_has_member(obj, lists[l])) continue;
+        JsonArray *arr = json_object_get_array_member(obj, lists[l]);
+        for (guint i = 0; i < json_array_get_length(arr); i++) {
+            json_glib_tree_node(json_array_get_object_element(arr, i),
+                                child_ws, out);
+            children++;
+        }
+    }
+
+    if (children || !json_object_has_member(obj, "app_id") ||
+        (g_strcmp0(type, "con") != 0 && g_strcmp0(type, "floating_con") != 0))
+        return;
+
+    WMWindow *win = g_malloc0(sizeof(WMWindow));
+    win->id = id;
+    win->workspace_id = workspace_id;
+    win->title = g_strdup(
+        json_object_get_string_member_with_default(obj, "name", NULL));
+    win->app_id = g_strdup(
+        json_object_get_string_member_with_default(obj, "app_id", NULL));
+    win->focused = json_object_get_boolean_member(obj, "focused");
+    win->urgent = json_object_get_boolean_member(obj, "urgent");
+    g_ptr_array_add(out, win);
+}
+
+static GPtrArray *json_glib_tree(const gchar *payload, gsize len) {
+    JsonParser *parser = json_parser_new();
+    GPtrArray *out = NULL;
+
+    if (json_parser_load_from_data(parser, payload, len, NULL)) {
+        out = g_ptr_array_new_full(0, sway_client_window_free);
+        json_glib_tree_node(json_node_get_object(json_parser_get_root(parser)),
+                            0, out);
+    }
+
+    g_object_unref(parser);
+    return out;
+}
+
+// Runs one decode of `payload` and returns the number of decoded elements.
+static guint run_once(gboolean streaming, payload_type type,
+                      const gchar *payload, gsize len) {
+    GPtrArray *out = NULL;
+    guint n = 0;
+
+    if (streaming) {
+        sway_client_ipc_msg msg = {.payload = g_memdup2(payload, len),
+                                   .size = len};
+        out = type == PAYLOAD_TREE ? sway_client_ipc_get_tree_resp(&msg)
+                                   : sway_client_ipc_get_workspaces_resp(&msg);
+    } else {
+        gchar *copy = g_memdup2(payload, len);
+        out = type == PAYLOAD_TREE ? json_glib_tree(copy, len)
+                                   : json_glib_workspaces(copy, len);
+        g_free(copy);
+    }
+
+    if (out) {
+        n = out->len;
+        g_ptr_array_unref(out);
+    }
+    return n;
+}
+
+static double bench(gboolean streaming, payload_type type,
+                    const gchar *payload, gsize len, guint iterations,
+                    guint *decoded) {
+    // warm up allocators and the interned string table.
+    for (guint i = 0; i < 10; i++)
+        *decoded = run_once(streaming, type, payload, len);
+
+    gint64 start = g_get_monotonic_time();
+    for (guint i = 0; i < iterations; i++)
+        run_once(streaming, type, payload, len);
+    return (double)(g_get_monotonic_time() - start) / iterations;
+}
+
+static void report(payload_type type, const gchar *payload, gsize len,
+                   guint iterations) {
+    guint decoded_glib = 0, decoded_stream = 0;
+    double glib_us =
+        bench(FALSE, type, payload, len, iterations, &decoded_glib);
+    double stream_us =
+        bench(TRUE, type, payload, len, iterations, &decoded_stream);
+
+    printf("%s reply, %zu bytes, %u iterations\n",
+           type == PAYLOAD_TREE ? "get_tree" : "get_workspaces", len,
+           iterations);
+    printf("  json-glib  %10.1f us/parse  %8.1f MB/s  (%u decoded)\n", glib_us,
+           len / glib_us, decoded_glib);
+    printf("  sway_json  %10.1f us/parse  %8.1f MB/s  (%u decoded)\n",
+           stream_us, len / stream_us, decoded_stream);
+    printf("  speedup    %10.2fx\n", glib_us / stream_us);
+
+    if (decoded_glib != decoded_stream)
+        printf("  [Warning] decoders disagree on the element count\n");
+}
+
+static void usage() {
+    printf(
+        "usage: sway-json-bench [-n iterations] [-w workspaces] [-c windows]\n"
+        "       sway-json-bench [-n iterations] -t workspaces|tree "
+        "<payload.json>\n"
+        "  -n iterations  parses timed per decoder (default 1000)\n"
+        "  -w workspaces  synthetic workspaces (default 10)\n"
+        "  -c windows     synthetic windows in the tree (default 100)\n"
+        "  -t type        reply type of <payload.json>\n");
+}
+
+int main(int argc, char **argv) {
+    guint iterations = 1000, workspaces = 10, windows = 100;
+    const char *type_arg = NULL;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "n:w:c:t:h")) != -1) {
+        switch (opt) {
+            case 'n':
+                iterations = atoi(optarg);
+                break;
+            case 'w':
+                workspaces = atoi(optarg);
+                break;
+            case 'c':
+                windows = atoi(optarg);
+                break;
+            case 't':
+                type_arg = optarg;
+                break;
+            default:
+                usage();
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (iterations == 0 || workspaces == 0 ||
+        (type_arg && argc - optind != 1)) {
+        usage();
+        return 1;
+    }
+
+    if (type_arg) {
+        payload_type type = g_strcmp0(type_arg, "tree") == 0
+                                ? PAYLOAD_TREE
+                                : PAYLOAD_WORKSPACES;
+        gchar *payload = NULL;
+        gsize len = 0;
+        GError *error = NULL;
+
+        if (!g_file_get_contents(argv[optind], &payload, &len, &error)) {
+            printf("[Error] Failed to read %s: %s\n", argv[optind],
+                   error->message);
+            return 1;
+        }
+        report(type, payload, len, iterations);
+        g_free(payload);
+        return 0;
+    }
+
+    for (payload_type type = PAYLOAD_WORKSPACES; type <= PAYLOAD_TREE;
+         type++) {
+        gsize len = 0;
+        gchar *payload = synthetic_payload(type, workspaces, windows, &len);
+        report(type, payload, len, iterations);
+        g_free(payload);
+    }
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+// sway-replay: serves a capture recorded by way-shell's sway backend on a
+// fake Sway IPC socket.
+//
+// Record a session by starting way-shell with
+// WAY_SHELL_SWAY_RECORD=/path/to/capture, then serve it back with
+//
+//   sway-replay [-s speed] [-l loops] <socket-path> <capture>
+//
+// and start way-shell with SWAYSOCK=<socket-path> to drive the sway backend
+// without a compositor.
+//
+// Requests are answered from the capture: the first recorded reply of the
+// same type is returned, subscribes always succeed and commands report
+// success. Once a client subscribes every recorded event is replayed to all
+// subscribed clients at the recorded pace divided by `speed`. A speed of 0
+// sends the whole capture back to back, which is handy for event storms.
+// Combined with G_MESSAGES_DEBUG=all way-shell logs per-frame dispatch times.
+#include <errno.h>
+#include <getopt.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../src/services/window_manager_service/sway/ipc.h"
+#include "../../src/services/window_manager_service/sway/sway_record.h"
+
+#define MAX_CLIENTS 16
+#define IPC_MAGIC "i3-ipc"
+#define IPC_MAGIC_SIZE 6
+#define IPC_HEADER_SIZE (IPC_MAGIC_SIZE + 8)
+#define IPC_EVENT_BIT (1u << 31)
+
+typedef struct frame {
+    uint64_t usec;
+    uint32_t size;
+    uint32_t type;
+    char *payload;
+} frame;
+
+typedef struct client {
+    int fd;
+    int subscribed;
+    char *buff;
+    size_t len;
+    size_t cap;
+} client;
+
+typedef struct replay_ctx {
+    frame *frames;
+    size_t frames_n;
+    client clients[MAX_CLIENTS];
+    double speed;
+    int loops;
+    // replay state, `started` flips on the first subscribe.
+    int started;
+    size_t next;
+    uint64_t base_usec;
+    uint64_t start_usec;
+    size_t events_sent;
+} replay_ctx;
+
+static uint64_t now_usec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int load_capture(replay_ctx *ctx, const char *path) {
+    sway_record_file_header hdr;
+    sway_record_frame_header fhdr;
+    size_t cap = 0;
+    FILE *f = fopen(path, "rb");
+
+    if (!f) {
+        printf("[Error] Failed to open capture %s: %s\n", path,
+               strerror(errno));
+        return -1;
+    }
+
+    if (fread(&hdr, sizeof(hdr), 1, f) != 1 ||
+        memcmp(hdr.magic, SWAY_RECORD_MAGIC, SWAY_RECORD_MAGIC_SIZE) != 0 ||
+        hdr.version != SWAY_RECORD_VERSION) {
+        printf("[Error] %s is not a sway capture\n", path);
+        fclose(f);
+        return -1;
+    }
+
+    while (fread(&fhdr, sizeof(fhdr), 1, f) == 1) {
+        frame *fr = NULL;
+
+        if (ctx->frames_n == cap) {
+            cap = cap ? cap * 2 : 64;
+            ctx->frames = realloc(ctx->frames, cap * sizeof(frame));
+        }
+        fr = &ctx->frames[ctx->frames_n];
+        fr->usec = fhdr.usec;
+        fr->size = fhdr.size;
+        fr->type = fhdr.type;
+        fr->payload = malloc(fhdr.size + 1);
+        if (fhdr.size && fread(fr->payload, fhdr.size, 1, f) != 1) {
+            // a capture cut short by a crash, keep what we have.
+            printf("[Warn] Truncated frame at end of capture\n");
+            free(fr->payload);
+            break;
+        }
+        ctx->frames_n++;
+    }
+
+    fclose(f);
+    return 0;
+}
+
+static int listen_socket(const char *path) {
+    struct sockaddr_un addr = {.sun_family = AF_UNIX};
+    int fd = -1;
+
+    if (strlen(path) + 1 > sizeof(addr.sun_path)) {
+        printf("[Error] Socket path too long\n");
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(fd, MAX_CLIENTS) != 0) {
+        printf("[Error] Failed to listen on %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    return fd;
+}
+
+static int write_all(int fd, const char *p, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static int send_frame(client *c, uint32_t type, const char *payload,
+                      uint32_t size) {
+    char hdr[IPC_HEADER_SIZE];
+
+    memcpy(hdr, IPC_MAGIC, IPC_MAGIC_SIZE);
+    memcpy(hdr + IPC_MAGIC_SIZE, &size, 4);
+    memcpy(hdr + IPC_MAGIC_SIZE + 4, &type, 4);
+
+    if (write_all(c->fd, hdr, sizeof(hdr)) != 0) return -1;
+    return write_all(c->fd, payload, size);
+}
+
+static void client_close(client *c) {
+    close(c->fd);
+    free(c->buff);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+}
+
+// Finds the first recorded reply to a request of `type`.
+static frame *find_reply(replay_ctx *ctx, uint32_t type) {
+    for (size_t i = 0; i < ctx->frames_n; i++)
+        if (ctx->frames[i].type == type) return &ctx->frames[i];
+    return NULL;
+}
+
+static int handle_request(replay_ctx *ctx, client *c, uint32_t type,
+                          const char *payload, uint32_t size) {
+    frame *reply = NULL;
+    char *buff = NULL;
+    size_t n = 1;
+    int quoted = 0;
+    int ret = 0;
+
+    switch (type) {
+        case IPC_SUBSCRIBE:
+            c->subscribed = 1;
+            if (!ctx->started) {
+                ctx->started = 1;
+                ctx->next = 0;
+                ctx->start_usec = now_usec();
+                ctx->base_usec = ctx->start_usec;
+            }
+            return send_frame(c, type, "{\"success\": true}", 17);
+        case IPC_COMMAND:
+            // sway runs ';' and ',' separated commands, one result each.
+            // separators within double quoted arguments don't count.
+            for (uint32_t i = 0; i < size; i++) {
+                if (payload[i] == '\\' && quoted)
+                    i++;
+                else if (payload[i] == '"')
+                    quoted = !quoted;
+                else if (!quoted && (payload[i] == ';' || payload[i] == ','))
+                    n++;
+            }
+            buff = malloc(n * 18 + 2);
+            strcpy(buff, "[");
+            for (size_t i = 0; i < n; i++)
+                strcat(buff, i ? ",{\"success\":true}" : "{\"success\":true}");
+            strcat(buff, "]");
+            ret = send_frame(c, type, buff, strlen(buff));
+            free(buff);
+            return ret;
+    }
+
+    reply = find_reply(ctx, type);
+    if (reply) return send_frame(c, type, reply->payload, reply->size);
+
+    if (type == IPC_GET_WORKSPACES || type == IPC_GET_OUTPUTS)
+        return send_frame(c, type, "[]", 2);
+    return send_frame(c, type, "{}", 2);
+}
+
+static int client_read(replay_ctx *ctx, client *c) {
+    ssize_t n = 0;
+    size_t off = 0;
+
+    if (c->cap - c->len < 4096) {
+        c->cap = c->cap ? c->cap * 2 : 8192;
+        c->buff = realloc(c->buff, c->cap);
+    }
+
+    n = read(c->fd, c->buff + c->len, c->cap - c->len);
+    if (n <= 0) return -1;
+    c->len += n;
+
+    while (c->len - off >= IPC_HEADER_SIZE) {
+        uint32_t size, type;
+        char *p = c->buff + off;
+
+        if (memcmp(p, IPC_MAGIC, IPC_MAGIC_SIZE) != 0) {
+            printf("[Error] Client sent a bad frame\n");
+            return -1;
+        }
+        memcpy(&size, p + IPC_MAGIC_SIZE, 4);
+        memcpy(&type, p + IPC_MAGIC_SIZE + 4, 4);
+        if (c->len - off - IPC_HEADER_SIZE < size) break;
+
+        if (handle_request(ctx, c, type, p + IPC_HEADER_SIZE, size) != 0)
+            return -1;
+        off += IPC_HEADER_SIZE + size;
+    }
+
+    memmove(c->buff, c->buff + off, c->len - off);
+    c->len -= off;
+    return 0;
+}
+
+// Sends every event which is due and returns the poll timeout in ms until
+// the next one, or -1 once the replay is finished.
+static int replay_due(replay_ctx *ctx) {
+    uint64_t now = 0;
+    uint64_t first = 0;
+
+    if (!ctx->started || ctx->loops == 0) return -1;
+
+    for (size_t i = 0; i < ctx->frames_n; i++)
+        if (ctx->frames[i].type & IPC_EVENT_BIT) {
+            first = ctx->frames[i].usec;
+            break;
+        }
+
+    for (;;) {
+        frame *fr = NULL;
+        uint64_t due = 0;
+
+        while (ctx->next < ctx->frames_n &&
+               !(ctx->frames[ctx->next].type & IPC_EVENT_BIT))
+            ctx->next++;
+
+        if (ctx->next == ctx->frames_n) {
+            if (--ctx->loops == 0) {
+                uint64_t elapsed = now_usec() - ctx->start_usec;
+                printf("[Info] Replayed %zu events in %.3f ms\n",
+                       ctx->events_sent, elapsed / 1000.0);
+                return -1;
+            }
+            ctx->next = 0;
+            ctx->base_usec = now_usec();
+            continue;
+        }
+
+        fr = &ctx->frames[ctx->next];
+        if (ctx->speed > 0) {
+            due = ctx->base_usec + (fr->usec - first) / ctx->speed;
+            now = now_usec();
+            if (due > now) return (due - now + 999) / 1000;
+        }
+
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            client *c = &ctx->clients[i];
+            if (c->fd < 0 || !c->subscribed) continue;
+            if (send_frame(c, fr->type, fr->payload, fr->size) != 0)
+                client_close(c);
+        }
+        ctx->events_sent++;
+        ctx->next++;
+    }
+}
+
+static void usage() {
+    printf(
+        "usage: sway-replay [-s speed] [-l loops] <socket-path> <capture>\n"
+        "  -s speed  replay speed multiplier, 0 replays without delays "
+        "(default 1)\n"
+        "  -l loops  number of times to replay the capture's events "
+        "(default 1)\n");
+}
+
+int main(int argc, char **argv) {
+    replay_ctx ctx = {.speed = 1.0, .loops = 1};
+    struct pollfd fds[MAX_CLIENTS + 1];
+    int listen_fd = -1;
+    int opt = 0;
+
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    while ((opt = getopt(argc, argv, "s:l:h")) != -1) {
+        switch (opt) {
+            case 's':
+                ctx.speed = atof(optarg);
+                break;
+            case 'l':
+                ctx.loops = atoi(optarg);
+                break;
+            default:
+                usage();
+                return opt == 'h' ? 0 : 1;
+        }
+    }
+    if (argc - optind != 2 || ctx.speed < 0 || ctx.loops < 1) {
+        usage();
+        return 1;
+    }
+
+    if (load_capture(&ctx, argv[optind + 1]) != 0) return 1;
+    printf("[Info] Loaded %zu frames\n", ctx.frames_n);
+
+    listen_fd = listen_socket(argv[optind]);
+    if (listen_fd < 0) return 1;
+
+    for (int i = 0; i < MAX_CLIENTS; i++) ctx.clients[i].fd = -1;
+
+    for (;;) {
+        int timeout = replay_due(&ctx);
+
+        fds[0] = (struct pollfd){.fd = listen_fd, .events = POLLIN};
+        for (int i = 0; i < MAX_CLIENTS; i++)
+            fds[i + 1] =
+                (struct pollfd){.fd = ctx.clients[i].fd, .events = POLLIN};
+
+        if (poll(fds, MAX_CLIENTS + 1, timeout) < 0) {
+            if (errno == EINTR) continue;
+            printf("[Error] poll failed: %s\n", strerror(errno));
+            return 1;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listen_fd, NULL, NULL);
+            int i = 0;
+            for (; i < MAX_CLIENTS && ctx.clients[i].fd >= 0; i++);
+            if (fd >= 0 && i < MAX_CLIENTS)
+                ctx.clients[i].fd = fd;
+            else if (fd >= 0)
+                close(fd);
+        }
+
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (fds[i + 1].fd < 0 || !fds[i + 1].revents) continue;
+            if (client_read(&ctx, &ctx.clients[i]) != 0)
+                client_close(&ctx.clients[i]);
+        }
+    }
+}
@@ -0,0 +1,479 @@
+// wayland-stall: measures how long foreign toplevel traffic keeps the GLib
+// main loop from running, with the events handled on the main loop as
+// wayland_service.c used to and with the wayland_event_thread it uses now.
+//
+//   wayland-stall churn [-n windows] [-r titles per second per window]
+//   wayland-stall measure [-m main|thread] [-d seconds]
+//
+// `churn` opens GTK windows and retitles them as fast as asked, a synthetic
+// title storm for any wlroots compositor to forward.
+// `measure` follows every toplevel through zwlr_foreign_toplevel_manager_v1
+// while a 1ms heartbeat timer runs on the main loop. A heartbeat firing late
+// is time the main loop could not spend on input or rendering, its lateness
+// is reported as percentiles along with the longest single wake-up spent on
+// Wayland events.
+//
+// `main` reads, demarshals and applies every event in a main loop callback.
+// `thread` runs the production wayland_event_thread.c and folds events per
+// done on the thread like wayland_service.c, the main loop only applies the
+// records. Either way applying a done costs the same, the work the service's
+// signal handlers do on top is not part of the measurement.
+//
+//   make bench
+//
+// runs a churn client and both modes against the current compositor, e.g. a
+// headless `WLR_BACKENDS=headless sway`.
+#include <adwaita.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+#include "../../src/services/wayland_service/wayland_event_thread.h"
+#include "../../src/services/wayland_service/wlr-foreign-toplevel-management-unstable-v1.h"
+
+#define CHANGE_TITLE (1 << 0)
+#define CHANGE_APP_ID (1 << 1)
+
+typedef struct _Toplevel {
+    struct zwlr_foreign_toplevel_handle_v1 *handle;
+    uint32_t serial;
+    char *title;
+    char *app_id;
+    guint changed;
+} Toplevel;
+
+static struct {
+    struct wl_display *display;
+    WaylandEventThread *events;
+    uint32_t serial;
+    // Toplevel structs mapped by their handles, main loop only
+    GHashTable *toplevels;
+
+    // title and app id events, counted on whichever thread dispatches them
+    gint events_seen;
+    guint64 dones;
+    gint64 busy_max;
+    gint64 busy_total;
+
+    gint64 heartbeat_last;
+    GArray *lateness;
+} state;
+
+static void toplevel_free(Toplevel *toplevel) {
+    g_free(toplevel->title);
+    g_free(toplevel->app_id);
+    g_free(toplevel);
+}
+
+// The cost of applying a done, the same in both modes.
+static void toplevel_apply(Toplevel *toplevel) {
+    if (toplevel->changed) state.dones++;
+    toplevel->changed = 0;
+}
+
+static void set_string(char **field, const char *value, guint *changed,
+                       guint bit) {
+    if (g_strcmp0(*field, value) == 0) return;
+    g_free(*field);
+    *field = g_strdup(value);
+    *changed |= bit;
+}
+
+// Listeners used by both modes, `data` is the Toplevel. In main mode it is
+// the one in `state.toplevels`, in thread mode a copy private to the thread.
+
+static void handle_title(void *data,
+                         struct zwlr_foreign_toplevel_handle_v1 *handle,
+                         const char *title) {
+    Toplevel *toplevel = data;
+    g_atomic_int_inc(&state.events_seen);
+    set_string(&toplevel->title, title, &toplevel->changed, CHANGE_TITLE);
+}
+
+static void handle_app_id(void *data,
+                          struct zwlr_foreign_toplevel_handle_v1 *handle,
+                          const char *app_id) {
+    Toplevel *toplevel = data;
+    g_atomic_int_inc(&state.events_seen);
+    set_string(&toplevel->app_id, app_id, &toplevel->changed, CHANGE_APP_ID);
+}
+
+static void handle_output(void *data,
+                          struct zwlr_foreign_toplevel_handle_v1 *handle,
+                          struct wl_output *output) {}
+
+static void handle_state(void *data,
+                         struct zwlr_foreign_toplevel_handle_v1 *handle,
+                         struct wl_array *array) {}
+
+static void handle_parent(void *data,
+                          struct zwlr_foreign_toplevel_handle_v1 *handle,
+                          struct zwlr_foreign_toplevel_handle_v1 *parent) {}
+
+static void handle_done_main(void *data,
+                             struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    toplevel_apply(data);
+}
+
+static void handle_closed_main(void *data,
+                               struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    g_hash_table_remove(state.toplevels, handle);
+    zwlr_foreign_toplevel_handle_v1_destroy(handle);
+}
+
+static void handle_done_thread(void *data,
+                               struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    Toplevel *pending = data;
+    if (!pending->changed) return;
+
+    WaylandEventRecord record = {
+        .type = WAYLAND_EVENT_TOPLEVEL_DONE,
+        .proxy = handle,
+        .serial = pending->serial,
+        .toplevel =
+            {
+                .title = pending->changed & CHANGE_TITLE
+                             ? g_strdup(pending->title)
+                             : NULL,
+                .app_id = pending->changed & CHANGE_APP_ID
+                              ? g_strdup(pending->app_id)
+                              : NULL,
+                .changed = pending->changed,
+            },
+    };
+    wayland_event_thread_push(state.events, &record);
+    pending->changed = 0;
+}
+
+static void handle_closed_thread(
+    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    Toplevel *pending = data;
+    wayland_event_thread_push(
+        state.events,
+        &(WaylandEventRecord){.type = WAYLAND_EVENT_TOPLEVEL_CLOSED,
+                              .proxy = handle,
+                              .serial = pending->serial});
+    toplevel_free(pending);
+}
+
+static const struct zwlr_foreign_toplevel_handle_v1_listener main_listener = {
+    .title = handle_title,
+    .app_id = handle_app_id,
+    .output_enter = handle_output,
+    .output_leave = handle_output,
+    .state = handle_state,
+    .done = handle_done_main,
+    .closed = handle_closed_main,
+    .parent = handle_parent,
+};
+
+static const struct zwlr_foreign_toplevel_handle_v1_listener thread_listener =
+    {
+        .title = handle_title,
+        .app_id = handle_app_id,
+        .output_enter = handle_output,
+        .output_leave = handle_output,
+        .state = handle_state,
+        .done = handle_done_thread,
+        .closed = handle_closed_thread,
+        .parent = handle_parent,
+};
+
+static void mgr_toplevel(void *data,
+                         struct zwlr_foreign_toplevel_manager_v1 *mgr,
+                         struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    Toplevel *toplevel = g_new0(Toplevel, 1);
+    toplevel->handle = handle;
+
+    if (!state.events) {
+        zwlr_foreign_toplevel_handle_v1_add_listener(handle, &main_listener,
+                                                     toplevel);
+        g_hash_table_insert(state.toplevels, handle, toplevel);
+        return;
+    }
+
+    // on the thread, the main loop gets its own Toplevel from the record
+    toplevel->serial = ++state.serial;
+    zwlr_foreign_toplevel_handle_v1_add_listener(handle, &thread_listener,
+                                                 toplevel);
+    wayland_event_thread_push(
+        state.events, &(WaylandEventRecord){.type = WAYLAND_EVENT_TOPLEVEL_NEW,
+                                            .proxy = handle,
+                                            .serial = toplevel->serial});
+}
+
+static void mgr_finished(void *data,
+                         struct zwlr_foreign_toplevel_manager_v1 *mgr) {}
+
+static const struct zwlr_foreign_toplevel_manager_v1_listener mgr_listener = {
+    .toplevel = mgr_toplevel,
+    .finished = mgr_finished,
+};
+
+static void registry_global(void *data, struct wl_registry *registry,
+                            uint32_t name, const char *interface,
+                            uint32_t version) {
+    if (strcmp(interface, zwlr_foreign_toplevel_manager_v1_interface.name))
+        return;
+
+    // in thread mode the manager, and every handle it creates, lives on the
+    // thread's queue.
+    struct wl_registry *wrapper = wl_proxy_create_wrapper(registry);
+    if (state.events)
+        wl_proxy_set_queue((struct wl_proxy *)wrapper,
+                           wayland_event_thread_get_queue(state.events));
+    struct zwlr_foreign_toplevel_manager_v1 *mgr = wl_registry_bind(
+        wrapper, name, &zwlr_foreign_toplevel_manager_v1_interface, 3);
+    wl_proxy_wrapper_destroy(wrapper);
+
+    zwlr_foreign_toplevel_manager_v1_add_listener(mgr, &mgr_listener, NULL);
+}
+
+static void registry_global_remove(void *data, struct wl_registry *registry,
+                                   uint32_t name) {}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = registry_global,
+    .global_remove = registry_global_remove,
+};
+
+static void flush(void) {
+    int ret = wl_display_flush(state.display);
+    while (ret == -1 && errno == EAGAIN) ret = wl_display_flush(state.display);
+}
+
+static void busy(gint64 start) {
+    gint64 elapsed = g_get_monotonic_time() - start;
+    state.busy_total += elapsed;
+    state.busy_max = MAX(state.busy_max, elapsed);
+}
+
+static gboolean on_display_readable(gint fd, GIOCondition condition,
+                                    gpointer data) {
+    gint64 start = g_get_monotonic_time();
+    if (wl_display_dispatch(state.display) == -1) g_error("dispatch failed");
+    flush();
+    busy(start);
+    return G_SOURCE_CONTINUE;
+}
+
+static void apply_record(WaylandEventRecord *record) {
+    Toplevel *toplevel = g_hash_table_lookup(state.toplevels, record->proxy);
+    if (toplevel && toplevel->serial != record->serial) toplevel = NULL;
+
+    switch (record->type) {
+        case WAYLAND_EVENT_TOPLEVEL_NEW:
+            toplevel = g_new0(Toplevel, 1);
+            toplevel->handle = record->proxy;
+            toplevel->serial = record->serial;
+            g_hash_table_insert(state.toplevels, record->proxy, toplevel);
+            break;
+        case WAYLAND_EVENT_TOPLEVEL_DONE:
+            if (toplevel) {
+                if (record->toplevel.changed & CHANGE_TITLE) {
+                    g_free(toplevel->title);
+                    toplevel->title = g_steal_pointer(&record->toplevel.title);
+                }
+                if (record->toplevel.changed & CHANGE_APP_ID) {
+                    g_free(toplevel->app_id);
+                    toplevel->app_id =
+                        g_steal_pointer(&record->toplevel.app_id);
+                }
+                toplevel->changed = record->toplevel.changed;
+                toplevel_apply(toplevel);
+            }
+            g_free(record->toplevel.title);
+            g_free(record->toplevel.app_id);
+            break;
+        case WAYLAND_EVENT_TOPLEVEL_CLOSED:
+            if (!toplevel) break;
+            g_hash_table_remove(state.toplevels, record->proxy);
+            zwlr_foreign_toplevel_handle_v1_destroy(record->proxy);
+            break;
+        default:
+            break;
+    }
+}
+
+static gboolean on_events_ready(gint fd, GIOCondition condition,
+                                gpointer data) {
+    gint64 start = g_get_monotonic_time();
+
+    wayland_event_thread_ack(state.events);
+
+    WaylandEventRecord record;
+    while (wayland_event_thread_pop(state.events, &record))
+        apply_record(&record);
+
+    if (wl_display_dispatch_pending(state.display) == -1)
+        g_error("dispatch failed");
+    flush();
+    busy(start);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_heartbeat(gpointer data) {
+    gint64 now = g_get_monotonic_time();
+    gint64 late = now - state.heartbeat_last - 1000;
+    g_array_append_val(state.lateness, late);
+    state.heartbeat_last = now;
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_deadline(gpointer data) {
+    g_main_loop_quit(data);
+    return G_SOURCE_REMOVE;
+}
+
+static gint compare_gint64(gconstpointer a, gconstpointer b) {
+    gint64 x = *(const gint64 *)a, y = *(const gint64 *)b;
+    return x < y ? -1 : x > y;
+}
+
+static gint64 percentile(GArray *sorted, double p) {
+    if (!sorted->len) return 0;
+    guint i = MIN(sorted->len - 1, (guint)(p * sorted->len));
+    return MAX(0, g_array_index(sorted, gint64, i));
+}
+
+static int measure(int argc, char **argv) {
+    const char *mode = "thread";
+    guint seconds = 10;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:d:")) != -1) {
+        switch (opt) {
+            case 'm':
+                mode = optarg;
+                break;
+            case 'd':
+                seconds = MAX(1, atoi(optarg));
+                break;
+            default:
+                return 1;
+        }
+    }
+    gboolean threaded = g_strcmp0(mode, "thread") == 0;
+    if (!threaded && g_strcmp0(mode, "main")) {
+        fprintf(stderr, "unknown mode: %s\n", mode);
+        return 1;
+    }
+
+    state.display = wl_display_connect(NULL);
+    if (!state.display) {
+        fprintf(stderr, "no Wayland display\n");
+        return 1;
+    }
+    state.toplevels =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                              (GDestroyNotify)toplevel_free);
+    state.lateness = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+    struct wl_registry *registry = wl_display_get_registry(state.display);
+    wl_registry_add_listener(registry, &registry_listener, NULL);
+
+    if (threaded) {
+        state.events = wayland_event_thread_new(state.display);
+        g_unix_fd_add(wayland_event_thread_get_wake_fd(state.events), G_IO_IN,
+                      on_events_ready, NULL);
+    } else {
+        g_unix_fd_add(wl_display_get_fd(state.display), G_IO_IN,
+                      on_display_readable, NULL);
+    }
+    flush();
+
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    state.heartbeat_last = g_get_monotonic_time();
+    g_timeout_add(1, on_heartbeat, NULL);
+    g_timeout_add_seconds(seconds, on_deadline, loop);
+    g_main_loop_run(loop);
+
+    g_array_sort(state.lateness, compare_gint64);
+    printf("%-6s  %u toplevels  %d events  %" G_GUINT64_FORMAT
+           " dones applied\n",
+           mode, g_hash_table_size(state.toplevels),
+           g_atomic_int_get(&state.events_seen), state.dones);
+    printf("        heartbeat lateness us: p50 %" G_GINT64_FORMAT
+           "  p99 %" G_GINT64_FORMAT "  p99.9 %" G_GINT64_FORMAT
+           "  max %" G_GINT64_FORMAT "\n",
+           percentile(state.lateness, 0.5), percentile(state.lateness, 0.99),
+           percentile(state.lateness, 0.999),
+           percentile(state.lateness, 1.0));
+    printf("        main loop busy on Wayland: %" G_GINT64_FORMAT
+           "us total, %" G_GINT64_FORMAT "us longest\n",
+           state.busy_total, state.busy_max);
+
+    // the event thread keeps reading until exit
+    _exit(0);
+}
+
+typedef struct _Churn {
+    GPtrArray *windows;
+    guint64 n;
+} Churn;
+
+static gboolean on_churn(gpointer data) {
+    Churn *churn = data;
+    for (guint i = 0; i < churn->windows->len; i++) {
+        char title[64];
+        g_snprintf(title, sizeof(title), "churn %u %" G_GUINT64_FORMAT, i,
+                   churn->n);
+        gtk_window_set_title(g_ptr_array_index(churn->windows, i), title);
+    }
+    churn->n++;
+    return G_SOURCE_CONTINUE;
+}
+
+static int churn(int argc, char **argv) {
+    guint windows = 8;
+    guint rate = 500;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:")) != -1) {
+        switch (opt) {
+            case 'n':
+                windows = MAX(1, atoi(optarg));
+                break;
+            case 'r':
+                rate = MAX(1, atoi(optarg));
+                break;
+            default:
+                return 1;
+        }
+    }
+
+    gtk_init();
+
+    Churn churn = {.windows = g_ptr_array_new()};
+    for (guint i = 0; i < windows; i++) {
+        GtkWidget *window = gtk_window_new();
+        gtk_window_set_default_size(GTK_WINDOW(window), 64, 64);
+        gtk_window_present(GTK_WINDOW(window));
+        g_ptr_array_add(churn.windows, window);
+    }
+
+    g_timeout_add(MAX(1, 1000 / rate), on_churn, &churn);
+
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+    g_main_loop_run(loop);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr,
+                "usage: %s churn [-n windows] [-r rate]\n"
+                "       %s measure [-m main|thread] [-d seconds]\n",
+                argv[0], argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "churn") == 0) return churn(argc - 1, argv + 1);
+    if (strcmp(argv[1], "measure") == 0) return measure(argc - 1, argv + 1);
+
+    fprintf(stderr, "unknown command: %s\n", argv[1]);
+    return 1;
+}
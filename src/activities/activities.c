@@ -5,7 +5,9 @@
 #include <gio/gio.h>
 #include <gtk4-layer-shell/gtk4-layer-shell.h>
 
+#include "../services/desktop_entry_service/desktop_entry_service.h"
 #include "./activities_app_widget.h"
+#include "./app_search.h"
 #include "gtk/gtk.h"
 #include "gtk/gtkrevealer.h"
 
@@ -28,12 +30,26 @@ typedef struct _Activities {
     // Search
     GtkSearchEntry *search_entry;
     GtkScrolledWindow *search_result_scrolled;
-    GtkFlowBox *search_result_flbox;
-
-    // App Carousel
-    AdwCarousel *app_carousel;
-    AdwCarouselIndicatorDots *app_carousel_dots;
-    GPtrArray *app_carousel_pages;
+    GtkGridView *search_result_grid;
+    AppSearch *search;
+    // rank of every app matching the current search, keyed by desktop id and
+    // counting from 1
+    GHashTable *search_ranks;
+    // the query `search_ranks` holds the matches of, NULL for none
+    char *search_query;
+    // apps filtered and sorted by their rank, best match first
+    GtkCustomFilter *search_filter;
+    GtkCustomSorter *search_sorter;
+    GtkSingleSelection *search_selection;
+
+    // App Grid
+    GtkScrolledWindow *app_grid_scrolled;
+    GtkGridView *app_grid;
+    // desktop ids of the launchable apps as GtkStringObjects, shared by the
+    // app grid and the search results.
+    // Both views only create widgets for the apps on screen and rebind them
+    // while scrolling, outliving the window.
+    GtkStringList *apps;
 
     // Cached pixel buffer of the configured desktop wallpaper.
     GdkPixbuf *desktop_wallpaper;
@@ -75,94 +91,81 @@ static void activities_class_init(ActivitiesClass *klass) {
                      G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 }
 
-static void fill_app_infos(Activities *self) {
-    // remove the current pages from the carousel and reset the pages array.
-    for (guint i = 0; i < self->app_carousel_pages->len; i++) {
-        GtkWidget *page = g_ptr_array_index(self->app_carousel_pages, i);
-        adw_carousel_remove(self->app_carousel, page);
-    }
-    g_ptr_array_set_size(self->app_carousel_pages, 0);
-
-    // empty search result box
-    gtk_flow_box_remove_all(self->search_result_flbox);
+static void on_search_changed(GtkSearchEntry *entry, Activities *self);
 
-    int page_size = 24;
-    int cur_page = -1;
-    int cur_row = 0;
-    int cur_col = 0;
-    int i = 0;
-    GList *app_infos = g_app_info_get_all();
+static void update_apps(Activities *self) {
+    // entries come from the desktop entry cache, no desktop file is parsed
+    // here.
+    GArray *entries =
+        desktop_entry_service_get_entries(desktop_entry_service_get_global());
 
-    for (GList *l = app_infos; l != NULL; l = l->next) {
-        GAppInfo *app_info = G_APP_INFO(l->data);
-        GtkGrid *page = NULL;
+    app_search_free(self->search);
+    self->search = app_search_new(entries);
+    g_hash_table_remove_all(self->search_ranks);
+    g_clear_pointer(&self->search_query, g_free);
 
-        GDesktopAppInfo *desktop_app_info = G_DESKTOP_APP_INFO(app_info);
+    GPtrArray *ids = g_ptr_array_new();
+    for (guint i = 0; i < entries->len; i++) {
+        DesktopEntry *entry = &g_array_index(entries, DesktopEntry, i);
 
         // perform sanity checks making sure this is an app we would actually
         // expect the user to launch
-        if (!desktop_app_info) {
-            continue;
-        }
-        if (g_desktop_app_info_get_nodisplay(desktop_app_info)) {
-            continue;
-        }
-        if (g_strcmp0(g_desktop_app_info_get_string(desktop_app_info, "Type"),
-                      "Application") != 0) {
+        if (entry->nodisplay || !entry->application) {
             continue;
         }
+        g_ptr_array_add(ids, (gpointer)entry->id);
+    }
+    g_ptr_array_add(ids, NULL);
 
-        // Unfortunately sharing a single widget between both GtkFlowBox (Search
-        // Results) and GtkGrid (App Carousel )does not work, so create one for
-        // each.
-        ActivitiesAppWidget *app_widget =
-            g_object_new(ACTIVITIES_APP_WIDGET_TYPE, NULL);
-        activities_app_widget_set_app_info(app_widget, app_info);
-
-        ActivitiesAppWidget *app_widget_search =
-            g_object_new(ACTIVITIES_APP_WIDGET_TYPE, NULL);
-        activities_app_widget_set_app_info(app_widget_search, app_info);
-        GtkWidget *w_search = activities_app_widget(app_widget_search);
-
-        // add our search widget to the search flbox
-        gtk_flow_box_insert(self->search_result_flbox, w_search, -1);
-
-        // check if we should make a new page
-        if (i % page_size == 0) {
-            cur_page++;
-            cur_row = 0;
-            cur_col = 0;
-            page = GTK_GRID(gtk_grid_new());
-            g_ptr_array_insert(self->app_carousel_pages, cur_page, page);
-        }
-        page = GTK_GRID(g_ptr_array_index(self->app_carousel_pages, cur_page));
+    // visible widgets are rebound, none are created for the apps off screen.
+    gtk_string_list_splice(self->apps, 0,
+                           g_list_model_get_n_items(G_LIST_MODEL(self->apps)),
+                           (const char *const *)ids->pdata);
+    g_ptr_array_free(ids, TRUE);
 
-        gtk_grid_attach(page, activities_app_widget(app_widget), cur_col,
-                        cur_row, 1, 1);
+    // run the current search again against the new apps
+    on_search_changed(self->search_entry, self);
+}
 
-        cur_col++;
-        if (cur_col == 7) {
-            cur_row++;
-            cur_col = 0;
-        }
-        i++;
-    }
+static void on_app_item_setup(GtkSignalListItemFactory *factory,
+                              GtkListItem *item, Activities *self) {
+    ActivitiesAppWidget *app_widget =
+        g_object_new(ACTIVITIES_APP_WIDGET_TYPE, NULL);
+    gtk_list_item_set_child(item, activities_app_widget(app_widget));
+}
 
-    // add every page to the carousel
-    for (guint i = 0; i < self->app_carousel_pages->len; i++) {
-        GtkWidget *page = g_ptr_array_index(self->app_carousel_pages, i);
+static void on_app_item_bind(GtkSignalListItemFactory *factory,
+                             GtkListItem *item, Activities *self) {
+    GtkStringObject *id = gtk_list_item_get_item(item);
+    ActivitiesAppWidget *app_widget =
+        activities_app_widget_from_widget(gtk_list_item_get_child(item));
+
+    GtkWidget *child = gtk_list_item_get_child(item);
+    DesktopEntry *entry = desktop_entry_service_lookup_entry(
+        desktop_entry_service_get_global(), gtk_string_object_get_string(id));
+
+    // the entry went away since the model was built. the widget is recycled
+    // and still shows the app it was last bound to, blank it out instead.
+    gtk_widget_set_visible(child, entry != NULL);
+    if (!entry) {
+        activities_app_widget_clear(app_widget);
+        return;
+    }
 
-        // deferring layout configuration of the GtkGrid seemed to be less buggy
-        // then at creation time in the loop above.
-        gtk_grid_set_column_spacing(GTK_GRID(page), 20);
-        gtk_grid_set_row_spacing(GTK_GRID(page), 20);
-        gtk_widget_set_halign(GTK_WIDGET(page), GTK_ALIGN_CENTER);
-        gtk_widget_set_valign(GTK_WIDGET(page), GTK_ALIGN_START);
-        gtk_widget_set_hexpand(GTK_WIDGET(page), true);
-        gtk_widget_set_vexpand(GTK_WIDGET(page), true);
+    activities_app_widget_set_entry(app_widget, entry);
+}
 
-        adw_carousel_append(self->app_carousel, GTK_WIDGET(page));
-    }
+static GtkGridView *app_grid_view_new(Activities *self,
+                                      GtkSelectionModel *model) {
+    GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
+    g_signal_connect(factory, "setup", G_CALLBACK(on_app_item_setup), self);
+    g_signal_connect(factory, "bind", G_CALLBACK(on_app_item_bind), self);
+
+    GtkGridView *grid = GTK_GRID_VIEW(gtk_grid_view_new(model, factory));
+    gtk_grid_view_set_max_columns(grid, 7);
+    gtk_widget_set_hexpand(GTK_WIDGET(grid), true);
+    gtk_widget_set_vexpand(GTK_WIDGET(grid), true);
+    return grid;
 }
 
 static void activities_init_layout(Activities *self);
@@ -185,73 +188,54 @@ static void on_revealer_child_revealed(GtkRevealer *revealer, GParamSpec *pspec,
     }
 }
 
-gboolean flow_box_filter_func(GtkFlowBoxChild *child, GtkSearchEntry *entry) {
-    GtkWidget *w = gtk_flow_box_child_get_child(child);
-    if (!w) return false;
-
-    // get pointer to ActivitiesAppWidget from GtkWidget
-    ActivitiesAppWidget *app_widget = activities_app_widget_from_widget(w);
+static guint search_rank(Activities *self, GtkStringObject *id) {
+    return GPOINTER_TO_UINT(g_hash_table_lookup(
+        self->search_ranks, gtk_string_object_get_string(id)));
+}
 
-    GAppInfo *info = activities_app_widget_get_app_info(app_widget);
+static gboolean search_filter_func(GtkStringObject *id, Activities *self) {
+    return search_rank(self, id) != 0;
+}
 
-    const char *display_name = g_app_info_get_display_name(info);
-    const char *search_text = gtk_editable_get_text(GTK_EDITABLE(entry));
+static int search_sort_func(GtkStringObject *a, GtkStringObject *b,
+                            Activities *self) {
+    guint rank_a = search_rank(self, a);
+    guint rank_b = search_rank(self, b);
 
-    gboolean match = g_str_match_string(search_text, display_name, true);
-    return match;
+    if (rank_a == rank_b) return GTK_ORDERING_EQUAL;
+    return rank_a < rank_b ? GTK_ORDERING_SMALLER : GTK_ORDERING_LARGER;
 }
 
-static void on_search_next_match(GtkSearchEntry *entry, Activities *self) {
-    GList *selected_list =
-        gtk_flow_box_get_selected_children(self->search_result_flbox);
-    if (!selected_list) return;
+// Selects the result `step` results away from the selected one.
+static void search_select_relative(Activities *self, int step) {
+    guint selected = gtk_single_selection_get_selected(self->search_selection);
+    if (selected == GTK_INVALID_LIST_POSITION) return;
 
-    GtkFlowBoxChild *selected = GTK_FLOW_BOX_CHILD(selected_list->data);
-    if (!selected) return;
+    guint n = g_list_model_get_n_items(G_LIST_MODEL(self->search_selection));
+    if (step < 0 && selected < (guint)-step) return;
+    if (step > 0 && selected + step >= n) return;
 
-    GtkFlowBoxChild *next =
-        GTK_FLOW_BOX_CHILD(gtk_widget_get_next_sibling(GTK_WIDGET(selected)));
-    while (next) {
-        if (gtk_widget_get_child_visible(GTK_WIDGET(next))) {
-            gtk_flow_box_select_child(self->search_result_flbox, next);
-            break;
-        }
-        next =
-            GTK_FLOW_BOX_CHILD(gtk_widget_get_next_sibling(GTK_WIDGET(next)));
-    }
+    selected += step;
+    gtk_single_selection_set_selected(self->search_selection, selected);
+    gtk_widget_activate_action(GTK_WIDGET(self->search_result_grid),
+                               "list.scroll-to-item", "u", selected);
 }
 
-static void on_search_previous_match(GtkSearchEntry *entry, Activities *self) {
-    GList *selected_list =
-        gtk_flow_box_get_selected_children(self->search_result_flbox);
-    if (!selected_list) return;
-
-    GtkFlowBoxChild *selected = GTK_FLOW_BOX_CHILD(selected_list->data);
-    if (!selected) return;
+static void on_search_next_match(GtkSearchEntry *entry, Activities *self) {
+    search_select_relative(self, 1);
+}
 
-    GtkFlowBoxChild *prev =
-        GTK_FLOW_BOX_CHILD(gtk_widget_get_prev_sibling(GTK_WIDGET(selected)));
-    while (prev) {
-        if (gtk_widget_get_child_visible(GTK_WIDGET(prev))) {
-            gtk_flow_box_select_child(self->search_result_flbox, prev);
-            break;
-        }
-        prev =
-            GTK_FLOW_BOX_CHILD(gtk_widget_get_prev_sibling(GTK_WIDGET(prev)));
-    }
+static void on_search_previous_match(GtkSearchEntry *entry, Activities *self) {
+    search_select_relative(self, -1);
 }
 
 static void on_search_stop(GtkSearchEntry *entry, Activities *self) {
     // hide search results and show apps
     gtk_widget_set_visible(GTK_WIDGET(self->search_result_scrolled), false);
-    gtk_widget_set_visible(GTK_WIDGET(self->app_carousel), true);
-    gtk_widget_set_visible(GTK_WIDGET(self->app_carousel_dots), true);
+    gtk_widget_set_visible(GTK_WIDGET(self->app_grid_scrolled), true);
 }
 
 static void on_search_changed(GtkSearchEntry *entry, Activities *self) {
-    gtk_widget_set_visible(GTK_WIDGET(self->app_carousel), false);
-    gtk_widget_set_visible(GTK_WIDGET(self->app_carousel_dots), false);
-
     const char *search_text = gtk_editable_get_text(GTK_EDITABLE(entry));
     // if search string is empty call on_search_stop
     if (strlen(search_text) == 0) {
@@ -259,53 +243,50 @@ static void on_search_changed(GtkSearchEntry *entry, Activities *self) {
         return;
     }
 
-    // invalidate any search filter done before
-    gtk_flow_box_invalidate_filter(self->search_result_flbox);
-
-    // apply search filter
-    gtk_flow_box_set_filter_func(self->search_result_flbox,
-                                 (GtkFlowBoxFilterFunc)flow_box_filter_func,
-                                 entry, NULL);
-
-    // using Gtk4 syntax loop over GtkFlowBox children and find first visible
-    // child.
-    for (GtkWidget *child =
-             gtk_widget_get_first_child(GTK_WIDGET(self->search_result_flbox));
-         child; child = gtk_widget_get_next_sibling(child)) {
-        // important to use 'gtk_widget_get_child_visible' after looking at
-        // GtkFlowBox source just checking 'gtk_widget_get_visible' does not
-        // work
-        if (gtk_widget_get_child_visible(child)) {
-            gtk_flow_box_select_child(self->search_result_flbox,
-                                      GTK_FLOW_BOX_CHILD(child));
-            break;
-        }
+    gtk_widget_set_visible(GTK_WIDGET(self->app_grid_scrolled), false);
+
+    // rank the matches, the search results are filtered and sorted by rank.
+    GPtrArray *results = app_search_query(self->search, search_text);
+    g_hash_table_remove_all(self->search_ranks);
+    for (guint i = 0; i < results->len; i++) {
+        DesktopEntry *result = g_ptr_array_index(results, i);
+        g_hash_table_insert(self->search_ranks, (gpointer)result->id,
+                            GUINT_TO_POINTER(i + 1));
+    }
+
+    // a query extending the last one only matches a subset of its results,
+    // the filter then only checks the apps it currently shows rather than
+    // every app, and the other way around for a query the last one extends.
+    GtkFilterChange change = GTK_FILTER_CHANGE_DIFFERENT;
+    if (self->search_query && g_str_has_prefix(search_text, self->search_query))
+        change = GTK_FILTER_CHANGE_MORE_STRICT;
+    else if (self->search_query &&
+             g_str_has_prefix(self->search_query, search_text))
+        change = GTK_FILTER_CHANGE_LESS_STRICT;
+    g_free(self->search_query);
+    self->search_query = g_strdup(search_text);
+
+    gtk_filter_changed(GTK_FILTER(self->search_filter), change);
+    gtk_sorter_changed(GTK_SORTER(self->search_sorter),
+                       GTK_SORTER_CHANGE_DIFFERENT);
+
+    // select the best match
+    if (results->len) {
+        gtk_single_selection_set_selected(self->search_selection, 0);
+        gtk_widget_activate_action(GTK_WIDGET(self->search_result_grid),
+                                   "list.scroll-to-item", "u", 0);
     }
 
-    // make search flow box visible
+    // make search results visible
     gtk_widget_set_visible(GTK_WIDGET(self->search_result_scrolled), true);
 }
 
 static void on_search_entry_activate(GtkSearchEntry *entry, Activities *self) {
-    GList *selected_list =
-        gtk_flow_box_get_selected_children(self->search_result_flbox);
-
-    if (!selected_list) {
-        return;
-    }
-
-    // get first GtkFlowBoxChild in list
-    GtkFlowBoxChild *selected = GTK_FLOW_BOX_CHILD(selected_list->data);
+    GtkStringObject *selected =
+        gtk_single_selection_get_selected_item(self->search_selection);
     if (!selected) return;
 
-    GtkWidget *w = gtk_flow_box_child_get_child(selected);
-    if (!w) return;
-
-    // get pointer to ActivitiesAppWidget from GtkWidget
-    ActivitiesAppWidget *app_widget = activities_app_widget_from_widget(w);
-
-    // simulate click
-    activities_app_widget_simulate_click(app_widget);
+    activities_launch_app(self, gtk_string_object_get_string(selected));
 }
 
 static void activities_init_layout(Activities *self) {
@@ -386,53 +367,74 @@ static void activities_init_layout(Activities *self) {
 
     gtk_box_append(search_container, GTK_WIDGET(self->search_entry));
 
-    // setup search result area bindings.
-    self->search_result_flbox = GTK_FLOW_BOX(gtk_flow_box_new());
-    gtk_flow_box_set_column_spacing(self->search_result_flbox, 20);
-    gtk_flow_box_set_row_spacing(self->search_result_flbox, 20);
-    gtk_widget_set_halign(GTK_WIDGET(self->search_result_flbox),
-                          GTK_ALIGN_CENTER);
-    gtk_widget_set_valign(GTK_WIDGET(self->search_result_flbox),
-                          GTK_ALIGN_START);
-    gtk_flow_box_set_homogeneous(self->search_result_flbox, true);
-
-    // create app carousel and dots
-    self->app_carousel = ADW_CAROUSEL(adw_carousel_new());
-    self->app_carousel_dots =
-        ADW_CAROUSEL_INDICATOR_DOTS(adw_carousel_indicator_dots_new());
-    adw_carousel_indicator_dots_set_carousel(self->app_carousel_dots,
-                                             self->app_carousel);
+    // setup search result area bindings, the views are rebuilt with the
+    // window but their models are kept.
+    self->search_result_grid = app_grid_view_new(
+        self, GTK_SELECTION_MODEL(g_object_ref(self->search_selection)));
+
+    // app grid showing every app
+    GtkNoSelection *apps_selection =
+        gtk_no_selection_new(G_LIST_MODEL(g_object_ref(self->apps)));
+    self->app_grid =
+        app_grid_view_new(self, GTK_SELECTION_MODEL(apps_selection));
 
     // wire up main container
     gtk_box_append(GTK_BOX(self->container), GTK_WIDGET(search_container));
 
-    // wrap search_result_flbox in a vertical scroll window
+    // wrap search_result_grid in a vertical scroll window
     self->search_result_scrolled =
         GTK_SCROLLED_WINDOW(gtk_scrolled_window_new());
-    gtk_scrolled_window_set_child(
-        GTK_SCROLLED_WINDOW(self->search_result_scrolled),
-        GTK_WIDGET(self->search_result_flbox));
+    gtk_scrolled_window_set_policy(self->search_result_scrolled,
+                                   GTK_POLICY_NEVER, GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_child(self->search_result_scrolled,
+                                  GTK_WIDGET(self->search_result_grid));
     gtk_widget_set_vexpand(GTK_WIDGET(self->search_result_scrolled), true);
     // starts hiden until a search takes place
     gtk_widget_set_visible(GTK_WIDGET(self->search_result_scrolled), false);
 
+    self->app_grid_scrolled = GTK_SCROLLED_WINDOW(gtk_scrolled_window_new());
+    gtk_scrolled_window_set_policy(self->app_grid_scrolled, GTK_POLICY_NEVER,
+                                   GTK_POLICY_AUTOMATIC);
+    gtk_scrolled_window_set_child(self->app_grid_scrolled,
+                                  GTK_WIDGET(self->app_grid));
+    gtk_widget_set_vexpand(GTK_WIDGET(self->app_grid_scrolled), true);
+
     gtk_box_append(GTK_BOX(self->container),
                    GTK_WIDGET(self->search_result_scrolled));
-    gtk_box_append(GTK_BOX(self->container), GTK_WIDGET(self->app_carousel));
     gtk_box_append(GTK_BOX(self->container),
-                   GTK_WIDGET(self->app_carousel_dots));
-
-    fill_app_infos(self);
+                   GTK_WIDGET(self->app_grid_scrolled));
 
     adw_window_set_content(self->win, GTK_WIDGET(self->revealer));
 }
 
+static void on_desktop_entries_changed(DesktopEntryService *des,
+                                       Activities *self) {
+    g_debug("activities.c:on_desktop_entries_changed called");
+
+    update_apps(self);
+}
+
 static void activities_init(Activities *self) {
-    self->app_carousel_pages = g_ptr_array_new();
+    self->apps = gtk_string_list_new(NULL);
+    self->search_ranks = g_hash_table_new(g_str_hash, g_str_equal);
+    self->search_filter = gtk_custom_filter_new(
+        (GtkCustomFilterFunc)search_filter_func, self, NULL);
+    self->search_sorter = gtk_custom_sorter_new(
+        (GCompareDataFunc)search_sort_func, self, NULL);
+    GtkFilterListModel *filtered = gtk_filter_list_model_new(
+        G_LIST_MODEL(g_object_ref(self->apps)),
+        GTK_FILTER(g_object_ref(self->search_filter)));
+    GtkSortListModel *sorted = gtk_sort_list_model_new(
+        G_LIST_MODEL(filtered), GTK_SORTER(g_object_ref(self->search_sorter)));
+    self->search_selection = gtk_single_selection_new(G_LIST_MODEL(sorted));
 
     self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
 
     activities_init_layout(self);
+    update_apps(self);
+
+    g_signal_connect(desktop_entry_service_get_global(), "changed",
+                     G_CALLBACK(on_desktop_entries_changed), self);
 }
 
 void activities_show(Activities *self) {
@@ -454,11 +456,27 @@ void activities_hide(Activities *self) {
 
     gtk_editable_set_text(GTK_EDITABLE(self->search_entry), "");
 
-	gtk_flow_box_unselect_all(self->search_result_flbox);
-
     on_search_stop(self->search_entry, self);
 }
 
+void activities_launch_app(Activities *self, const char *app_id) {
+    GError *error = NULL;
+    GAppInfo *app_info = desktop_entry_service_lookup(
+        desktop_entry_service_get_global(), app_id);
+    if (!app_info) {
+        return;
+    }
+
+    g_app_info_launch(app_info, NULL, NULL, &error);
+    if (error) {
+        g_warning("Failed to launch app: %s", error->message);
+        g_error_free(error);
+    }
+
+    // close Activities if opened
+    activities_hide(self);
+}
+
 void activities_toggle(Activities *self) {
     g_debug("activities.c:activities_toggle called");
 
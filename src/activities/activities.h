@@ -22,3 +22,6 @@ void activities_hide(Activities *self);
 
 void activities_toggle(Activities *self);
 
+// Launches the app with desktop id `app_id` and hides Activities.
+void activities_launch_app(Activities *self, const char *app_id);
+
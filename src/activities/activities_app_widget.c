@@ -4,15 +4,17 @@
 #include <gio/gio.h>
 #include <sys/wait.h>
 
+#include "../services/icon_cache_service/icon_cache_service.h"
 #include "./activities.h"
 #include "glib.h"
 
 typedef struct _ActivitiesAppWidget {
     GObject parent_instance;
-    GAppInfo *app_info;
+    // desktop id, the GAppInfo is only resolved on launch
+    char *id;
     GtkBox *container;
     GtkImage *icon;
-    GtkLabel *display_name;
+    GtkLabel *display_name_label;
     GtkButton *button;
     GtkBox *button_contents;
     guint parent_index;
@@ -35,25 +37,12 @@ static void activities_app_widget_class_init(ActivitiesAppWidgetClass *klass) {
 }
 
 static void launch_app_on_click(GtkButton *button, ActivitiesAppWidget *self) {
-    GError *error = NULL;
-    GAppInfo *app_info = activities_app_widget_get_app_info(self);
-    if (!app_info) {
-        return;
-    }
-
-    g_app_info_launch(app_info, NULL, NULL, &error);
-    if (error) {
-        g_warning("Failed to launch app: %s", error->message);
-    }
-
-    // close Activities if opened
-    Activities *activities = activities_get_global();
-    activities_hide(activities);
+    activities_launch_app(activities_get_global(), self->id);
 }
 
 static void on_container_destroyed(GtkWidget *widget,
                                    ActivitiesAppWidget *self) {
-    g_clear_object(&self->app_info);
+    g_clear_pointer(&self->id, g_free);
     g_object_unref(self);
 }
 
@@ -81,12 +70,13 @@ static void activities_app_widget_layout(ActivitiesAppWidget *self) {
     gtk_widget_add_css_class(GTK_WIDGET(self->icon),
                              "activities-app-widget-icon");
 
-    self->display_name = GTK_LABEL(gtk_label_new(""));
-    gtk_widget_add_css_class(GTK_WIDGET(self->display_name),
+    self->display_name_label = GTK_LABEL(gtk_label_new(""));
+    gtk_widget_add_css_class(GTK_WIDGET(self->display_name_label),
                              "activities-app-widget-display-name");
 
     gtk_box_append(self->button_contents, GTK_WIDGET(self->icon));
-    gtk_box_append(self->button_contents, GTK_WIDGET(self->display_name));
+    gtk_box_append(self->button_contents,
+                   GTK_WIDGET(self->display_name_label));
     gtk_button_set_child(self->button, GTK_WIDGET(self->button_contents));
     gtk_box_append(self->container, GTK_WIDGET(self->button));
 }
@@ -95,44 +85,36 @@ static void activities_app_widget_init(ActivitiesAppWidget *self) {
     activities_app_widget_layout(self);
 }
 
-void activities_app_widget_set_app_info(ActivitiesAppWidget *self,
-                                        GAppInfo *app_info) {
-    g_return_if_fail(self != NULL && G_IS_APP_INFO(app_info));
+void activities_app_widget_set_entry(ActivitiesAppWidget *self,
+                                     DesktopEntry *entry) {
+    g_return_if_fail(self != NULL && entry != NULL);
 
-    g_object_ref(app_info);
-    g_clear_object(&self->app_info);
-    self->app_info = app_info;
+    g_free(self->id);
+    self->id = g_strdup(entry->id);
 
-    const char *display_name = g_app_info_get_display_name(app_info);
-    gtk_label_set_text(GTK_LABEL(self->display_name),
-                       display_name ? display_name : "");
+    gtk_label_set_text(GTK_LABEL(self->display_name_label),
+                       entry->name ? entry->name : "");
 
-    GIcon *icon = g_app_info_get_icon(app_info);
-    // check and handle GFileIcon, set self->icon to a GtkImage
-    if (G_IS_FILE_ICON(icon)) {
-        g_debug("G_FILE_ICON");
-    }
-    // check and handle if GThemedIcon
-    else if (G_IS_THEMED_ICON(icon)) {
-        GdkDisplay *display = gdk_display_get_default();
-        GtkIconTheme *theme = gtk_icon_theme_get_for_display(display);
-        GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
-            theme, icon, 78, 1, GTK_TEXT_DIR_RTL, 0);
-        gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(paintable));
-        gtk_image_set_pixel_size(self->icon, 78);
-    }
-    // check and handle if GLoadableIcon
-    else if (G_IS_LOADABLE_ICON(icon)) {
-        g_debug("G_LOADABLE_ICON");
+    // the app grid and the search results share one paintable per icon
+    GdkPaintable *paintable = icon_cache_service_lookup(
+        icon_cache_service_get_global(), entry->icon, 78, 1);
+    // widgets are recycled, never keep the previous app's icon
+    if (!paintable) {
+        gtk_image_clear(self->icon);
+        return;
     }
-}
 
-GAppInfo *activities_app_widget_get_app_info(ActivitiesAppWidget *self) {
-    return self->app_info;
+    gtk_image_set_from_paintable(self->icon, paintable);
+    gtk_image_set_pixel_size(self->icon, 78);
+    g_object_unref(paintable);
 }
 
-void activities_app_widget_simulate_click(ActivitiesAppWidget *self) {
-    launch_app_on_click(self->button, self);
+void activities_app_widget_clear(ActivitiesAppWidget *self) {
+    g_return_if_fail(self != NULL);
+
+    g_clear_pointer(&self->id, g_free);
+    gtk_label_set_text(GTK_LABEL(self->display_name_label), "");
+    gtk_image_clear(self->icon);
 }
 
 GtkWidget *activities_app_widget(ActivitiesAppWidget *self) {
@@ -2,6 +2,8 @@
 
 #include <adwaita.h>
 
+#include "../services/desktop_entry_service/desktop_entry_cache.h"
+
 G_BEGIN_DECLS
 
 struct _ActivitesAppWidget;
@@ -11,12 +13,11 @@ G_DECLARE_FINAL_TYPE(ActivitiesAppWidget, activities_app_widget, Activities,
 
 G_END_DECLS
 
-void activities_app_widget_set_app_info(ActivitiesAppWidget *self,
-                                        GAppInfo *app_info);
-
-GAppInfo *activities_app_widget_get_app_info(ActivitiesAppWidget *self);
+void activities_app_widget_set_entry(ActivitiesAppWidget *self,
+                                     DesktopEntry *entry);
 
-void activities_app_widget_simulate_click(ActivitiesAppWidget *self);
+// Drops the widget's application, leaving it blank and inert.
+void activities_app_widget_clear(ActivitiesAppWidget *self);
 
 GtkWidget *activities_app_widget(ActivitiesAppWidget *self);
 
@@ -0,0 +1,279 @@
+#include "app_search.h"
+
+#include <adwaita.h>
+
+#define SCORE_MATCH 16
+// a character following the previous match directly
+#define SCORE_CONSECUTIVE 8
+// a character starting a word
+#define SCORE_BOUNDARY 12
+// a word matched from the start of a line
+#define SCORE_PREFIX 24
+// a word matched in the name line
+#define SCORE_NAME 20
+// per character skipped between two matches
+#define SCORE_GAP -1
+
+typedef struct _AppSearchCandidate {
+    DesktopEntry *entry;
+    const char *keys;
+    gsize len;
+    // characters present in `keys`, see char_mask
+    guint64 mask;
+} AppSearchCandidate;
+
+typedef struct _AppSearchMatch {
+    guint candidate;
+    int score;
+} AppSearchMatch;
+
+struct _AppSearch {
+    // in name order, ties in the cache's order, so matches collected in
+    // candidate order only need a stable sort by score.
+    GArray *candidates;
+    // the previous query, whether each candidate matched it and the matched
+    // entries best first
+    char *query;
+    guint8 *matched;
+    GPtrArray *results;
+};
+
+// One bit per letter and digit, the remaining bytes share the rest, so a
+// candidate lacking any character of a query is rejected with one AND.
+static guint64 char_bit(guchar c) {
+    if (c >= 'a' && c <= 'z') return (guint64)1 << (c - 'a');
+    if (c >= '0' && c <= '9') return (guint64)1 << (26 + c - '0');
+    return (guint64)1 << (36 + c % 28);
+}
+
+static guint64 char_mask(const char *str, gsize len) {
+    guint64 mask = 0;
+    for (gsize i = 0; i < len; i++)
+        if (str[i] != ' ' && str[i] != '\t' && str[i] != '\n')
+            mask |= char_bit(str[i]);
+    return mask;
+}
+
+static gboolean is_boundary(const char *keys, gsize pos) {
+    if (pos == 0) return TRUE;
+    switch (keys[pos - 1]) {
+        case '\n':
+        case ' ':
+        case '-':
+        case '_':
+        case '.':
+        case '/':
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+// Scores `word` as a subsequence of the line of `keys` starting at
+// `line_start`, from `start` which holds word[0]. Returns 0 if the line does
+// not contain it.
+static int score_from(const char *keys, gsize len, gsize line_start,
+                      gsize start, const char *word, gsize word_len) {
+    int score = 0;
+    gsize matched = 0;
+    gsize prev = 0;
+
+    for (gsize i = start; i < len && matched < word_len; i++) {
+        if (keys[i] == '\n') return 0;
+
+        if (keys[i] != word[matched]) {
+            if (matched) score += SCORE_GAP;
+            continue;
+        }
+
+        score += SCORE_MATCH;
+        if (matched && i == prev + 1) score += SCORE_CONSECUTIVE;
+        if (is_boundary(keys, i)) score += SCORE_BOUNDARY;
+        prev = i;
+        matched++;
+    }
+
+    if (matched < word_len) return 0;
+
+    if (start == line_start) score += SCORE_PREFIX;
+    if (line_start == 0) score += SCORE_NAME;
+    return MAX(score, 1);
+}
+
+// Returns the best score of `word` over every position its first character
+// occurs at, 0 if it matches nowhere.
+static int score_word(const AppSearchCandidate *candidate, const char *word,
+                      gsize word_len) {
+    const char *keys = candidate->keys;
+    int best = 0;
+    gsize pos = 0;
+    // the line holding the last hit, found by scanning forward once rather
+    // than back from every hit.
+    gsize line_start = 0;
+    gsize scanned = 0;
+
+    const char *hit;
+    while ((hit = memchr(keys + pos, word[0], candidate->len - pos))) {
+        gsize start = hit - keys;
+        for (; scanned < start; scanned++)
+            if (keys[scanned] == '\n') line_start = scanned + 1;
+
+        int score = score_from(keys, candidate->len, line_start, start, word,
+                               word_len);
+        if (score) {
+            best = MAX(best, score);
+            pos = start + 1;
+            continue;
+        }
+
+        // the rest of the line holds the word no more than this hit did
+        const char *end = memchr(hit, '\n', candidate->len - start);
+        if (!end) break;
+        pos = scanned = line_start = end - keys + 1;
+    }
+
+    return best;
+}
+
+static int score_candidate(const AppSearchCandidate *candidate,
+                           gchar **words) {
+    int score = 0;
+
+    for (gchar **word = words; *word; word++) {
+        gsize word_len = strlen(*word);
+        if (word_len == 0) continue;
+
+        int word_score = score_word(candidate, *word, word_len);
+        if (!word_score) return 0;
+        score += word_score;
+    }
+
+    return score;
+}
+
+static gint compare_names(gconstpointer a, gconstpointer b) {
+    const AppSearchCandidate *ca = a, *cb = b;
+    return g_strcmp0(ca->entry->name, cb->entry->name);
+}
+
+// Sorts `matches`, collected in candidate order, best score first.
+// A counting sort over the span of scores, it is stable so ties stay in name
+// order, and a query matching most applications costs no comparison.
+static void sort_matches(GArray *matches) {
+    if (matches->len < 2) return;
+
+    int low = G_MAXINT, high = G_MININT;
+    for (guint i = 0; i < matches->len; i++) {
+        int score = g_array_index(matches, AppSearchMatch, i).score;
+        low = MIN(low, score);
+        high = MAX(high, score);
+    }
+
+    // start of each score's run in the result, best first
+    guint span = high - low + 1;
+    guint *starts = g_new0(guint, span + 1);
+    for (guint i = 0; i < matches->len; i++)
+        starts[high - g_array_index(matches, AppSearchMatch, i).score + 1]++;
+    for (guint i = 1; i <= span; i++) starts[i] += starts[i - 1];
+
+    AppSearchMatch *sorted = g_new(AppSearchMatch, matches->len);
+    for (guint i = 0; i < matches->len; i++) {
+        AppSearchMatch *match = &g_array_index(matches, AppSearchMatch, i);
+        sorted[starts[high - match->score]++] = *match;
+    }
+
+    memcpy(matches->data, sorted, matches->len * sizeof(AppSearchMatch));
+    g_free(sorted);
+    g_free(starts);
+}
+
+AppSearch *app_search_new(GArray *entries) {
+    AppSearch *self = g_new0(AppSearch, 1);
+
+    self->candidates = g_array_new(FALSE, FALSE, sizeof(AppSearchCandidate));
+    self->results = g_ptr_array_new();
+
+    for (guint i = 0; i < entries->len; i++) {
+        DesktopEntry *entry = &g_array_index(entries, DesktopEntry, i);
+        if (entry->nodisplay || !entry->application || !entry->search_keys)
+            continue;
+
+        AppSearchCandidate candidate = {
+            .entry = entry,
+            .keys = entry->search_keys,
+            .len = strlen(entry->search_keys),
+        };
+        candidate.mask = char_mask(candidate.keys, candidate.len);
+        g_array_append_val(self->candidates, candidate);
+    }
+
+    // GArray sorts are stable, equal names keep the cache's order
+    g_array_sort(self->candidates, compare_names);
+    self->matched = g_new0(guint8, self->candidates->len);
+
+    return self;
+}
+
+void app_search_free(AppSearch *self) {
+    if (!self) return;
+    g_array_unref(self->candidates);
+    g_free(self->matched);
+    g_ptr_array_unref(self->results);
+    g_free(self->query);
+    g_free(self);
+}
+
+GPtrArray *app_search_query(AppSearch *self, const char *query) {
+    gint64 start_us = g_get_monotonic_time();
+    char *folded = desktop_entry_fold(query ? query : "");
+    gchar **words = g_strsplit_set(g_strstrip(folded), " \t", -1);
+
+    // every match of a longer query also matched the shorter one, only those
+    // are scored again.
+    gboolean narrow = self->query && *self->query &&
+                      g_str_has_prefix(folded, self->query);
+
+    GArray *matches = g_array_new(FALSE, FALSE, sizeof(AppSearchMatch));
+    guint64 mask = char_mask(folded, strlen(folded));
+    guint n = narrow ? self->results->len : self->candidates->len;
+
+    for (guint i = 0; *folded && i < self->candidates->len; i++) {
+        const AppSearchCandidate *candidate =
+            &g_array_index(self->candidates, AppSearchCandidate, i);
+
+        gboolean was_matched = self->matched[i];
+        self->matched[i] = FALSE;
+        if (narrow && !was_matched) continue;
+        if (mask & ~candidate->mask) continue;
+
+        int score = score_candidate(candidate, words);
+        if (!score) continue;
+
+        self->matched[i] = TRUE;
+        AppSearchMatch match = {.candidate = i, .score = score};
+        g_array_append_val(matches, match);
+    }
+
+    sort_matches(matches);
+
+    g_ptr_array_set_size(self->results, 0);
+    for (guint i = 0; i < matches->len; i++) {
+        guint index = g_array_index(matches, AppSearchMatch, i).candidate;
+        g_ptr_array_add(
+            self->results,
+            g_array_index(self->candidates, AppSearchCandidate, index).entry);
+    }
+
+    g_debug(
+        "app_search.c:app_search_query(): '%s': %u of %u scanned, %u matches "
+        "in %" G_GINT64_FORMAT "us",
+        folded, n, self->candidates->len, matches->len,
+        g_get_monotonic_time() - start_us);
+
+    g_array_unref(matches);
+    g_free(self->query);
+    self->query = folded;
+    g_strfreev(words);
+
+    return self->results;
+}
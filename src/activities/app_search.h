@@ -0,0 +1,26 @@
+#pragma once
+
+#include <adwaita.h>
+
+#include "../services/desktop_entry_service/desktop_entry_cache.h"
+
+// Ranked fuzzy search over the launchable desktop entries.
+//
+// A query is split into words, an application matches when every word is a
+// subsequence of one line of its search keys. Matches score higher the more
+// of a word is consecutive, starts at word boundaries or a line's start, and
+// when it is found in the name rather than a generic name, keyword or the
+// executable.
+// A query extending the previous one only rescans the previous matches.
+
+typedef struct _AppSearch AppSearch;
+
+// Indexes the launchable applications of `entries`, a DesktopEntry array
+// which must outlive the search.
+AppSearch *app_search_new(GArray *entries);
+
+void app_search_free(AppSearch *self);
+
+// Returns the DesktopEntry structs matching `query`, best first.
+// The array is owned by `self` and valid until the next query.
+GPtrArray *app_search_query(AppSearch *self, const char *query);
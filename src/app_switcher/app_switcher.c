@@ -25,6 +25,9 @@ typedef struct _AppSwitcher {
     gchar *last_activated_app;
     gpointer last_activated_instance;
     gboolean select_alternative_app;
+    // AppSwitcherAppWidget holding each toplevel, keyed by its
+    // zwlr_foreign_toplevel_handle_v1.
+    GHashTable *widgets_by_toplevel;
 } AppSwitcher;
 
 static guint app_switcher_signals[signals_n] = {0};
@@ -112,10 +115,24 @@ static void app_switcher_activate_widget_at_index(AppSwitcher *self,
     app_switcher_app_widget_activate(widget);
 }
 
-static void on_top_level_changed(WaylandService *wayland, GPtrArray *toplevels,
+static void on_top_level_changed(WaylandService *wayland, GHashTable *toplevels,
                                  WaylandWLRForeignTopLevel *toplevel,
-                                 AppSwitcher *self) {
-    AppSwitcherAppWidget *app_widget = NULL;
+                                 guint changed, AppSwitcher *self) {
+    // outputs are not shown in the switcher
+    if (!(changed & ~TOPLEVEL_CHANGE_OUTPUT)) return;
+
+    AppSwitcherAppWidget *app_widget =
+        g_hash_table_lookup(self->widgets_by_toplevel, toplevel->toplevel);
+
+    // title churn from terminals and browsers only needs the instance's
+    // label updated, skip the app_id lookup.
+    if (app_widget && !(changed & ~(TOPLEVEL_CHANGE_TITLE |
+                                    TOPLEVEL_CHANGE_OUTPUT))) {
+        app_switcher_app_widget_set_title(app_widget, toplevel);
+        return;
+    }
+
+    app_widget = NULL;
     app_switcher_find_widget_by_app_id(self, toplevel->app_id, &app_widget);
 
     if (!app_widget) {
@@ -133,6 +150,8 @@ static void on_top_level_changed(WaylandService *wayland, GPtrArray *toplevels,
     }
 
     app_switcher_app_widget_add_toplevel(app_widget, toplevel);
+    g_hash_table_insert(self->widgets_by_toplevel, toplevel->toplevel,
+                        app_widget);
 
     if (toplevel->activated) {
         gtk_box_reorder_child_after(
@@ -171,6 +190,8 @@ static void on_top_level_removed(WaylandService *wayland,
         return;
     }
 
+    g_hash_table_remove(self->widgets_by_toplevel, toplevel->toplevel);
+
     AppSwitcherAppWidget *widget = NULL;
     app_switcher_find_widget_by_app_id(self, toplevel->app_id, &widget);
 
@@ -218,6 +239,8 @@ static void app_switcher_init_layout(AppSwitcher *self) {
 
     self->app_widget_list = GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
     gtk_widget_set_name(GTK_WIDGET(self->app_widget_list), "app-switcher-list");
+    // widgets of a previous list went with its window
+    g_hash_table_remove_all(self->widgets_by_toplevel);
 
 	gtk_scrolled_window_set_child(self->scrolled, GTK_WIDGET(self->app_widget_list));
 
@@ -374,6 +397,8 @@ static void app_switcher_init(AppSwitcher *self) {
 
     self->key_controller = gtk_event_controller_key_new();
 
+    self->widgets_by_toplevel = g_hash_table_new(g_direct_hash, g_direct_equal);
+
     g_signal_connect(self->key_controller, "key-pressed",
                      G_CALLBACK(key_pressed), self);
     g_signal_connect(self->key_controller, "key-released",
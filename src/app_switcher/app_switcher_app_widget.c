@@ -5,6 +5,7 @@
 #include <gio/gio.h>
 #include <gtk4-layer-shell/gtk4-layer-shell.h>
 
+#include "./../services/icon_cache_service/icon_cache_service.h"
 #include "./../services/wayland_service/wayland_service.h"
 #include "./app_switcher.h"
 #include "gtk/gtk.h"
@@ -187,45 +188,16 @@ static void app_switcher_app_widget_init(AppSwitcherAppWidget *self) {
     app_switcher_app_widget_init_layout(self);
 }
 
-GAppInfo *search_apps_by_app_id(gchar *app_id) {
-    GAppInfo *app_info = NULL;
-    GList *apps = g_app_info_get_all();
-    GList *l;
-    g_debug("app_switcher_app_widget: search_apps_by_app_id: %s", app_id);
-    for (l = apps; l != NULL; l = l->next) {
-        GAppInfo *info = l->data;
-        const gchar *id = g_app_info_get_id(info);
-        const gchar *lower_id = g_utf8_strdown(id, -1);
-        const gchar *lower_app_id = g_utf8_strdown(app_id, -1);
-        if (g_strrstr(lower_id, lower_app_id)) {
-            app_info = info;
-            break;
-        }
-    }
-    g_list_free(apps);
-    return app_info;
-}
-
 static void set_icon(AppSwitcherAppWidget *self,
                      WaylandWLRForeignTopLevel *toplevel) {
-    GAppInfo *app_info = search_apps_by_app_id(toplevel->app_id);
-    GIcon *icon = g_app_info_get_icon(G_APP_INFO(app_info));
-    // check and handle GFileIcon, set self->icon to a GtkImage
-    if (G_IS_FILE_ICON(icon)) {
-        g_debug("G_FILE_ICON");
-    }
-    // check and handle if GThemedIcon
-    else if (G_IS_THEMED_ICON(icon)) {
-        GdkDisplay *display = gdk_display_get_default();
-        GtkIconTheme *theme = gtk_icon_theme_get_for_display(display);
-        GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
-            theme, icon, 64, 1, GTK_TEXT_DIR_RTL, 0);
-        gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(paintable));
-    }
-    // check and handle if GLoadableIcon
-    else if (G_IS_LOADABLE_ICON(icon)) {
-        g_debug("G_LOADABLE_ICON");
-    }
+    // every instance of an app shares the cached paintable, the icon theme
+    // is only consulted for the first.
+    GdkPaintable *paintable = icon_cache_service_lookup_app(
+        icon_cache_service_get_global(), toplevel->app_id, 64, 1);
+    if (!paintable) return;
+
+    gtk_image_set_from_paintable(self->icon, paintable);
+    g_object_unref(paintable);
 }
 
 static void app_switcher_app_widget_set_layout_instance(
@@ -295,6 +267,16 @@ void app_switcher_app_widget_preview(AppSwitcherAppWidget *self) {
         gtk_widget_set_visible(GTK_WIDGET(self->parent->win), true);
 }
 
+void app_switcher_app_widget_set_title(AppSwitcherAppWidget *self,
+                                       WaylandWLRForeignTopLevel *toplevel) {
+    AppSwitcherAppWidget *instance =
+        find_instance_by_toplevel(self, toplevel->toplevel);
+    if (!instance) return;
+
+    gtk_label_set_text(instance->id_or_title, toplevel->title);
+    gtk_widget_set_tooltip_text(GTK_WIDGET(instance->button), toplevel->title);
+}
+
 void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
                                           WaylandWLRForeignTopLevel *toplevel) {
     // first time we are setting a top level, configure our name and icon.
@@ -323,8 +305,7 @@ void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
 
     // whether we created an instance or have an existing, this add maybe
     // just to update the widget's titles, do this in both cases.
-    gtk_label_set_text(instance->id_or_title, toplevel->title);
-    gtk_widget_set_tooltip_text(GTK_WIDGET(instance->button), toplevel->title);
+    app_switcher_app_widget_set_title(self, toplevel);
 
     if (self->instances_n > 1) {
         gtk_widget_set_visible(GTK_WIDGET(self->expand_arrow), true);
@@ -18,6 +18,10 @@ GtkWidget *app_switcher_app_widget_get_widget(AppSwitcherAppWidget *self);
 void app_switcher_app_widget_add_toplevel(AppSwitcherAppWidget *self,
                                           WaylandWLRForeignTopLevel *toplevel);
 
+// Updates the title shown for `toplevel`'s instance.
+void app_switcher_app_widget_set_title(AppSwitcherAppWidget *self,
+                                       WaylandWLRForeignTopLevel *toplevel);
+
 gboolean app_switcher_app_widget_remove_toplevel(
     AppSwitcherAppWidget *self, WaylandWLRForeignTopLevel *toplevel);
 
@@ -13,6 +13,8 @@
 #include "./services/brightness_service/brightness_service.h"
 #include "./services/clock_service.h"
 #include "./services/dbus_service.h"
+#include "./services/desktop_entry_service/desktop_entry_service.h"
+#include "./services/icon_cache_service/icon_cache_service.h"
 #include "./services/ipc_service/ipc_service.h"
 #include "./services/logind_service/logind_service.h"
 #include "./services/media_player_service/media_player_service.h"
@@ -89,6 +91,15 @@ static void activate(AdwApplication *app, gpointer user_data) {
         g_error("main.c: activate(): failed to initialize theme service.");
     }
 
+    if (desktop_entry_service_global_init() != 0) {
+        g_error(
+            "main.c: activate(): failed to initialize desktop entry service.");
+    }
+
+    if (icon_cache_service_global_init() != 0) {
+        g_error("main.c: activate(): failed to initialize icon cache service.");
+    }
+
     if (network_manager_service_global_init() != 0) {
         g_error(
             "main.c: activate(): failed to initialize network manager "
@@ -6,6 +6,7 @@
 #include <gtk4-layer-shell/gtk4-layer-shell.h>
 
 #include "../switcher/switcher.h"
+#include "./../services/wayland_service/wayland_service.h"
 #include "./../services/window_manager_service/window_manager_service.h"
 #include "./output_switcher_output_widget.h"
 #include "gdk/gdkkeysyms.h"
@@ -55,14 +56,29 @@ static void on_window_destroy(GtkWindow *win, OutputSwitcher *self) {}
 
 static gboolean filter_func(GtkListBoxRow *row, GtkSearchEntry *entry) {
     GtkWidget *widget = gtk_list_box_row_get_child(row);
+    const char *search_text = gtk_editable_get_text(GTK_EDITABLE(entry));
+
+    const char *layout = g_object_get_data(G_OBJECT(widget), "layout");
+    if (layout) return g_str_match_string(search_text, layout, true);
 
     WMOutput *ws = g_object_get_data(G_OBJECT(widget), "output");
 
-    const char *search_text = gtk_editable_get_text(GTK_EDITABLE(entry));
     gboolean match = g_str_match_string(search_text, ws->name, true);
     return match;
 }
 
+// Applies the layout of `widget` if it lists one.
+static gboolean output_switcher_apply_layout(OutputSwitcher *self,
+                                             GtkWidget *widget) {
+    const char *layout = g_object_get_data(G_OBJECT(widget), "layout");
+    if (!layout) return false;
+
+    wayland_output_layout_apply(wayland_service_get_global(), layout);
+
+    output_switcher_hide(self);
+    return true;
+}
+
 static void on_search_next_match(GtkSearchEntry *entry, OutputSwitcher *self) {
     g_debug("output_switcher.c:on_search_next_match() called.");
 
@@ -112,6 +128,8 @@ static void on_search_activated(GtkSearchEntry *entry, OutputSwitcher *self) {
     GtkWidget *widget = gtk_list_box_row_get_child(selected);
     if (!widget) return;
 
+    if (output_switcher_apply_layout(self, widget)) return;
+
     OutputSwitcherOutputWidget *output =
         g_object_get_data(G_OBJECT(widget), "output-widget");
 
@@ -164,6 +182,47 @@ static void on_search_changed(GtkSearchEntry *entry, OutputSwitcher *self) {
     }
 }
 
+// Appends a row for each saved output layout.
+static void output_switcher_append_layouts(OutputSwitcher *self) {
+    gchar **layouts = wayland_output_layouts(wayland_service_get_global());
+    if (!layouts) return;
+
+    for (int i = 0; layouts[i]; i++) {
+        OutputSwitcherOutputWidget *widget =
+            g_object_new(OUTPUT_SWITCHER_OUTPUT_WIDGET_TYPE, NULL);
+
+        char *label = g_strdup_printf("Layout: %s", layouts[i]);
+        output_switcher_output_widget_set_output_name(widget, label);
+        g_free(label);
+
+        g_object_set_data_full(
+            G_OBJECT(output_switcher_output_widget_get_widget(widget)),
+            "layout", g_strdup(layouts[i]), g_free);
+        gtk_list_box_append(SWITCHER(self).list,
+                            output_switcher_output_widget_get_widget(widget));
+    }
+
+    g_strfreev(layouts);
+}
+
+static void on_output_layouts_changed(WaylandService *wayland,
+                                      OutputSwitcher *self) {
+    g_debug("output_switcher.c:on_output_layouts_changed() called.");
+
+    // replace the layout rows, output rows stay as they are
+    GtkWidget *row =
+        gtk_widget_get_first_child(GTK_WIDGET(SWITCHER(self).list));
+    while (row) {
+        GtkWidget *next = gtk_widget_get_next_sibling(row);
+        GtkWidget *widget = gtk_list_box_row_get_child(GTK_LIST_BOX_ROW(row));
+        if (widget && g_object_get_data(G_OBJECT(widget), "layout"))
+            gtk_list_box_remove(SWITCHER(self).list, row);
+        row = next;
+    }
+
+    output_switcher_append_layouts(self);
+}
+
 static void on_outputs_changed(void *data, GPtrArray *outputs) {
     g_debug("output_switcher.c:on_outputs_changed() called.");
     if (!outputs) return;
@@ -185,6 +244,8 @@ static void on_outputs_changed(void *data, GPtrArray *outputs) {
         gtk_list_box_append(SWITCHER(self).list,
                             output_switcher_output_widget_get_widget(widget));
     }
+
+    output_switcher_append_layouts(self);
 }
 
 static void on_row_activated(GtkListBox *box, GtkListBoxRow *row,
@@ -192,6 +253,8 @@ static void on_row_activated(GtkListBox *box, GtkListBoxRow *row,
     GtkWidget *widget = gtk_list_box_row_get_child(row);
     if (!widget) return;
 
+    if (output_switcher_apply_layout(self, widget)) return;
+
     OutputSwitcherOutputWidget *output =
         g_object_get_data(G_OBJECT(widget), "output-widget");
 
@@ -245,6 +308,16 @@ static gboolean key_pressed(GtkEventControllerKey *controller, guint keyval,
         return true;
     }
 
+    // save the current output configuration as a layout named by the search
+    if (keyval == GDK_KEY_s && (state & GDK_CONTROL_MASK)) {
+        const char *name =
+            gtk_editable_get_text(GTK_EDITABLE(SWITCHER(self).search_entry));
+        if (strlen(name) > 0 &&
+            wayland_output_layout_save(wayland_service_get_global(), name))
+            output_switcher_hide(self);
+        return true;
+    }
+
     return false;
 }
 
@@ -279,6 +352,10 @@ static void output_switcher_init_layout(OutputSwitcher *self) {
     // wire into outputs changed events
     wm->register_on_outputs_changed(wm, on_outputs_changed, self);
 
+    // wire into saved output layouts changing
+    g_signal_connect(wayland_service_get_global(), "output-layouts-changed",
+                     G_CALLBACK(on_output_layouts_changed), self);
+
     // wire into GtkListBox's activated
     g_signal_connect(SWITCHER(self).list, "row-activated",
                      G_CALLBACK(on_row_activated), self);
@@ -3,6 +3,7 @@
 #include <adwaita.h>
 #include <string.h>
 
+#include "../../../services/icon_cache_service/icon_cache_service.h"
 #include "../../../services/media_player_service/media_player_service.h"
 #include "../message_tray.h"
 #include "glib.h"
@@ -438,56 +439,20 @@ static void avatar_from_img_data(NotificationWidget *self,
 }
 
 static void icon_from_app_id(GtkImage *icon, gchar *app_id) {
-    GAppInfo *app_info = NULL;
-    GList *apps = g_app_info_get_all();
-    GList *l;
-    g_debug("app_switcher_app_widget: search_apps_by_app_id: %s", app_id);
-    for (l = apps; l != NULL; l = l->next) {
-        GAppInfo *info = l->data;
-        const gchar *id = g_app_info_get_id(info);
-        const gchar *lower_id = g_utf8_strdown(id, -1);
-        const gchar *lower_app_id = g_utf8_strdown(app_id, -1);
-        if (g_strrstr(lower_id, lower_app_id)) {
-            app_info = info;
-            break;
-        }
-    }
-    g_list_free(apps);
-
-    GIcon *g_icon = g_app_info_get_icon(G_APP_INFO(app_info));
-    if (g_icon && G_IS_THEMED_ICON(g_icon)) {
-        GdkDisplay *display = gdk_display_get_default();
-        GtkIconTheme *theme = gtk_icon_theme_get_for_display(display);
-        GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
-            theme, g_icon, 48, 1, GTK_TEXT_DIR_RTL, 0);
-        gtk_image_set_from_paintable(icon, GDK_PAINTABLE(paintable));
-    }
+    GdkPaintable *paintable = icon_cache_service_lookup_app(
+        icon_cache_service_get_global(), app_id, 48, 1);
+    if (!paintable) return;
+
+    gtk_image_set_from_paintable(icon, paintable);
+    g_object_unref(paintable);
 }
 static void avatar_from_app_id(NotificationWidget *self, gchar *app_id) {
-    GAppInfo *app_info = NULL;
-    GList *apps = g_app_info_get_all();
-    GList *l;
-    g_debug("app_switcher_app_widget: search_apps_by_app_id: %s", app_id);
-    for (l = apps; l != NULL; l = l->next) {
-        GAppInfo *info = l->data;
-        const gchar *id = g_app_info_get_id(info);
-        const gchar *lower_id = g_utf8_strdown(id, -1);
-        const gchar *lower_app_id = g_utf8_strdown(app_id, -1);
-        if (g_strrstr(lower_id, lower_app_id)) {
-            app_info = info;
-            break;
-        }
-    }
-    g_list_free(apps);
-
-    GIcon *g_icon = g_app_info_get_icon(G_APP_INFO(app_info));
-    if (g_icon && G_IS_THEMED_ICON(g_icon)) {
-        GdkDisplay *display = gdk_display_get_default();
-        GtkIconTheme *theme = gtk_icon_theme_get_for_display(display);
-        GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
-            theme, g_icon, 48, 1, GTK_TEXT_DIR_RTL, 0);
-        adw_avatar_set_custom_image(self->avatar, GDK_PAINTABLE(paintable));
-    }
+    GdkPaintable *paintable = icon_cache_service_lookup_app(
+        icon_cache_service_get_global(), app_id, 48, 1);
+    if (!paintable) return;
+
+    adw_avatar_set_custom_image(self->avatar, paintable);
+    g_object_unref(paintable);
 }
 
 static void set_notification_icon(NotificationWidget *self, Notification *n) {
@@ -10,12 +10,35 @@ void quick_settings_grid_night_light_button_layout(
     self->menu = g_object_new(QUICK_SETTINGS_GRID_NIGHT_LIGHT_MENU_TYPE, NULL);
 
     quick_settings_grid_button_init(
-        &self->button, QUICK_SETTINGS_BUTTON_NIGHT_LIGHT, "Night Light", NULL,
+        &self->button, QUICK_SETTINGS_BUTTON_NIGHT_LIGHT, "Night Light", "",
         "night-light-symbolic",
         quick_settings_grid_night_light_button_get_menu_widget(self),
         quick_settings_grid_night_light_menu_on_reveal);
 }
 
+// shows the next scheduled transition, if any, in the subtitle.
+static void on_night_light_schedule_changed(
+    WaylandService *wayland_service, QuickSettingsGridNightLightButton *self) {
+    gint64 next = 0;
+    gboolean night = false;
+
+    if (!wayland_night_light_schedule_next(wayland_service, &next, &night)) {
+        gtk_label_set_text(self->button.subtitle, "");
+        return;
+    }
+
+    GDateTime *at = g_date_time_new_from_unix_local(next);
+    gchar *time = g_date_time_format(at, "%H:%M");
+    gchar *subtitle =
+        g_strdup_printf(night ? "From %s" : "Until %s", time);
+
+    gtk_label_set_text(self->button.subtitle, subtitle);
+
+    g_free(subtitle);
+    g_free(time);
+    g_date_time_unref(at);
+}
+
 static void on_gamma_control_enabled(
     WaylandService *wayland_service, QuickSettingsGridNightLightButton *self) {
     quick_settings_grid_button_set_toggled(&self->button, true);
@@ -60,6 +83,9 @@ quick_settings_grid_night_light_button_init() {
                      G_CALLBACK(on_gamma_control_enabled), self);
     g_signal_connect(w, "gamma-control-disabled",
                      G_CALLBACK(on_gamma_control_disabled), self);
+    g_signal_connect(w, "night-light-schedule-changed",
+                     G_CALLBACK(on_night_light_schedule_changed), self);
+    on_night_light_schedule_changed(w, self);
 
     gboolean gamma_ctlr_enabled = wayland_wlr_gamma_control_enabled(w);
     if (gamma_ctlr_enabled) {
@@ -3,31 +3,13 @@
 #include <adwaita.h>
 #include <gio/gio.h>
 
+#include "../../../../services/icon_cache_service/icon_cache_service.h"
 #include "../../../../services/wireplumber_service.h"
 #include "../../quick_settings_menu_widget.h"
 #include "glibconfig.h"
 #include "gtk/gtkdropdown.h"
 #include "gtk/gtkrevealer.h"
 
-static GAppInfo *search_apps_by_app_id(const gchar *app_id) {
-    GAppInfo *app_info = NULL;
-    GList *apps = g_app_info_get_all();
-    GList *l;
-    g_debug("app_switcher_app_widget: search_apps_by_app_id: %s", app_id);
-    for (l = apps; l != NULL; l = l->next) {
-        GAppInfo *info = l->data;
-        const gchar *id = g_app_info_get_id(info);
-        const gchar *lower_id = g_utf8_strdown(id, -1);
-        const gchar *lower_app_id = g_utf8_strdown(app_id, -1);
-        if (g_strrstr(lower_id, lower_app_id)) {
-            app_info = info;
-            break;
-        }
-    }
-    g_list_free(apps);
-    return app_info;
-}
-
 enum signals { signals_n };
 
 typedef struct _QuickSettingsHeaderMixerMenuOption {
@@ -358,25 +340,11 @@ GtkButton *link_button_new(WirePlumberServiceNodeHeader *header) {
 static void set_stream_common(QuickSettingsHeaderMixerMenuOption *self,
                               WirePlumberServiceAudioStream *node) {
     // prefer icons from app info
-    GAppInfo *app_info = search_apps_by_app_id(node->app_name);
-    if (app_info) {
-        GIcon *icon = g_app_info_get_icon(G_APP_INFO(app_info));
-        // check and handle GFileIcon, set self->icon to a GtkImage
-        if (G_IS_FILE_ICON(icon)) {
-            g_debug("G_FILE_ICON");
-        }
-        // check and handle if GThemedIcon
-        else if (G_IS_THEMED_ICON(icon)) {
-            GdkDisplay *display = gdk_display_get_default();
-            GtkIconTheme *theme = gtk_icon_theme_get_for_display(display);
-            GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
-                theme, icon, 64, 1, GTK_TEXT_DIR_RTL, 0);
-            gtk_image_set_from_paintable(self->icon, GDK_PAINTABLE(paintable));
-        }
-        // check and handle if GLoadableIcon
-        else if (G_IS_LOADABLE_ICON(icon)) {
-            g_debug("G_LOADABLE_ICON");
-        }
+    GdkPaintable *paintable = icon_cache_service_lookup_app(
+        icon_cache_service_get_global(), node->app_name, 64, 1);
+    if (paintable) {
+        gtk_image_set_from_paintable(self->icon, paintable);
+        g_object_unref(paintable);
     } else
         gtk_image_set_from_icon_name(self->icon,
                                      "applications-multimedia-symbolic");
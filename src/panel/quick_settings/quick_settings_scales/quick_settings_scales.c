@@ -3,6 +3,7 @@
 #include <adwaita.h>
 
 #include "../../../services/brightness_service/brightness_service.h"
+#include "../../../services/wayland_service/wayland_service.h"
 #include "../../../services/wireplumber_service.h"
 #include "gtk/gtkrevealer.h"
 
@@ -290,7 +291,12 @@ static void on_brightness_scale_changed(GtkRange *range,
 
     gdouble r = gtk_range_get_value(range);
     BrightnessService *bs = brightness_service_get_global();
-    brightness_service_set_backlight(bs, r);
+    gboolean backlight = brightness_service_has_backlight_brightness(bs);
+    if (backlight) brightness_service_set_backlight(bs, r);
+
+    // outputs without a backlight are dimmed through their gamma ramps
+    wayland_gamma_set_brightness_all(wayland_service_get_global(), r,
+                                     backlight);
 
     block_brightness_changed_signals(self, false);
 }
@@ -453,30 +459,39 @@ static void quick_settings_scales_init_layout(QuickSettingsScales *self) {
 
     gtk_box_append(self->container, GTK_WIDGET(self->audio_scales_revealer));
 
-    // brightness setup, dependent on whether brightness service is available.
+    // connect to scale's Range::value-changed signal
+    g_signal_connect(GTK_RANGE(self->default_sink_scale), "value-changed",
+                     G_CALLBACK(on_sink_scale_value_changed), self);
+
+    g_signal_connect(GTK_RANGE(self->default_source_scale), "value-changed",
+                     G_CALLBACK(on_source_scale_value_changed), self);
+
+    // brightness setup, the backlight is used when the brightness service has
+    // one, external outputs are dimmed in software either way.
     BrightnessService *bs = brightness_service_get_global();
 
-    if (brightness_service_has_backlight_brightness(bs)) {
-        self->brightness_container =
-            GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
-        gtk_widget_set_name(GTK_WIDGET(self->brightness_container),
-                            "brightness-container");
+    self->brightness_container =
+        GTK_BOX(gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0));
+    gtk_widget_set_name(GTK_WIDGET(self->brightness_container),
+                        "brightness-container");
 
-        self->brightness_scale = GTK_SCALE(
-            gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 1, 0.05));
-        gtk_widget_set_hexpand(GTK_WIDGET(self->brightness_scale), true);
+    // software dimming stops at WAYLAND_GAMMA_MIN_BRIGHTNESS
+    self->brightness_scale = GTK_SCALE(
+        gtk_scale_new_with_range(GTK_ORIENTATION_HORIZONTAL, 0, 1, 0.05));
+    gtk_widget_set_hexpand(GTK_WIDGET(self->brightness_scale), true);
 
-        self->brightness_button = GTK_BUTTON(
-            gtk_button_new_from_icon_name(brightness_service_map_icon(bs)));
+    self->brightness_button = GTK_BUTTON(
+        gtk_button_new_from_icon_name(brightness_service_map_icon(bs)));
 
-        self->brightness_icon = GTK_IMAGE(
-            gtk_widget_get_first_child(GTK_WIDGET(self->brightness_button)));
+    self->brightness_icon = GTK_IMAGE(
+        gtk_widget_get_first_child(GTK_WIDGET(self->brightness_button)));
 
-        gtk_box_append(self->brightness_container,
-                       GTK_WIDGET(self->brightness_button));
-        gtk_box_append(self->brightness_container,
-                       GTK_WIDGET(self->brightness_scale));
+    gtk_box_append(self->brightness_container,
+                   GTK_WIDGET(self->brightness_button));
+    gtk_box_append(self->brightness_container,
+                   GTK_WIDGET(self->brightness_scale));
 
+    if (brightness_service_has_backlight_brightness(bs)) {
         // listen for brightness changes
         g_signal_connect(bs, "brightness-changed",
                          G_CALLBACK(on_brightness_change), self);
@@ -484,19 +499,16 @@ static void quick_settings_scales_init_layout(QuickSettingsScales *self) {
         // get initial brightness value
         float brightness = brightness_service_get_backlight(bs);
         gtk_range_set_value(GTK_RANGE(self->brightness_scale), brightness);
+    } else {
+        gtk_range_set_value(
+            GTK_RANGE(self->brightness_scale),
+            wayland_gamma_get_brightness(wayland_service_get_global(), NULL));
+    }
 
-        // connect to scale's Range::value-changed signal
-        g_signal_connect(GTK_RANGE(self->default_sink_scale), "value-changed",
-                         G_CALLBACK(on_sink_scale_value_changed), self);
-
-        g_signal_connect(GTK_RANGE(self->default_source_scale), "value-changed",
-                         G_CALLBACK(on_source_scale_value_changed), self);
-
-        g_signal_connect(GTK_RANGE(self->brightness_scale), "value-changed",
-                         G_CALLBACK(on_brightness_scale_changed), self);
+    g_signal_connect(GTK_RANGE(self->brightness_scale), "value-changed",
+                     G_CALLBACK(on_brightness_scale_changed), self);
 
-        gtk_box_append(self->container, GTK_WIDGET(self->brightness_container));
-    }
+    gtk_box_append(self->container, GTK_WIDGET(self->brightness_container));
 }
 
 static void quick_settings_scales_init(QuickSettingsScales *self) {
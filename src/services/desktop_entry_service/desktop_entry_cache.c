@@ -0,0 +1,515 @@
+#include "desktop_entry_cache.h"
+
+#include <adwaita.h>
+#include <errno.h>
+#include <gio/gdesktopappinfo.h>
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#define CACHE_DIR "way-shell"
+#define CACHE_FILE "desktop-entries.cache"
+#define CACHE_MAGIC "WSDEC\0\0\0"
+// bump whenever the layout or the meaning of a field changes
+#define CACHE_VERSION 2
+// the blob is written in host byte order, a cache from another host is
+// rejected rather than converted.
+#define CACHE_BYTE_ORDER 0x01020304
+
+#define ENTRY_FLAG_NODISPLAY (1 << 0)
+#define ENTRY_FLAG_APPLICATION (1 << 1)
+
+// The blob is a CacheHeader, `n_entries` CacheEntry records and the string
+// table, in that order.
+// Strings are referenced by their offset into the table, which starts with an
+// empty string so offset 0 stands for NULL.
+typedef struct _CacheHeader {
+    char magic[8];
+    guint32 version;
+    guint32 byte_order;
+    guint32 n_entries;
+    guint32 strings_offset;
+    guint32 strings_size;
+    // desktop_entry_cache_stamp at the time the entries were read
+    guint32 stamps;
+} CacheHeader;
+
+typedef struct _CacheEntry {
+    guint32 id;
+    guint32 name;
+    guint32 icon;
+    guint32 exec;
+    guint32 lower_id;
+    guint32 wm_class;
+    guint32 exec_key;
+    guint32 search_keys;
+    guint32 flags;
+} CacheEntry;
+
+struct _DesktopEntryCache {
+    // the blob, either mapped from the cache file or freshly built
+    GBytes *bytes;
+    GBytes *stamps;
+    // DesktopEntry structs pointing into `bytes`
+    GArray *entries;
+};
+
+typedef struct _StringTable {
+    GByteArray *data;
+    // offsets of the strings added so far, to store each only once
+    GHashTable *offsets;
+} StringTable;
+
+static guint32 string_table_add(StringTable *table, const char *str) {
+    if (!str) return 0;
+
+    gpointer offset = NULL;
+    if (g_hash_table_lookup_extended(table->offsets, str, NULL, &offset))
+        return GPOINTER_TO_UINT(offset);
+
+    guint32 new_offset = table->data->len;
+    g_byte_array_append(table->data, (const guint8 *)str, strlen(str) + 1);
+    g_hash_table_insert(table->offsets, g_strdup(str),
+                        GUINT_TO_POINTER(new_offset));
+    return new_offset;
+}
+
+static char *cache_path(void) {
+    return g_build_filename(g_get_user_cache_dir(), CACHE_DIR, CACHE_FILE,
+                            NULL);
+}
+
+GPtrArray *desktop_entry_cache_dirs(void) {
+    GPtrArray *dirs = g_ptr_array_new_with_free_func(g_free);
+
+    g_ptr_array_add(dirs, g_build_filename(g_get_user_data_dir(),
+                                           "applications", NULL));
+    for (const gchar *const *dir = g_get_system_data_dirs(); *dir; dir++)
+        g_ptr_array_add(dirs, g_build_filename(*dir, "applications", NULL));
+
+    return dirs;
+}
+
+// Folds the desktop files under `dir` into `newest`, the latest modification
+// time of them and of the directories holding them, and into `size` and
+// `count`.
+static void stamp_dir(const char *dir, gint64 *newest, guint64 *size,
+                      guint *count) {
+    GStatBuf st;
+    if (g_stat(dir, &st) != 0) return;
+    *newest = MAX(*newest, (gint64)st.st_mtim.tv_sec * G_USEC_PER_SEC +
+                               st.st_mtim.tv_nsec / 1000);
+
+    GDir *handle = g_dir_open(dir, 0, NULL);
+    if (!handle) return;
+
+    const char *name;
+    while ((name = g_dir_read_name(handle))) {
+        char *path = g_build_filename(dir, name, NULL);
+
+        if (g_str_has_suffix(name, ".desktop")) {
+            if (g_stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+                *newest =
+                    MAX(*newest, (gint64)st.st_mtim.tv_sec * G_USEC_PER_SEC +
+                                     st.st_mtim.tv_nsec / 1000);
+                *size += st.st_size;
+                (*count)++;
+            }
+        } else if (g_file_test(path, G_FILE_TEST_IS_DIR)) {
+            // desktop ids of subdirectories are prefixed with their name
+            stamp_dir(path, newest, size, count);
+        }
+
+        g_free(path);
+    }
+
+    g_dir_close(handle);
+}
+
+GBytes *desktop_entry_cache_stamp(void) {
+    GPtrArray *dirs = desktop_entry_cache_dirs();
+    GString *stamps = g_string_new(NULL);
+
+    // a directory's mtime moves when desktop files are added, removed or
+    // renamed in it, a file's when it is edited in place. Sizes and counts
+    // catch a file replaced by one carrying an older mtime.
+    for (guint i = 0; i < dirs->len; i++) {
+        const char *dir = g_ptr_array_index(dirs, i);
+        gint64 newest = -1;
+        guint64 size = 0;
+        guint count = 0;
+
+        stamp_dir(dir, &newest, &size, &count);
+
+        g_string_append_printf(stamps,
+                               "%s %" G_GINT64_FORMAT " %" G_GUINT64_FORMAT
+                               " %u\n",
+                               dir, newest, size, count);
+    }
+
+    g_ptr_array_unref(dirs);
+    return g_string_free_to_bytes(stamps);
+}
+
+char *desktop_entry_fold(const char *str) {
+    char *decomposed = g_utf8_normalize(str, -1, G_NORMALIZE_ALL);
+    if (!decomposed) return g_utf8_strdown(str, -1);
+
+    GString *folded = g_string_sized_new(strlen(decomposed));
+    for (const char *p = decomposed; *p; p = g_utf8_next_char(p)) {
+        gunichar c = g_utf8_get_char(p);
+        // accents are separate marks after decomposition
+        if (g_unichar_ismark(c)) continue;
+        g_string_append_unichar(folded, g_unichar_tolower(c));
+    }
+
+    g_free(decomposed);
+    return g_string_free(folded, FALSE);
+}
+
+// Adds `str` folded as another line of `keys`.
+static void search_keys_add(GString *keys, const char *str) {
+    if (!str || *str == '\0') return;
+
+    char *folded = desktop_entry_fold(str);
+    g_string_append_c(keys, '\n');
+    g_string_append(keys, folded);
+    g_free(folded);
+}
+
+void desktop_entry_init_from_app_info(DesktopEntry *entry, GAppInfo *info,
+                                      GStringChunk *chunk) {
+    memset(entry, 0, sizeof(*entry));
+    entry->app_info = info;
+
+    const char *id = g_app_info_get_id(info);
+    const char *name = g_app_info_get_display_name(info);
+    const char *exec = g_app_info_get_executable(info);
+
+    if (id) {
+        char *lower = g_utf8_strdown(id, -1);
+        if (g_str_has_suffix(lower, ".desktop"))
+            lower[strlen(lower) - strlen(".desktop")] = '\0';
+        entry->id = g_string_chunk_insert_const(chunk, id);
+        entry->lower_id = g_string_chunk_insert_const(chunk, lower);
+        g_free(lower);
+    }
+
+    if (name) entry->name = g_string_chunk_insert_const(chunk, name);
+
+    GIcon *icon = g_app_info_get_icon(info);
+    if (icon) {
+        char *icon_str = g_icon_to_string(icon);
+        if (icon_str)
+            entry->icon = g_string_chunk_insert_const(chunk, icon_str);
+        g_free(icon_str);
+    }
+
+    char *exec_key = NULL;
+    if (exec) {
+        char *basename = g_path_get_basename(exec);
+        exec_key = g_utf8_strdown(basename, -1);
+        g_free(basename);
+        entry->exec = g_string_chunk_insert_const(chunk, exec);
+        entry->exec_key = g_string_chunk_insert_const(chunk, exec_key);
+    }
+
+    // the name is always the first line, empty if there is none
+    GString *keys = g_string_new(NULL);
+    if (name) {
+        char *folded = desktop_entry_fold(name);
+        g_string_append(keys, folded);
+        g_free(folded);
+    }
+
+    entry->application = TRUE;
+    if (G_IS_DESKTOP_APP_INFO(info)) {
+        GDesktopAppInfo *desktop_info = G_DESKTOP_APP_INFO(info);
+
+        const char *wm_class =
+            g_desktop_app_info_get_startup_wm_class(desktop_info);
+        if (wm_class) {
+            char *lower = g_utf8_strdown(wm_class, -1);
+            entry->wm_class = g_string_chunk_insert_const(chunk, lower);
+            g_free(lower);
+        }
+
+        entry->nodisplay = g_desktop_app_info_get_nodisplay(desktop_info);
+        entry->application =
+            g_strcmp0(g_desktop_app_info_get_string(desktop_info, "Type"),
+                      "Application") == 0;
+
+        search_keys_add(keys,
+                        g_desktop_app_info_get_generic_name(desktop_info));
+        const char *const *keywords =
+            g_desktop_app_info_get_keywords(desktop_info);
+        for (; keywords && *keywords; keywords++)
+            search_keys_add(keys, *keywords);
+    }
+
+    search_keys_add(keys, exec_key);
+    entry->search_keys = g_string_chunk_insert_const(chunk, keys->str);
+
+    g_string_free(keys, TRUE);
+    g_free(exec_key);
+}
+
+// Returns the string at `offset` of the validated table `strings`.
+static const char *cache_string(const char *strings, guint32 offset) {
+    return offset ? strings + offset : NULL;
+}
+
+// Takes ownership of `bytes`, returns NULL if it is not a valid blob.
+static DesktopEntryCache *desktop_entry_cache_parse(GBytes *bytes) {
+    gsize size = 0;
+    const guint8 *data = g_bytes_get_data(bytes, &size);
+    const CacheHeader *header = (const CacheHeader *)data;
+
+    if (size < sizeof(CacheHeader) ||
+        memcmp(header->magic, CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != CACHE_VERSION ||
+        header->byte_order != CACHE_BYTE_ORDER)
+        goto invalid;
+
+    // every offset is checked against the table once here, the table ends
+    // with a NUL so any offset within it is a terminated string.
+    guint64 records_end = sizeof(CacheHeader) +
+                          (guint64)header->n_entries * sizeof(CacheEntry);
+    if (header->strings_offset != records_end ||
+        records_end + header->strings_size != size ||
+        header->strings_size == 0)
+        goto invalid;
+
+    const char *strings = (const char *)data + header->strings_offset;
+    if (strings[0] != '\0' || strings[header->strings_size - 1] != '\0' ||
+        header->stamps >= header->strings_size)
+        goto invalid;
+
+    const CacheEntry *records =
+        (const CacheEntry *)(data + sizeof(CacheHeader));
+    for (guint32 i = 0; i < header->n_entries; i++) {
+        const guint32 *offsets = (const guint32 *)&records[i];
+        for (guint f = 0; f < G_STRUCT_OFFSET(CacheEntry, flags) / 4; f++)
+            if (offsets[f] >= header->strings_size) goto invalid;
+    }
+
+    DesktopEntryCache *self = g_new0(DesktopEntryCache, 1);
+    self->bytes = bytes;
+
+    const char *stamps = cache_string(strings, header->stamps);
+    self->stamps = g_bytes_new(stamps ? stamps : "",
+                               stamps ? strlen(stamps) : 0);
+
+    self->entries = g_array_sized_new(FALSE, TRUE, sizeof(DesktopEntry),
+                                      header->n_entries);
+    g_array_set_size(self->entries, header->n_entries);
+
+    for (guint32 i = 0; i < header->n_entries; i++) {
+        const CacheEntry *record = &records[i];
+        DesktopEntry *entry = &g_array_index(self->entries, DesktopEntry, i);
+
+        entry->id = cache_string(strings, record->id);
+        entry->name = cache_string(strings, record->name);
+        entry->icon = cache_string(strings, record->icon);
+        entry->exec = cache_string(strings, record->exec);
+        entry->lower_id = cache_string(strings, record->lower_id);
+        entry->wm_class = cache_string(strings, record->wm_class);
+        entry->exec_key = cache_string(strings, record->exec_key);
+        entry->search_keys = cache_string(strings, record->search_keys);
+        entry->nodisplay = (record->flags & ENTRY_FLAG_NODISPLAY) != 0;
+        entry->application = (record->flags & ENTRY_FLAG_APPLICATION) != 0;
+    }
+
+    return self;
+
+invalid:
+    g_bytes_unref(bytes);
+    return NULL;
+}
+
+DesktopEntryCache *desktop_entry_cache_new_from_entries(GArray *entries,
+                                                        GBytes *stamps) {
+    StringTable table = {
+        .data = g_byte_array_new(),
+        .offsets = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                         NULL),
+    };
+    guint8 nul = 0;
+    g_byte_array_append(table.data, &nul, 1);
+
+    CacheEntry *records = g_new0(CacheEntry, entries->len);
+    for (guint i = 0; i < entries->len; i++) {
+        DesktopEntry *entry = &g_array_index(entries, DesktopEntry, i);
+        CacheEntry *record = &records[i];
+
+        record->id = string_table_add(&table, entry->id);
+        record->name = string_table_add(&table, entry->name);
+        record->icon = string_table_add(&table, entry->icon);
+        record->exec = string_table_add(&table, entry->exec);
+        record->lower_id = string_table_add(&table, entry->lower_id);
+        record->wm_class = string_table_add(&table, entry->wm_class);
+        record->exec_key = string_table_add(&table, entry->exec_key);
+        record->search_keys = string_table_add(&table, entry->search_keys);
+        record->flags = (entry->nodisplay ? ENTRY_FLAG_NODISPLAY : 0) |
+                        (entry->application ? ENTRY_FLAG_APPLICATION : 0);
+    }
+
+    // the stamps are text, added as one more string
+    char *stamps_str = g_strndup(g_bytes_get_data(stamps, NULL),
+                                 g_bytes_get_size(stamps));
+
+    CacheHeader header = {
+        .version = CACHE_VERSION,
+        .byte_order = CACHE_BYTE_ORDER,
+        .n_entries = entries->len,
+        .strings_offset =
+            sizeof(CacheHeader) + entries->len * sizeof(CacheEntry),
+        .stamps = string_table_add(&table, stamps_str),
+    };
+    memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.strings_size = table.data->len;
+
+    GByteArray *blob = g_byte_array_sized_new(header.strings_offset +
+                                              header.strings_size);
+    g_byte_array_append(blob, (const guint8 *)&header, sizeof(header));
+    g_byte_array_append(blob, (const guint8 *)records,
+                        entries->len * sizeof(CacheEntry));
+    g_byte_array_append(blob, table.data->data, table.data->len);
+
+    g_free(stamps_str);
+    g_free(records);
+    g_hash_table_unref(table.offsets);
+    g_byte_array_unref(table.data);
+
+    DesktopEntryCache *self =
+        desktop_entry_cache_parse(g_byte_array_free_to_bytes(blob));
+
+    // carry resolved app infos over, entries keep their order
+    for (guint i = 0; self && i < entries->len; i++) {
+        GAppInfo *info = g_array_index(entries, DesktopEntry, i).app_info;
+        if (info)
+            g_array_index(self->entries, DesktopEntry, i).app_info =
+                g_object_ref(info);
+    }
+
+    return self;
+}
+
+DesktopEntryCache *desktop_entry_cache_new_from_app_infos(GPtrArray *app_infos,
+                                                          GBytes *stamps) {
+    GStringChunk *chunk = g_string_chunk_new(4096);
+    GArray *entries = g_array_sized_new(FALSE, TRUE, sizeof(DesktopEntry),
+                                        app_infos->len);
+    g_array_set_size(entries, app_infos->len);
+
+    for (guint i = 0; i < app_infos->len; i++)
+        desktop_entry_init_from_app_info(
+            &g_array_index(entries, DesktopEntry, i),
+            g_ptr_array_index(app_infos, i), chunk);
+
+    DesktopEntryCache *self =
+        desktop_entry_cache_new_from_entries(entries, stamps);
+
+    g_array_unref(entries);
+    g_string_chunk_free(chunk);
+    return self;
+}
+
+DesktopEntryCache *desktop_entry_cache_open(void) {
+    char *path = cache_path();
+    GError *error = NULL;
+
+    GMappedFile *file = g_mapped_file_new(path, FALSE, &error);
+    if (!file) {
+        if (!g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_warning("desktop_entry_cache.c:desktop_entry_cache_open(): %s",
+                      error->message);
+        g_error_free(error);
+        g_free(path);
+        return NULL;
+    }
+
+    DesktopEntryCache *self =
+        desktop_entry_cache_parse(g_mapped_file_get_bytes(file));
+    g_mapped_file_unref(file);
+
+    if (!self) {
+        g_warning(
+            "desktop_entry_cache.c:desktop_entry_cache_open(): %s: invalid "
+            "cache, ignoring it",
+            path);
+        g_free(path);
+        return NULL;
+    }
+
+    g_debug(
+        "desktop_entry_cache.c:desktop_entry_cache_open(): %s: entries: %u",
+        path, self->entries->len);
+
+    g_free(path);
+    return self;
+}
+
+GArray *desktop_entry_cache_get_entries(DesktopEntryCache *self) {
+    return self->entries;
+}
+
+GBytes *desktop_entry_cache_get_stamps(DesktopEntryCache *self) {
+    return self->stamps;
+}
+
+static void on_cache_saved(GFile *file, GAsyncResult *res, gpointer data) {
+    GError *error = NULL;
+    if (!g_file_replace_contents_finish(file, res, NULL, &error)) {
+        g_warning("desktop_entry_cache.c:on_cache_saved(): %s",
+                  error->message);
+        g_error_free(error);
+        return;
+    }
+    g_debug("desktop_entry_cache.c:on_cache_saved(): cache written");
+}
+
+void desktop_entry_cache_save(DesktopEntryCache *self) {
+    char *dir = g_build_filename(g_get_user_cache_dir(), CACHE_DIR, NULL);
+    char *path = cache_path();
+
+    if (g_mkdir_with_parents(dir, 0755) != 0) {
+        g_warning("desktop_entry_cache.c:desktop_entry_cache_save(): %s: %s",
+                  dir, g_strerror(errno));
+        goto out;
+    }
+
+    // written to a temporary file and renamed over the old cache, a mapping
+    // of the old one stays valid.
+    GFile *file = g_file_new_for_path(path);
+    g_file_replace_contents_bytes_async(
+        file, self->bytes, NULL, FALSE, G_FILE_CREATE_REPLACE_DESTINATION,
+        NULL, (GAsyncReadyCallback)on_cache_saved, NULL);
+    g_object_unref(file);
+
+out:
+    g_free(dir);
+    g_free(path);
+}
+
+static void desktop_entry_clear(DesktopEntry *entry) {
+    g_clear_object(&entry->app_info);
+}
+
+void desktop_entry_cache_free(DesktopEntryCache *self) {
+    if (!self) return;
+
+    for (guint i = 0; i < self->entries->len; i++)
+        desktop_entry_clear(&g_array_index(self->entries, DesktopEntry, i));
+    g_array_unref(self->entries);
+    g_bytes_unref(self->stamps);
+    g_bytes_unref(self->bytes);
+    g_free(self);
+}
+
+GAppInfo *desktop_entry_get_app_info(DesktopEntry *entry) {
+    if (!entry->app_info && entry->id) {
+        GDesktopAppInfo *info = g_desktop_app_info_new(entry->id);
+        if (info) entry->app_info = G_APP_INFO(info);
+    }
+    return entry->app_info;
+}
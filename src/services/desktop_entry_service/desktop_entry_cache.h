@@ -0,0 +1,89 @@
+#pragma once
+
+#include <adwaita.h>
+
+// Installed applications serialized into one compact blob, stored at
+// $XDG_CACHE_HOME/way-shell/desktop-entries.cache and mapped read-only on the
+// next start, so the shell comes up without parsing any desktop file.
+//
+// The blob holds a record per application whose strings point into a shared,
+// deduplicated string table, along with stamps of the desktop files in the
+// XDG applications directories it was built from. A cache whose stamps differ
+// from the current ones is stale but still usable while a new one is built.
+
+// A single installed application.
+// Strings point into the cache's blob and are NULL when the desktop file has
+// no such key.
+typedef struct _DesktopEntry {
+    // desktop id, such as "org.gnome.Nautilus.desktop"
+    const char *id;
+    const char *name;
+    // serialized GIcon, see g_icon_new_for_string
+    const char *icon;
+    const char *exec;
+    // lowercased desktop id without the ".desktop" suffix
+    const char *lower_id;
+    // lowercased StartupWMClass
+    const char *wm_class;
+    // lowercased basename of the executable
+    const char *exec_key;
+    // name, generic name, keywords and executable folded by
+    // desktop_entry_fold, one per line and the name always first
+    const char *search_keys;
+    gboolean nodisplay;
+    // Type=Application
+    gboolean application;
+
+    // resolved on first use, see desktop_entry_get_app_info
+    GAppInfo *app_info;
+} DesktopEntry;
+
+typedef struct _DesktopEntryCache DesktopEntryCache;
+
+// Returns the XDG applications directories, the user's first, in the order
+// their desktop files take precedence.
+GPtrArray *desktop_entry_cache_dirs(void);
+
+// Maps the cache file.
+// Returns NULL if there is none or it is corrupt.
+DesktopEntryCache *desktop_entry_cache_open(void);
+
+// Builds a cache from `app_infos` read after `stamps`, taken with
+// desktop_entry_cache_stamp.
+// Safe to call from any thread, the entries keep a reference on their
+// GAppInfo.
+DesktopEntryCache *desktop_entry_cache_new_from_app_infos(GPtrArray *app_infos,
+                                                          GBytes *stamps);
+
+// Builds a cache from `entries`, such as those of another cache with some
+// replaced, keeping their resolved GAppInfo.
+DesktopEntryCache *desktop_entry_cache_new_from_entries(GArray *entries,
+                                                        GBytes *stamps);
+
+// Serializes, per applications directory, the newest modification time of
+// its desktop files and subdirectories, their total size and their count.
+GBytes *desktop_entry_cache_stamp(void);
+
+// Fills `entry` from `info`, strings are allocated in `chunk`.
+void desktop_entry_init_from_app_info(DesktopEntry *entry, GAppInfo *info,
+                                      GStringChunk *chunk);
+
+// Returns the DesktopEntry array of `self`.
+GArray *desktop_entry_cache_get_entries(DesktopEntryCache *self);
+
+// Returns the stamps `self` was built under, the cache is stale when they
+// differ from desktop_entry_cache_stamp.
+GBytes *desktop_entry_cache_get_stamps(DesktopEntryCache *self);
+
+// Writes `self` to the cache file in the background.
+void desktop_entry_cache_save(DesktopEntryCache *self);
+
+void desktop_entry_cache_free(DesktopEntryCache *self);
+
+// Returns `str` lowercased and without accents, the form search keys are
+// stored in.
+char *desktop_entry_fold(const char *str);
+
+// Returns the GAppInfo of `entry`, parsing its desktop file on first use.
+// NULL if the desktop file is gone.
+GAppInfo *desktop_entry_get_app_info(DesktopEntry *entry);
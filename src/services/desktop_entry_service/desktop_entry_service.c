@@ -0,0 +1,444 @@
+#include "desktop_entry_service.h"
+
+#include <adwaita.h>
+#include <gio/gdesktopappinfo.h>
+#include <gio/gio.h>
+
+// Desktop files are often written in several steps, or several at once by a
+// package manager, changes are collected for this long before applying them.
+#define UPDATE_DELAY_MS 500
+
+static DesktopEntryService *global = NULL;
+
+enum signals { changed, signals_n };
+
+struct _DesktopEntryService {
+    GObject parent_instance;
+    // every installed application, see desktop_entry_cache.h
+    DesktopEntryCache *cache;
+    // Indexes into the cache's entries keyed by the desktop id, the
+    // lowercased desktop id and its last reverse DNS component, the
+    // lowercased StartupWMClass and the lowercased basename of the
+    // executable. Keys point into the cache, the first entry claiming a key
+    // keeps it.
+    GHashTable *by_id;
+    GHashTable *by_lower_id;
+    GHashTable *by_wm_class;
+    GHashTable *by_exec;
+    // Results of desktop_entry_service_lookup_entry, misses included, keyed
+    // by the app id asked for.
+    GHashTable *lookups;
+    // GFileMonitor of each XDG applications directory
+    GPtrArray *monitors;
+    // Desktop ids changed on disk since the last update
+    GHashTable *pending;
+    guint update_id;
+    // cancels a background rebuild of the cache
+    GCancellable *rebuild;
+    // bumped whenever the cache is replaced, a rebuild started under an
+    // older generation missed the updates since.
+    guint generation;
+};
+static guint signals[signals_n] = {0};
+G_DEFINE_TYPE(DesktopEntryService, desktop_entry_service, G_TYPE_OBJECT);
+
+// Stub out GObject's dispose, finalize, class_init, and init methods
+static void desktop_entry_service_dispose(GObject *gobject) {
+    DesktopEntryService *self = DESKTOP_ENTRY_SERVICE(gobject);
+
+    g_clear_handle_id(&self->update_id, g_source_remove);
+    g_clear_pointer(&self->monitors, g_ptr_array_unref);
+    if (self->rebuild) {
+        g_cancellable_cancel(self->rebuild);
+        g_clear_object(&self->rebuild);
+    }
+
+    // Chain-up
+    G_OBJECT_CLASS(desktop_entry_service_parent_class)->dispose(gobject);
+};
+
+static void desktop_entry_service_finalize(GObject *gobject) {
+    DesktopEntryService *self = DESKTOP_ENTRY_SERVICE(gobject);
+
+    g_hash_table_unref(self->by_id);
+    g_hash_table_unref(self->by_lower_id);
+    g_hash_table_unref(self->by_wm_class);
+    g_hash_table_unref(self->by_exec);
+    g_hash_table_unref(self->lookups);
+    g_hash_table_unref(self->pending);
+    desktop_entry_cache_free(self->cache);
+
+    // Chain-up
+    G_OBJECT_CLASS(desktop_entry_service_parent_class)->finalize(gobject);
+};
+
+static void desktop_entry_service_class_init(DesktopEntryServiceClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = desktop_entry_service_dispose;
+    object_class->finalize = desktop_entry_service_finalize;
+
+    // emitted once the applications changed, after the indexes were updated.
+    signals[changed] =
+        g_signal_new("changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0,
+                     NULL, NULL, NULL, G_TYPE_NONE, 0);
+};
+
+static void index_add(GHashTable *index, const char *key,
+                      DesktopEntry *entry) {
+    if (!key || *key == '\0' || g_hash_table_contains(index, key)) return;
+    g_hash_table_insert(index, (gpointer)key, entry);
+}
+
+// Rebuilds every index from the cache's entries, this only touches memory and
+// allocates no key.
+static void desktop_entry_service_index(DesktopEntryService *self) {
+    GArray *entries = desktop_entry_cache_get_entries(self->cache);
+
+    g_hash_table_remove_all(self->by_id);
+    g_hash_table_remove_all(self->by_lower_id);
+    g_hash_table_remove_all(self->by_wm_class);
+    g_hash_table_remove_all(self->by_exec);
+    g_hash_table_remove_all(self->lookups);
+
+    for (guint i = 0; i < entries->len; i++) {
+        DesktopEntry *entry = &g_array_index(entries, DesktopEntry, i);
+
+        index_add(self->by_id, entry->id, entry);
+        if (entry->lower_id) {
+            const char *last = strrchr(entry->lower_id, '.');
+            if (last) index_add(self->by_lower_id, last + 1, entry);
+            index_add(self->by_lower_id, entry->lower_id, entry);
+        }
+        index_add(self->by_wm_class, entry->wm_class, entry);
+        index_add(self->by_exec, entry->exec_key, entry);
+    }
+
+    g_debug(
+        "desktop_entry_service.c:desktop_entry_service_index(): entries: %u, "
+        "ids: %u, wm classes: %u, executables: %u",
+        entries->len, g_hash_table_size(self->by_lower_id),
+        g_hash_table_size(self->by_wm_class), g_hash_table_size(self->by_exec));
+}
+
+// Makes `cache` the current one, saves it and lets listeners refresh.
+static void desktop_entry_service_set_cache(DesktopEntryService *self,
+                                            DesktopEntryCache *cache) {
+    DesktopEntryCache *old = self->cache;
+
+    self->cache = cache;
+    self->generation++;
+    desktop_entry_service_index(self);
+    desktop_entry_cache_save(cache);
+
+    // listeners drop their references into the old cache here
+    g_signal_emit(self, signals[changed], 0);
+
+    desktop_entry_cache_free(old);
+}
+
+// Parses every desktop file, safe to call from any thread.
+static DesktopEntryCache *desktop_entry_service_scan(void) {
+    // stamped first, a change during the scan leaves the cache stale
+    GBytes *stamps = desktop_entry_cache_stamp();
+    GPtrArray *app_infos = g_ptr_array_new_with_free_func(g_object_unref);
+
+    GList *apps = g_app_info_get_all();
+    for (GList *l = apps; l; l = l->next) g_ptr_array_add(app_infos, l->data);
+    g_list_free(apps);
+
+    DesktopEntryCache *cache =
+        desktop_entry_cache_new_from_app_infos(app_infos, stamps);
+
+    g_ptr_array_unref(app_infos);
+    g_bytes_unref(stamps);
+    return cache;
+}
+
+static void rebuild_thread(GTask *task, gpointer source, gpointer data,
+                           GCancellable *cancellable) {
+    g_task_return_pointer(task, desktop_entry_service_scan(),
+                          (GDestroyNotify)desktop_entry_cache_free);
+}
+
+static void desktop_entry_service_rebuild(DesktopEntryService *self);
+
+static void on_rebuild_done(GObject *source, GAsyncResult *res,
+                            gpointer data) {
+    GError *error = NULL;
+    DesktopEntryCache *cache = g_task_propagate_pointer(G_TASK(res), &error);
+
+    // the service is going away
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+        g_error_free(error);
+        return;
+    }
+    g_clear_error(&error);
+
+    DesktopEntryService *self = DESKTOP_ENTRY_SERVICE(source);
+    g_clear_object(&self->rebuild);
+
+    if (!cache) {
+        g_warning(
+            "desktop_entry_service.c:on_rebuild_done(): failed to rebuild "
+            "the cache");
+        return;
+    }
+
+    // an update replaced the cache during the scan, which may have read the
+    // directories before that change. Scan again rather than undo it.
+    if (GPOINTER_TO_UINT(data) != self->generation) {
+        g_debug(
+            "desktop_entry_service.c:on_rebuild_done(): cache changed since, "
+            "rebuilding again");
+        desktop_entry_cache_free(cache);
+        desktop_entry_service_rebuild(self);
+        return;
+    }
+
+    g_debug("desktop_entry_service.c:on_rebuild_done(): cache rebuilt");
+
+    desktop_entry_service_set_cache(self, cache);
+}
+
+// Rebuilds the cache on a worker thread, the current one keeps serving
+// lookups meanwhile.
+static void desktop_entry_service_rebuild(DesktopEntryService *self) {
+    if (self->rebuild) return;
+
+    self->rebuild = g_cancellable_new();
+
+    GTask *task = g_task_new(self, self->rebuild, on_rebuild_done,
+                             GUINT_TO_POINTER(self->generation));
+    g_task_set_return_on_cancel(task, TRUE);
+    g_task_run_in_thread(task, rebuild_thread);
+    g_object_unref(task);
+}
+
+static gboolean desktop_entry_service_update(DesktopEntryService *self) {
+    self->update_id = 0;
+
+    // a copy of the current entries with the changed ones replaced, strings
+    // of new entries live in `chunk` until the new cache is built.
+    GArray *current = desktop_entry_cache_get_entries(self->cache);
+    GArray *entries =
+        g_array_sized_new(FALSE, TRUE, sizeof(DesktopEntry), current->len);
+    g_array_append_vals(entries, current->data, current->len);
+
+    GStringChunk *chunk = g_string_chunk_new(1024);
+    GPtrArray *app_infos = g_ptr_array_new_with_free_func(g_object_unref);
+
+    GHashTableIter iter;
+    const char *id = NULL;
+
+    g_hash_table_iter_init(&iter, self->pending);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&id, NULL)) {
+        // resolved by id rather than from the changed file, so the usual
+        // precedence between the XDG directories still applies. GLib's own
+        // monitors have long invalidated its copy of the directories by now.
+        GDesktopAppInfo *info = g_desktop_app_info_new(id);
+
+        guint i = 0;
+        for (; i < entries->len; i++)
+            if (g_strcmp0(g_array_index(entries, DesktopEntry, i).id, id) == 0)
+                break;
+
+        g_debug(
+            "desktop_entry_service.c:desktop_entry_service_update(): %s: %s",
+            id, info ? "updated" : "removed");
+
+        if (!info) {
+            if (i < entries->len) g_array_remove_index(entries, i);
+            continue;
+        }
+
+        g_ptr_array_add(app_infos, info);
+
+        DesktopEntry entry;
+        desktop_entry_init_from_app_info(&entry, G_APP_INFO(info), chunk);
+
+        // replace in place to keep the order stable
+        if (i < entries->len)
+            g_array_index(entries, DesktopEntry, i) = entry;
+        else
+            g_array_append_val(entries, entry);
+    }
+    g_hash_table_remove_all(self->pending);
+
+    // every change seen so far is applied, the directories as they are now
+    // match the new cache.
+    GBytes *stamps = desktop_entry_cache_stamp();
+    DesktopEntryCache *cache =
+        desktop_entry_cache_new_from_entries(entries, stamps);
+
+    g_bytes_unref(stamps);
+    g_ptr_array_unref(app_infos);
+    g_string_chunk_free(chunk);
+    g_array_unref(entries);
+
+    if (cache) desktop_entry_service_set_cache(self, cache);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void queue_update(DesktopEntryService *self, GFile *file) {
+    if (!file) return;
+
+    char *basename = g_file_get_basename(file);
+    if (!g_str_has_suffix(basename, ".desktop")) {
+        g_free(basename);
+        return;
+    }
+    g_hash_table_add(self->pending, basename);
+
+    if (!self->update_id)
+        self->update_id = g_timeout_add(
+            UPDATE_DELAY_MS, (GSourceFunc)desktop_entry_service_update, self);
+}
+
+static void on_applications_dir_changed(GFileMonitor *monitor, GFile *file,
+                                        GFile *other_file,
+                                        GFileMonitorEvent event,
+                                        DesktopEntryService *self) {
+    switch (event) {
+        case G_FILE_MONITOR_EVENT_RENAMED:
+            queue_update(self, other_file);
+            queue_update(self, file);
+            break;
+        case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+        case G_FILE_MONITOR_EVENT_DELETED:
+        case G_FILE_MONITOR_EVENT_CREATED:
+        case G_FILE_MONITOR_EVENT_MOVED_IN:
+        case G_FILE_MONITOR_EVENT_MOVED_OUT:
+            queue_update(self, file);
+            break;
+        default:
+            break;
+    }
+}
+
+static void monitor_applications_dir(DesktopEntryService *self,
+                                     const char *path) {
+    GFile *dir = g_file_new_for_path(path);
+    GError *error = NULL;
+
+    // only the top level is watched, desktop files in subdirectories are
+    // picked up on the next start.
+    GFileMonitor *monitor = g_file_monitor_directory(
+        dir, G_FILE_MONITOR_WATCH_MOVES, NULL, &error);
+    if (!monitor) {
+        g_warning(
+            "desktop_entry_service.c:monitor_applications_dir(): %s: %s", path,
+            error->message);
+        g_error_free(error);
+    } else {
+        g_signal_connect(monitor, "changed",
+                         G_CALLBACK(on_applications_dir_changed), self);
+        g_ptr_array_add(self->monitors, monitor);
+    }
+
+    g_object_unref(dir);
+}
+
+static void desktop_entry_service_init(DesktopEntryService *self) {
+    self->by_id = g_hash_table_new(g_str_hash, g_str_equal);
+    self->by_lower_id = g_hash_table_new(g_str_hash, g_str_equal);
+    self->by_wm_class = g_hash_table_new(g_str_hash, g_str_equal);
+    self->by_exec = g_hash_table_new(g_str_hash, g_str_equal);
+    self->lookups =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    self->pending =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+    self->monitors = g_ptr_array_new_with_free_func(g_object_unref);
+
+    self->cache = desktop_entry_cache_open();
+
+    if (!self->cache) {
+        // the first start, there is nothing to show until every desktop file
+        // was parsed once.
+        self->cache = desktop_entry_service_scan();
+        desktop_entry_cache_save(self->cache);
+    } else {
+        GBytes *stamps = desktop_entry_cache_stamp();
+        gboolean stale =
+            !g_bytes_equal(stamps, desktop_entry_cache_get_stamps(self->cache));
+        g_bytes_unref(stamps);
+
+        g_debug("desktop_entry_service.c:desktop_entry_service_init(): "
+                "stale: %d",
+                stale);
+        if (stale) desktop_entry_service_rebuild(self);
+    }
+
+    desktop_entry_service_index(self);
+
+    GPtrArray *dirs = desktop_entry_cache_dirs();
+    for (guint i = 0; i < dirs->len; i++)
+        monitor_applications_dir(self, g_ptr_array_index(dirs, i));
+    g_ptr_array_unref(dirs);
+};
+
+int desktop_entry_service_global_init(void) {
+    g_debug(
+        "desktop_entry_service.c:desktop_entry_service_global_init(): "
+        "initializing global service.");
+
+    global = g_object_new(DESKTOP_ENTRY_SERVICE_TYPE, NULL);
+    return 0;
+}
+
+DesktopEntryService *desktop_entry_service_get_global() { return global; }
+
+GArray *desktop_entry_service_get_entries(DesktopEntryService *self) {
+    return desktop_entry_cache_get_entries(self->cache);
+}
+
+static DesktopEntry *desktop_entry_service_resolve(DesktopEntryService *self,
+                                                   const char *app_id) {
+    DesktopEntry *entry = g_hash_table_lookup(self->by_id, app_id);
+    if (entry) return entry;
+
+    char *lower = g_utf8_strdown(app_id, -1);
+    if (g_str_has_suffix(lower, ".desktop"))
+        lower[strlen(lower) - strlen(".desktop")] = '\0';
+
+    entry = g_hash_table_lookup(self->by_lower_id, lower);
+    if (!entry) entry = g_hash_table_lookup(self->by_wm_class, lower);
+    if (!entry) entry = g_hash_table_lookup(self->by_exec, lower);
+
+    // the substring match every caller used to do on its own, only reached
+    // on a miss and memoized by the caller.
+    GArray *entries = desktop_entry_cache_get_entries(self->cache);
+    for (guint i = 0; !entry && i < entries->len; i++) {
+        DesktopEntry *candidate = &g_array_index(entries, DesktopEntry, i);
+        if (candidate->lower_id && g_strrstr(candidate->lower_id, lower))
+            entry = candidate;
+    }
+
+    g_free(lower);
+    return entry;
+}
+
+DesktopEntry *desktop_entry_service_lookup_entry(DesktopEntryService *self,
+                                                 const char *app_id) {
+    if (!app_id || *app_id == '\0') return NULL;
+
+    DesktopEntry *entry = NULL;
+    if (g_hash_table_lookup_extended(self->lookups, app_id, NULL,
+                                     (gpointer *)&entry))
+        return entry;
+
+    entry = desktop_entry_service_resolve(self, app_id);
+    g_hash_table_insert(self->lookups, g_strdup(app_id), entry);
+
+    g_debug(
+        "desktop_entry_service.c:desktop_entry_service_lookup_entry(): %s: %s",
+        app_id, entry ? entry->id : "no match");
+
+    return entry;
+}
+
+GAppInfo *desktop_entry_service_lookup(DesktopEntryService *self,
+                                       const char *app_id) {
+    DesktopEntry *entry = desktop_entry_service_lookup_entry(self, app_id);
+    return entry ? desktop_entry_get_app_info(entry) : NULL;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <adwaita.h>
+
+#include "desktop_entry_cache.h"
+
+G_BEGIN_DECLS
+
+struct _DesktopEntryService;
+#define DESKTOP_ENTRY_SERVICE_TYPE desktop_entry_service_get_type()
+G_DECLARE_FINAL_TYPE(DesktopEntryService, desktop_entry_service, DESKTOP_ENTRY,
+                     SERVICE, GObject);
+
+G_END_DECLS
+
+int desktop_entry_service_global_init(void);
+
+// Get the global desktop entry service
+// Will return NULL if `desktop_entry_service_global_init` has not been called.
+DesktopEntryService *desktop_entry_service_get_global();
+
+// Returns every installed application as a DesktopEntry array, in the order
+// g_app_info_get_all() reported them.
+// The array is owned by the service and valid until the next "changed"
+// signal.
+GArray *desktop_entry_service_get_entries(DesktopEntryService *self);
+
+// Resolves an app id, as reported by a toplevel, a notification or an audio
+// stream, to its entry.
+// Tries the desktop id, the lowercased id and its last reverse DNS component,
+// StartupWMClass and the executable's basename, in that order, before falling
+// back to a substring match on the desktop id.
+// Returns NULL if nothing matches, the entry is owned by the service and valid
+// until the next "changed" signal.
+DesktopEntry *desktop_entry_service_lookup_entry(DesktopEntryService *self,
+                                                 const char *app_id);
+
+// Like desktop_entry_service_lookup_entry but returns the entry's GAppInfo,
+// parsing its desktop file on first use.
+GAppInfo *desktop_entry_service_lookup(DesktopEntryService *self,
+                                       const char *app_id);
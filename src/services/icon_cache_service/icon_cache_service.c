@@ -0,0 +1,178 @@
+#include "icon_cache_service.h"
+
+#include <adwaita.h>
+
+#include "../desktop_entry_service/desktop_entry_service.h"
+
+// Bytes the cached paintables may take, estimated as their RGBA texture.
+// Enough for a few hundred application icons at the sizes the shell uses.
+#define ICON_CACHE_BUDGET (16 * 1024 * 1024)
+
+static IconCacheService *global = NULL;
+
+typedef struct _IconCacheEntry {
+    // "size@scale:icon"
+    char *key;
+    GdkPaintable *paintable;
+    gsize bytes;
+} IconCacheEntry;
+
+struct _IconCacheService {
+    GObject parent_instance;
+    GtkIconTheme *theme;
+    // IconCacheEntry structs, the most recently used at the head
+    GQueue lru;
+    // links of `lru` keyed by the entry's key
+    GHashTable *entries;
+    gsize bytes;
+    guint64 hits;
+    guint64 misses;
+    guint64 evictions;
+};
+G_DEFINE_TYPE(IconCacheService, icon_cache_service, G_TYPE_OBJECT);
+
+static void icon_cache_entry_free(IconCacheEntry *entry) {
+    g_object_unref(entry->paintable);
+    g_free(entry->key);
+    g_free(entry);
+}
+
+static void icon_cache_service_clear(IconCacheService *self) {
+    g_hash_table_remove_all(self->entries);
+    g_queue_clear_full(&self->lru, (GDestroyNotify)icon_cache_entry_free);
+    self->bytes = 0;
+}
+
+// Stub out GObject's dispose, finalize, class_init, and init methods
+static void icon_cache_service_dispose(GObject *gobject) {
+    IconCacheService *self = ICON_CACHE_SERVICE(gobject);
+
+    if (self->theme) {
+        g_signal_handlers_disconnect_by_data(self->theme, self);
+        g_clear_object(&self->theme);
+    }
+
+    // Chain-up
+    G_OBJECT_CLASS(icon_cache_service_parent_class)->dispose(gobject);
+};
+
+static void icon_cache_service_finalize(GObject *gobject) {
+    IconCacheService *self = ICON_CACHE_SERVICE(gobject);
+
+    icon_cache_service_clear(self);
+    g_hash_table_unref(self->entries);
+
+    // Chain-up
+    G_OBJECT_CLASS(icon_cache_service_parent_class)->finalize(gobject);
+};
+
+static void icon_cache_service_class_init(IconCacheServiceClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = icon_cache_service_dispose;
+    object_class->finalize = icon_cache_service_finalize;
+};
+
+static void on_icon_theme_changed(GtkIconTheme *theme,
+                                  IconCacheService *self) {
+    g_debug(
+        "icon_cache_service.c:on_icon_theme_changed(): dropping %u icons, "
+        "hits: %" G_GUINT64_FORMAT ", misses: %" G_GUINT64_FORMAT
+        ", evictions: %" G_GUINT64_FORMAT,
+        g_queue_get_length(&self->lru), self->hits, self->misses,
+        self->evictions);
+
+    // widgets showing an icon keep their own reference, they pick up the new
+    // theme the next time they look it up.
+    icon_cache_service_clear(self);
+}
+
+static void icon_cache_service_init(IconCacheService *self) {
+    g_queue_init(&self->lru);
+    self->entries = g_hash_table_new(g_str_hash, g_str_equal);
+
+    self->theme = g_object_ref(
+        gtk_icon_theme_get_for_display(gdk_display_get_default()));
+    g_signal_connect(self->theme, "changed",
+                     G_CALLBACK(on_icon_theme_changed), self);
+};
+
+int icon_cache_service_global_init(void) {
+    g_debug(
+        "icon_cache_service.c:icon_cache_service_global_init(): "
+        "initializing global service.");
+
+    global = g_object_new(ICON_CACHE_SERVICE_TYPE, NULL);
+    return 0;
+}
+
+IconCacheService *icon_cache_service_get_global() { return global; }
+
+// Drops the least recently used icons until the cache fits its budget, the
+// icon just added always stays.
+static void icon_cache_service_evict(IconCacheService *self) {
+    while (self->bytes > ICON_CACHE_BUDGET &&
+           g_queue_get_length(&self->lru) > 1) {
+        IconCacheEntry *entry = g_queue_pop_tail(&self->lru);
+        g_hash_table_remove(self->entries, entry->key);
+        self->bytes -= entry->bytes;
+        self->evictions++;
+        icon_cache_entry_free(entry);
+    }
+}
+
+GdkPaintable *icon_cache_service_lookup(IconCacheService *self,
+                                        const char *icon, int size,
+                                        int scale) {
+    if (!icon) return NULL;
+
+    char *key = g_strdup_printf("%d@%d:%s", size, scale, icon);
+
+    GList *link = g_hash_table_lookup(self->entries, key);
+    if (link) {
+        self->hits++;
+        g_free(key);
+        g_queue_unlink(&self->lru, link);
+        g_queue_push_head_link(&self->lru, link);
+        return g_object_ref(((IconCacheEntry *)link->data)->paintable);
+    }
+
+    self->misses++;
+
+    GIcon *gicon = g_icon_new_for_string(icon, NULL);
+    if (!gicon) {
+        g_free(key);
+        return NULL;
+    }
+
+    GtkIconPaintable *paintable = gtk_icon_theme_lookup_by_gicon(
+        self->theme, gicon, size, scale, GTK_TEXT_DIR_RTL, 0);
+    g_object_unref(gicon);
+
+    IconCacheEntry *entry = g_new0(IconCacheEntry, 1);
+    entry->key = key;
+    entry->paintable = GDK_PAINTABLE(paintable);
+    entry->bytes = (gsize)size * scale * size * scale * 4;
+
+    g_queue_push_head(&self->lru, entry);
+    g_hash_table_insert(self->entries, entry->key, self->lru.head);
+    self->bytes += entry->bytes;
+
+    g_debug(
+        "icon_cache_service.c:icon_cache_service_lookup(): miss: %s, hits: "
+        "%" G_GUINT64_FORMAT ", misses: %" G_GUINT64_FORMAT ", bytes: %zu",
+        entry->key, self->hits, self->misses, self->bytes);
+
+    icon_cache_service_evict(self);
+
+    return g_object_ref(entry->paintable);
+}
+
+GdkPaintable *icon_cache_service_lookup_app(IconCacheService *self,
+                                            const char *app_id, int size,
+                                            int scale) {
+    DesktopEntry *entry = desktop_entry_service_lookup_entry(
+        desktop_entry_service_get_global(), app_id);
+    if (!entry) return NULL;
+
+    return icon_cache_service_lookup(self, entry->icon, size, scale);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <adwaita.h>
+
+G_BEGIN_DECLS
+
+// Process wide cache of icon paintables keyed by (icon, size, scale).
+// Every component asking for the same icon at the same size shares one
+// GtkIconPaintable and so one GdkTexture, the icon theme is only consulted on
+// a miss.
+// Paintables are kept within a byte budget, least recently used first out,
+// and all dropped when the icon theme changes.
+struct _IconCacheService;
+#define ICON_CACHE_SERVICE_TYPE icon_cache_service_get_type()
+G_DECLARE_FINAL_TYPE(IconCacheService, icon_cache_service, ICON_CACHE, SERVICE,
+                     GObject);
+
+G_END_DECLS
+
+int icon_cache_service_global_init(void);
+
+// Get the global icon cache service
+// Will return NULL if `icon_cache_service_global_init` has not been called.
+IconCacheService *icon_cache_service_get_global();
+
+// Returns the paintable of `icon`, a GIcon serialized by g_icon_to_string, at
+// `size` pixels for `scale`.
+// Returns NULL if `icon` is NULL or cannot be parsed, the caller owns the
+// returned reference.
+GdkPaintable *icon_cache_service_lookup(IconCacheService *self,
+                                        const char *icon, int size, int scale);
+
+// Returns the icon of the application `app_id` resolves to, see
+// desktop_entry_service_lookup_entry, as icon_cache_service_lookup does.
+GdkPaintable *icon_cache_service_lookup_app(IconCacheService *self,
+                                            const char *app_id, int size,
+                                            int scale);
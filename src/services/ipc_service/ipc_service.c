@@ -518,239 +518,361 @@ static gboolean ipc_command_keyboard_brightness_down() {
     return true;
 }
 
-static gboolean on_ipc_readable(gint fd, GIOCondition condition,
-                                gpointer user_data) {
-    uint8_t buff[4096];
+// Runs the handler for the command described by `hdr`.
+// `handled` is set to false if the command is unknown.
+static gboolean ipc_service_dispatch(IPCHeader *hdr, gboolean *handled) {
     gboolean ret = false;
-    struct sockaddr_un saddr = {0};
-    socklen_t size = sizeof(struct sockaddr_un);
 
-    g_debug("ipc_service.c:on_ipc_readable() received IPC message");
-
-    if (recvfrom(fd, buff, sizeof(buff), 0, (struct sockaddr *)&saddr, &size) ==
-        -1) {
-        g_critical("ipc_service.c:on_ipc_readable() failed to recvfrom()");
-        return true;
-    }
-
-    // client is an abstract unix socket, debug the client socket's path
-    g_debug("ipc_service.c:on_ipc_readable() received IPC message from %s",
-            &saddr.sun_path[1]);
-    ret = false;
-
-    IPCHeader *hdr = (IPCHeader *)&buff;
+    *handled = true;
 
     switch (hdr->type) {
         case IPC_CMD_MESSAGE_TRAY_OPEN:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_MESSAGE_TRAY_OPEN");
             ret = ipc_cmd_message_tray_open();
             break;
         case IPC_CMD_VOLUME_UP:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_VOLUME_UP");
             ret = ipc_cmd_volume_up();
             break;
         case IPC_CMD_VOLUME_DOWN:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_VOLUME_DOWN");
             ret = ipc_cmd_volume_down();
             break;
         case IPC_CMD_VOLUME_SET:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_VOLUME_SET");
             ret = ipc_cmd_volume_set((IPCVolumeSet *)hdr);
             break;
         case IPC_CMD_VOLUME_MUTE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_VOLUME_MUTE");
             ret = ipc_cmd_volume_mute((IPCVolumeMute *)hdr);
             break;
         case IPC_CMD_BRIGHTNESS_UP:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_BRIGHTNESS_UP");
             ret = ipc_cmd_brightness_up();
             break;
         case IPC_CMD_BRIGHTNESS_DOWN:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_BRIGHTNESS_DOWN");
             ret = ipc_cmd_brightness_down();
             break;
         case IPC_CMD_THEME_DARK:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_THEME_DARK");
             ret = ipc_cmd_theme_dark();
             break;
         case IPC_CMD_THEME_LIGHT:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_THEME_LIGHT");
             ret = ipc_cmd_theme_light();
             break;
         case IPC_CMD_DUMP_DARK_THEME:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_DUMP_DARK_THEME");
             ret = ipc_cmd_dump_dark_theme();
             break;
         case IPC_CMD_DUMP_LIGHT_THEME:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_DUMP_LIGHT_THEME");
             ret = ipc_cmd_dump_light_theme();
             break;
         case IPC_CMD_ACTIVITIES_SHOW:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_ACTIVITIES_SHOW");
             ret = ip_cmd_activities_show();
             break;
         case IPC_CMD_ACTIVITIES_HIDE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_ACTIVITIES_HIDE");
             ret = ip_cmd_activities_hide();
             break;
         case IPC_CMD_ACTIVITIES_TOGGLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_ACTIVITIES_TOGGLE");
             ret = ip_cmd_activities_toggle();
             break;
         case IPC_CMD_APP_SWITCHER_SHOW:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_APP_SWITCHER_SHOW");
             ret = ip_cmd_app_switcher_show();
             break;
         case IPC_CMD_APP_SWITCHER_HIDE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_APP_SWITCHER_HIDE");
             ret = ip_cmd_app_switcher_hide();
             break;
         case IPC_CMD_APP_SWITCHER_TOGGLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_APP_SWITCHER_TOGGLE");
             ret = ip_cmd_app_switcher_toggle();
             break;
         case IPC_CMD_WORKSPACE_SWITCHER_SHOW:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_SWITCHER_SHOW");
             ret = ip_cmd_workspace_switcher_show();
             break;
         case IPC_CMD_WORKSPACE_SWITCHER_HIDE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_SWITCHER_HIDE");
             ret = ip_cmd_workspace_switcher_hide();
             break;
         case IPC_CMD_WORKSPACE_SWITCHER_TOGGLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_SWITCHER_TOGGLE");
             ret = ip_cmd_workspace_switcher_toggle();
             break;
         case IPC_CMD_OUTPUT_SWITCHER_SHOW:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_OUTPUT_SWITCHER_SHOW");
             ret = ip_cmd_output_switcher_show();
             break;
         case IPC_CMD_OUTPUT_SWITCHER_HIDE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_OUTPUT_SWITCHER_HIDE");
             ret = ip_cmd_output_switcher_hide();
             break;
         case IPC_CMD_OUTPUT_SWITCHER_TOGGLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_OUTPUT_SWITCHER_TOGGLE");
             ret = ip_cmd_output_switcher_toggle();
             break;
         case IPC_CMD_WORKSPACE_APP_SWITCHER_SHOW:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_APP_SWITCHER_SHOW");
             ret = ip_cmd_workspace_app_switcher_show();
             break;
         case IPC_CMD_WORKSPACE_APP_SWITCHER_HIDE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_APP_SWITCHER_HIDE");
             ret = ip_cmd_workspace_app_switcher_hide();
             break;
         case IPC_CMD_WORKSPACE_APP_SWITCHER_TOGGLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_WORKSPACE_APP_SWITCHER_TOGGLE");
             ret = ip_cmd_workspace_app_switcher_toggle();
             break;
         case IPC_CMD_BLUELIGHT_FILTER_ENABLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_BLUELIGHT_FILTER_ENABLE");
             ret = ipc_command_bluelight_filter_enable();
             break;
         case IPC_CMD_BLUELIGHT_FILTER_DISABLE:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_BLUELIGHT_FILTER_DISABLE");
             ret = ipc_command_bluelight_filter_disable();
             break;
         case IPC_CMD_KEYBOARD_BRIGHTNESS_UP:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_KEYBOARD_BRIGHTNESS_UP");
             ret = ipc_command_keyboard_brightness_up();
             break;
         case IPC_CMD_KEYBOARD_BRIGHTNESS_DOWN:
             g_debug(
-                "ipc_service.c:on_ipc_readable() received "
+                "ipc_service.c:ipc_service_dispatch() received "
                 "IPC_CMD_KEYBOARD_BRIGHTNESS_DOWN");
             ret = ipc_command_keyboard_brightness_down();
             break;
 		case IPC_CMD_RENAME_SWITCHER_SHOW:
 			g_debug(
-				"ipc_service.c:on_ipc_readable() received "
+				"ipc_service.c:ipc_service_dispatch() received "
 				"IPC_CMD_RENAME_SWITCHER_SHOW");
 			ret = ip_cmd_rename_switcher_show();
 			break;
 		case IPC_CMD_RENAME_SWITCHER_HIDE:
 			g_debug(
-				"ipc_service.c:on_ipc_readable() received "
+				"ipc_service.c:ipc_service_dispatch() received "
 				"IPC_CMD_RENAME_SWITCHER_HIDE");
 			ret = ip_cmd_rename_switcher_hide();
 			break;
 		case IPC_CMD_RENAME_SWITCHER_TOGGLE:
 			g_debug(
-				"ipc_service.c:on_ipc_readable() received "
+				"ipc_service.c:ipc_service_dispatch() received "
 				"IPC_CMD_RENAME_SWITCHER_TOGGLE");
 			ret = ip_cmd_rename_switcher_toggle();
 			break;
         default:
-            goto skip_resp;
+            *handled = false;
             break;
     }
 
+    return ret;
+}
+
+static gboolean on_ipc_readable(gint fd, GIOCondition condition,
+                                gpointer user_data) {
+    uint8_t buff[4096];
+    gboolean ret = false;
+    struct sockaddr_un saddr = {0};
+    socklen_t size = sizeof(struct sockaddr_un);
+
+    g_debug("ipc_service.c:on_ipc_readable() received IPC message");
+
+    if (recvfrom(fd, buff, sizeof(buff), 0, (struct sockaddr *)&saddr, &size) ==
+        -1) {
+        g_critical("ipc_service.c:on_ipc_readable() failed to recvfrom()");
+        return true;
+    }
+
+    // client is an abstract unix socket, debug the client socket's path
+    g_debug("ipc_service.c:on_ipc_readable() received IPC message from %s",
+            &saddr.sun_path[1]);
+    ret = false;
+
+    IPCHeader *hdr = (IPCHeader *)&buff;
+    gboolean handled = false;
+
+    ret = ipc_service_dispatch(hdr, &handled);
+    if (!handled) return true;
+
     // set ret as a response back to client, its a simple one byte boolean.
     sendto(fd, &ret, sizeof(ret), 0, (struct sockaddr *)&saddr, size);
 
-skip_resp:
     return true;
 }
 
+// Maps `way-sh` style command lines onto IPC commands.
+typedef struct _IPCCommandName {
+    const gchar *cmd;
+    const gchar *subcmd;
+    enum IPCCommands type;
+} IPCCommandName;
+
+static const IPCCommandName ipc_command_names[] = {
+    {"message-tray", "open", IPC_CMD_MESSAGE_TRAY_OPEN},
+    {"volume", "up", IPC_CMD_VOLUME_UP},
+    {"volume", "down", IPC_CMD_VOLUME_DOWN},
+    {"volume", "set", IPC_CMD_VOLUME_SET},
+    {"volume", "mute", IPC_CMD_VOLUME_MUTE},
+    {"brightness", "up", IPC_CMD_BRIGHTNESS_UP},
+    {"brightness", "down", IPC_CMD_BRIGHTNESS_DOWN},
+    {"brightness", "keyboard-up", IPC_CMD_KEYBOARD_BRIGHTNESS_UP},
+    {"brightness", "keyboard-down", IPC_CMD_KEYBOARD_BRIGHTNESS_DOWN},
+    {"theme", "dark", IPC_CMD_THEME_DARK},
+    {"theme", "light", IPC_CMD_THEME_LIGHT},
+    {"theme", "dump-dark", IPC_CMD_DUMP_DARK_THEME},
+    {"theme", "dump-light", IPC_CMD_DUMP_LIGHT_THEME},
+    {"activities", "show", IPC_CMD_ACTIVITIES_SHOW},
+    {"activities", "hide", IPC_CMD_ACTIVITIES_HIDE},
+    {"activities", "toggle", IPC_CMD_ACTIVITIES_TOGGLE},
+    {"app-switcher", "show", IPC_CMD_APP_SWITCHER_SHOW},
+    {"app-switcher", "hide", IPC_CMD_APP_SWITCHER_HIDE},
+    {"app-switcher", "toggle", IPC_CMD_APP_SWITCHER_TOGGLE},
+    {"workspace-switcher", "show", IPC_CMD_WORKSPACE_SWITCHER_SHOW},
+    {"workspace-switcher", "hide", IPC_CMD_WORKSPACE_SWITCHER_HIDE},
+    {"workspace-switcher", "toggle", IPC_CMD_WORKSPACE_SWITCHER_TOGGLE},
+    {"output-switcher", "show", IPC_CMD_OUTPUT_SWITCHER_SHOW},
+    {"output-switcher", "hide", IPC_CMD_OUTPUT_SWITCHER_HIDE},
+    {"output-switcher", "toggle", IPC_CMD_OUTPUT_SWITCHER_TOGGLE},
+    {"workspace-app-switcher", "show", IPC_CMD_WORKSPACE_APP_SWITCHER_SHOW},
+    {"workspace-app-switcher", "hide", IPC_CMD_WORKSPACE_APP_SWITCHER_HIDE},
+    {"workspace-app-switcher", "toggle",
+     IPC_CMD_WORKSPACE_APP_SWITCHER_TOGGLE},
+    {"bluelight-filter", "enable", IPC_CMD_BLUELIGHT_FILTER_ENABLE},
+    {"bluelight-filter", "disable", IPC_CMD_BLUELIGHT_FILTER_DISABLE},
+    {"rename-switcher", "show", IPC_CMD_RENAME_SWITCHER_SHOW},
+    {"rename-switcher", "hide", IPC_CMD_RENAME_SWITCHER_HIDE},
+    {"rename-switcher", "toggle", IPC_CMD_RENAME_SWITCHER_TOGGLE},
+};
+
+gboolean ipc_service_exec_command(const gchar *command) {
+    gchar **argv = NULL;
+    gchar *args[3] = {0};
+    guint argc = 0;
+    gboolean handled = false;
+    gboolean known = false;
+    gboolean ret = false;
+
+    g_debug("ipc_service.c:ipc_service_exec_command() command: %s", command);
+
+    // split on whitespace, ignoring repeated separators.
+    argv = g_strsplit_set(command, " \t", -1);
+    for (guint i = 0; argv[i] && argc < G_N_ELEMENTS(args); i++) {
+        if (*argv[i] == '\0') continue;
+        args[argc++] = argv[i];
+    }
+
+    if (argc < 2) goto done;
+
+    for (guint i = 0; i < G_N_ELEMENTS(ipc_command_names); i++) {
+        const IPCCommandName *name = &ipc_command_names[i];
+
+        if (g_strcmp0(name->cmd, args[0]) != 0 ||
+            g_strcmp0(name->subcmd, args[1]) != 0)
+            continue;
+
+        known = true;
+
+        if (name->type == IPC_CMD_VOLUME_SET) {
+            IPCVolumeSet msg = {.header = {.type = name->type}};
+            gchar *end = NULL;
+
+            if (argc < 3) {
+                g_warning(
+                    "ipc_service.c:ipc_service_exec_command() %s %s: missing "
+                    "volume, expected a value from 0.0 to 1.0",
+                    args[0], args[1]);
+                break;
+            }
+            msg.volume = g_ascii_strtod(args[2], &end);
+            if (end == args[2] || *end != '\0' || !(msg.volume >= 0.0) ||
+                msg.volume > 1.0) {
+                g_warning(
+                    "ipc_service.c:ipc_service_exec_command() %s %s: invalid "
+                    "volume '%s', expected a value from 0.0 to 1.0",
+                    args[0], args[1], args[2]);
+                break;
+            }
+            ret = ipc_service_dispatch(&msg.header, &handled);
+        } else {
+            IPCHeader hdr = {.type = name->type};
+            ret = ipc_service_dispatch(&hdr, &handled);
+        }
+        break;
+    }
+
+done:
+    // known commands which were not dispatched already reported why.
+    if (!known)
+        g_warning("ipc_service.c:ipc_service_exec_command() unknown command: %s",
+                  command);
+    g_strfreev(argv);
+    return ret;
+}
+
 static int ipc_service_setup_ipc_sock(IPCService *self) {
     g_debug("ipc_service.c:ipc_service_setup_ipc_sock() called");
 
@@ -19,3 +19,10 @@ int ipc_service_global_init(void);
 // Get the global ipc service
 // Will return NULL if `ipc_service_global_init` has not been called.
 IPCService *ipc_service_get_global();
+
+// Runs a command in-process, skipping the IPC socket entirely.
+//
+// `command` uses the same syntax as the `way-sh` CLI without the program
+// name, for example "volume up" or "volume set 0.5".
+// Returns the command handler's result, or false if the command is unknown.
+gboolean ipc_service_exec_command(const gchar *command);
@@ -1,17 +1,23 @@
 #include <math.h>
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/cdefs.h>
 #include <unistd.h>
 
-/* All credit for the below code goes to the gammastep application
+/* All credit for the blackbody table below goes to the gammastep application
    https://gitlab.com/chinstrap/gammastep
-   The F macro is slightly modified from its original value:
 
-   #define F(Y, C)  pow((Y) * setting->brightness
-            white_point[C], 1.0/setting->gamma[C])
+   gammastep computes each ramp entry as
 
-   to simplify our needs, we do not allow adjmust of brightness or
-   gamma in our calculation for internal bluelight filtering */
+   pow((Y) * setting->brightness * white_point[C], 1.0/setting->gamma[C])
+
+   which splits into pow(Y, 1/gamma) * pow(brightness * white_point[C],
+   1/gamma), a curve depending only on the ramp size and gamma, scaled by a
+   constant per channel. colorramp_fill_profile computes that in fixed point,
+   with gamma and brightness at 1.0 the curve is the identity ramp.
+   colorramp_fill_calibrated takes a display's calibration curves as Y, the
+   same way gammastep scales the ramps it found on the display. */
 
 /* Whitepoint values for temperatures at 100K intervals.
    These will be interpolated for the actual temperature.
@@ -175,23 +181,232 @@ static void interpolate_color(float a, const float *c1, const float *c2,
     c[2] = (1.0 - a) * c1[2] + a * c2[2];
 }
 
-#define F(Y, C) pow((Y) * 1.0 * white_point[C], 1.0 / 1.0)
+// White point multipliers in Q16 fixed point for every COLORRAMP_LUT_STEP
+// Kelvin between COLORRAMP_LUT_MIN and COLORRAMP_LUT_MAX, interpolated from
+// blackbody_color once on first use.
+//
+// A multiplier of 1.0 is stored as COLORRAMP_LUT_ONE and copies the identity
+// ramp unchanged.
+#define COLORRAMP_LUT_MIN 1000
+#define COLORRAMP_LUT_MAX 25000
+#define COLORRAMP_LUT_STEP 10
+#define COLORRAMP_LUT_LEN \
+    ((COLORRAMP_LUT_MAX - COLORRAMP_LUT_MIN) / COLORRAMP_LUT_STEP + 1)
+#define COLORRAMP_LUT_ONE UINT16_MAX
 
-void colorramp_fill(uint16_t *gamma_r, uint16_t *gamma_g, uint16_t *gamma_b,
-                    int size, int temperature) {
-    /* Approximate white point */
-    float white_point[3];
-    float alpha = (temperature % 100) / 100.0;
-    int temp_index = ((temperature - 1000) / 100) * 3;
-    interpolate_color(alpha, &blackbody_color[temp_index],
-                      &blackbody_color[temp_index + 3], white_point);
+static uint16_t colorramp_lut[COLORRAMP_LUT_LEN * 3];
+static int colorramp_lut_ready = 0;
+
+// Curves pow(Y, 1/gamma) of recently requested ramp sizes and gammas, shared
+// by every output using that combination.
+#define COLORRAMP_CURVES 4
+
+typedef struct _ColorrampCurve {
+    int size;
+    double gamma;
+    uint16_t *ramp;
+} ColorrampCurve;
+
+static ColorrampCurve colorramp_curves[COLORRAMP_CURVES];
+static int colorramp_curves_next = 0;
+
+static void colorramp_lut_init(void) {
+    for (int i = 0; i < COLORRAMP_LUT_LEN; i++) {
+        int temperature = COLORRAMP_LUT_MIN + i * COLORRAMP_LUT_STEP;
+        float alpha = (temperature % 100) / 100.0;
+        int temp_index = ((temperature - 1000) / 100) * 3;
+        float white_point[3];
+
+        interpolate_color(alpha, &blackbody_color[temp_index],
+                          &blackbody_color[temp_index + 3], white_point);
+
+        for (int c = 0; c < 3; c++) {
+            long m = lround(white_point[c] * (UINT16_MAX + 1));
+            colorramp_lut[i * 3 + c] =
+                m >= COLORRAMP_LUT_ONE ? COLORRAMP_LUT_ONE : m;
+        }
+    }
+    colorramp_lut_ready = 1;
+}
+
+// Returns the multiplier `m` stands for, COLORRAMP_LUT_ONE being 1.0.
+static uint32_t colorramp_q16(uint16_t m) {
+    return m == COLORRAMP_LUT_ONE ? UINT16_MAX + 1 : m;
+}
+
+// Writes the Q16 white point multipliers of `temperature` to `white_point`,
+// interpolated between the buckets on either side of it.
+// Buckets evenly divide the 100K steps of blackbody_color, so this follows
+// the table's own interpolation up to the rounding of the buckets.
+static void colorramp_white_point(int temperature, uint16_t white_point[3]) {
+    if (!colorramp_lut_ready) colorramp_lut_init();
+
+    if (temperature < COLORRAMP_LUT_MIN) temperature = COLORRAMP_LUT_MIN;
+    if (temperature > COLORRAMP_LUT_MAX) temperature = COLORRAMP_LUT_MAX;
+
+    int offset = temperature - COLORRAMP_LUT_MIN;
+    int frac = offset % COLORRAMP_LUT_STEP;
+    const uint16_t *lo = &colorramp_lut[offset / COLORRAMP_LUT_STEP * 3];
+
+    for (int c = 0; c < 3; c++) {
+        if (!frac) {
+            white_point[c] = lo[c];
+            continue;
+        }
+
+        uint32_t m = (colorramp_q16(lo[c]) * (COLORRAMP_LUT_STEP - frac) +
+                      colorramp_q16(lo[c + 3]) * frac +
+                      COLORRAMP_LUT_STEP / 2) /
+                     COLORRAMP_LUT_STEP;
+        white_point[c] = m >= COLORRAMP_LUT_ONE ? COLORRAMP_LUT_ONE : m;
+    }
+}
+
+static const uint16_t *colorramp_curve_get(int size, double gamma) {
+    for (int i = 0; i < COLORRAMP_CURVES; i++) {
+        ColorrampCurve *curve = &colorramp_curves[i];
+        if (curve->ramp && curve->size == size && curve->gamma == gamma)
+            return curve->ramp;
+    }
+
+    // replace the oldest curve
+    ColorrampCurve *curve = &colorramp_curves[colorramp_curves_next];
+    colorramp_curves_next = (colorramp_curves_next + 1) % COLORRAMP_CURVES;
+
+    free(curve->ramp);
+    curve->ramp = malloc(size * sizeof(uint16_t));
+    curve->size = size;
+    curve->gamma = gamma;
 
     for (int i = 0; i < size; i++) {
-        gamma_r[i] =
-            F((double)gamma_r[i] / (UINT16_MAX + 1), 0) * (UINT16_MAX + 1);
-        gamma_g[i] =
-            F((double)gamma_g[i] / (UINT16_MAX + 1), 1) * (UINT16_MAX + 1);
-        gamma_b[i] =
-            F((double)gamma_b[i] / (UINT16_MAX + 1), 2) * (UINT16_MAX + 1);
+        if (gamma == 1.0) {
+            curve->ramp[i] = ((uint32_t)i << 16) / size;
+            continue;
+        }
+        long v = lround(pow((double)i / size, 1.0 / gamma) * (UINT16_MAX + 1));
+        curve->ramp[i] = v > UINT16_MAX ? UINT16_MAX : v;
+    }
+
+    return curve->ramp;
+}
+
+// Ramp kernels, each computes out[i] = (in[i] * m) >> 16 for a Q16 `m`.
+
+static void colorramp_scale_scalar(uint16_t *out, const uint16_t *in, int size,
+                                   uint16_t m) {
+    for (int i = 0; i < size; i++) out[i] = ((uint32_t)in[i] * m) >> 16;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+#ifdef __SSE2__
+static void colorramp_scale_sse2(uint16_t *out, const uint16_t *in, int size,
+                                 uint16_t m) {
+    __m128i vm = _mm_set1_epi16((short)m);
+    int i = 0;
+
+    for (; i + 8 <= size; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_si128((__m128i *)(out + i), _mm_mulhi_epu16(v, vm));
+    }
+    colorramp_scale_scalar(out + i, in + i, size - i, m);
+}
+#endif
+
+__attribute__((target("avx2"))) static void colorramp_scale_avx2(
+    uint16_t *out, const uint16_t *in, int size, uint16_t m) {
+    __m256i vm = _mm256_set1_epi16((short)m);
+    int i = 0;
+
+    for (; i + 16 <= size; i += 16) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_mulhi_epu16(v, vm));
     }
+    colorramp_scale_scalar(out + i, in + i, size - i, m);
+}
+#endif
+
+typedef void (*colorramp_scale_func)(uint16_t *out, const uint16_t *in,
+                                     int size, uint16_t m);
+
+// Picks the widest kernel the CPU supports, once.
+static colorramp_scale_func colorramp_scale_kernel(void) {
+    static colorramp_scale_func kernel = NULL;
+
+    if (kernel) return kernel;
+
+    kernel = colorramp_scale_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+#ifdef __SSE2__
+    kernel = colorramp_scale_sse2;
+#endif
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) kernel = colorramp_scale_avx2;
+#endif
+    return kernel;
+}
+
+// Scales `curves`, one per channel, into the ramps by the white point of
+// `temperature` dimmed to `brightness`, with `gamma` applied to the latter.
+static void colorramp_scale_curves(uint16_t *gamma_r, uint16_t *gamma_g,
+                                   uint16_t *gamma_b, const uint16_t *curves[3],
+                                   int size, int temperature, double brightness,
+                                   double gamma) {
+    uint16_t white_point[3];
+    colorramp_white_point(temperature, white_point);
+    colorramp_scale_func scale = colorramp_scale_kernel();
+    uint16_t *ramps[3] = {gamma_r, gamma_g, gamma_b};
+
+    for (int c = 0; c < 3; c++) {
+        uint16_t m = white_point[c];
+
+        // fold brightness and gamma into the channel's multiplier, the
+        // common case of neither keeps the table's value as is.
+        if (brightness != 1.0 || gamma != 1.0) {
+            double wp = (double)colorramp_q16(m) / (UINT16_MAX + 1);
+            long q = lround(pow(wp * brightness, 1.0 / gamma) *
+                            (UINT16_MAX + 1));
+            m = q >= COLORRAMP_LUT_ONE ? COLORRAMP_LUT_ONE : q;
+        }
+
+        if (m == COLORRAMP_LUT_ONE)
+            memcpy(ramps[c], curves[c], size * sizeof(uint16_t));
+        else
+            scale(ramps[c], curves[c], size, m);
+    }
+}
+
+// Fills the red, green and blue ramps of `size` entries for `temperature` in
+// Kelvin, dimmed to `brightness` in [0, 1] and with `gamma` applied.
+void colorramp_fill_profile(uint16_t *gamma_r, uint16_t *gamma_g,
+                            uint16_t *gamma_b, int size, int temperature,
+                            double brightness, double gamma) {
+    const uint16_t *curve = colorramp_curve_get(size, gamma);
+    const uint16_t *curves[3] = {curve, curve, curve};
+
+    colorramp_scale_curves(gamma_r, gamma_g, gamma_b, curves, size,
+                           temperature, brightness, gamma);
+}
+
+// Like colorramp_fill_profile but scales `base`, the red, green and blue
+// ramps of `size` entries back to back, in place of the gamma curve.
+// `base` is typically a display's calibration and must have `gamma` applied
+// already, see vcgt_get_ramps.
+void colorramp_fill_calibrated(uint16_t *gamma_r, uint16_t *gamma_g,
+                               uint16_t *gamma_b, const uint16_t *base,
+                               int size, int temperature, double brightness,
+                               double gamma) {
+    const uint16_t *curves[3] = {base, base + size, base + 2 * size};
+
+    colorramp_scale_curves(gamma_r, gamma_g, gamma_b, curves, size,
+                           temperature, brightness, gamma);
+}
+
+// Fills the red, green and blue ramps of `size` entries for `temperature` in
+// Kelvin.
+void colorramp_fill(uint16_t *gamma_r, uint16_t *gamma_g, uint16_t *gamma_b,
+                    int size, int temperature) {
+    colorramp_fill_profile(gamma_r, gamma_g, gamma_b, size, temperature, 1.0,
+                           1.0);
 }
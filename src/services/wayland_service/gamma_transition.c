@@ -0,0 +1,80 @@
+#include "gamma_transition.h"
+
+#include <math.h>
+
+void gamma_transition_start(GammaTransition *self, double from, int target,
+                            gint64 duration_us, gint64 interval_us,
+                            gint64 now) {
+    *self = (GammaTransition){
+        .from = from,
+        .target = target,
+        .start_us = now,
+        .duration_us = MAX(duration_us, 0),
+        .interval_us = MAX(interval_us, 1),
+    };
+
+    // the first step runs at the start, one more per refresh after it
+    self->stats.expected = self->duration_us / self->interval_us + 1;
+}
+
+gboolean gamma_transition_step(GammaTransition *self, gint64 now,
+                               gboolean in_flight, int *temperature,
+                               gboolean *done) {
+    GammaTransitionStats *stats = &self->stats;
+
+    stats->ticks++;
+
+    // the timer is due once per interval, a longer gap passed over refreshes
+    // no step was taken for.
+    if (self->tick_us) {
+        gint64 gap = now - self->tick_us;
+        gint64 refreshes = (gap + self->interval_us / 2) / self->interval_us;
+        if (refreshes > 1) stats->missed += refreshes - 1;
+    }
+    self->tick_us = now;
+
+    if (in_flight) {
+        stats->skipped++;
+        return FALSE;
+    }
+
+    double t = 1.0;
+    if (self->duration_us > 0)
+        t = MIN((double)(now - self->start_us) / self->duration_us, 1.0);
+
+    // smoothstep, eases in and out of the transition
+    double eased = t * t * (3.0 - 2.0 * t);
+    *temperature = lround(self->from + (self->target - self->from) * eased);
+    *done = t >= 1.0;
+    return TRUE;
+}
+
+void gamma_transition_sent(GammaTransition *self, gint64 now, gint64 busy_us) {
+    GammaTransitionStats *stats = &self->stats;
+
+    stats->frames++;
+    stats->busy_us += busy_us;
+
+    if (self->frame_us) {
+        gint64 interval = now - self->frame_us;
+        stats->interval_total_us += interval;
+        stats->interval_max_us = MAX(stats->interval_max_us, interval);
+    }
+    self->frame_us = now;
+}
+
+void gamma_transition_acked(GammaTransition *self, gint64 now) {
+    GammaTransitionStats *stats = &self->stats;
+
+    // nothing sent yet
+    if (!self->frame_us) return;
+
+    gint64 latency = now - self->frame_us;
+    stats->acked++;
+    stats->ack_total_us += latency;
+    stats->ack_max_us = MAX(stats->ack_max_us, latency);
+}
+
+guint gamma_transition_dropped(const GammaTransitionStats *stats) {
+    return stats->skipped + stats->missed;
+}
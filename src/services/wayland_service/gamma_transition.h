@@ -0,0 +1,66 @@
+#pragma once
+
+#include <adwaita.h>
+
+// How well a night light transition kept pace with its output.
+// A transition is stepped once per refresh of the output, a refresh without a
+// table is dropped either because the timer fired late, `missed`, or because
+// the compositor had not acknowledged the previous table yet, `skipped`.
+typedef struct _GammaTransitionStats {
+    // refreshes the transition spans, the steps a perfectly paced one takes
+    guint expected;
+    // timer ticks and tables sent
+    guint ticks;
+    guint frames;
+    // ticks skipped while a table was in flight
+    guint skipped;
+    // refreshes passed without a tick
+    guint missed;
+    // time between consecutive tables
+    gint64 interval_max_us;
+    gint64 interval_total_us;
+    // time from a table to the compositor's acknowledgment of it
+    guint acked;
+    gint64 ack_max_us;
+    gint64 ack_total_us;
+    // time spent filling and sending tables
+    gint64 busy_us;
+} GammaTransitionStats;
+
+// A transition from `from` to `target` Kelvin over `duration_us`, eased in and
+// out, stepped every `interval_us`.
+typedef struct _GammaTransition {
+    double from;
+    int target;
+    gint64 start_us;
+    gint64 duration_us;
+    gint64 interval_us;
+    // when the last tick ran and the last table was sent, 0 for never
+    gint64 tick_us;
+    gint64 frame_us;
+    GammaTransitionStats stats;
+} GammaTransition;
+
+// Starts a transition at `now`, resetting its stats.
+void gamma_transition_start(GammaTransition *self, double from, int target,
+                            gint64 duration_us, gint64 interval_us,
+                            gint64 now);
+
+// Steps the transition at `now`.
+// Returns FALSE if the step is skipped because the last table is
+// `in_flight`. Otherwise sets `temperature` to the one to apply and `done` to
+// whether the transition reached its target.
+gboolean gamma_transition_step(GammaTransition *self, gint64 now,
+                               gboolean in_flight, int *temperature,
+                               gboolean *done);
+
+// Records that a table was sent at `now`, taking `busy_us` to fill and send.
+void gamma_transition_sent(GammaTransition *self, gint64 now, gint64 busy_us);
+
+// Records that the compositor acknowledged the last table at `now`.
+// Acknowledgments of tables sent before the transition started must not be
+// reported, the owner drops a sync still in flight when it starts one.
+void gamma_transition_acked(GammaTransition *self, gint64 now);
+
+// Refreshes of the transition without a table, late or skipped.
+guint gamma_transition_dropped(const GammaTransitionStats *stats);
@@ -0,0 +1,142 @@
+#include "night_light_schedule.h"
+
+#include <adwaita.h>
+#include <math.h>
+
+#define J2000 2451545.0
+#define UNIX_EPOCH_JULIAN 2440587.5
+#define SECONDS_PER_DAY 86400
+#define DEG (G_PI / 180.0)
+
+// how long to wait before evaluating again when the sun neither rises nor
+// sets around `now`.
+#define POLAR_RECHECK_SECONDS (6 * 3600)
+
+typedef struct _SunEvent {
+    gint64 time;
+    gboolean sunset;
+} SunEvent;
+
+// Computes sunrise and sunset of the solar day `n` days after J2000 using the
+// sunrise equation.
+// Returns FALSE if the sun does not cross the horizon that day, in which case
+// `polar_night` tells which side of it the sun stays on.
+static gboolean sun_times(gint64 n, double latitude, double longitude,
+                          gint64 *sunrise, gint64 *sunset,
+                          gboolean *polar_night) {
+    double mean_solar_noon = n - longitude / 360.0;
+
+    double anomaly = fmod(357.5291 + 0.98560028 * mean_solar_noon, 360.0);
+    double center = 1.9148 * sin(anomaly * DEG) +
+                    0.0200 * sin(2 * anomaly * DEG) +
+                    0.0003 * sin(3 * anomaly * DEG);
+    double ecliptic_longitude =
+        fmod(anomaly + center + 180.0 + 102.9372, 360.0);
+
+    double transit = J2000 + mean_solar_noon + 0.0053 * sin(anomaly * DEG) -
+                     0.0069 * sin(2 * ecliptic_longitude * DEG);
+
+    double declination =
+        asin(sin(ecliptic_longitude * DEG) * sin(23.4397 * DEG));
+
+    // -0.833 degrees accounts for refraction and the solar disc
+    double cos_hour_angle =
+        (sin(-0.833 * DEG) - sin(latitude * DEG) * sin(declination)) /
+        (cos(latitude * DEG) * cos(declination));
+
+    if (cos_hour_angle > 1.0 || cos_hour_angle < -1.0) {
+        *polar_night = cos_hour_angle > 1.0;
+        return FALSE;
+    }
+
+    double hour_angle = acos(cos_hour_angle) / DEG;
+
+    *sunrise = llround((transit - hour_angle / 360.0 - UNIX_EPOCH_JULIAN) *
+                       SECONDS_PER_DAY);
+    *sunset = llround((transit + hour_angle / 360.0 - UNIX_EPOCH_JULIAN) *
+                      SECONDS_PER_DAY);
+    return TRUE;
+}
+
+gint64 night_light_schedule_sun(double latitude, double longitude, gint64 now,
+                                gboolean *night) {
+    gint64 today =
+        (gint64)floor((double)now / SECONDS_PER_DAY + UNIX_EPOCH_JULIAN -
+                      J2000 + 0.0008);
+
+    // collect events of the surrounding days, in order, so both the latest
+    // past and the earliest future event are among them.
+    SunEvent events[8];
+    int n_events = 0;
+    gboolean polar_night = FALSE;
+
+    for (gint64 n = today - 1; n <= today + 2; n++) {
+        gint64 sunrise, sunset;
+        if (!sun_times(n, latitude, longitude, &sunrise, &sunset,
+                       &polar_night))
+            continue;
+        events[n_events++] = (SunEvent){sunrise, FALSE};
+        events[n_events++] = (SunEvent){sunset, TRUE};
+    }
+
+    const SunEvent *last = NULL;
+    const SunEvent *next = NULL;
+    for (int i = 0; i < n_events; i++) {
+        if (events[i].time <= now)
+            last = &events[i];
+        else if (!next)
+            next = &events[i];
+    }
+
+    if (last)
+        *night = last->sunset;
+    else if (next)
+        *night = !next->sunset;
+    else
+        *night = polar_night;
+
+    if (!next) return now + POLAR_RECHECK_SECONDS;
+    return next->time;
+}
+
+// Returns the unix time of `hours` past local midnight of `day`.
+static gint64 local_time_at(GDateTime *day, double hours) {
+    int minutes = (int)lround(hours * 60.0);
+    GDateTime *midnight = g_date_time_new_local(
+        g_date_time_get_year(day), g_date_time_get_month(day),
+        g_date_time_get_day_of_month(day), 0, 0, 0);
+    GDateTime *t = g_date_time_add_minutes(midnight, minutes);
+    gint64 time = g_date_time_to_unix(t);
+    g_date_time_unref(t);
+    g_date_time_unref(midnight);
+    return time;
+}
+
+gint64 night_light_schedule_fixed(double from, double to, gint64 now,
+                                  gboolean *night) {
+    GDateTime *today = g_date_time_new_from_unix_local(now);
+    gint64 next = G_MAXINT64;
+
+    *night = FALSE;
+
+    // the window starting yesterday may still be open past midnight, the one
+    // starting tomorrow is the next boundary late in the evening.
+    for (int offset = -1; offset <= 1; offset++) {
+        GDateTime *day = g_date_time_add_days(today, offset);
+        gint64 start = local_time_at(day, from);
+        gint64 end = local_time_at(day, to);
+        g_date_time_unref(day);
+
+        if (end <= start) end += SECONDS_PER_DAY;
+
+        if (now >= start && now < end) {
+            *night = TRUE;
+            next = MIN(next, end);
+        } else if (start > now) {
+            next = MIN(next, start);
+        }
+    }
+
+    g_date_time_unref(today);
+    return next;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <adwaita.h>
+
+// Evaluates a sunset to sunrise schedule at `now` for the location given in
+// degrees, north and east positive.
+// Sets `night` to whether the night light should be on and returns the unix
+// time of the next sunrise or sunset.
+// Within the polar circles, where the sun may not rise or set for days,
+// the returned time is simply a later point to evaluate the schedule again.
+gint64 night_light_schedule_sun(double latitude, double longitude, gint64 now,
+                                gboolean *night);
+
+// Evaluates a fixed schedule at `now`, the night light is on from `from` to
+// `to`, both given in local hours, e.g. 20.5 for 20:30.
+// Sets `night` to whether the night light should be on and returns the unix
+// time of the next boundary.
+gint64 night_light_schedule_fixed(double from, double to, gint64 now,
+                                  gboolean *night);
@@ -0,0 +1,758 @@
+#include "output_config.h"
+
+#include <adwaita.h>
+#include <stdlib.h>
+#include <wayland-client.h>
+
+// keys of a layout group which do not describe a head
+#define LAYOUT_KEY_HEADS "heads"
+#define LAYOUT_KEY_LAST_USED "last-used"
+
+// integers stored per head in a layout, in the order of
+// WaylandOutputLayoutHead's fields following its identity.
+#define LAYOUT_HEAD_FIELDS 8
+
+// refresh rates further apart than this are different modes, in mHz
+#define LAYOUT_REFRESH_TOLERANCE 1000
+
+typedef struct _WaylandOutputLayoutHead {
+    char *identity;
+    gboolean enabled;
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+    int32_t refresh;
+    int32_t transform;
+    wl_fixed_t scale;
+} WaylandOutputLayoutHead;
+
+// A layout being tested or applied.
+typedef struct _WaylandOutputConfigRequest {
+    WaylandOutputConfig *self;
+    struct zwlr_output_configuration_v1 *config;
+    char *name;
+    // WaylandOutputLayoutHead entries
+    GArray *heads;
+    // serial of the heads the configuration was created for
+    uint32_t serial;
+    // FALSE while testing
+    gboolean applying;
+} WaylandOutputConfigRequest;
+
+struct _WaylandOutputConfig {
+    struct wl_display *display;
+    struct zwlr_output_manager_v1 *manager;
+    // WaylandOutputHead structs
+    GPtrArray *heads;
+    // serial of the last done event
+    uint32_t serial;
+    // identities of the heads as of the last done event, sorted and joined
+    // by newlines.
+    char *head_set;
+    // at most one layout is in flight, a newer one replaces it.
+    WaylandOutputConfigRequest *pending;
+    // path of the key file holding the layouts
+    char *path;
+
+    WaylandOutputConfigFunc heads_changed;
+    WaylandOutputConfigFunc layouts_changed;
+    gpointer data;
+};
+
+// Identifies a monitor across reconnects, the connector it is plugged in may
+// change while make, model and serial do not.
+static char *wayland_output_head_identity(WaylandOutputHead *head) {
+    char *identity;
+
+    if (head->make && head->model && head->serial && *head->serial)
+        identity =
+            g_strdup_printf("%s %s %s", head->make, head->model, head->serial);
+    else if (head->make && head->model)
+        // identical monitors without serial are told apart by connector
+        identity = g_strdup_printf("%s %s %s", head->make, head->model,
+                                   head->name ? head->name : "");
+    else
+        identity = g_strdup(head->name ? head->name : "");
+
+    // '=' ends a key and brackets start a group in a key file
+    g_strdelimit(identity, "=[]\n", '_');
+    return g_strstrip(identity);
+}
+
+static int compare_identities(const void *a, const void *b) {
+    return g_strcmp0(*(char *const *)a, *(char *const *)b);
+}
+
+// Returns the sorted identities of the current heads.
+static char **wayland_output_config_head_set(WaylandOutputConfig *self) {
+    char **set = g_new0(char *, self->heads->len + 1);
+
+    for (guint i = 0; i < self->heads->len; i++)
+        set[i] = wayland_output_head_identity(
+            g_ptr_array_index(self->heads, i));
+
+    qsort(set, self->heads->len, sizeof(char *), compare_identities);
+    return set;
+}
+
+static void wayland_output_mode_release(struct zwlr_output_mode_v1 *mode) {
+    if (wl_proxy_get_version((struct wl_proxy *)mode) >=
+        ZWLR_OUTPUT_MODE_V1_RELEASE_SINCE_VERSION)
+        zwlr_output_mode_v1_release(mode);
+    else
+        zwlr_output_mode_v1_destroy(mode);
+}
+
+static void wayland_output_head_free(gpointer data) {
+    WaylandOutputHead *head = data;
+
+    for (guint i = 0; i < head->modes->len; i++)
+        wayland_output_mode_release(
+            g_array_index(head->modes, WaylandOutputMode, i).mode);
+    g_array_unref(head->modes);
+
+    if (wl_proxy_get_version((struct wl_proxy *)head->head) >=
+        ZWLR_OUTPUT_HEAD_V1_RELEASE_SINCE_VERSION)
+        zwlr_output_head_v1_release(head->head);
+    else
+        zwlr_output_head_v1_destroy(head->head);
+
+    g_free(head->name);
+    g_free(head->description);
+    g_free(head->make);
+    g_free(head->model);
+    g_free(head->serial);
+    g_free(head);
+}
+
+static WaylandOutputMode *wayland_output_head_lookup_mode(
+    WaylandOutputHead *head, struct zwlr_output_mode_v1 *mode) {
+    for (guint i = 0; i < head->modes->len; i++) {
+        WaylandOutputMode *m =
+            &g_array_index(head->modes, WaylandOutputMode, i);
+        if (m->mode == mode) return m;
+    }
+    return NULL;
+}
+
+const WaylandOutputMode *wayland_output_head_get_current_mode(
+    WaylandOutputHead *head) {
+    if (!head->enabled || !head->current_mode) return NULL;
+    return wayland_output_head_lookup_mode(head, head->current_mode);
+}
+
+// Returns the mode of the given size closest to `refresh`, compositors round
+// refresh rates differently.
+static WaylandOutputMode *wayland_output_head_find_mode(WaylandOutputHead *head,
+                                                        int32_t width,
+                                                        int32_t height,
+                                                        int32_t refresh) {
+    WaylandOutputMode *best = NULL;
+
+    for (guint i = 0; i < head->modes->len; i++) {
+        WaylandOutputMode *m =
+            &g_array_index(head->modes, WaylandOutputMode, i);
+        if (m->width != width || m->height != height) continue;
+        if (!best || abs(m->refresh - refresh) < abs(best->refresh - refresh))
+            best = m;
+    }
+
+    if (best && refresh &&
+        abs(best->refresh - refresh) > LAYOUT_REFRESH_TOLERANCE)
+        return NULL;
+    return best;
+}
+
+static void mode_handle_size(void *data, struct zwlr_output_mode_v1 *mode,
+                             int32_t width, int32_t height) {
+    WaylandOutputMode *m = wayland_output_head_lookup_mode(data, mode);
+    if (!m) return;
+    m->width = width;
+    m->height = height;
+}
+
+static void mode_handle_refresh(void *data, struct zwlr_output_mode_v1 *mode,
+                                int32_t refresh) {
+    WaylandOutputMode *m = wayland_output_head_lookup_mode(data, mode);
+    if (!m) return;
+    m->refresh = refresh;
+}
+
+static void mode_handle_preferred(void *data,
+                                  struct zwlr_output_mode_v1 *mode) {
+    WaylandOutputMode *m = wayland_output_head_lookup_mode(data, mode);
+    if (!m) return;
+    m->preferred = TRUE;
+}
+
+static void mode_handle_finished(void *data, struct zwlr_output_mode_v1 *mode) {
+    WaylandOutputHead *head = data;
+
+    for (guint i = 0; i < head->modes->len; i++) {
+        if (g_array_index(head->modes, WaylandOutputMode, i).mode != mode)
+            continue;
+        g_array_remove_index(head->modes, i);
+        break;
+    }
+    if (head->current_mode == mode) head->current_mode = NULL;
+
+    wayland_output_mode_release(mode);
+}
+
+static const struct zwlr_output_mode_v1_listener mode_listener = {
+    .size = mode_handle_size,
+    .refresh = mode_handle_refresh,
+    .preferred = mode_handle_preferred,
+    .finished = mode_handle_finished,
+};
+
+static void head_handle_name(void *data, struct zwlr_output_head_v1 *zhead,
+                             const char *name) {
+    WaylandOutputHead *head = data;
+    g_free(head->name);
+    head->name = g_strdup(name);
+}
+
+static void head_handle_description(void *data,
+                                    struct zwlr_output_head_v1 *zhead,
+                                    const char *description) {
+    WaylandOutputHead *head = data;
+    g_free(head->description);
+    head->description = g_strdup(description);
+}
+
+static void head_handle_physical_size(void *data,
+                                      struct zwlr_output_head_v1 *zhead,
+                                      int32_t width, int32_t height) {}
+
+static void head_handle_mode(void *data, struct zwlr_output_head_v1 *zhead,
+                             struct zwlr_output_mode_v1 *mode) {
+    WaylandOutputHead *head = data;
+    WaylandOutputMode m = {.mode = mode};
+    g_array_append_val(head->modes, m);
+    zwlr_output_mode_v1_add_listener(mode, &mode_listener, head);
+}
+
+static void head_handle_enabled(void *data, struct zwlr_output_head_v1 *zhead,
+                                int32_t enabled) {
+    WaylandOutputHead *head = data;
+    head->enabled = enabled;
+    if (!enabled) head->current_mode = NULL;
+}
+
+static void head_handle_current_mode(void *data,
+                                     struct zwlr_output_head_v1 *zhead,
+                                     struct zwlr_output_mode_v1 *mode) {
+    WaylandOutputHead *head = data;
+    head->current_mode = mode;
+}
+
+static void head_handle_position(void *data, struct zwlr_output_head_v1 *zhead,
+                                 int32_t x, int32_t y) {
+    WaylandOutputHead *head = data;
+    head->x = x;
+    head->y = y;
+}
+
+static void head_handle_transform(void *data,
+                                  struct zwlr_output_head_v1 *zhead,
+                                  int32_t transform) {
+    WaylandOutputHead *head = data;
+    head->transform = transform;
+}
+
+static void head_handle_scale(void *data, struct zwlr_output_head_v1 *zhead,
+                              wl_fixed_t scale) {
+    WaylandOutputHead *head = data;
+    head->scale = scale;
+}
+
+static void head_handle_finished(void *data,
+                                 struct zwlr_output_head_v1 *zhead) {
+    WaylandOutputHead *head = data;
+    g_debug("output_config.c:head_handle_finished(): head: %s", head->name);
+    g_ptr_array_remove(head->config->heads, head);
+}
+
+static void head_handle_make(void *data, struct zwlr_output_head_v1 *zhead,
+                             const char *make) {
+    WaylandOutputHead *head = data;
+    g_free(head->make);
+    head->make = g_strdup(make);
+}
+
+static void head_handle_model(void *data, struct zwlr_output_head_v1 *zhead,
+                              const char *model) {
+    WaylandOutputHead *head = data;
+    g_free(head->model);
+    head->model = g_strdup(model);
+}
+
+static void head_handle_serial_number(void *data,
+                                      struct zwlr_output_head_v1 *zhead,
+                                      const char *serial) {
+    WaylandOutputHead *head = data;
+    g_free(head->serial);
+    head->serial = g_strdup(serial);
+}
+
+static void head_handle_adaptive_sync(void *data,
+                                      struct zwlr_output_head_v1 *zhead,
+                                      uint32_t state) {}
+
+static const struct zwlr_output_head_v1_listener head_listener = {
+    .name = head_handle_name,
+    .description = head_handle_description,
+    .physical_size = head_handle_physical_size,
+    .mode = head_handle_mode,
+    .enabled = head_handle_enabled,
+    .current_mode = head_handle_current_mode,
+    .position = head_handle_position,
+    .transform = head_handle_transform,
+    .scale = head_handle_scale,
+    .finished = head_handle_finished,
+    .make = head_handle_make,
+    .model = head_handle_model,
+    .serial_number = head_handle_serial_number,
+    .adaptive_sync = head_handle_adaptive_sync,
+};
+
+static GKeyFile *wayland_output_config_load(WaylandOutputConfig *self) {
+    GKeyFile *key_file = g_key_file_new();
+    GError *err = NULL;
+
+    if (!g_key_file_load_from_file(key_file, self->path,
+                                   G_KEY_FILE_KEEP_COMMENTS, &err)) {
+        if (!g_error_matches(err, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            g_warning("output_config.c:wayland_output_config_load(): %s: %s",
+                      self->path, err->message);
+        g_error_free(err);
+    }
+
+    return key_file;
+}
+
+static gboolean wayland_output_config_store(WaylandOutputConfig *self,
+                                            GKeyFile *key_file) {
+    GError *err = NULL;
+
+    char *dir = g_path_get_dirname(self->path);
+    g_mkdir_with_parents(dir, 0755);
+    g_free(dir);
+
+    if (!g_key_file_save_to_file(key_file, self->path, &err)) {
+        g_warning("output_config.c:wayland_output_config_store(): %s: %s",
+                  self->path, err->message);
+        g_error_free(err);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static void wayland_output_layout_head_clear(gpointer data) {
+    WaylandOutputLayoutHead *head = data;
+    g_free(head->identity);
+}
+
+// Reads the heads of layout `name`, returns NULL if there is no such layout.
+static GArray *wayland_output_layout_read(GKeyFile *key_file,
+                                          const char *name) {
+    gchar **keys = g_key_file_get_keys(key_file, name, NULL, NULL);
+    if (!keys) return NULL;
+
+    GArray *heads = g_array_new(FALSE, TRUE, sizeof(WaylandOutputLayoutHead));
+    g_array_set_clear_func(heads, wayland_output_layout_head_clear);
+
+    for (int i = 0; keys[i]; i++) {
+        if (strcmp(keys[i], LAYOUT_KEY_HEADS) == 0 ||
+            strcmp(keys[i], LAYOUT_KEY_LAST_USED) == 0)
+            continue;
+
+        gsize n = 0;
+        gint *fields =
+            g_key_file_get_integer_list(key_file, name, keys[i], &n, NULL);
+        if (!fields || n != LAYOUT_HEAD_FIELDS) {
+            g_warning(
+                "output_config.c:wayland_output_layout_read(): layout %s: "
+                "ignoring malformed head %s",
+                name, keys[i]);
+            g_free(fields);
+            continue;
+        }
+
+        WaylandOutputLayoutHead head = {
+            .identity = g_strdup(keys[i]),
+            .enabled = fields[0],
+            .x = fields[1],
+            .y = fields[2],
+            .width = fields[3],
+            .height = fields[4],
+            .refresh = fields[5],
+            .transform = fields[6],
+            .scale = fields[7],
+        };
+        g_array_append_val(heads, head);
+        g_free(fields);
+    }
+
+    g_strfreev(keys);
+    return heads;
+}
+
+static const WaylandOutputLayoutHead *wayland_output_layout_find(
+    GArray *heads, const char *identity) {
+    for (guint i = 0; i < heads->len; i++) {
+        const WaylandOutputLayoutHead *head =
+            &g_array_index(heads, WaylandOutputLayoutHead, i);
+        if (strcmp(head->identity, identity) == 0) return head;
+    }
+    return NULL;
+}
+
+static void wayland_output_config_request_free(
+    WaylandOutputConfigRequest *req) {
+    if (req->self->pending == req) req->self->pending = NULL;
+    if (req->config) zwlr_output_configuration_v1_destroy(req->config);
+    g_array_unref(req->heads);
+    g_free(req->name);
+    g_free(req);
+}
+
+static const struct zwlr_output_configuration_v1_listener
+    configuration_listener;
+
+// Creates a configuration for the current heads from the layout of `req`.
+// Every head is part of it, heads the layout does not know keep their state.
+static void wayland_output_config_request_build(
+    WaylandOutputConfigRequest *req) {
+    WaylandOutputConfig *self = req->self;
+
+    req->serial = self->serial;
+    req->config = zwlr_output_manager_v1_create_configuration(self->manager,
+                                                              self->serial);
+    zwlr_output_configuration_v1_add_listener(req->config,
+                                              &configuration_listener, req);
+
+    for (guint i = 0; i < self->heads->len; i++) {
+        WaylandOutputHead *head = g_ptr_array_index(self->heads, i);
+
+        char *identity = wayland_output_head_identity(head);
+        const WaylandOutputLayoutHead *entry =
+            wayland_output_layout_find(req->heads, identity);
+        g_free(identity);
+
+        if (!(entry ? entry->enabled : head->enabled)) {
+            zwlr_output_configuration_v1_disable_head(req->config, head->head);
+            continue;
+        }
+
+        // an enabled head starts out with its current state
+        struct zwlr_output_configuration_head_v1 *config_head =
+            zwlr_output_configuration_v1_enable_head(req->config, head->head);
+        if (!entry) continue;
+
+        WaylandOutputMode *mode = wayland_output_head_find_mode(
+            head, entry->width, entry->height, entry->refresh);
+        if (mode)
+            zwlr_output_configuration_head_v1_set_mode(config_head,
+                                                       mode->mode);
+        else if (entry->width > 0 && entry->height > 0)
+            zwlr_output_configuration_head_v1_set_custom_mode(
+                config_head, entry->width, entry->height, entry->refresh);
+
+        zwlr_output_configuration_head_v1_set_position(config_head, entry->x,
+                                                       entry->y);
+        zwlr_output_configuration_head_v1_set_transform(config_head,
+                                                        entry->transform);
+        if (entry->scale > 0)
+            zwlr_output_configuration_head_v1_set_scale(config_head,
+                                                        entry->scale);
+    }
+}
+
+// Marks layout `name` as the most recently used one for its heads.
+static void wayland_output_config_touch(WaylandOutputConfig *self,
+                                        const char *name) {
+    GKeyFile *key_file = wayland_output_config_load(self);
+    if (g_key_file_has_group(key_file, name)) {
+        g_key_file_set_int64(key_file, name, LAYOUT_KEY_LAST_USED,
+                             g_get_real_time() / G_USEC_PER_SEC);
+        wayland_output_config_store(self, key_file);
+    }
+    g_key_file_free(key_file);
+}
+
+static void configuration_handle_succeeded(
+    void *data, struct zwlr_output_configuration_v1 *config) {
+    WaylandOutputConfigRequest *req = data;
+    WaylandOutputConfig *self = req->self;
+
+    if (req->applying) {
+        g_debug(
+            "output_config.c:configuration_handle_succeeded(): applied layout "
+            "%s",
+            req->name);
+        wayland_output_config_touch(self, req->name);
+        wayland_output_config_request_free(req);
+        wl_display_flush(self->display);
+        return;
+    }
+
+    // the heads changed since the configuration was tested, what passed the
+    // test is not what would be applied now.
+    if (req->serial != self->serial) {
+        g_debug(
+            "output_config.c:configuration_handle_succeeded(): heads changed "
+            "while testing layout %s",
+            req->name);
+        wayland_output_config_request_free(req);
+        wl_display_flush(self->display);
+        return;
+    }
+
+    // a configuration is used once, apply an identical one
+    zwlr_output_configuration_v1_destroy(req->config);
+    req->applying = TRUE;
+    wayland_output_config_request_build(req);
+    zwlr_output_configuration_v1_apply(req->config);
+    wl_display_flush(self->display);
+}
+
+static void configuration_handle_failed(
+    void *data, struct zwlr_output_configuration_v1 *config) {
+    WaylandOutputConfigRequest *req = data;
+    WaylandOutputConfig *self = req->self;
+
+    g_warning(
+        "output_config.c:configuration_handle_failed(): compositor rejected "
+        "layout %s during %s",
+        req->name, req->applying ? "apply" : "test");
+
+    wayland_output_config_request_free(req);
+    wl_display_flush(self->display);
+}
+
+static void configuration_handle_cancelled(
+    void *data, struct zwlr_output_configuration_v1 *config) {
+    WaylandOutputConfigRequest *req = data;
+    WaylandOutputConfig *self = req->self;
+
+    g_debug(
+        "output_config.c:configuration_handle_cancelled(): layout %s "
+        "outdated by a change to the heads",
+        req->name);
+
+    wayland_output_config_request_free(req);
+    wl_display_flush(self->display);
+}
+
+static const struct zwlr_output_configuration_v1_listener
+    configuration_listener = {
+        .succeeded = configuration_handle_succeeded,
+        .failed = configuration_handle_failed,
+        .cancelled = configuration_handle_cancelled,
+};
+
+// Applies the most recently used layout saved for exactly the heads in `set`.
+static void wayland_output_config_restore(WaylandOutputConfig *self,
+                                          char **set) {
+    GKeyFile *key_file = wayland_output_config_load(self);
+    gchar **groups = g_key_file_get_groups(key_file, NULL);
+    const char *best = NULL;
+    gint64 best_used = -1;
+
+    for (int i = 0; groups[i]; i++) {
+        gchar **heads = g_key_file_get_string_list(
+            key_file, groups[i], LAYOUT_KEY_HEADS, NULL, NULL);
+        if (heads && g_strv_equal((const gchar *const *)heads,
+                                  (const gchar *const *)set)) {
+            gint64 used = g_key_file_get_int64(key_file, groups[i],
+                                               LAYOUT_KEY_LAST_USED, NULL);
+            if (used > best_used) {
+                best = groups[i];
+                best_used = used;
+            }
+        }
+        g_strfreev(heads);
+    }
+
+    if (best) {
+        g_debug("output_config.c:wayland_output_config_restore(): layout: %s",
+                best);
+        wayland_output_config_apply_layout(self, best);
+    }
+
+    g_strfreev(groups);
+    g_key_file_free(key_file);
+}
+
+static void manager_handle_head(void *data,
+                                struct zwlr_output_manager_v1 *manager,
+                                struct zwlr_output_head_v1 *zhead) {
+    WaylandOutputConfig *self = data;
+
+    WaylandOutputHead *head = g_new0(WaylandOutputHead, 1);
+    head->config = self;
+    head->head = zhead;
+    head->modes = g_array_new(FALSE, TRUE, sizeof(WaylandOutputMode));
+    head->scale = wl_fixed_from_int(1);
+    g_ptr_array_add(self->heads, head);
+
+    zwlr_output_head_v1_add_listener(zhead, &head_listener, head);
+}
+
+static void manager_handle_done(void *data,
+                                struct zwlr_output_manager_v1 *manager,
+                                uint32_t serial) {
+    WaylandOutputConfig *self = data;
+
+    self->serial = serial;
+
+    // restore a known layout only when the set of monitors changed, not for
+    // the changes applying one causes.
+    char **set = wayland_output_config_head_set(self);
+    char *head_set = g_strjoinv("\n", set);
+    gboolean hotplugged = g_strcmp0(head_set, self->head_set) != 0;
+    g_free(self->head_set);
+    self->head_set = head_set;
+
+    g_debug("output_config.c:manager_handle_done(): serial: %u, heads: %u",
+            serial, self->heads->len);
+
+    if (hotplugged && self->heads->len > 0)
+        wayland_output_config_restore(self, set);
+    g_strfreev(set);
+
+    if (self->heads_changed) self->heads_changed(self->data);
+}
+
+static void manager_handle_finished(void *data,
+                                    struct zwlr_output_manager_v1 *manager) {
+    WaylandOutputConfig *self = data;
+
+    g_warning(
+        "output_config.c:manager_handle_finished(): compositor stopped output "
+        "management");
+
+    if (self->pending) wayland_output_config_request_free(self->pending);
+    g_ptr_array_set_size(self->heads, 0);
+    zwlr_output_manager_v1_destroy(self->manager);
+    self->manager = NULL;
+}
+
+static const struct zwlr_output_manager_v1_listener manager_listener = {
+    .head = manager_handle_head,
+    .done = manager_handle_done,
+    .finished = manager_handle_finished,
+};
+
+WaylandOutputConfig *wayland_output_config_new(
+    struct wl_display *display, struct zwlr_output_manager_v1 *manager,
+    WaylandOutputConfigFunc heads_changed,
+    WaylandOutputConfigFunc layouts_changed, gpointer data) {
+    WaylandOutputConfig *self = g_new0(WaylandOutputConfig, 1);
+
+    self->display = display;
+    self->manager = manager;
+    self->heads = g_ptr_array_new_with_free_func(wayland_output_head_free);
+    self->path = g_build_filename(g_get_user_config_dir(), "way-shell",
+                                  "output-layouts.ini", NULL);
+    self->heads_changed = heads_changed;
+    self->layouts_changed = layouts_changed;
+    self->data = data;
+
+    zwlr_output_manager_v1_add_listener(manager, &manager_listener, self);
+
+    return self;
+}
+
+gchar **wayland_output_config_list_layouts(WaylandOutputConfig *self) {
+    GKeyFile *key_file = wayland_output_config_load(self);
+    gchar **groups = g_key_file_get_groups(key_file, NULL);
+    g_key_file_free(key_file);
+    return groups;
+}
+
+gboolean wayland_output_config_save_layout(WaylandOutputConfig *self,
+                                           const char *name) {
+    if (!name || !*name || strpbrk(name, "[]\n")) {
+        g_warning(
+            "output_config.c:wayland_output_config_save_layout(): invalid "
+            "layout name: %s",
+            name);
+        return FALSE;
+    }
+
+    if (self->heads->len == 0) return FALSE;
+
+    GKeyFile *key_file = wayland_output_config_load(self);
+    g_key_file_remove_group(key_file, name, NULL);
+
+    char **set = wayland_output_config_head_set(self);
+    g_key_file_set_string_list(key_file, name, LAYOUT_KEY_HEADS,
+                               (const gchar *const *)set, g_strv_length(set));
+    g_strfreev(set);
+
+    g_key_file_set_int64(key_file, name, LAYOUT_KEY_LAST_USED,
+                         g_get_real_time() / G_USEC_PER_SEC);
+
+    for (guint i = 0; i < self->heads->len; i++) {
+        WaylandOutputHead *head = g_ptr_array_index(self->heads, i);
+        const WaylandOutputMode *mode =
+            wayland_output_head_get_current_mode(head);
+
+        gint fields[LAYOUT_HEAD_FIELDS] = {
+            head->enabled,
+            head->x,
+            head->y,
+            mode ? mode->width : 0,
+            mode ? mode->height : 0,
+            mode ? mode->refresh : 0,
+            head->transform,
+            head->scale,
+        };
+
+        char *identity = wayland_output_head_identity(head);
+        g_key_file_set_integer_list(key_file, name, identity, fields,
+                                    LAYOUT_HEAD_FIELDS);
+        g_free(identity);
+    }
+
+    gboolean saved = wayland_output_config_store(self, key_file);
+    g_key_file_free(key_file);
+
+    if (saved && self->layouts_changed) self->layouts_changed(self->data);
+    return saved;
+}
+
+gboolean wayland_output_config_apply_layout(WaylandOutputConfig *self,
+                                            const char *name) {
+    if (!self->manager) return FALSE;
+
+    GKeyFile *key_file = wayland_output_config_load(self);
+    GArray *heads = wayland_output_layout_read(key_file, name);
+    g_key_file_free(key_file);
+
+    if (!heads) {
+        g_warning(
+            "output_config.c:wayland_output_config_apply_layout(): no layout "
+            "named %s",
+            name);
+        return FALSE;
+    }
+
+    if (self->pending) wayland_output_config_request_free(self->pending);
+
+    WaylandOutputConfigRequest *req = g_new0(WaylandOutputConfigRequest, 1);
+    req->self = self;
+    req->name = g_strdup(name);
+    req->heads = heads;
+    self->pending = req;
+
+    wayland_output_config_request_build(req);
+    zwlr_output_configuration_v1_test(req->config);
+    wl_display_flush(self->display);
+
+    return TRUE;
+}
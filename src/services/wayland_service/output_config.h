@@ -0,0 +1,80 @@
+#pragma once
+
+#include <adwaita.h>
+#include <wayland-client.h>
+
+#include "./wlr-output-management-unstable-v1.h"
+
+// Tracks the heads advertised by zwlr_output_manager_v1 and applies named
+// layouts to them.
+//
+// A layout stores, per head, whether it is enabled along with its mode,
+// position, transform and scale.
+// Layouts are kept in $XDG_CONFIG_HOME/way-shell/output-layouts.ini together
+// with the set of heads they were saved for, when that set of heads is
+// connected again the most recently used layout for it is restored.
+//
+// Everything runs on the default queue, from the main loop.
+
+typedef struct _WaylandOutputConfig WaylandOutputConfig;
+
+// A mode advertised by a head, stored inline in the head's mode table.
+typedef struct _WaylandOutputMode {
+    struct zwlr_output_mode_v1 *mode;
+    int32_t width;
+    int32_t height;
+    // mHz, 0 when unknown
+    int32_t refresh;
+    gboolean preferred;
+} WaylandOutputMode;
+
+// A connected output, enabled or not.
+typedef struct _WaylandOutputHead {
+    // the tracker owning this head
+    WaylandOutputConfig *config;
+    struct zwlr_output_head_v1 *head;
+    char *name;
+    char *description;
+    char *make;
+    char *model;
+    char *serial;
+    // WaylandOutputMode entries
+    GArray *modes;
+    // the current mode, NULL while the head is disabled
+    struct zwlr_output_mode_v1 *current_mode;
+    gboolean enabled;
+    int32_t x;
+    int32_t y;
+    // a wl_output_transform
+    int32_t transform;
+    wl_fixed_t scale;
+} WaylandOutputHead;
+
+typedef void (*WaylandOutputConfigFunc)(gpointer data);
+
+// Starts tracking `manager`.
+// `heads_changed` is called after the compositor finished describing a change
+// to the heads, `layouts_changed` after a layout was saved.
+WaylandOutputConfig *wayland_output_config_new(
+    struct wl_display *display, struct zwlr_output_manager_v1 *manager,
+    WaylandOutputConfigFunc heads_changed,
+    WaylandOutputConfigFunc layouts_changed, gpointer data);
+
+// Returns the current mode of `head` or NULL if it is disabled.
+const WaylandOutputMode *wayland_output_head_get_current_mode(
+    WaylandOutputHead *head);
+
+// Returns the names of the saved layouts, free with g_strfreev.
+gchar **wayland_output_config_list_layouts(WaylandOutputConfig *self);
+
+// Saves the current state of every head as the layout `name`, replacing any
+// layout of that name.
+gboolean wayland_output_config_save_layout(WaylandOutputConfig *self,
+                                           const char *name);
+
+// Tests the layout `name` and applies it if the compositor accepts it.
+// Heads the layout does not know keep their current state.
+// Returns FALSE if there is no such layout, the outcome of the test and apply
+// is only logged.
+gboolean wayland_output_config_apply_layout(WaylandOutputConfig *self,
+                                            const char *name);
@@ -0,0 +1,170 @@
+#include "toplevel_matcher.h"
+
+#include <adwaita.h>
+
+// tokens of a compiled pattern, anything else is a literal byte
+#define TOKEN_ANY -1
+#define TOKEN_STAR -2
+#define TOKEN_ACCEPT -3
+
+#define IS_CONTINUATION(c) (((c) & 0xC0) == 0x80)
+
+// Every token of every pattern is one position in the automaton, followed by
+// an accepting position per pattern.
+// A set bit means the input so far matches the pattern up to, not including,
+// that position's token.
+struct _ToplevelMatcher {
+    // 64 bit words per set of positions
+    guint words;
+    // the first position of each pattern, and the one past it when the first
+    // token is a star
+    guint64 *start;
+    guint64 *accept;
+    // positions which stay set on any byte
+    guint64 *star;
+    // star positions and the positions following a '?', which stay set on the
+    // continuation bytes of the character '?' consumed
+    guint64 *hold;
+    // per byte, the positions whose token consumes it
+    guint64 *advance;
+};
+
+// Appends the tokens of `pattern` followed by TOKEN_ACCEPT.
+static void toplevel_matcher_tokenize(GArray *tokens, const char *pattern) {
+    for (const char *p = pattern; *p; p++) {
+        int token;
+
+        if (*p == '*')
+            token = TOKEN_STAR;
+        else if (*p == '?')
+            token = TOKEN_ANY;
+        else if (*p == '\\' && p[1])
+            token = (guchar)*++p;
+        else
+            token = (guchar)*p;
+
+        // runs of stars are one star, which keeps closing over a star a
+        // single shift.
+        if (token == TOKEN_STAR && tokens->len > 0 &&
+            g_array_index(tokens, int, tokens->len - 1) == TOKEN_STAR)
+            continue;
+
+        g_array_append_val(tokens, token);
+    }
+
+    int accept = TOKEN_ACCEPT;
+    g_array_append_val(tokens, accept);
+}
+
+static inline void set_bit(guint64 *set, guint pos) {
+    set[pos / 64] |= (guint64)1 << (pos % 64);
+}
+
+// Also sets the position following each set star position, `set` must not
+// have a star position as its last bit.
+static inline void close_over_stars(const ToplevelMatcher *self,
+                                    guint64 *set) {
+    guint64 carry = 0;
+    for (guint w = 0; w < self->words; w++) {
+        guint64 stars = set[w] & self->star[w];
+        set[w] |= (stars << 1) | carry;
+        carry = stars >> 63;
+    }
+}
+
+ToplevelMatcher *toplevel_matcher_new(gchar **patterns) {
+    ToplevelMatcher *self = g_new0(ToplevelMatcher, 1);
+    GArray *tokens = g_array_new(FALSE, FALSE, sizeof(int));
+    GArray *starts = g_array_new(FALSE, FALSE, sizeof(guint));
+
+    for (gchar **pattern = patterns; pattern && *pattern; pattern++) {
+        if (**pattern == '\0') continue;
+        guint start = tokens->len;
+        g_array_append_val(starts, start);
+        toplevel_matcher_tokenize(tokens, *pattern);
+    }
+
+    self->words = (tokens->len + 63) / 64;
+    self->start = g_new0(guint64, self->words);
+    self->accept = g_new0(guint64, self->words);
+    self->star = g_new0(guint64, self->words);
+    self->hold = g_new0(guint64, self->words);
+    self->advance = g_new0(guint64, 256 * self->words);
+
+    for (guint pos = 0; pos < tokens->len; pos++) {
+        int token = g_array_index(tokens, int, pos);
+
+        switch (token) {
+            case TOKEN_ACCEPT:
+                set_bit(self->accept, pos);
+                break;
+            case TOKEN_STAR:
+                set_bit(self->star, pos);
+                set_bit(self->hold, pos);
+                break;
+            case TOKEN_ANY:
+                // '?' consumes a whole character, its lead byte advances and
+                // the position after it holds through the rest.
+                for (guint c = 0; c < 256; c++)
+                    if (!IS_CONTINUATION(c))
+                        set_bit(&self->advance[c * self->words], pos);
+                set_bit(self->hold, pos + 1);
+                break;
+            default:
+                set_bit(&self->advance[token * self->words], pos);
+                break;
+        }
+    }
+
+    for (guint i = 0; i < starts->len; i++)
+        set_bit(self->start, g_array_index(starts, guint, i));
+    close_over_stars(self, self->start);
+
+    g_debug("toplevel_matcher.c:toplevel_matcher_new(): patterns: %u, "
+            "positions: %u",
+            starts->len, tokens->len);
+
+    g_array_unref(tokens);
+    g_array_unref(starts);
+    return self;
+}
+
+void toplevel_matcher_free(ToplevelMatcher *self) {
+    if (!self) return;
+    g_free(self->start);
+    g_free(self->accept);
+    g_free(self->star);
+    g_free(self->hold);
+    g_free(self->advance);
+    g_free(self);
+}
+
+gboolean toplevel_matcher_match(ToplevelMatcher *self, const char *str) {
+    if (!self || self->words == 0 || !str) return FALSE;
+
+    guint64 *set = g_newa(guint64, self->words);
+    memcpy(set, self->start, self->words * sizeof(guint64));
+
+    for (const guchar *p = (const guchar *)str; *p; p++) {
+        const guint64 *advance = &self->advance[*p * self->words];
+        const guint64 *keep = IS_CONTINUATION(*p) ? self->hold : self->star;
+        guint64 carry = 0;
+        guint64 any = 0;
+
+        for (guint w = 0; w < self->words; w++) {
+            guint64 advanced = set[w] & advance[w];
+            set[w] = (advanced << 1) | carry | (set[w] & keep[w]);
+            carry = advanced >> 63;
+            any |= set[w];
+        }
+
+        // no pattern can match anymore
+        if (!any) return FALSE;
+
+        close_over_stars(self, set);
+    }
+
+    for (guint w = 0; w < self->words; w++)
+        if (set[w] & self->accept[w]) return TRUE;
+    return FALSE;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <adwaita.h>
+
+// Matches strings against a list of glob patterns at once.
+//
+// '*' matches any run of characters, '?' any single character and '\' makes
+// the character following it literal, a pattern without these matches
+// exactly that string.
+// All patterns are compiled into one automaton whose states are simulated as
+// a bit set, so a match costs a few word operations per input character no
+// matter how many patterns there are.
+
+typedef struct _ToplevelMatcher ToplevelMatcher;
+
+// Compiles `patterns`, a NULL terminated array, empty patterns are skipped.
+ToplevelMatcher *toplevel_matcher_new(gchar **patterns);
+
+void toplevel_matcher_free(ToplevelMatcher *self);
+
+// Returns whether `str` matches any of the patterns as a whole.
+gboolean toplevel_matcher_match(ToplevelMatcher *self, const char *str);
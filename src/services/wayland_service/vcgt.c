@@ -0,0 +1,225 @@
+#include "vcgt.h"
+
+#include <adwaita.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define ICC_HEADER_SIZE 128
+#define ICC_TAG_ENTRY_SIZE 12
+// bounds the tag table read, real profiles have a few dozen tags
+#define ICC_MAX_TAGS 1024
+
+#define VCGT_TYPE_TABLE 0
+#define VCGT_TYPE_FORMULA 1
+// entries generated for a formula tag
+#define VCGT_FORMULA_ENTRIES 1024
+
+struct _Vcgt {
+    // entries per channel of `table`
+    int entries;
+    // red, green then blue curves, `entries` each
+    uint16_t *table;
+
+    // ramps resampled for the last requested size and gamma
+    int size;
+    double gamma;
+    uint16_t *ramps;
+};
+
+static uint32_t read_be32(const guchar *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+           ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint16_t read_be16(const guchar *p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+}
+
+// s15Fixed16Number
+static double read_fixed(const guchar *p) {
+    return (int32_t)read_be32(p) / 65536.0;
+}
+
+static gboolean read_at(FILE *f, long offset, void *buf, size_t len) {
+    return fseek(f, offset, SEEK_SET) == 0 && fread(buf, 1, len, f) == len;
+}
+
+// Parses a table type vcgt tag starting at `offset`, `size` bytes long.
+static gboolean vcgt_parse_table(Vcgt *self, FILE *f, long offset,
+                                 uint32_t size) {
+    guchar header[6];
+    if (size < 18 || !read_at(f, offset + 12, header, sizeof(header)))
+        return FALSE;
+
+    int channels = read_be16(header);
+    int entries = read_be16(header + 2);
+    int entry_size = read_be16(header + 4);
+
+    if ((channels != 1 && channels != 3) || entries < 2 ||
+        (entry_size != 1 && entry_size != 2))
+        return FALSE;
+
+    size_t len = (size_t)channels * entries * entry_size;
+    if (18 + len > size) return FALSE;
+
+    guchar *data = g_malloc(len);
+    if (!read_at(f, offset + 18, data, len)) {
+        g_free(data);
+        return FALSE;
+    }
+
+    self->entries = entries;
+    self->table = g_new(uint16_t, 3 * entries);
+
+    // a single channel applies to all three
+    for (int c = 0; c < 3; c++) {
+        const guchar *src =
+            data + (size_t)(channels == 3 ? c : 0) * entries * entry_size;
+        for (int i = 0; i < entries; i++)
+            self->table[c * entries + i] = entry_size == 2
+                                               ? read_be16(src + i * 2)
+                                               : src[i] * 257;
+    }
+
+    g_free(data);
+    return TRUE;
+}
+
+// Parses a formula type vcgt tag into a table of VCGT_FORMULA_ENTRIES.
+static gboolean vcgt_parse_formula(Vcgt *self, FILE *f, long offset,
+                                   uint32_t size) {
+    guchar params[36];
+    if (size < 48 || !read_at(f, offset + 12, params, sizeof(params)))
+        return FALSE;
+
+    self->entries = VCGT_FORMULA_ENTRIES;
+    self->table = g_new(uint16_t, 3 * VCGT_FORMULA_ENTRIES);
+
+    for (int c = 0; c < 3; c++) {
+        double gamma = read_fixed(params + c * 12);
+        double min = read_fixed(params + c * 12 + 4);
+        double max = read_fixed(params + c * 12 + 8);
+
+        for (int i = 0; i < VCGT_FORMULA_ENTRIES; i++) {
+            double x = (double)i / (VCGT_FORMULA_ENTRIES - 1);
+            double v = min + (max - min) * pow(x, gamma);
+            self->table[c * VCGT_FORMULA_ENTRIES + i] =
+                lround(CLAMP(v, 0.0, 1.0) * UINT16_MAX);
+        }
+    }
+
+    return TRUE;
+}
+
+Vcgt *vcgt_load(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        g_warning("vcgt.c:vcgt_load(): %s: %s", path, strerror(errno));
+        return NULL;
+    }
+
+    Vcgt *self = g_new0(Vcgt, 1);
+
+    guchar header[ICC_HEADER_SIZE + 4];
+    if (!read_at(f, 0, header, sizeof(header)) ||
+        memcmp(header + 36, "acsp", 4) != 0) {
+        g_warning("vcgt.c:vcgt_load(): %s: not an ICC profile", path);
+        goto fail;
+    }
+
+    uint32_t profile_size = read_be32(header);
+    uint32_t tags = read_be32(header + ICC_HEADER_SIZE);
+    if (tags > ICC_MAX_TAGS) {
+        g_warning("vcgt.c:vcgt_load(): %s: bad tag count %u", path, tags);
+        goto fail;
+    }
+
+    // walk the tag table one entry at a time, the rest of the profile is
+    // never read.
+    gboolean parsed = FALSE;
+    for (uint32_t i = 0; i < tags && !parsed; i++) {
+        guchar entry[ICC_TAG_ENTRY_SIZE];
+        if (!read_at(f, ICC_HEADER_SIZE + 4 + i * ICC_TAG_ENTRY_SIZE, entry,
+                     sizeof(entry)))
+            break;
+        if (memcmp(entry, "vcgt", 4) != 0) continue;
+
+        uint32_t offset = read_be32(entry + 4);
+        uint32_t size = read_be32(entry + 8);
+        guchar type[12];
+        if ((uint64_t)offset + size > profile_size || size < 12 ||
+            !read_at(f, offset, type, sizeof(type)) ||
+            memcmp(type, "vcgt", 4) != 0)
+            break;
+
+        switch (read_be32(type + 8)) {
+            case VCGT_TYPE_TABLE:
+                parsed = vcgt_parse_table(self, f, offset, size);
+                break;
+            case VCGT_TYPE_FORMULA:
+                parsed = vcgt_parse_formula(self, f, offset, size);
+                break;
+        }
+        if (!parsed) break;
+    }
+
+    if (!parsed) {
+        g_warning("vcgt.c:vcgt_load(): %s: no usable vcgt tag", path);
+        goto fail;
+    }
+
+    fclose(f);
+
+    g_debug("vcgt.c:vcgt_load(): %s: %d entries per channel", path,
+            self->entries);
+
+    return self;
+
+fail:
+    fclose(f);
+    vcgt_free(self);
+    return NULL;
+}
+
+void vcgt_free(Vcgt *self) {
+    if (!self) return;
+    g_free(self->table);
+    g_free(self->ramps);
+    g_free(self);
+}
+
+const uint16_t *vcgt_get_ramps(Vcgt *self, int size, double gamma) {
+    if (self->ramps && self->size == size && self->gamma == gamma)
+        return self->ramps;
+
+    g_free(self->ramps);
+    self->ramps = g_new(uint16_t, 3 * size);
+    self->size = size;
+    self->gamma = gamma;
+
+    // interpolate linearly between the tag's entries, both span the full
+    // input range end to end.
+    double step = size > 1 ? (double)(self->entries - 1) / (size - 1) : 0.0;
+
+    for (int c = 0; c < 3; c++) {
+        const uint16_t *table = &self->table[c * self->entries];
+        uint16_t *ramp = &self->ramps[c * size];
+
+        for (int i = 0; i < size; i++) {
+            double pos = i * step;
+            int lo = MIN((int)pos, self->entries - 2);
+            double a = pos - lo;
+            double v = (table[lo] * (1.0 - a) + table[lo + 1] * a) /
+                       (UINT16_MAX + 1);
+
+            if (gamma != 1.0) v = pow(v, 1.0 / gamma);
+
+            long q = lround(v * (UINT16_MAX + 1));
+            ramp[i] = q > UINT16_MAX ? UINT16_MAX : q;
+        }
+    }
+
+    return self->ramps;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <adwaita.h>
+#include <stdint.h>
+
+// The video card gamma table of an ICC profile, the calibration curves a
+// profile expects to be loaded into the display's gamma ramps.
+//
+// Only the header, the tag table and the vcgt tag itself are read from the
+// profile, once when loading it.
+// Ramps for a controller are resampled from the tag on first use and cached,
+// a temperature change only scales the cached ramps again.
+
+typedef struct _Vcgt Vcgt;
+
+// Reads the vcgt tag of the ICC profile at `path`.
+// Returns NULL, after logging why, if the file is no ICC profile or has no
+// usable vcgt tag.
+Vcgt *vcgt_load(const char *path);
+
+void vcgt_free(Vcgt *self);
+
+// Returns the red, green and blue calibration ramps of `size` entries each,
+// back to back, with `gamma` applied as colorramp_fill_profile would.
+// The ramps are owned by `self` and valid until it is asked for a different
+// size or gamma.
+const uint16_t *vcgt_get_ramps(Vcgt *self, int size, double gamma);
@@ -0,0 +1,202 @@
+#include "wayland_event_thread.h"
+
+#include <adwaita.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <wayland-client.h>
+
+// must be a power of two
+#define WAYLAND_EVENT_RING_SIZE 4096
+#define WAYLAND_EVENT_RING_MASK (WAYLAND_EVENT_RING_SIZE - 1)
+
+struct _WaylandEventThread {
+    struct wl_display *display;
+    struct wl_event_queue *queue;
+    GThread *thread;
+
+    // single producer, single consumer ring.
+    // head is only written by the thread and tail only by the main loop, each
+    // is published with a barrier after the slot it covers is written or
+    // read.
+    WaylandEventRecord ring[WAYLAND_EVENT_RING_SIZE];
+    gint head;
+    gint tail;
+
+    // eventfd waking the main loop, `wake_pending` avoids a write per record
+    // while the main loop has not caught up.
+    int wake_fd;
+    gint wake_pending;
+
+    // eventfd the thread blocks on while the ring is full, written by the
+    // main loop's next pop only when `space_waiting` is set.
+    int space_fd;
+    gint space_waiting;
+};
+
+static void wayland_event_thread_wake(WaylandEventThread *self) {
+    if (!g_atomic_int_compare_and_exchange(&self->wake_pending, 0, 1)) return;
+
+    uint64_t one = 1;
+    if (write(self->wake_fd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+        g_warning("wayland_event_thread.c:wayland_event_thread_wake(): %s",
+                  strerror(errno));
+}
+
+void wayland_event_thread_push(WaylandEventThread *self,
+                               const WaylandEventRecord *record) {
+    guint head = (guint)self->head;
+
+    // the main loop is behind by a whole ring, let it catch up rather than
+    // drop events.
+    // `space_waiting` is raised before the ring is checked again, so either
+    // the check sees the pop or the pop sees the flag and signals.
+    while (head - (guint)g_atomic_int_get(&self->tail) ==
+           WAYLAND_EVENT_RING_SIZE) {
+        g_atomic_int_set(&self->space_waiting, 1);
+        if (head - (guint)g_atomic_int_get(&self->tail) !=
+            WAYLAND_EVENT_RING_SIZE)
+            break;
+
+        wayland_event_thread_wake(self);
+
+        struct pollfd pfd = {.fd = self->space_fd, .events = POLLIN};
+        if (poll(&pfd, 1, -1) == -1 && errno != EINTR)
+            g_warning("wayland_event_thread.c:wayland_event_thread_push(): %s",
+                      strerror(errno));
+
+        uint64_t count;
+        if (read(self->space_fd, &count, sizeof(count)) == -1 &&
+            errno != EAGAIN)
+            g_warning("wayland_event_thread.c:wayland_event_thread_push(): %s",
+                      strerror(errno));
+    }
+    g_atomic_int_set(&self->space_waiting, 0);
+
+    self->ring[head & WAYLAND_EVENT_RING_MASK] = *record;
+    g_atomic_int_set(&self->head, (gint)(head + 1));
+
+    wayland_event_thread_wake(self);
+}
+
+gboolean wayland_event_thread_pop(WaylandEventThread *self,
+                                  WaylandEventRecord *record) {
+    guint tail = (guint)self->tail;
+
+    if (tail == (guint)g_atomic_int_get(&self->head)) return FALSE;
+
+    *record = self->ring[tail & WAYLAND_EVENT_RING_MASK];
+    g_atomic_int_set(&self->tail, (gint)(tail + 1));
+
+    // the thread is blocked on a full ring
+    if (g_atomic_int_compare_and_exchange(&self->space_waiting, 1, 0)) {
+        uint64_t one = 1;
+        if (write(self->space_fd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+            g_warning("wayland_event_thread.c:wayland_event_thread_pop(): %s",
+                      strerror(errno));
+    }
+    return TRUE;
+}
+
+void wayland_event_thread_ack(WaylandEventThread *self) {
+    uint64_t count;
+    if (read(self->wake_fd, &count, sizeof(count)) == -1 && errno != EAGAIN)
+        g_warning("wayland_event_thread.c:wayland_event_thread_ack(): %s",
+                  strerror(errno));
+
+    // cleared before the caller pops, anything pushed from here on wakes the
+    // main loop again.
+    g_atomic_int_set(&self->wake_pending, 0);
+}
+
+static gpointer wayland_event_thread_run(gpointer data) {
+    WaylandEventThread *self = data;
+    struct pollfd pfd = {
+        .fd = wl_display_get_fd(self->display),
+        .events = POLLIN,
+    };
+    int error = 0;
+
+    // requests are only flushed by the main loop, so a proxy created there
+    // gets its listener before any event for it can be read here.
+    while (!error) {
+        while (wl_display_prepare_read_queue(self->display, self->queue) != 0)
+            wl_display_dispatch_queue_pending(self->display, self->queue);
+
+        if (poll(&pfd, 1, -1) == -1) {
+            wl_display_cancel_read(self->display);
+            if (errno != EINTR) error = errno;
+            continue;
+        }
+
+        if (pfd.revents & (POLLERR | POLLHUP)) {
+            wl_display_cancel_read(self->display);
+            error = EPIPE;
+            continue;
+        }
+
+        if (wl_display_read_events(self->display) == -1) {
+            error = wl_display_get_error(self->display);
+            if (!error) error = EIO;
+            continue;
+        }
+
+        wl_display_dispatch_queue_pending(self->display, self->queue);
+
+        // the read may have queued events on the default queue too, which
+        // only the main loop dispatches.
+        if (wl_display_prepare_read(self->display) == 0)
+            wl_display_cancel_read(self->display);
+        else
+            wayland_event_thread_wake(self);
+    }
+
+    // the main loop tears the service down once it pops this, rather than
+    // the whole process aborting here.
+    wayland_event_thread_push(
+        self, &(WaylandEventRecord){.type = WAYLAND_EVENT_DISCONNECTED,
+                                    .error = error});
+
+    return NULL;
+}
+
+WaylandEventThread *wayland_event_thread_new(struct wl_display *display) {
+    WaylandEventThread *self = g_new0(WaylandEventThread, 1);
+
+    self->display = display;
+    self->queue = wl_display_create_queue(display);
+
+    self->wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (self->wake_fd == -1) {
+        g_error("wayland_event_thread.c:wayland_event_thread_new(): %s",
+                strerror(errno));
+    }
+
+    self->space_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (self->space_fd == -1) {
+        g_error("wayland_event_thread.c:wayland_event_thread_new(): %s",
+                strerror(errno));
+    }
+
+    self->thread =
+        g_thread_new("wayland-events", wayland_event_thread_run, self);
+
+    return self;
+}
+
+struct wl_event_queue *wayland_event_thread_get_queue(
+    WaylandEventThread *self) {
+    return self->queue;
+}
+
+int wayland_event_thread_get_wake_fd(WaylandEventThread *self) {
+    return self->wake_fd;
+}
+
+void wayland_event_thread_free(WaylandEventThread *self) {
+    g_thread_join(self->thread);
+    close(self->wake_fd);
+    close(self->space_fd);
+    g_free(self);
+}
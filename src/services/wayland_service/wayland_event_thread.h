@@ -0,0 +1,83 @@
+#pragma once
+
+#include <adwaita.h>
+#include <wayland-client.h>
+
+// Reads the Wayland socket on a dedicated thread and dispatches a private
+// wl_event_queue there.
+//
+// Listeners of objects on the private queue run on the thread. They fold
+// their events into thread owned state and hand the main loop compact
+// WaylandEventRecords, which it pops and applies after being woken through the
+// wake fd.
+// Events for the default queue are read by the thread as well, the main loop
+// is woken to dispatch those with wl_display_dispatch_pending.
+
+enum WaylandEventType {
+    WAYLAND_EVENT_TOPLEVEL_NEW,
+    // a toplevel's done, carrying every change since its previous one
+    WAYLAND_EVENT_TOPLEVEL_DONE,
+    WAYLAND_EVENT_TOPLEVEL_CLOSED,
+    WAYLAND_EVENT_GAMMA_SIZE,
+    WAYLAND_EVENT_GAMMA_FAILED,
+    // the thread lost the connection and stopped, always the last record
+    WAYLAND_EVENT_DISCONNECTED,
+};
+
+typedef struct _WaylandEventRecord {
+    enum WaylandEventType type;
+    // the serial of the object the event was received for, and the proxy it
+    // was received on.
+    // A proxy destroyed while its records are queued can have its address
+    // reused by a new one, a record only applies to an object holding the
+    // same serial.
+    uint32_t serial;
+    void *proxy;
+    union {
+        // WAYLAND_EVENT_TOPLEVEL_DONE
+        struct {
+            // owned by the record, NULL unless changed
+            char *title;
+            char *app_id;
+            // WaylandWLRForeignTopLevelChange bits
+            uint32_t changed;
+            gboolean entered;
+            gboolean activated;
+        } toplevel;
+        // WAYLAND_EVENT_GAMMA_SIZE
+        uint32_t gamma_size;
+        // WAYLAND_EVENT_DISCONNECTED, errno of the failure
+        int error;
+    };
+} WaylandEventRecord;
+
+typedef struct _WaylandEventThread WaylandEventThread;
+
+// Starts reading `display` on a new thread.
+WaylandEventThread *wayland_event_thread_new(struct wl_display *display);
+
+// Joins the thread and frees it, only called once WAYLAND_EVENT_DISCONNECTED
+// was popped.
+void wayland_event_thread_free(WaylandEventThread *self);
+
+// The queue dispatched by the thread.
+// Proxies are best placed on it with a wrapper at creation, see
+// wl_proxy_create_wrapper, so none of their events reach the default queue.
+struct wl_event_queue *wayland_event_thread_get_queue(WaylandEventThread *self);
+
+// Readable whenever records or default queue events are waiting for the main
+// loop.
+int wayland_event_thread_get_wake_fd(WaylandEventThread *self);
+
+// Called by the main loop when the wake fd is readable, before popping.
+void wayland_event_thread_ack(WaylandEventThread *self);
+
+// Queues `record` for the main loop, only called from the thread.
+// Blocks while the ring is full, until the main loop pops.
+void wayland_event_thread_push(WaylandEventThread *self,
+                               const WaylandEventRecord *record);
+
+// Pops the oldest record into `record`, only called from the main loop.
+// Returns FALSE when there are none.
+gboolean wayland_event_thread_pop(WaylandEventThread *self,
+                                  WaylandEventRecord *record);
@@ -1,12 +1,17 @@
+// memfd_create
+#define _GNU_SOURCE
+
 #include "wayland_service.h"
 
 #include <adwaita.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <gdk/wayland/gdkwayland.h>
 #include <glib-2.0/glib-unix.h>
 #include <sys/cdefs.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/timerfd.h>
 #include <unistd.h>
 #include <wayland-client-core.h>
 #include <wayland-client-protocol.h>
@@ -14,7 +19,12 @@
 
 #include "./wlr-foreign-toplevel-management-unstable-v1.h"
 #include "./wlr-gamma-control-unstable-v1.h"
+#include "./wlr-output-management-unstable-v1.h"
 #include "colorramp.h"
+#include "night_light_schedule.h"
+#include "output_config.h"
+#include "toplevel_matcher.h"
+#include "wayland_event_thread.h"
 
 static WaylandService *global = NULL;
 
@@ -25,6 +35,9 @@ enum signals {
     output_removed,
     gamma_control_enabled,
     gamma_control_disabled,
+    night_light_schedule_changed,
+    output_heads_changed,
+    output_layouts_changed,
     signals_n
 };
 
@@ -40,9 +53,21 @@ struct _WaylandService {
     // wayland registry
     struct wl_registry *registry;
 
+    // reads the display and dispatches foreign toplevel and gamma control
+    // events off the main loop
+    WaylandEventThread *events;
+    // serials given to new toplevels, only used by the event thread, and to
+    // new gamma controls, only used by the main loop.
+    uint32_t toplevel_serial;
+    uint32_t gamma_serial;
+
     // wlr gamma control manager for adjusting gamma
     struct zwlr_gamma_control_manager_v1 *gamma_control_manager;
 
+    // heads and saved layouts of zwlr_output_manager_v1, NULL if the
+    // compositor does not support it
+    WaylandOutputConfig *output_config;
+
     // keyboard short inhibitor
     gboolean shortcuts_inhitibed;
     GdkToplevel *shorcuts_inhibited_toplevel;
@@ -65,22 +90,57 @@ struct _WaylandService {
     gboolean gamma_control_enabled;
     // List of created gamma controllers
     GHashTable *gamma_controllers;
+    // WaylandGammaPool structs mapped to wl_output pointers
+    GHashTable *gamma_pools;
+    // WaylandGammaProfile structs mapped to output names, outputs without
+    // one use wayland_gamma_default_profile.
+    GHashTable *gamma_profiles;
+    // Vcgt calibrations mapped to output names, loaded from the ICC profiles
+    // of the output-calibrations key.
+    GHashTable *gamma_calibrations;
+    // pending write of gamma_profiles to settings, see
+    // wayland_gamma_profiles_changed.
+    guint gamma_store_id;
     // The last seen temperature
     double temperature;
+    // Monitors org.ldelossa.way-shell.night-light for the transition length
+    // and schedule
+    GSettings *night_light_settings;
+    // timerfd armed on CLOCK_REALTIME for the next scheduled transition, it
+    // also fires when the clock is set so the schedule can be re-evaluated.
+    int schedule_fd;
+    guint schedule_source_id;
+    // unix time of the next scheduled transition, 0 when unscheduled.
+    gint64 schedule_next;
+    gboolean schedule_next_night;
 
     // Monitors org.ldelossa.way-shell.window-manager.ignored-toplevels-app-ids
     // and org.ldelossa.way-shell.window-manager.ignored-toplevels-titles
     GSettings *settings;
-    GHashTable *ignored_toplevel_app_ids;
-    GHashTable *ignored_toplevel_titles;
+    ToplevelMatcher *ignored_toplevel_app_ids;
+    ToplevelMatcher *ignored_toplevel_titles;
+    // bumped whenever either matcher is rebuilt, toplevels evaluated against
+    // an older generation are evaluated again.
+    guint ignored_toplevels_generation;
 };
 
 static guint service_signals[signals_n] = {0};
 
 G_DEFINE_TYPE(WaylandService, wayland_service, G_TYPE_OBJECT);
 
+static void wayland_gamma_profiles_store(WaylandService *self);
+
 // stub out dispose, finalize, class_init, and init methods for this GObject
 static void wayland_service_dispose(GObject *gobject) {
+    WaylandService *self = WAYLAND_SERVICE(gobject);
+
+    // don't lose a brightness change still waiting to be saved
+    if (self->gamma_store_id) {
+        g_source_remove(self->gamma_store_id);
+        self->gamma_store_id = 0;
+        wayland_gamma_profiles_store(self);
+    }
+
     // Chain-up
     G_OBJECT_CLASS(wayland_service_parent_class)->dispose(gobject);
 };
@@ -97,7 +157,8 @@ static void wayland_service_class_init(WaylandServiceClass *klass) {
 
     service_signals[top_level_changed] = g_signal_new(
         "top-level-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST, 0,
-        NULL, NULL, NULL, G_TYPE_NONE, 2, G_TYPE_HASH_TABLE, G_TYPE_POINTER);
+        NULL, NULL, NULL, G_TYPE_NONE, 3, G_TYPE_HASH_TABLE, G_TYPE_POINTER,
+        G_TYPE_UINT);
 
     service_signals[top_level_removed] = g_signal_new(
         "top-level-removed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST, 0,
@@ -118,20 +179,67 @@ static void wayland_service_class_init(WaylandServiceClass *klass) {
     service_signals[gamma_control_disabled] =
         g_signal_new("gamma-control-disabled", G_TYPE_FROM_CLASS(klass),
                      G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+
+    service_signals[night_light_schedule_changed] = g_signal_new(
+        "night-light-schedule-changed", G_TYPE_FROM_CLASS(klass),
+        G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+
+    service_signals[output_heads_changed] = g_signal_new(
+        "output-heads-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_FIRST,
+        0, NULL, NULL, NULL, G_TYPE_NONE, 0);
+
+    service_signals[output_layouts_changed] = g_signal_new(
+        "output-layouts-changed", G_TYPE_FROM_CLASS(klass),
+        G_SIGNAL_RUN_FIRST, 0, NULL, NULL, NULL, G_TYPE_NONE, 0);
 };
 
-gboolean on_fd_read(gint fd, GIOCondition condition, gpointer user_data) {
-    g_debug("wayland_service.c:on_fd_read(): fd: %d, condition: %d", fd,
+static void wayland_event_apply(WaylandService *self,
+                                WaylandEventRecord *record);
+
+// The event thread lost the compositor connection. Stops the thread and the
+// gamma transitions, nothing is read or dispatched on the display after this.
+static void wayland_service_disconnected(WaylandService *self, int error) {
+    GHashTableIter iter;
+    WaylandWLRGammaControl *ctrl = NULL;
+
+    g_warning("wayland_service.c:wayland_service_disconnected(): %s",
+              strerror(error));
+
+    wayland_event_thread_free(self->events);
+    self->events = NULL;
+
+    g_hash_table_iter_init(&iter, self->gamma_controllers);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&ctrl)) {
+        if (!ctrl->tick_id) continue;
+        g_source_remove(ctrl->tick_id);
+        ctrl->tick_id = 0;
+    }
+}
+
+gboolean on_events_ready(gint fd, GIOCondition condition, gpointer user_data) {
+    g_debug("wayland_service.c:on_events_ready(): fd: %d, condition: %d", fd,
             condition);
 
     WaylandService *self = (WaylandService *)user_data;
-    if (condition & (G_IO_ERR | G_IO_HUP)) {
-        g_error("Wayland socket error");
+    gint64 start = g_get_monotonic_time();
+    guint applied = 0;
+
+    wayland_event_thread_ack(self->events);
+
+    // apply what the event thread decoded
+    WaylandEventRecord record;
+    while (wayland_event_thread_pop(self->events, &record)) {
+        if (record.type == WAYLAND_EVENT_DISCONNECTED) {
+            wayland_service_disconnected(self, record.error);
+            return G_SOURCE_REMOVE;
+        }
+        wayland_event_apply(self, &record);
+        applied++;
     }
 
-    // wl_display_dispatch will both read from the socket and then dispatch
-    // messages from the default queue to listeners
-    if (wl_display_dispatch(self->display) == -1) {
+    // the event thread reads the socket, only dispatch what it queued on the
+    // default queue.
+    if (wl_display_dispatch_pending(self->display) == -1) {
         g_error("Wayland dispatch failed");
     }
 
@@ -141,26 +249,12 @@ gboolean on_fd_read(gint fd, GIOCondition condition, gpointer user_data) {
     while (ret == -1 && errno == EAGAIN) ret = wl_display_flush(self->display);
     if (ret == -1) g_error("Wayland flush failed");
 
-    return TRUE;
-}
-
-static void toplevel_handle_title(
-    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
-    const char *title) {
-    g_debug("wayland_service.c:toplevel_handle_title(): title: %s", title);
-
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *top_level =
-        g_hash_table_lookup(self->toplevels, handle);
-
-    if (!top_level) {
-        return;
-    }
-
-    top_level->title = g_strdup(title);
+    g_debug(
+        "wayland_service.c:on_events_ready(): applied %u records, main loop "
+        "busy %" G_GINT64_FORMAT "us",
+        applied, g_get_monotonic_time() - start);
 
-    g_debug("wayland_service.c:toplevel_handle_title(): top_level->title: %s",
-            top_level->title);
+    return TRUE;
 }
 
 static void seat_listener_capabilities(void *data, struct wl_seat *seat,
@@ -187,40 +281,28 @@ static const struct wl_seat_listener seat_listener = {
     .name = seat_listener_name,
 };
 
-static void toplevel_handle_app_id(
-    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
-    const char *app_id) {
-    g_debug("wayland_service.c:toplevel_handle_app_id(): app_id: %s", app_id);
-
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *top_level =
-        g_hash_table_lookup(self->toplevels, handle);
-
-    if (!top_level) {
-        return;
-    }
-
-    top_level->app_id = g_strdup(app_id);
-
-    g_debug("wayland_service.c:toplevel_handle_app_id(): top_level->app_id: %s",
-            top_level->app_id);
+// Returns whether `toplevel` matches the ignored app ids or titles.
+// The verdict is cached on the toplevel and only evaluated again when its
+// title or app id changed since, or the patterns did.
+static gboolean wayland_toplevel_ignored(WaylandService *self,
+                                         WaylandWLRForeignTopLevel *toplevel) {
+    if (toplevel->ignored_generation == self->ignored_toplevels_generation &&
+        !(toplevel->changed & (TOPLEVEL_CHANGE_TITLE | TOPLEVEL_CHANGE_APP_ID)))
+        return toplevel->ignored;
+
+    toplevel->ignored =
+        toplevel_matcher_match(self->ignored_toplevel_app_ids,
+                               toplevel->app_id) ||
+        toplevel_matcher_match(self->ignored_toplevel_titles, toplevel->title);
+    toplevel->ignored_generation = self->ignored_toplevels_generation;
+
+    return toplevel->ignored;
 }
 
-static void toplevel_handle_closed(
-    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
-    g_debug(
-        "wayland_service.c:toplevel_handle_closed(): toplevel handle closed");
-
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *toplevel =
-        g_hash_table_lookup(self->toplevels, handle);
-
-    if (!toplevel) {
-        return;
-    }
-
+static void toplevel_apply_closed(WaylandService *self,
+                                  WaylandWLRForeignTopLevel *toplevel) {
     g_debug(
-        "wayland_service.c:toplevel_handle_closed(): toplevel->app_id: %s, "
+        "wayland_service.c:toplevel_apply_closed(): toplevel->app_id: %s, "
         "toplevel->title: %s",
         toplevel->app_id, toplevel->title);
 
@@ -228,23 +310,15 @@ static void toplevel_handle_closed(
     // rest of Way-Shell, so no reason to signal its removal.
     if (!toplevel->app_id || !toplevel->title) goto remove;
 
-    gboolean ignored = false;
-    ignored =
-        g_hash_table_contains(self->ignored_toplevel_app_ids, toplevel->app_id);
-
-    if (!ignored)
-        ignored = g_hash_table_contains(self->ignored_toplevel_titles,
-                                        toplevel->title);
-
-    if (!ignored)
+    if (!wayland_toplevel_ignored(self, toplevel))
         g_signal_emit(self, service_signals[top_level_removed], 0, toplevel);
 
 remove:
     // remove it from our inventory
-    g_hash_table_remove(self->toplevels, handle);
+    g_hash_table_remove(self->toplevels, toplevel->toplevel);
 
     // destroy the proxy at the Wayland server.
-    zwlr_foreign_toplevel_handle_v1_destroy(handle);
+    zwlr_foreign_toplevel_handle_v1_destroy(toplevel->toplevel);
 
     // free any memory we alloc'd
     g_free(toplevel->app_id);
@@ -252,113 +326,195 @@ remove:
     g_free(toplevel);
 }
 
-static void toplevel_handle_done(
-    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
-    g_debug("wayland_service.c:toplevel_handle_done(): toplevel handle done");
-
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *toplevel =
-        g_hash_table_lookup(self->toplevels, handle);
-
-    if (!toplevel) {
-        return;
+// Applies the changes the event thread folded up to a toplevel's done, taking
+// the record's strings.
+static void toplevel_apply_done(WaylandService *self,
+                                WaylandWLRForeignTopLevel *toplevel,
+                                WaylandEventRecord *record) {
+    if (record->toplevel.changed & TOPLEVEL_CHANGE_TITLE) {
+        g_free(toplevel->title);
+        toplevel->title = g_steal_pointer(&record->toplevel.title);
     }
+    if (record->toplevel.changed & TOPLEVEL_CHANGE_APP_ID) {
+        g_free(toplevel->app_id);
+        toplevel->app_id = g_steal_pointer(&record->toplevel.app_id);
+    }
+    toplevel->entered = record->toplevel.entered;
+    toplevel->activated = record->toplevel.activated;
+    toplevel->changed = record->toplevel.changed;
 
     // debug toplevel details
     g_debug(
-        "wayland_service.c:toplevel_handle_done(): toplevel->app_id: %s, "
-        "toplevel->title: %s, toplevel->entered: %d, toplevel->activated: %d",
+        "wayland_service.c:toplevel_apply_done(): toplevel->app_id: %s, "
+        "toplevel->title: %s, toplevel->entered: %d, toplevel->activated: %d, "
+        "toplevel->changed: %x",
         toplevel->app_id, toplevel->title, toplevel->entered,
-        toplevel->activated);
+        toplevel->activated, toplevel->changed);
 
     // if we don't have a valid app_id and title, don't bother signaling this
     // toplevel, the rest of Way-Shell expects these fields.
     if (!toplevel->app_id || !toplevel->title) goto reset;
 
-    gboolean ignored = false;
-    ignored =
-        g_hash_table_contains(self->ignored_toplevel_app_ids, toplevel->app_id);
+    if (wayland_toplevel_ignored(self, toplevel)) goto reset;
 
-    if (!ignored)
-        ignored = g_hash_table_contains(self->ignored_toplevel_titles,
-                                        toplevel->title);
+    guint changed = toplevel->changed;
+    if (!toplevel->advertised) changed = TOPLEVEL_CHANGE_ALL;
+    toplevel->advertised = TRUE;
 
-    if (!ignored)
+    if (changed)
         g_signal_emit(self, service_signals[top_level_changed], 0,
-                      self->toplevels, toplevel);
+                      self->toplevels, toplevel, changed);
 
 reset:
     // reset bools after handlers read event
     toplevel->entered = FALSE;
     toplevel->activated = FALSE;
+    toplevel->changed = 0;
 }
 
-static void toplevel_handle_output_enter(
+static void toplevel_apply_new(WaylandService *self,
+                               WaylandEventRecord *record) {
+    g_debug("wayland_service.c:toplevel_apply_new(): new toplevel handle");
+
+    WaylandWLRForeignTopLevel *toplevel = g_new0(WaylandWLRForeignTopLevel, 1);
+    toplevel->header.type = WL_REGISTRY;
+    toplevel->header.serial = record->serial;
+    toplevel->toplevel = record->proxy;
+
+    g_hash_table_insert(self->toplevels, toplevel->toplevel, toplevel);
+}
+
+// A toplevel handle as seen by the event thread, the handle's listener data.
+// Its events are folded in here and handed to the main loop as one record on
+// done, so a burst of title changes costs the main loop a record per done
+// rather than one per event, and a done changing nothing costs it nothing.
+typedef struct _WaylandToplevelPending {
+    WaylandService *service;
+    uint32_t serial;
+    // current values, only sent when changed
+    char *title;
+    char *app_id;
+    gboolean entered;
+    gboolean activated;
+    // WaylandWLRForeignTopLevelChange bits since the last done
+    guint changed;
+} WaylandToplevelPending;
+
+// Listeners below run on the event thread.
+
+static void toplevel_handle_title(
     void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
-    struct wl_output *output) {
-    g_debug(
-        "wayland_service.c:toplevel_handle_output_enter(): toplevel handle "
-        "output enter");
+    const char *title) {
+    WaylandToplevelPending *pending = data;
 
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *top_level =
-        g_hash_table_lookup(self->toplevels, handle);
+    if (g_strcmp0(pending->title, title) == 0) return;
 
-    if (!top_level) {
-        return;
-    }
+    g_free(pending->title);
+    pending->title = g_strdup(title);
+    pending->changed |= TOPLEVEL_CHANGE_TITLE;
+}
+
+static void toplevel_handle_app_id(
+    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+    const char *app_id) {
+    WaylandToplevelPending *pending = data;
 
-    top_level->entered = TRUE;
+    if (g_strcmp0(pending->app_id, app_id) == 0) return;
+
+    g_free(pending->app_id);
+    pending->app_id = g_strdup(app_id);
+    pending->changed |= TOPLEVEL_CHANGE_APP_ID;
 }
 
-static void toplevel_handle_output_leave(
+static void toplevel_handle_output_enter(
     void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
     struct wl_output *output) {
-    g_debug(
-        "wayland_service.c:toplevel_handle_output_leave(): toplevel handle "
-        "output leave");
+    WaylandToplevelPending *pending = data;
 
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *top_level =
-        g_hash_table_lookup(self->toplevels, handle);
+    pending->entered = TRUE;
+    pending->changed |= TOPLEVEL_CHANGE_OUTPUT;
+}
 
-    if (!top_level) {
-        return;
-    }
+static void toplevel_handle_output_leave(
+    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
+    struct wl_output *output) {
+    WaylandToplevelPending *pending = data;
 
-    top_level->entered = FALSE;
+    pending->entered = FALSE;
+    pending->changed |= TOPLEVEL_CHANGE_OUTPUT;
 }
 
 static void toplevel_handle_parent(
     void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
     struct zwlr_foreign_toplevel_handle_v1 *parent) {
-    g_debug(
-        "wayland_service.c:toplevel_handle_parent(): toplevel handle parent");
 }
 
 static void toplevel_handle_state(
     void *data, struct zwlr_foreign_toplevel_handle_v1 *handle,
     struct wl_array *state) {
-    g_debug("wayland_service.c:toplevel_handle_state(): toplevel handle state");
+    WaylandToplevelPending *pending = data;
 
-    WaylandService *self = (WaylandService *)data;
-    WaylandWLRForeignTopLevel *top_level =
-        g_hash_table_lookup(self->toplevels, handle);
-
-    if (!top_level) {
-        return;
-    }
+    // the compositor only sends state when it changed
+    pending->changed |= TOPLEVEL_CHANGE_STATE;
 
     // check if activated
-    top_level->activated = FALSE;
-    for (size_t i = 0; i < state->size; i++) {
-        uint32_t *state_ptr = (uint32_t *)state->data + i;
-        if (*state_ptr == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED) {
-            top_level->activated = TRUE;
-        }
+    pending->activated = FALSE;
+    uint32_t *s;
+    wl_array_for_each(s, state) {
+        if (*s == ZWLR_FOREIGN_TOPLEVEL_HANDLE_V1_STATE_ACTIVATED)
+            pending->activated = TRUE;
     }
 }
 
+static void toplevel_handle_done(
+    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    WaylandToplevelPending *pending = data;
+
+    // e.g. a title set to the one it had, a toplevel skipped by the ignore
+    // patterns is evaluated again on its next change.
+    if (!pending->changed) return;
+
+    guint changed = pending->changed;
+    WaylandEventRecord record = {
+        .type = WAYLAND_EVENT_TOPLEVEL_DONE,
+        .proxy = handle,
+        .serial = pending->serial,
+        .toplevel =
+            {
+                .title = changed & TOPLEVEL_CHANGE_TITLE
+                             ? g_strdup(pending->title)
+                             : NULL,
+                .app_id = changed & TOPLEVEL_CHANGE_APP_ID
+                              ? g_strdup(pending->app_id)
+                              : NULL,
+                .changed = changed,
+                .entered = pending->entered,
+                .activated = pending->activated,
+            },
+    };
+    wayland_event_thread_push(pending->service->events, &record);
+
+    pending->entered = FALSE;
+    pending->activated = FALSE;
+    pending->changed = 0;
+}
+
+static void toplevel_handle_closed(
+    void *data, struct zwlr_foreign_toplevel_handle_v1 *handle) {
+    WaylandToplevelPending *pending = data;
+
+    wayland_event_thread_push(
+        pending->service->events,
+        &(WaylandEventRecord){.type = WAYLAND_EVENT_TOPLEVEL_CLOSED,
+                              .proxy = handle,
+                              .serial = pending->serial});
+
+    // no event follows closed, the main loop destroys the handle.
+    g_free(pending->title);
+    g_free(pending->app_id);
+    g_free(pending);
+}
+
 static const struct zwlr_foreign_toplevel_handle_v1_listener
     toplevel_handle_listener = {
         .title = toplevel_handle_title,
@@ -371,22 +527,25 @@ static const struct zwlr_foreign_toplevel_handle_v1_listener
         .parent = toplevel_handle_parent,
 };
 
+// The listener is added here so the handle's own events, which follow in the
+// same read, are folded in too.
 static void toplevel_mgr_new_toplevel(
     void *data, struct zwlr_foreign_toplevel_manager_v1 *mgr,
     struct zwlr_foreign_toplevel_handle_v1 *wayland_toplevel) {
-    g_debug(
-        "wayland_service.c:toplevel_mgr_new_toplevel(): new toplevel handle");
-
     WaylandService *self = (WaylandService *)data;
 
-    WaylandWLRForeignTopLevel *toplevel = g_new0(WaylandWLRForeignTopLevel, 1);
-    toplevel->header.type = WL_REGISTRY;
-    toplevel->toplevel = wayland_toplevel;
-
-    g_hash_table_insert(self->toplevels, wayland_toplevel, toplevel);
+    WaylandToplevelPending *pending = g_new0(WaylandToplevelPending, 1);
+    pending->service = self;
+    pending->serial = ++self->toplevel_serial;
 
     zwlr_foreign_toplevel_handle_v1_add_listener(
-        wayland_toplevel, &toplevel_handle_listener, self);
+        wayland_toplevel, &toplevel_handle_listener, pending);
+
+    wayland_event_thread_push(
+        self->events,
+        &(WaylandEventRecord){.type = WAYLAND_EVENT_TOPLEVEL_NEW,
+                              .proxy = wayland_toplevel,
+                              .serial = pending->serial});
 }
 
 static void toplevel_mgr_finished(
@@ -417,7 +576,12 @@ static void wl_output_handle_description(void *data, struct wl_output *output,
         output_data->desc);
 }
 
-void wayland_wlr_bluelight_filter(WaylandService *self, double temperature);
+static void wayland_gamma_update(WaylandService *self);
+static void on_output_profiles_changed(GSettings *settings, gchar *key,
+                                       WaylandService *self);
+static void on_output_calibrations_changed(GSettings *settings, gchar *key,
+                                           WaylandService *self);
+static void wayland_night_light_schedule_init(WaylandService *self);
 
 static void wl_output_handle_done(void *data, struct wl_output *output) {
     g_debug("wayland_service.c:wl_output_handle_done(): output done");
@@ -431,10 +595,8 @@ static void wl_output_handle_done(void *data, struct wl_output *output) {
 
     output_data->initialized = TRUE;
 
-    // if gamma controls are enabled, we should apply it to the new monitor
-    if (self->gamma_control_enabled) {
-        wayland_wlr_bluelight_filter(self, self->temperature);
-    }
+    // apply the night light and the monitor's profile to it
+    wayland_gamma_update(self);
 
     g_signal_emit(self, service_signals[output_added], 0, self->outputs,
                   output);
@@ -446,6 +608,39 @@ static void wl_output_handle_done(void *data, struct wl_output *output) {
         output_data->model);
 }
 
+static void on_output_calibrations_changed(GSettings *settings, gchar *key,
+                                           WaylandService *self) {
+    g_debug("wayland_service.c:on_output_calibrations_changed(): key: %s",
+            key);
+
+    // controls must not outlive the calibrations they point at, the update
+    // below hands them the reloaded ones.
+    GHashTableIter iter;
+    WaylandWLRGammaControl *ctrl = NULL;
+    g_hash_table_iter_init(&iter, self->gamma_controllers);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&ctrl))
+        ctrl->calibration = NULL;
+
+    g_hash_table_remove_all(self->gamma_calibrations);
+
+    GVariant *calibrations =
+        g_settings_get_value(settings, "output-calibrations");
+    GVariantIter variant_iter;
+    const char *name, *path;
+
+    // each profile is parsed once here, never on a temperature change
+    g_variant_iter_init(&variant_iter, calibrations);
+    while (g_variant_iter_next(&variant_iter, "{&s&s}", &name, &path)) {
+        Vcgt *vcgt = vcgt_load(path);
+        if (vcgt)
+            g_hash_table_insert(self->gamma_calibrations, g_strdup(name),
+                                vcgt);
+    }
+    g_variant_unref(calibrations);
+
+    wayland_gamma_update(self);
+}
+
 static void wl_output_handle_geometry(void *data, struct wl_output *output,
                                       int32_t x, int32_t y,
                                       int32_t physical_width,
@@ -477,6 +672,12 @@ static void wl_output_handle_mode(void *data, struct wl_output *output,
         "wayland_service.c:wl_output_handle_mode(): flags: %d, width: %d, "
         "height: %d, refresh: %d",
         flags, width, height, refresh);
+
+    if (!(flags & WL_OUTPUT_MODE_CURRENT)) return;
+
+    WaylandService *self = (WaylandService *)data;
+    WaylandOutput *output_data = g_hash_table_lookup(self->outputs, output);
+    if (output_data) output_data->refresh = refresh;
 }
 
 static void wl_output_handle_name(void *data, struct wl_output *output,
@@ -505,6 +706,30 @@ static const struct wl_output_listener wl_output_listener = {
     .scale = wl_output_handle_scale,
 };
 
+// Binds global `name` through a wrapper placed on the event thread's queue,
+// events for the returned proxy and any object created from it are
+// dispatched there.
+static void *registry_bind_threaded(WaylandService *self,
+                                    struct wl_registry *registry,
+                                    uint32_t name,
+                                    const struct wl_interface *interface,
+                                    uint32_t version) {
+    struct wl_registry *wrapper = wl_proxy_create_wrapper(registry);
+    wl_proxy_set_queue((struct wl_proxy *)wrapper,
+                       wayland_event_thread_get_queue(self->events));
+    void *proxy = wl_registry_bind(wrapper, name, interface, version);
+    wl_proxy_wrapper_destroy(wrapper);
+    return proxy;
+}
+
+static void on_output_heads_changed(gpointer data) {
+    g_signal_emit(data, service_signals[output_heads_changed], 0);
+}
+
+static void on_output_layouts_changed(gpointer data) {
+    g_signal_emit(data, service_signals[output_layouts_changed], 0);
+}
+
 static void registry_handle_global(void *data, struct wl_registry *registry,
                                    uint32_t name, const char *interface,
                                    uint32_t version) {
@@ -531,9 +756,9 @@ static void registry_handle_global(void *data, struct wl_registry *registry,
     // register zwlr_foreign_toplevel_manager_v1_listener
     if (strcmp(interface, "zwlr_foreign_toplevel_manager_v1") == 0) {
         struct zwlr_foreign_toplevel_manager_v1 *toplevel_mgr =
-            wl_registry_bind(registry, name,
-                             &zwlr_foreign_toplevel_manager_v1_interface,
-                             version);
+            registry_bind_threaded(self, registry, name,
+                                   &zwlr_foreign_toplevel_manager_v1_interface,
+                                   version);
         zwlr_foreign_toplevel_manager_v1_add_listener(
             toplevel_mgr, &toplevel_mgr_listener, self);
     }
@@ -557,11 +782,33 @@ static void registry_handle_global(void *data, struct wl_registry *registry,
 
     // register zwlr_gamma_control_manager_v1
     if (strcmp(interface, "zwlr_gamma_control_manager_v1") == 0) {
-        self->gamma_control_manager = wl_registry_bind(
-            registry, name, &zwlr_gamma_control_manager_v1_interface, version);
+        // gamma controls inherit the manager's queue
+        self->gamma_control_manager = registry_bind_threaded(
+            self, registry, name, &zwlr_gamma_control_manager_v1_interface,
+            version);
+        // outputs announced before the manager get their profiles now
+        wayland_gamma_update(self);
+    }
+
+    // register zwlr_output_manager_v1, on the default queue as output
+    // configuration is rare and driven by the main loop.
+    if (strcmp(interface, "zwlr_output_manager_v1") == 0) {
+        struct zwlr_output_manager_v1 *output_mgr =
+            wl_registry_bind(registry, name, &zwlr_output_manager_v1_interface,
+                             MIN(version, 4));
+        self->output_config = wayland_output_config_new(
+            self->display, output_mgr, on_output_heads_changed,
+            on_output_layouts_changed, self);
     }
 }
 
+static void wayland_gamma_pool_free(gpointer data);
+static void wayland_wlr_gamma_control_free(gpointer data);
+static WaylandWLRGammaControl *wayland_wlr_gamma_control_find(
+    WaylandService *self, struct wl_output *output);
+static void wayland_wlr_gamma_control_destroy(WaylandService *self,
+                                              WaylandWLRGammaControl *ctrl);
+
 static void wayland_seat_remove(WaylandService *self, WaylandSeat *seat) {
     g_debug("wayland_service.c:wayland_seat_remove(): seat: %s", seat->name);
 
@@ -586,6 +833,12 @@ static void wayland_output_remove(WaylandService *self, WaylandOutput *output) {
     // remove from outputs hash table
     g_hash_table_remove(self->outputs, output->output);
 
+    // stop any transition on it and drop its gamma tables
+    WaylandWLRGammaControl *ctrl =
+        wayland_wlr_gamma_control_find(self, output->output);
+    if (ctrl) wayland_wlr_gamma_control_destroy(self, ctrl);
+    g_hash_table_remove(self->gamma_pools, output->output);
+
     // release output from wayland
     wl_output_release(output->output);
 
@@ -638,22 +891,17 @@ static void on_ignored_toplevels_app_ids_changed(GSettings *settings,
     g_debug("wayland_service.c:on_ignored_toplevels_app_ids_changed(): key: %s",
             key);
 
-    // clear the hash table
-    g_hash_table_remove_all(self->ignored_toplevel_app_ids);
-
     gchar *encoded_list =
         g_settings_get_string(self->settings, "ignored-toplevels-app-ids");
 
-    // if encoded_list is empty just return
-    if (g_strcmp0(encoded_list, "") == 0) return;
-
-    // split list by colons
+    // split list by colons and compile the patterns
     gchar **app_ids = g_strsplit(encoded_list, ":", -1);
+    toplevel_matcher_free(self->ignored_toplevel_app_ids);
+    self->ignored_toplevel_app_ids = toplevel_matcher_new(app_ids);
+    self->ignored_toplevels_generation++;
 
-    // dup and hash each string
-    for (gchar **app_id = app_ids; *app_id; app_id++) {
-        g_hash_table_insert(self->ignored_toplevel_app_ids, *app_id, *app_id);
-    }
+    g_strfreev(app_ids);
+    g_free(encoded_list);
 }
 
 static void on_ignored_toplevels_titles_changed(GSettings *settings, gchar *key,
@@ -661,22 +909,17 @@ static void on_ignored_toplevels_titles_changed(GSettings *settings, gchar *key,
     g_debug("wayland_service.c:on_ignored_toplevels_titles_changed(): key: %s",
             key);
 
-    // clear the hash table
-    g_hash_table_remove_all(self->ignored_toplevel_titles);
-
     gchar *encoded_list =
         g_settings_get_string(self->settings, "ignored-toplevels-titles");
 
-    // if encoded_list is empty just return
-    if (g_strcmp0(encoded_list, "") == 0) return;
-
-    // split list by colons
+    // split list by colons and compile the patterns
     gchar **titles = g_strsplit(encoded_list, ":", -1);
+    toplevel_matcher_free(self->ignored_toplevel_titles);
+    self->ignored_toplevel_titles = toplevel_matcher_new(titles);
+    self->ignored_toplevels_generation++;
 
-    // dup and hash each string
-    for (gchar **title = titles; *title; title++) {
-        g_hash_table_insert(self->ignored_toplevel_titles, *title, *title);
-    }
+    g_strfreev(titles);
+    g_free(encoded_list);
 }
 
 static void wayland_service_init(WaylandService *self) {
@@ -693,9 +936,15 @@ static void wayland_service_init(WaylandService *self) {
     self->seats = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->toplevels = g_hash_table_new(g_direct_hash, g_direct_equal);
     self->outputs = g_hash_table_new(g_direct_hash, g_direct_equal);
-    self->gamma_controllers = g_hash_table_new(g_direct_hash, g_direct_equal);
-    self->ignored_toplevel_app_ids = g_hash_table_new(g_str_hash, g_str_equal);
-    self->ignored_toplevel_titles = g_hash_table_new(g_str_hash, g_str_equal);
+    self->gamma_controllers =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                              wayland_wlr_gamma_control_free);
+    self->gamma_pools = g_hash_table_new_full(g_direct_hash, g_direct_equal,
+                                              NULL, wayland_gamma_pool_free);
+    self->gamma_profiles =
+        g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+    self->gamma_calibrations = g_hash_table_new_full(
+        g_str_hash, g_str_equal, g_free, (GDestroyNotify)vcgt_free);
 
     self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
     // simulate settings signals
@@ -704,11 +953,27 @@ static void wayland_service_init(WaylandService *self) {
     on_ignored_toplevels_titles_changed(self->settings,
                                         "ignored-toplevels-titles", self);
 
+    self->night_light_settings =
+        g_settings_new("org.ldelossa.way-shell.night-light");
+    on_output_profiles_changed(self->night_light_settings, "output-profiles",
+                               self);
+    g_signal_connect(self->night_light_settings, "changed::output-profiles",
+                     G_CALLBACK(on_output_profiles_changed), self);
+    on_output_calibrations_changed(self->night_light_settings,
+                                   "output-calibrations", self);
+    g_signal_connect(self->night_light_settings,
+                     "changed::output-calibrations",
+                     G_CALLBACK(on_output_calibrations_changed), self);
+    wayland_night_light_schedule_init(self);
+
     // add registry listener
     wl_registry_add_listener(self->registry, &registry_listener, self);
 
-    // add wayland fd to event loop
-    g_unix_fd_add(self->fd, G_IO_IN | G_IO_ERR | G_IO_HUP, on_fd_read, self);
+    // the event thread reads the wayland fd and wakes the main loop for
+    // anything it has to apply or dispatch.
+    self->events = wayland_event_thread_new(self->display);
+    g_unix_fd_add(wayland_event_thread_get_wake_fd(self->events), G_IO_IN,
+                  on_events_ready, self);
 
     // issue a round-trip so we block until all globals are all bound and
     // listeners are registered.
@@ -730,6 +995,15 @@ int wayland_service_global_init(void) {
 
 WaylandService *wayland_service_get_global() { return global; }
 
+struct wl_display *wayland_service_get_display(WaylandService *self) {
+    return self->display;
+}
+
+WaylandOutput *wayland_service_get_output(WaylandService *self,
+                                          struct wl_output *output) {
+    return g_hash_table_lookup(self->outputs, output);
+}
+
 void wayland_wlr_foreign_toplevel_activate(
     WaylandService *self, WaylandWLRForeignTopLevel *toplevel) {
     g_debug("wayland_service.c:wayland_wlr_foreign_toplevel_activate()");
@@ -814,152 +1088,464 @@ void wayland_wlr_shortcuts_inhibitor_destroy(WaylandService *self) {
     gdk_toplevel_restore_system_shortcuts(self->shorcuts_inhibited_toplevel);
 }
 
+static void wayland_gamma_pool_release(WaylandGammaPool *pool) {
+    for (int i = 0; i < WAYLAND_GAMMA_POOL_BUFFERS; i++) {
+        if (pool->tables[i]) munmap(pool->tables[i], pool->table_size);
+        if (pool->fds[i] >= 0) close(pool->fds[i]);
+        pool->tables[i] = NULL;
+        pool->fds[i] = -1;
+    }
+    pool->gamma_size = 0;
+    pool->table_size = 0;
+}
+
+static void wayland_gamma_pool_free(gpointer data) {
+    WaylandGammaPool *pool = data;
+    wayland_gamma_pool_release(pool);
+    g_free(pool);
+}
+
+// Returns the output's gamma pool with buffers sized for `gamma_size`,
+// (re)allocating them only when the size changed.
+static WaylandGammaPool *wayland_gamma_pool_get(WaylandService *self,
+                                                struct wl_output *output,
+                                                uint32_t gamma_size) {
+    WaylandGammaPool *pool = g_hash_table_lookup(self->gamma_pools, output);
+
+    if (!pool) {
+        pool = g_malloc0(sizeof(WaylandGammaPool));
+        for (int i = 0; i < WAYLAND_GAMMA_POOL_BUFFERS; i++) pool->fds[i] = -1;
+        g_hash_table_insert(self->gamma_pools, output, pool);
+    }
+
+    if (pool->gamma_size == gamma_size) return pool;
+
+    wayland_gamma_pool_release(pool);
+    pool->gamma_size = gamma_size;
+    pool->table_size = gamma_size * 3 * sizeof(uint16_t);
+
+    for (int i = 0; i < WAYLAND_GAMMA_POOL_BUFFERS; i++) {
+        // anonymous memory shared with Wayland, nothing is published in the
+        // shm namespace.
+        int fd = memfd_create("way-shell-gamma-table",
+                              MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) {
+            g_error(
+                "wayland_service.c:wayland_gamma_pool_get() memfd_create "
+                "failed: %s",
+                strerror(errno));
+        }
+
+        if (ftruncate(fd, pool->table_size) < 0) {
+            g_error(
+                "wayland_service.c:wayland_gamma_pool_get() ftruncate "
+                "failed: %s",
+                strerror(errno));
+        }
+
+        // the compositor may rely on the table's size, fix it for good.
+        if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) <
+            0) {
+            g_error(
+                "wayland_service.c:wayland_gamma_pool_get() sealing failed: "
+                "%s",
+                strerror(errno));
+        }
+
+        pool->tables[i] = mmap(NULL, pool->table_size, PROT_READ | PROT_WRITE,
+                               MAP_SHARED, fd, 0);
+        if (pool->tables[i] == MAP_FAILED) {
+            g_error(
+                "wayland_service.c:wayland_gamma_pool_get() mmap failed: %s",
+                strerror(errno));
+        }
+        pool->fds[i] = fd;
+    }
+
+    g_debug(
+        "wayland_service.c:wayland_gamma_pool_get() allocated %d tables of "
+        "%zu bytes",
+        WAYLAND_GAMMA_POOL_BUFFERS, pool->table_size);
+
+    return pool;
+}
+
 static void wayland_wlr_gamma_control_apply(WaylandService *self,
                                             WaylandWLRGammaControl *ctrl) {
     g_debug("wayland_service.c:wayland_wlr_gamma_control_apply() called");
     // when we get here we must have the gamma ramp table size known
     if (ctrl->gamma_size == 0) return;
 
-    // get the total size needed for the gamma table.
-    size_t table_size = ctrl->gamma_size * 3 * sizeof(uint16_t);
+    WaylandGammaPool *pool =
+        wayland_gamma_pool_get(self, ctrl->output, ctrl->gamma_size);
 
-    // create unique name for our shared memory gamma table.
-    char shm_name[255];
-    snprintf(shm_name, 255, "/way-shell-ephemeral-gamma-table-%d", rand());
-
-    // we'll create a memory backed fd and share with Wayland.
-    int fd = shm_open(shm_name, O_RDWR | O_CREAT, 0666);
-    if (fd < 0) {
-        g_error(
-            "wayland_service.c:wayland_wlr_gamma_control_apply() shm_open "
-            "failed: %s",
-            strerror(errno));
-    }
-
-    if (ftruncate(fd, table_size) < 0) {
-        g_error(
-            "wayland_service.c:wayland_wlr_gamma_control_apply() ftruncate "
-            "failed: %s",
-            strerror(errno));
-    }
-
-    uint16_t *table =
-        mmap(NULL, table_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
-    if (table == MAP_FAILED) {
-        g_error(
-            "wayland_service.c:wayland_wlr_gamma_control_apply() mmap failed: "
-            "%s",
-            strerror(errno));
-    }
+    int fd = pool->fds[pool->next];
+    uint16_t *table = pool->tables[pool->next];
+    pool->next = (pool->next + 1) % WAYLAND_GAMMA_POOL_BUFFERS;
 
     // fill gammma table.
     uint16_t *r = table;
     uint16_t *g = table + ctrl->gamma_size;
     uint16_t *b = table + (ctrl->gamma_size * 2);
 
-    /* Initialize gamma ramps to pure state */
-    for (int i = 0; i < ctrl->gamma_size; i++) {
-        uint16_t value = (double)i / ctrl->gamma_size * (UINT16_MAX + 1);
-        r[i] = value;
-        g[i] = value;
-        b[i] = value;
-    }
-
-    colorramp_fill(r, g, b, ctrl->gamma_size, ctrl->temperature);
+    // the calibration's ramps are resampled once per size and gamma, after
+    // that a temperature change only scales them.
+    if (ctrl->calibration)
+        colorramp_fill_calibrated(
+            r, g, b,
+            vcgt_get_ramps(ctrl->calibration, ctrl->gamma_size, ctrl->gamma),
+            ctrl->gamma_size, ctrl->temperature, ctrl->brightness,
+            ctrl->gamma);
+    else
+        colorramp_fill_profile(r, g, b, ctrl->gamma_size, ctrl->temperature,
+                               ctrl->brightness, ctrl->gamma);
+
+    // the file description is shared with the compositor, which may read()
+    // rather than pread() the table, rewind it for every send.
+    lseek(fd, 0, SEEK_SET);
 
     zwlr_gamma_control_v1_set_gamma(ctrl->control, fd);
+}
 
-    munmap(table, table_size);
-    shm_unlink(shm_name);
-    close(fd);
+static void wayland_wlr_gamma_control_free(gpointer data) {
+    WaylandWLRGammaControl *ctrl = data;
+    if (ctrl->tick_id) g_source_remove(ctrl->tick_id);
+    if (ctrl->in_flight) wl_callback_destroy(ctrl->in_flight);
+    g_free(ctrl);
+}
 
-    ctrl->gamma_table_fd = fd;
+static void wayland_wlr_gamma_control_destroy(WaylandService *self,
+                                              WaylandWLRGammaControl *ctrl) {
+    struct zwlr_gamma_control_v1 *control = ctrl->control;
+    g_hash_table_remove(self->gamma_controllers, control);
+    zwlr_gamma_control_v1_destroy(control);
 }
 
-static void zwlr_gamma_control_handle_size(
-    void *data, struct zwlr_gamma_control_v1 *control, uint32_t size) {
-    g_debug("wayland_service.c:zwlr_gamma_control_handle_size(): size: %d",
-            size);
+static void gamma_sync_handle_done(void *data, struct wl_callback *callback,
+                                   uint32_t serial) {
+    WaylandWLRGammaControl *ctrl = data;
+    wl_callback_destroy(callback);
+    ctrl->in_flight = NULL;
+    gamma_transition_acked(&ctrl->transition, g_get_monotonic_time());
+}
 
-    WaylandService *self = (WaylandService *)data;
+static const struct wl_callback_listener gamma_sync_listener = {
+    .done = gamma_sync_handle_done,
+};
 
-    WaylandWLRGammaControl *ctrl =
-        g_hash_table_lookup(self->gamma_controllers, control);
-    if (!ctrl) return;
+static gboolean wayland_wlr_gamma_control_tick(gpointer data) {
+    WaylandWLRGammaControl *ctrl = data;
+    WaylandService *self = global;
+    GammaTransition *transition = &ctrl->transition;
+    gint64 now = g_get_monotonic_time();
+    int temperature = 0;
+    gboolean done = FALSE;
+
+    // the compositor has not processed the previous table yet, skip this
+    // frame rather than queue tables it will only overwrite.
+    if (!gamma_transition_step(transition, now, ctrl->in_flight != NULL,
+                               &temperature, &done))
+        return G_SOURCE_CONTINUE;
+
+    if (temperature != ctrl->temperature || ctrl->dirty) {
+        ctrl->temperature = temperature;
+        ctrl->dirty = FALSE;
+        wayland_wlr_gamma_control_apply(self, ctrl);
 
-    ctrl->gamma_size = size;
+        ctrl->in_flight = wl_display_sync(self->display);
+        wl_callback_add_listener(ctrl->in_flight, &gamma_sync_listener, ctrl);
+        wl_display_flush(self->display);
 
-    if (self->gamma_control_enabled) {
-        wayland_wlr_gamma_control_apply(self, ctrl);
+        gamma_transition_sent(transition, now, g_get_monotonic_time() - now);
     }
 
-    wl_display_flush(self->display);
+    if (!done) return G_SOURCE_CONTINUE;
 
+    GammaTransitionStats *stats = &transition->stats;
     g_debug(
-        "wayland_service.c:zwlr_gamma_control_handle_size(): ctrl->gamma_size: "
-        "%d",
-        ctrl->gamma_size);
+        "wayland_service.c:wayland_wlr_gamma_control_tick(): transition to "
+        "%dK done, frames: %u, refreshes: %u, dropped: %u (late %u, "
+        "skipped %u), max interval: %" G_GINT64_FORMAT
+        "us, max ack: %" G_GINT64_FORMAT "us, busy: %" G_GINT64_FORMAT "us",
+        transition->target, stats->frames, stats->expected,
+        gamma_transition_dropped(stats), stats->missed, stats->skipped,
+        stats->interval_max_us, stats->ack_max_us, stats->busy_us);
+
+    ctrl->tick_id = 0;
+    if (ctrl->destroy_on_done) {
+        wayland_wlr_gamma_control_destroy(self, ctrl);
+        wl_display_flush(self->display);
+    }
+    return G_SOURCE_REMOVE;
 }
 
-static void zlwr_gamma_control_handle_failed(
-    void *data, struct zwlr_gamma_control_v1 *ctrl) {
-    g_debug("wayland_service.c:zlwr_gamma_control_handle_failed(): failed");
-    WaylandService *self = (WaylandService *)data;
-    g_hash_table_remove(self->gamma_controllers, ctrl);
-    zwlr_gamma_control_v1_destroy(ctrl);
+// Starts a transition from the currently applied temperature to `target`.
+// A transition already running is retargeted from wherever it got to.
+static void wayland_wlr_gamma_control_animate(WaylandService *self,
+                                              WaylandWLRGammaControl *ctrl,
+                                              int target) {
+    gint64 duration_us =
+        (gint64)g_settings_get_uint(self->night_light_settings,
+                                    "transition-ms") *
+        1000;
+
+    // nothing to animate, the first step completes the transition and
+    // applies a changed brightness or gamma.
+    if (ctrl->temperature == target) duration_us = 0;
+
+    // one step per refresh of the output
+    WaylandOutput *output = g_hash_table_lookup(self->outputs, ctrl->output);
+    guint interval_ms = 16;
+    if (output && output->refresh > 0)
+        interval_ms = MAX(1, 1000000 / output->refresh);
+
+    // a table of the previous transition still in flight would count
+    // against this one, forget it rather than skip steps waiting for it.
+    if (ctrl->in_flight) {
+        wl_callback_destroy(ctrl->in_flight);
+        ctrl->in_flight = NULL;
+    }
+
+    gamma_transition_start(&ctrl->transition, ctrl->temperature, target,
+                           duration_us, interval_ms * 1000,
+                           g_get_monotonic_time());
+
+    // the ramp size is not known yet, the gamma_size event starts us.
+    if (ctrl->gamma_size == 0 || ctrl->tick_id) return;
+
+    // step once now so short or disabled transitions apply immediately
+    if (wayland_wlr_gamma_control_tick(ctrl) == G_SOURCE_REMOVE) return;
+
+    ctrl->tick_id =
+        g_timeout_add(interval_ms, wayland_wlr_gamma_control_tick, ctrl);
+}
+
+static void zwlr_gamma_control_apply_size(WaylandService *self,
+                                          WaylandWLRGammaControl *ctrl,
+                                          uint32_t size) {
+    g_debug("wayland_service.c:zwlr_gamma_control_apply_size(): size: %d",
+            size);
+
+    ctrl->gamma_size = size;
+
+    wayland_wlr_gamma_control_animate(self, ctrl, ctrl->transition.target);
+
     wl_display_flush(self->display);
 }
 
+static void zwlr_gamma_control_apply_failed(WaylandService *self,
+                                            WaylandWLRGammaControl *ctrl) {
+    g_debug("wayland_service.c:zwlr_gamma_control_apply_failed(): failed");
+    wayland_wlr_gamma_control_destroy(self, ctrl);
+    wl_display_flush(self->display);
+}
+
+// Gamma control listeners run on the event thread, like the toplevel ones.
+// Their listener data is the control's serial rather than the control, which
+// the main loop may free at any time, `global` is set before any control
+// exists.
+
+static void zwlr_gamma_control_handle_size(
+    void *data, struct zwlr_gamma_control_v1 *control, uint32_t size) {
+    wayland_event_thread_push(
+        global->events,
+        &(WaylandEventRecord){.type = WAYLAND_EVENT_GAMMA_SIZE,
+                              .proxy = control,
+                              .serial = GPOINTER_TO_UINT(data),
+                              .gamma_size = size});
+}
+
+static void zwlr_gamma_control_handle_failed(
+    void *data, struct zwlr_gamma_control_v1 *control) {
+    wayland_event_thread_push(
+        global->events,
+        &(WaylandEventRecord){.type = WAYLAND_EVENT_GAMMA_FAILED,
+                              .proxy = control,
+                              .serial = GPOINTER_TO_UINT(data)});
+}
+
 static const struct zwlr_gamma_control_v1_listener gamma_control_listener = {
     .gamma_size = zwlr_gamma_control_handle_size,
-    .failed = zlwr_gamma_control_handle_failed,
+    .failed = zwlr_gamma_control_handle_failed,
 };
 
-void wayland_wlr_bluelight_filter(WaylandService *self, double temperature) {
-    g_debug("wayland_service.c:wayland_wlr_bluelight_filter(): intensity: %f",
-            temperature);
+// Returns the object of `table` `record` is meant for, NULL if its proxy was
+// destroyed since, even when a newer object got the same address.
+static gpointer wayland_event_lookup(GHashTable *table,
+                                     WaylandEventRecord *record) {
+    WaylandHeader *header = g_hash_table_lookup(table, record->proxy);
+    if (!header || header->serial != record->serial) return NULL;
+    return header;
+}
 
-    if (self->gamma_control_enabled) {
-        for (GList *l = g_hash_table_get_values(self->gamma_controllers); l;
-             l = l->next) {
-            WaylandWLRGammaControl *ctrl = l->data;
-            ctrl->temperature = temperature;
-            wayland_wlr_gamma_control_apply(self, ctrl);
-        }
+// Applies a record from the event thread on the main loop, records of objects
+// destroyed since are dropped.
+static void wayland_event_apply(WaylandService *self,
+                                WaylandEventRecord *record) {
+    WaylandWLRForeignTopLevel *toplevel;
+    WaylandWLRGammaControl *ctrl;
+
+    switch (record->type) {
+        case WAYLAND_EVENT_TOPLEVEL_NEW:
+            toplevel_apply_new(self, record);
+            break;
+        case WAYLAND_EVENT_TOPLEVEL_DONE:
+            if ((toplevel = wayland_event_lookup(self->toplevels, record)))
+                toplevel_apply_done(self, toplevel, record);
+            g_free(record->toplevel.title);
+            g_free(record->toplevel.app_id);
+            break;
+        case WAYLAND_EVENT_TOPLEVEL_CLOSED:
+            if ((toplevel = wayland_event_lookup(self->toplevels, record)))
+                toplevel_apply_closed(self, toplevel);
+            break;
+        case WAYLAND_EVENT_GAMMA_SIZE:
+            if ((ctrl = wayland_event_lookup(self->gamma_controllers, record)))
+                zwlr_gamma_control_apply_size(self, ctrl, record->gamma_size);
+            break;
+        case WAYLAND_EVENT_GAMMA_FAILED:
+            if ((ctrl = wayland_event_lookup(self->gamma_controllers, record)))
+                zwlr_gamma_control_apply_failed(self, ctrl);
+            break;
+        case WAYLAND_EVENT_DISCONNECTED:
+            // handled by on_events_ready
+            break;
     }
+}
 
-    self->gamma_control_enabled = true;
-    self->temperature = temperature;
+static WaylandWLRGammaControl *wayland_wlr_gamma_control_find(
+    WaylandService *self, struct wl_output *output) {
+    GHashTableIter iter;
+    WaylandWLRGammaControl *ctrl = NULL;
 
-    // iterate over wl_outputs
-    GList *outputs = g_hash_table_get_values(self->outputs);
-    for (GList *l = outputs; l; l = l->next) {
-        WaylandOutput *output = l->data;
+    g_hash_table_iter_init(&iter, self->gamma_controllers);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&ctrl))
+        if (ctrl->output == output) return ctrl;
+    return NULL;
+}
 
-        WaylandWLRGammaControl *ctrl =
-            g_malloc0(sizeof(WaylandWLRGammaControl));
+static const WaylandGammaProfile wayland_gamma_default_profile = {
+    .temperature = 0,
+    .brightness = 1.0,
+    .gamma = 1.0,
+};
 
-        ctrl->header.type = WLR_GAMMA_CONTROL;
+static const WaylandGammaProfile *wayland_gamma_profile_get(
+    WaylandService *self, const char *output_name) {
+    const WaylandGammaProfile *profile = NULL;
+    if (output_name)
+        profile = g_hash_table_lookup(self->gamma_profiles, output_name);
+    return profile ? profile : &wayland_gamma_default_profile;
+}
 
-        ctrl->output = output->output;
+static WaylandWLRGammaControl *wayland_wlr_gamma_control_new(
+    WaylandService *self, WaylandOutput *output) {
+    WaylandWLRGammaControl *ctrl = g_malloc0(sizeof(WaylandWLRGammaControl));
 
-        ctrl->temperature = temperature;
+    ctrl->header.type = WLR_GAMMA_CONTROL;
+    ctrl->header.serial = ++self->gamma_serial;
+
+    ctrl->output = output->output;
 
-        ctrl->gamma_size = 0;
+    // fade in from an unfiltered output once the ramp size is known
+    ctrl->temperature = WAYLAND_GAMMA_NEUTRAL_TEMPERATURE;
+    ctrl->transition.from = WAYLAND_GAMMA_NEUTRAL_TEMPERATURE;
+    ctrl->transition.target = WAYLAND_GAMMA_NEUTRAL_TEMPERATURE;
+    ctrl->brightness = 1.0;
+    ctrl->gamma = 1.0;
+    ctrl->dirty = TRUE;
 
-        ctrl->gamma_table_fd = -1;
+    ctrl->gamma_size = 0;
+
+    ctrl->control = zwlr_gamma_control_manager_v1_get_gamma_control(
+        self->gamma_control_manager, output->output);
+
+    // add listener
+    zwlr_gamma_control_v1_add_listener(ctrl->control, &gamma_control_listener,
+                                       GUINT_TO_POINTER(ctrl->header.serial));
+
+    g_hash_table_insert(self->gamma_controllers, ctrl->control, ctrl);
+
+    return ctrl;
+}
 
-        ctrl->control = zwlr_gamma_control_manager_v1_get_gamma_control(
-            self->gamma_control_manager, output->output);
+// Brings the gamma control of every output in line with the night light and
+// the output's profile.
+// Outputs which need one get a control, the controls of outputs which no
+// longer do fade back to neutral and are destroyed. A control only moves when
+// its own target, brightness or gamma changed, so changing one output leaves
+// the tables of the others alone.
+static void wayland_gamma_update(WaylandService *self) {
+    if (!self->gamma_control_manager) return;
 
-        // add listener
-        zwlr_gamma_control_v1_add_listener(ctrl->control,
-                                           &gamma_control_listener, self);
+    GHashTableIter iter;
+    WaylandOutput *output = NULL;
+
+    g_hash_table_iter_init(&iter, self->outputs);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&output)) {
+        // the profile is looked up by name, which arrives before done
+        if (!output->initialized) continue;
+
+        const WaylandGammaProfile *profile =
+            wayland_gamma_profile_get(self, output->name);
+
+        int target = WAYLAND_GAMMA_NEUTRAL_TEMPERATURE;
+        if (self->gamma_control_enabled)
+            target = profile->temperature ? profile->temperature
+                                          : lround(self->temperature);
+
+        Vcgt *calibration =
+            g_hash_table_lookup(self->gamma_calibrations, output->name);
+
+        // a calibrated output keeps its control, destroying it would hand the
+        // output back uncalibrated.
+        gboolean needed = target != WAYLAND_GAMMA_NEUTRAL_TEMPERATURE ||
+                          profile->brightness != 1.0 ||
+                          profile->gamma != 1.0 || calibration;
+
+        WaylandWLRGammaControl *ctrl =
+            wayland_wlr_gamma_control_find(self, output->output);
+        if (!ctrl) {
+            if (!needed) continue;
+            ctrl = wayland_wlr_gamma_control_new(self, output);
+        }
+
+        // never applied, nothing to fade out of
+        if (!needed && ctrl->gamma_size == 0) {
+            wayland_wlr_gamma_control_destroy(self, ctrl);
+            continue;
+        }
 
-        g_hash_table_insert(self->gamma_controllers, ctrl->control, ctrl);
+        ctrl->destroy_on_done = !needed;
+
+        if (ctrl->brightness != profile->brightness ||
+            ctrl->gamma != profile->gamma ||
+            ctrl->calibration != calibration) {
+            ctrl->brightness = profile->brightness;
+            ctrl->gamma = profile->gamma;
+            ctrl->calibration = calibration;
+            ctrl->dirty = TRUE;
+        }
+
+        // a transition already heading to the target keeps going
+        if (ctrl->transition.target != target || ctrl->dirty ||
+            (ctrl->destroy_on_done && !ctrl->tick_id))
+            wayland_wlr_gamma_control_animate(self, ctrl, target);
     }
 
     wl_display_flush(self->display);
+}
+
+void wayland_wlr_bluelight_filter(WaylandService *self, double temperature) {
+    g_debug("wayland_service.c:wayland_wlr_bluelight_filter(): intensity: %f",
+            temperature);
+
+    self->gamma_control_enabled = true;
+    self->temperature = temperature;
+
+    // existing controllers, including ones still fading out after a disable,
+    // transition from where they are.
+    wayland_gamma_update(self);
 
     g_signal_emit(self, service_signals[gamma_control_enabled], 0);
 }
@@ -967,21 +1553,293 @@ void wayland_wlr_bluelight_filter(WaylandService *self, double temperature) {
 void wayland_wlr_bluelight_filter_destroy(WaylandService *self) {
     if (!self->gamma_control_enabled) return;
 
-    for (GList *l = g_hash_table_get_values(self->gamma_controllers); l;
-         l = l->next) {
-        WaylandWLRGammaControl *ctrl = l->data;
-        zwlr_gamma_control_v1_destroy(ctrl->control);
+    self->gamma_control_enabled = false;
+
+    // fade each output back to its profile, controls no longer needed are
+    // destroyed once the transition completes.
+    wayland_gamma_update(self);
+
+    g_signal_emit(self, service_signals[gamma_control_disabled], 0);
+}
+
+static void on_output_profiles_changed(GSettings *settings, gchar *key,
+                                       WaylandService *self) {
+    g_debug("wayland_service.c:on_output_profiles_changed(): key: %s", key);
+
+    g_hash_table_remove_all(self->gamma_profiles);
+
+    GVariant *profiles = g_settings_get_value(settings, "output-profiles");
+    GVariantIter iter;
+    const char *name;
+    guint32 temperature;
+    double brightness, gamma;
+
+    g_variant_iter_init(&iter, profiles);
+    while (g_variant_iter_next(&iter, "{&s(udd)}", &name, &temperature,
+                               &brightness, &gamma)) {
+        WaylandGammaProfile *profile = g_new0(WaylandGammaProfile, 1);
+        profile->temperature = temperature;
+        profile->brightness =
+            CLAMP(brightness, WAYLAND_GAMMA_MIN_BRIGHTNESS, 1.0);
+        profile->gamma = CLAMP(gamma, 0.1, 10.0);
+        g_hash_table_insert(self->gamma_profiles, g_strdup(name), profile);
     }
+    g_variant_unref(profiles);
 
-    g_hash_table_remove_all(self->gamma_controllers);
+    wayland_gamma_update(self);
+}
 
-    wl_display_flush(self->display);
+// Writes the profiles back to settings.
+static void wayland_gamma_profiles_store(WaylandService *self) {
+    GVariantBuilder builder;
+    GHashTableIter iter;
+    const char *name;
+    WaylandGammaProfile *profile;
 
-    self->gamma_control_enabled = false;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a{s(udd)}"));
 
-    g_signal_emit(self, service_signals[gamma_control_disabled], 0);
+    g_hash_table_iter_init(&iter, self->gamma_profiles);
+    while (g_hash_table_iter_next(&iter, (gpointer *)&name,
+                                  (gpointer *)&profile))
+        g_variant_builder_add(&builder, "{s(udd)}", name,
+                              (guint32)profile->temperature,
+                              profile->brightness, profile->gamma);
+
+    g_settings_set_value(self->night_light_settings, "output-profiles",
+                         g_variant_builder_end(&builder));
+}
+
+static gboolean on_gamma_profiles_store(WaylandService *self) {
+    self->gamma_store_id = 0;
+    wayland_gamma_profiles_store(self);
+    return G_SOURCE_REMOVE;
+}
+
+// Applies edited profiles right away and writes them to settings once the
+// edits stop for WAYLAND_GAMMA_STORE_DELAY_MS. A brightness slider edits them
+// on every step of a drag, each write would hit dconf and wake every listener
+// of the key.
+static void wayland_gamma_profiles_changed(WaylandService *self) {
+    wayland_gamma_update(self);
+
+    if (self->gamma_store_id) g_source_remove(self->gamma_store_id);
+    self->gamma_store_id = g_timeout_add(
+        WAYLAND_GAMMA_STORE_DELAY_MS, (GSourceFunc)on_gamma_profiles_store,
+        self);
+}
+
+// Sets the brightness in the profile of `output_name`, creating it if needed.
+// Returns whether it changed.
+static gboolean wayland_gamma_profile_set_brightness(WaylandService *self,
+                                                     const char *output_name,
+                                                     double brightness) {
+    brightness = CLAMP(brightness, WAYLAND_GAMMA_MIN_BRIGHTNESS, 1.0);
+
+    WaylandGammaProfile *profile =
+        g_hash_table_lookup(self->gamma_profiles, output_name);
+    if (!profile) {
+        if (brightness == 1.0) return FALSE;
+        profile = g_new0(WaylandGammaProfile, 1);
+        *profile = wayland_gamma_default_profile;
+        g_hash_table_insert(self->gamma_profiles, g_strdup(output_name),
+                            profile);
+    }
+
+    if (profile->brightness == brightness) return FALSE;
+    profile->brightness = brightness;
+    return TRUE;
+}
+
+void wayland_gamma_set_brightness(WaylandService *self, const char *output_name,
+                                  double brightness) {
+    g_debug(
+        "wayland_service.c:wayland_gamma_set_brightness(): output: %s, "
+        "brightness: %f",
+        output_name, brightness);
+
+    if (!output_name) return;
+    if (wayland_gamma_profile_set_brightness(self, output_name, brightness))
+        wayland_gamma_profiles_changed(self);
+}
+
+// Whether the connector is a built in panel, which has a backlight.
+static gboolean wayland_output_is_internal(WaylandOutput *output) {
+    return g_str_has_prefix(output->name, "eDP") ||
+           g_str_has_prefix(output->name, "LVDS") ||
+           g_str_has_prefix(output->name, "DSI");
+}
+
+void wayland_gamma_set_brightness_all(WaylandService *self, double brightness,
+                                      gboolean skip_internal) {
+    GHashTableIter iter;
+    WaylandOutput *output = NULL;
+    gboolean changed = FALSE;
+
+    g_hash_table_iter_init(&iter, self->outputs);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&output)) {
+        if (!output->name) continue;
+        if (skip_internal && wayland_output_is_internal(output)) continue;
+        changed |= wayland_gamma_profile_set_brightness(self, output->name,
+                                                        brightness);
+    }
+
+    // a single write for all outputs
+    if (changed) wayland_gamma_profiles_changed(self);
+}
+
+double wayland_gamma_get_brightness(WaylandService *self,
+                                    const char *output_name) {
+    if (output_name)
+        return wayland_gamma_profile_get(self, output_name)->brightness;
+
+    GHashTableIter iter;
+    WaylandOutput *output = NULL;
+    double brightness = 0.0;
+
+    g_hash_table_iter_init(&iter, self->outputs);
+    while (g_hash_table_iter_next(&iter, NULL, (gpointer *)&output))
+        brightness = MAX(brightness,
+                         wayland_gamma_profile_get(self, output->name)
+                             ->brightness);
+
+    return brightness > 0.0 ? brightness : 1.0;
 }
 
 gboolean wayland_wlr_gamma_control_enabled(WaylandService *self) {
     return self->gamma_control_enabled;
 }
+
+// Evaluates the configured schedule now, turning the filter on or off to
+// match it when `apply` is set, and arms the timer for the next transition.
+// Outside of evaluations the filter is left alone, so a manual toggle holds
+// until the next scheduled transition.
+static void wayland_night_light_schedule_update(WaylandService *self,
+                                                gboolean apply) {
+    gchar *schedule =
+        g_settings_get_string(self->night_light_settings, "schedule");
+    gint64 now = g_get_real_time() / G_USEC_PER_SEC;
+    gboolean night = FALSE;
+    gint64 next = 0;
+
+    if (g_strcmp0(schedule, "sunset-to-sunrise") == 0) {
+        next = night_light_schedule_sun(
+            g_settings_get_double(self->night_light_settings, "latitude"),
+            g_settings_get_double(self->night_light_settings, "longitude"),
+            now, &night);
+    } else if (g_strcmp0(schedule, "fixed") == 0) {
+        next = night_light_schedule_fixed(
+            g_settings_get_double(self->night_light_settings,
+                                  "schedule-from"),
+            g_settings_get_double(self->night_light_settings, "schedule-to"),
+            now, &night);
+    }
+
+    g_debug(
+        "wayland_service.c:wayland_night_light_schedule_update(): schedule: "
+        "%s, night: %d, next: %" G_GINT64_FORMAT,
+        schedule, night, next);
+    g_free(schedule);
+
+    // an absolute CLOCK_REALTIME timer fires on time after a suspend, and
+    // TFD_TIMER_CANCEL_ON_SET wakes us if the clock is set meanwhile.
+    // a zero it_value disarms it when no schedule is configured.
+    struct itimerspec spec = {.it_value = {.tv_sec = next}};
+    if (timerfd_settime(self->schedule_fd,
+                        TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec,
+                        NULL) == -1)
+        g_warning(
+            "wayland_service.c:wayland_night_light_schedule_update(): "
+            "timerfd_settime failed: %s",
+            strerror(errno));
+
+    self->schedule_next = next;
+    self->schedule_next_night = !night;
+
+    if (next && apply) {
+        if (night && !self->gamma_control_enabled)
+            wayland_wlr_bluelight_filter(
+                self, g_settings_get_uint(self->night_light_settings,
+                                          "scheduled-temperature"));
+        else if (!night && self->gamma_control_enabled)
+            wayland_wlr_bluelight_filter_destroy(self);
+    }
+
+    g_signal_emit(self, service_signals[night_light_schedule_changed], 0);
+}
+
+static gboolean on_schedule_fd_read(gint fd, GIOCondition condition,
+                                    gpointer user_data) {
+    WaylandService *self = user_data;
+    uint64_t expirations = 0;
+
+    // ECANCELED means the clock was set, a transition may have been crossed
+    // or skipped so the schedule is applied as if it fired.
+    if (read(fd, &expirations, sizeof(expirations)) == -1 &&
+        errno != ECANCELED) {
+        if (errno == EAGAIN) return G_SOURCE_CONTINUE;
+        g_warning(
+            "wayland_service.c:on_schedule_fd_read(): read failed: %s",
+            strerror(errno));
+    }
+
+    wayland_night_light_schedule_update(self, TRUE);
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_night_light_schedule_changed(GSettings *settings, gchar *key,
+                                            WaylandService *self) {
+    g_debug(
+        "wayland_service.c:on_night_light_schedule_changed(): key: %s", key);
+    wayland_night_light_schedule_update(self, TRUE);
+}
+
+static void wayland_night_light_schedule_init(WaylandService *self) {
+    self->schedule_fd =
+        timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (self->schedule_fd == -1) {
+        g_warning(
+            "wayland_service.c:wayland_night_light_schedule_init(): "
+            "timerfd_create failed, night light schedule disabled: %s",
+            strerror(errno));
+        return;
+    }
+
+    self->schedule_source_id =
+        g_unix_fd_add(self->schedule_fd, G_IO_IN, on_schedule_fd_read, self);
+
+    const gchar *keys[] = {"schedule", "latitude", "longitude",
+                           "schedule-from", "schedule-to"};
+    for (guint i = 0; i < G_N_ELEMENTS(keys); i++) {
+        gchar *signal = g_strdup_printf("changed::%s", keys[i]);
+        g_signal_connect(self->night_light_settings, signal,
+                         G_CALLBACK(on_night_light_schedule_changed), self);
+        g_free(signal);
+    }
+
+    wayland_night_light_schedule_update(self, TRUE);
+}
+
+gboolean wayland_night_light_schedule_next(WaylandService *self,
+                                           gint64 *next, gboolean *night) {
+    if (!self->schedule_next) return FALSE;
+    *next = self->schedule_next;
+    *night = self->schedule_next_night;
+    return TRUE;
+}
+
+gchar **wayland_output_layouts(WaylandService *self) {
+    if (!self->output_config) return NULL;
+    return wayland_output_config_list_layouts(self->output_config);
+}
+
+gboolean wayland_output_layout_save(WaylandService *self, const char *name) {
+    g_debug("wayland_service.c:wayland_output_layout_save(): name: %s", name);
+    if (!self->output_config) return FALSE;
+    return wayland_output_config_save_layout(self->output_config, name);
+}
+
+gboolean wayland_output_layout_apply(WaylandService *self, const char *name) {
+    g_debug("wayland_service.c:wayland_output_layout_apply(): name: %s", name);
+    if (!self->output_config) return FALSE;
+    return wayland_output_config_apply_layout(self->output_config, name);
+}
@@ -4,10 +4,16 @@
 #include <wayland-client-core.h>
 #include <wayland-client.h>
 
+#include "gamma_transition.h"
+#include "vcgt.h"
+
 enum WaylandType { WL_REGISTRY, WL_SEAT, WL_OUTPUT, WLR_GAMMA_CONTROL };
 
 typedef struct _WaylandHeader {
     enum WaylandType type;
+    // matches the serial of event thread records meant for this object, see
+    // WaylandEventRecord.
+    uint32_t serial;
 } WaylandHeader;
 
 typedef struct WaylandSeat {
@@ -23,6 +29,16 @@ enum WaylandWLRForeignTopLevelState {
     TOPLEVEL_STATE_FULLSCEEN,
 };
 
+// Fields of a toplevel that changed since its last top-level-changed signal.
+enum WaylandWLRForeignTopLevelChange {
+    TOPLEVEL_CHANGE_TITLE = 1 << 0,
+    TOPLEVEL_CHANGE_APP_ID = 1 << 1,
+    TOPLEVEL_CHANGE_STATE = 1 << 2,
+    TOPLEVEL_CHANGE_OUTPUT = 1 << 3,
+    TOPLEVEL_CHANGE_ALL = TOPLEVEL_CHANGE_TITLE | TOPLEVEL_CHANGE_APP_ID |
+                          TOPLEVEL_CHANGE_STATE | TOPLEVEL_CHANGE_OUTPUT,
+};
+
 typedef struct _WaylandWLRForeignTopLevel {
     WaylandHeader header;
     struct zwlr_foreign_toplevel_handle_v1 *toplevel;
@@ -32,6 +48,15 @@ typedef struct _WaylandWLRForeignTopLevel {
     gboolean activated;
     gboolean closed;
     enum WaylandWLRForeignTopLevelState state;
+    // WaylandWLRForeignTopLevelChange bits accumulated until the next done
+    guint changed;
+    // whether top-level-changed was emitted for this toplevel yet, its first
+    // emission reports every field as changed.
+    gboolean advertised;
+    // whether the toplevel matches the ignored app ids or titles, as of
+    // `ignored_generation` of those patterns.
+    gboolean ignored;
+    guint ignored_generation;
 
 } WaylandWLRForeignTopLevel;
 
@@ -44,6 +69,8 @@ typedef struct _WaylandOutput {
     char *desc;
     char *make;
     char *model;
+    // refresh rate of the current mode in mHz, 0 until it is advertised
+    int32_t refresh;
     gboolean initialized;
 } WaylandOutput;
 
@@ -53,10 +80,66 @@ typedef struct _WaylandWLRGammaControl {
     struct zwlr_gamma_control_v1 *control;
     struct wl_output *output;
     uint32_t gamma_size;
-    int gamma_table_fd;
+    // temperature currently applied to the output
     int temperature;
+    // brightness and gamma of the output's profile, composed into the same
+    // ramps as the temperature.
+    double brightness;
+    double gamma;
+    // calibration of the output the ramps are composed with, owned by the
+    // service's calibrations table, NULL for none.
+    Vcgt *calibration;
+    // the ramps need to be applied again although the temperature did not
+    // change.
+    gboolean dirty;
+
+    // current or last transition, stepped by a timer paced to the output's
+    // refresh rate.
+    GammaTransition transition;
+    guint tick_id;
+    // sync issued after the last set_gamma, frames are skipped while the
+    // compositor has not caught up with it.
+    struct wl_callback *in_flight;
+    // destroy the control once the transition completes, used to fade out
+    // when the filter is disabled.
+    gboolean destroy_on_done;
 } WaylandWLRGammaControl;
 
+// Temperature at which colorramp_fill leaves the ramps effectively unchanged,
+// transitions start from and end at it when the filter is toggled.
+#define WAYLAND_GAMMA_NEUTRAL_TEMPERATURE 6500
+
+// Software dimming never goes below this, the output would be unreadable.
+#define WAYLAND_GAMMA_MIN_BRIGHTNESS 0.1
+
+// Brightness changes apply at once but are saved to the output-profiles key
+// only after this long without another change.
+#define WAYLAND_GAMMA_STORE_DELAY_MS 500
+
+// Gamma settings of a single output, see the output-profiles key of
+// org.ldelossa.way-shell.night-light.
+typedef struct _WaylandGammaProfile {
+    // night light temperature in Kelvin, 0 to follow the global one
+    int temperature;
+    double brightness;
+    double gamma;
+} WaylandGammaProfile;
+
+#define WAYLAND_GAMMA_POOL_BUFFERS 2
+
+// Gamma tables shared with the compositor for a single output.
+// Buffers are sealed memfds sized for `gamma_size`, they are allocated once and
+// reused by every apply, only the ramp contents are rewritten.
+typedef struct _WaylandGammaPool {
+    uint32_t gamma_size;
+    size_t table_size;
+    int fds[WAYLAND_GAMMA_POOL_BUFFERS];
+    uint16_t *tables[WAYLAND_GAMMA_POOL_BUFFERS];
+    // the buffer written by the next apply. buffers are alternated so a table
+    // the compositor may still be reading is never rewritten in place.
+    guint next;
+} WaylandGammaPool;
+
 G_BEGIN_DECLS
 
 struct _WaylandService;
@@ -71,6 +154,14 @@ int wayland_service_global_init(void);
 // Will return NULL if `wayland_service_global_init` has not been called.
 WaylandService *wayland_service_get_global();
 
+// The Wayland display connection owned by the service.
+// Proxies created on it are dispatched by the service's event source.
+struct wl_display *wayland_service_get_display(WaylandService *self);
+
+// Returns the WaylandOutput bound for `output` or NULL if it is unknown.
+WaylandOutput *wayland_service_get_output(WaylandService *self,
+                                          struct wl_output *output);
+
 void wayland_wlr_foreign_toplevel_activate(WaylandService *self,
                                            WaylandWLRForeignTopLevel *toplevel);
 
@@ -93,3 +184,35 @@ void wayland_wlr_bluelight_filter_destroy(WaylandService *self);
 
 // Whether the gamma control is enabled
 gboolean wayland_wlr_gamma_control_enabled(WaylandService *self);
+
+// Dims the output named `output_name` in software, by scaling its gamma ramps.
+// `brightness` is clamped to [WAYLAND_GAMMA_MIN_BRIGHTNESS, 1] and applied
+// immediately, it is stored in the output's profile once changes settle, see
+// WAYLAND_GAMMA_STORE_DELAY_MS.
+void wayland_gamma_set_brightness(WaylandService *self, const char *output_name,
+                                  double brightness);
+
+// Dims every connected output as wayland_gamma_set_brightness does, skipping
+// internal panels when `skip_internal` is set since those have a backlight.
+void wayland_gamma_set_brightness_all(WaylandService *self, double brightness,
+                                      gboolean skip_internal);
+
+// Returns the brightness of output `output_name`, or the highest brightness of
+// the connected outputs if NULL.
+double wayland_gamma_get_brightness(WaylandService *self,
+                                    const char *output_name);
+
+// Returns FALSE if no night light schedule is configured.
+// Otherwise sets `next` to the unix time of the next scheduled transition and
+// `night` to whether the night light turns on at it.
+gboolean wayland_night_light_schedule_next(WaylandService *self, gint64 *next,
+                                           gboolean *night);
+
+// Returns the names of the saved output layouts, free with g_strfreev.
+gchar **wayland_output_layouts(WaylandService *self);
+
+// Saves the current output configuration as the layout `name`.
+gboolean wayland_output_layout_save(WaylandService *self, const char *name);
+
+// Tests the saved layout `name` and applies it if the compositor accepts it.
+gboolean wayland_output_layout_apply(WaylandService *self, const char *name);
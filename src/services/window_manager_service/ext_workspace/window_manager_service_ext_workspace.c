@@ -0,0 +1,868 @@
+#include "window_manager_service_ext_workspace.h"
+
+#include <adwaita.h>
+#include <string.h>
+#include <wayland-client.h>
+
+#include "../../wayland_service/ext-workspace-v1.h"
+#include "../../wayland_service/wayland_service.h"
+
+// The ext-workspace-v1 backend.
+//
+// Workspace state arrives as Wayland events on the WaylandService's display
+// connection and is dispatched by its event source, there is no second socket
+// and nothing to parse. The compositor batches changes and terminates each
+// batch with the manager's done event, our models are rebuilt once per batch.
+//
+// Windows are sourced from the WaylandService's wlr-foreign-toplevel inventory.
+// Neither protocol relates toplevels to workspaces, so a window's workspace is
+// inferred, see on_top_level_changed.
+
+enum signals {
+    workspaces_changed,
+    outputs_changed,
+    windows_changed,
+    signals_n
+};
+
+// A workspace group as advertised by the compositor, typically one per output.
+typedef struct _ExtWorkspaceGroup {
+    WMServiceExtWorkspace *self;
+    struct ext_workspace_group_handle_v1 *handle;
+    // wl_output proxies bound by the WaylandService, not owned.
+    GPtrArray *outputs;
+} ExtWorkspaceGroup;
+
+typedef struct _ExtWorkspace {
+    WMServiceExtWorkspace *self;
+    struct ext_workspace_handle_v1 *handle;
+    // the group this workspace was last assigned to, may be NULL.
+    ExtWorkspaceGroup *group;
+    gchar *name;
+    // stable for the lifetime of the handle, exposed as WMWorkspace.id.
+    guint32 id;
+    guint32 state;
+    guint32 capabilities;
+} ExtWorkspace;
+
+struct _WMServiceExtWorkspace {
+    GObject parent_instance;
+    WaylandService *wayland;
+    struct wl_registry *registry;
+    struct ext_workspace_manager_v1 *manager;
+    // ExtWorkspaceGroup and ExtWorkspace in the order they were announced.
+    GPtrArray *groups;
+    GPtrArray *ext_workspaces;
+    // the workspace most recently activated, its group holds the focus.
+    ExtWorkspace *last_activated;
+    guint32 next_workspace_id;
+    // protocol state changed since the last done event.
+    gboolean dirty;
+    // models handed to listeners, rebuilt on each done event.
+    GPtrArray *workspaces;
+    GPtrArray *outputs;
+    // application windows, owns its WMWindow elements.
+    GPtrArray *windows;
+    // index into `windows` keyed by WaylandWLRForeignTopLevel.
+    GHashTable *windows_by_toplevel;
+    guint32 next_window_id;
+    GSettings *settings;
+};
+static guint service_signals[signals_n] = {0};
+G_DEFINE_TYPE(WMServiceExtWorkspace, wm_service_ext_workspace, G_TYPE_OBJECT);
+
+static void free_workspace(gpointer data) {
+    WMWorkspace *ws = data;
+    g_free(ws->name);
+    g_free(ws);
+}
+
+static void free_output(gpointer data) {
+    WMOutput *o = data;
+    g_free(o->make);
+    g_free(o->model);
+    g_free(o->serial);
+    g_free(o->current_workspace);
+    g_free(o);
+}
+
+static void free_window(gpointer data) {
+    WMWindow *win = data;
+    g_free(win->app_id);
+    g_free(win->title);
+    g_free(win);
+}
+
+static void ext_workspace_free(ExtWorkspace *ws) {
+    ext_workspace_handle_v1_destroy(ws->handle);
+    g_free(ws->name);
+    g_free(ws);
+}
+
+static void ext_workspace_group_free(ExtWorkspaceGroup *group) {
+    ext_workspace_group_handle_v1_destroy(group->handle);
+    g_ptr_array_unref(group->outputs);
+    g_free(group);
+}
+
+static void wm_service_ext_workspace_dispose(GObject *gobject) {
+    WMServiceExtWorkspace *self = WM_SERVICE_EXT_WORKSPACE(gobject);
+
+    g_signal_handlers_disconnect_by_data(self->wayland, self);
+
+    if (self->ext_workspaces) {
+        g_ptr_array_free(self->ext_workspaces, TRUE);
+        self->ext_workspaces = NULL;
+    }
+    if (self->groups) {
+        g_ptr_array_free(self->groups, TRUE);
+        self->groups = NULL;
+    }
+    if (self->manager) {
+        ext_workspace_manager_v1_stop(self->manager);
+        ext_workspace_manager_v1_destroy(self->manager);
+        self->manager = NULL;
+    }
+    if (self->registry) {
+        wl_registry_destroy(self->registry);
+        self->registry = NULL;
+    }
+
+    if (self->workspaces) g_ptr_array_unref(self->workspaces);
+    if (self->outputs) g_ptr_array_unref(self->outputs);
+    if (self->windows) g_ptr_array_unref(self->windows);
+    g_hash_table_destroy(self->windows_by_toplevel);
+
+    // Chain-up
+    G_OBJECT_CLASS(wm_service_ext_workspace_parent_class)->dispose(gobject);
+};
+
+static void wm_service_ext_workspace_finalize(GObject *gobject) {
+    // Chain-up
+    G_OBJECT_CLASS(wm_service_ext_workspace_parent_class)->finalize(gobject);
+};
+
+static void wm_service_ext_workspace_class_init(
+    WMServiceExtWorkspaceClass *klass) {
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+    object_class->dispose = wm_service_ext_workspace_dispose;
+    object_class->finalize = wm_service_ext_workspace_finalize;
+
+    service_signals[workspaces_changed] = g_signal_new(
+        "workspaces-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0,
+        NULL, NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+
+    service_signals[outputs_changed] = g_signal_new(
+        "outputs-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0, NULL,
+        NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+
+    service_signals[windows_changed] = g_signal_new(
+        "windows-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0, NULL,
+        NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+};
+
+static gint compare_workspace_name(WMWorkspace **a, WMWorkspace **b) {
+    return g_strcmp0((*a)->name, (*b)->name);
+}
+
+// Returns the interned name of the group's first named output or NULL.
+static const gchar *group_output_name(WMServiceExtWorkspace *self,
+                                      ExtWorkspaceGroup *group) {
+    if (!group) return NULL;
+
+    for (guint i = 0; i < group->outputs->len; i++) {
+        WaylandOutput *o = wayland_service_get_output(
+            self->wayland, g_ptr_array_index(group->outputs, i));
+        if (o && o->name) return g_intern_string(o->name);
+    }
+    return NULL;
+}
+
+// Workspace names conventionally start with their number, as in Sway.
+static gint32 workspace_num(const gchar *name) {
+    gchar *end = NULL;
+    gint64 num = 0;
+
+    if (!name) return -1;
+
+    num = g_ascii_strtoll(name, &end, 10);
+    if (end == name) return -1;
+    return num;
+}
+
+static void rebuild_workspaces(WMServiceExtWorkspace *self) {
+    GPtrArray *tmp = g_ptr_array_new_full(self->ext_workspaces->len,
+                                          free_workspace);
+    ExtWorkspaceGroup *focused_group =
+        self->last_activated ? self->last_activated->group : NULL;
+
+    for (guint i = 0; i < self->ext_workspaces->len; i++) {
+        ExtWorkspace *ext = g_ptr_array_index(self->ext_workspaces, i);
+        WMWorkspace *ws = NULL;
+
+        if (ext->state & EXT_WORKSPACE_HANDLE_V1_STATE_HIDDEN) continue;
+
+        ws = g_malloc0(sizeof(WMWorkspace));
+        ws->name = g_strdup(ext->name);
+        ws->output = group_output_name(self, ext->group);
+        ws->id = ext->id;
+        ws->num = workspace_num(ext->name);
+        ws->urgent = (ext->state & EXT_WORKSPACE_HANDLE_V1_STATE_URGENT) != 0;
+        ws->visible = (ext->state & EXT_WORKSPACE_HANDLE_V1_STATE_ACTIVE) != 0;
+        ws->focused = ws->visible && ext->group == focused_group;
+        g_ptr_array_add(tmp, ws);
+    }
+
+    // check 'sort-alphabetical' setting and if true sort
+    if (g_settings_get_boolean(self->settings, "sort-workspaces-alphabetical"))
+        g_ptr_array_sort(tmp, (GCompareFunc)compare_workspace_name);
+
+    if (self->workspaces) g_ptr_array_unref(self->workspaces);
+    self->workspaces = tmp;
+}
+
+static void rebuild_outputs(WMServiceExtWorkspace *self) {
+    GPtrArray *tmp = g_ptr_array_new_full(0, free_output);
+
+    for (guint i = 0; i < self->groups->len; i++) {
+        ExtWorkspaceGroup *group = g_ptr_array_index(self->groups, i);
+        const gchar *current = NULL;
+
+        for (guint j = 0; j < self->ext_workspaces->len; j++) {
+            ExtWorkspace *ext = g_ptr_array_index(self->ext_workspaces, j);
+            if (ext->group == group &&
+                (ext->state & EXT_WORKSPACE_HANDLE_V1_STATE_ACTIVE)) {
+                current = ext->name;
+                break;
+            }
+        }
+
+        for (guint j = 0; j < group->outputs->len; j++) {
+            WaylandOutput *wo = wayland_service_get_output(
+                self->wayland, g_ptr_array_index(group->outputs, j));
+            WMOutput *o = NULL;
+
+            // the output's details have not arrived yet, on_output_added
+            // rebuilds once they do.
+            if (!wo || !wo->name) continue;
+
+            o = g_malloc0(sizeof(WMOutput));
+            o->name = g_intern_string(wo->name);
+            o->make = g_strdup(wo->make);
+            o->model = g_strdup(wo->model);
+            o->current_workspace = g_strdup(current);
+            g_ptr_array_add(tmp, o);
+        }
+    }
+
+    if (self->outputs) g_ptr_array_unref(self->outputs);
+    self->outputs = tmp;
+}
+
+static void rebuild_and_emit(WMServiceExtWorkspace *self) {
+    rebuild_workspaces(self);
+    rebuild_outputs(self);
+
+    g_signal_emit(self, service_signals[workspaces_changed], 0,
+                  self->workspaces);
+    g_signal_emit(self, service_signals[outputs_changed], 0, self->outputs);
+}
+
+static void workspace_handle_id(void *data,
+                                struct ext_workspace_handle_v1 *handle,
+                                const char *id) {
+    g_debug(
+        "window_manager_service_ext_workspace.c:workspace_handle_id() id: %s",
+        id);
+}
+
+static void workspace_handle_name(void *data,
+                                  struct ext_workspace_handle_v1 *handle,
+                                  const char *name) {
+    ExtWorkspace *ws = data;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:workspace_handle_name() "
+        "name: %s",
+        name);
+
+    g_free(ws->name);
+    ws->name = g_strdup(name);
+    ws->self->dirty = TRUE;
+}
+
+static void workspace_handle_coordinates(
+    void *data, struct ext_workspace_handle_v1 *handle,
+    struct wl_array *coordinates) {
+    // no-op, workspaces are presented as a list.
+}
+
+static void workspace_handle_state(void *data,
+                                   struct ext_workspace_handle_v1 *handle,
+                                   uint32_t state) {
+    ExtWorkspace *ws = data;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:workspace_handle_state() "
+        "name: %s state: %u",
+        ws->name, state);
+
+    if ((state & EXT_WORKSPACE_HANDLE_V1_STATE_ACTIVE) &&
+        !(ws->state & EXT_WORKSPACE_HANDLE_V1_STATE_ACTIVE))
+        ws->self->last_activated = ws;
+
+    ws->state = state;
+    ws->self->dirty = TRUE;
+}
+
+static void workspace_handle_capabilities(
+    void *data, struct ext_workspace_handle_v1 *handle,
+    uint32_t capabilities) {
+    ExtWorkspace *ws = data;
+    ws->capabilities = capabilities;
+}
+
+static void workspace_handle_removed(void *data,
+                                     struct ext_workspace_handle_v1 *handle) {
+    ExtWorkspace *ws = data;
+    WMServiceExtWorkspace *self = ws->self;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:workspace_handle_removed() "
+        "name: %s",
+        ws->name);
+
+    if (self->last_activated == ws) self->last_activated = NULL;
+
+    // frees ws.
+    g_ptr_array_remove(self->ext_workspaces, ws);
+    self->dirty = TRUE;
+}
+
+static const struct ext_workspace_handle_v1_listener workspace_listener = {
+    .id = workspace_handle_id,
+    .name = workspace_handle_name,
+    .coordinates = workspace_handle_coordinates,
+    .state = workspace_handle_state,
+    .capabilities = workspace_handle_capabilities,
+    .removed = workspace_handle_removed,
+};
+
+static void group_handle_capabilities(
+    void *data, struct ext_workspace_group_handle_v1 *handle,
+    uint32_t capabilities) {
+    // no-op, way-shell does not create workspaces.
+}
+
+static void group_handle_output_enter(
+    void *data, struct ext_workspace_group_handle_v1 *handle,
+    struct wl_output *output) {
+    ExtWorkspaceGroup *group = data;
+
+    if (!output) return;
+
+    g_ptr_array_add(group->outputs, output);
+    group->self->dirty = TRUE;
+}
+
+static void group_handle_output_leave(
+    void *data, struct ext_workspace_group_handle_v1 *handle,
+    struct wl_output *output) {
+    ExtWorkspaceGroup *group = data;
+
+    g_ptr_array_remove(group->outputs, output);
+    group->self->dirty = TRUE;
+}
+
+static void group_handle_workspace_enter(
+    void *data, struct ext_workspace_group_handle_v1 *handle,
+    struct ext_workspace_handle_v1 *workspace) {
+    ExtWorkspaceGroup *group = data;
+    ExtWorkspace *ws = NULL;
+
+    if (!workspace) return;
+
+    ws = ext_workspace_handle_v1_get_user_data(workspace);
+    ws->group = group;
+    group->self->dirty = TRUE;
+}
+
+static void group_handle_workspace_leave(
+    void *data, struct ext_workspace_group_handle_v1 *handle,
+    struct ext_workspace_handle_v1 *workspace) {
+    ExtWorkspaceGroup *group = data;
+    ExtWorkspace *ws = NULL;
+
+    if (!workspace) return;
+
+    ws = ext_workspace_handle_v1_get_user_data(workspace);
+    if (ws->group == group) ws->group = NULL;
+    group->self->dirty = TRUE;
+}
+
+static void group_handle_removed(void *data,
+                                 struct ext_workspace_group_handle_v1 *handle) {
+    ExtWorkspaceGroup *group = data;
+    WMServiceExtWorkspace *self = group->self;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:group_handle_removed() "
+        "group removed");
+
+    for (guint i = 0; i < self->ext_workspaces->len; i++) {
+        ExtWorkspace *ws = g_ptr_array_index(self->ext_workspaces, i);
+        if (ws->group == group) ws->group = NULL;
+    }
+
+    // frees group.
+    g_ptr_array_remove(self->groups, group);
+    self->dirty = TRUE;
+}
+
+static const struct ext_workspace_group_handle_v1_listener group_listener = {
+    .capabilities = group_handle_capabilities,
+    .output_enter = group_handle_output_enter,
+    .output_leave = group_handle_output_leave,
+    .workspace_enter = group_handle_workspace_enter,
+    .workspace_leave = group_handle_workspace_leave,
+    .removed = group_handle_removed,
+};
+
+static void manager_handle_workspace_group(
+    void *data, struct ext_workspace_manager_v1 *manager,
+    struct ext_workspace_group_handle_v1 *handle) {
+    WMServiceExtWorkspace *self = data;
+    ExtWorkspaceGroup *group = g_malloc0(sizeof(ExtWorkspaceGroup));
+
+    group->self = self;
+    group->handle = handle;
+    group->outputs = g_ptr_array_new();
+    g_ptr_array_add(self->groups, group);
+
+    ext_workspace_group_handle_v1_add_listener(handle, &group_listener, group);
+    self->dirty = TRUE;
+}
+
+static void manager_handle_workspace(void *data,
+                                     struct ext_workspace_manager_v1 *manager,
+                                     struct ext_workspace_handle_v1 *handle) {
+    WMServiceExtWorkspace *self = data;
+    ExtWorkspace *ws = g_malloc0(sizeof(ExtWorkspace));
+
+    ws->self = self;
+    ws->handle = handle;
+    ws->id = ++self->next_workspace_id;
+    g_ptr_array_add(self->ext_workspaces, ws);
+
+    ext_workspace_handle_v1_add_listener(handle, &workspace_listener, ws);
+    self->dirty = TRUE;
+}
+
+static void manager_handle_done(void *data,
+                                struct ext_workspace_manager_v1 *manager) {
+    WMServiceExtWorkspace *self = data;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:manager_handle_done() "
+        "dirty: %d",
+        self->dirty);
+
+    if (!self->dirty) return;
+    self->dirty = FALSE;
+
+    rebuild_and_emit(self);
+}
+
+static void manager_handle_finished(void *data,
+                                    struct ext_workspace_manager_v1 *manager) {
+    WMServiceExtWorkspace *self = data;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:manager_handle_finished() "
+        "compositor finished sending workspace events.");
+
+    ext_workspace_manager_v1_destroy(manager);
+    self->manager = NULL;
+}
+
+static const struct ext_workspace_manager_v1_listener manager_listener = {
+    .workspace_group = manager_handle_workspace_group,
+    .workspace = manager_handle_workspace,
+    .done = manager_handle_done,
+    .finished = manager_handle_finished,
+};
+
+static void registry_handle_global(void *data, struct wl_registry *registry,
+                                   uint32_t name, const char *interface,
+                                   uint32_t version) {
+    WMServiceExtWorkspace *self = data;
+
+    if (strcmp(interface, ext_workspace_manager_v1_interface.name) != 0)
+        return;
+    if (self->manager) return;
+
+    g_debug(
+        "window_manager_service_ext_workspace.c:registry_handle_global() "
+        "binding %s version %u",
+        interface, version);
+
+    // the listener is added before control returns to the dispatcher so no
+    // event of the initial burst is missed.
+    self->manager = wl_registry_bind(
+        registry, name, &ext_workspace_manager_v1_interface, 1);
+    ext_workspace_manager_v1_add_listener(self->manager, &manager_listener,
+                                          self);
+}
+
+static void registry_handle_global_remove(void *data,
+                                          struct wl_registry *registry,
+                                          uint32_t name) {
+    // no-op, the manager announces its own end with the finished event.
+}
+
+static const struct wl_registry_listener registry_listener = {
+    .global = registry_handle_global,
+    .global_remove = registry_handle_global_remove,
+};
+
+static void on_output_added(WaylandService *wayland, GHashTable *outputs,
+                            struct wl_output *output,
+                            WMServiceExtWorkspace *self) {
+    // output names are resolved when models are built, pick up the new name.
+    // mid batch the done event will rebuild instead.
+    if (self->dirty) return;
+    rebuild_and_emit(self);
+}
+
+static void on_output_removed(WaylandService *wayland, WaylandOutput *output,
+                              WMServiceExtWorkspace *self) {
+    // the WaylandService releases the proxy, drop our references to it.
+    for (guint i = 0; i < self->groups->len; i++) {
+        ExtWorkspaceGroup *group = g_ptr_array_index(self->groups, i);
+        g_ptr_array_remove(group->outputs, output->output);
+    }
+    rebuild_and_emit(self);
+}
+
+// Returns the id of the active workspace which most recently gained focus,
+// 0 if there is none.
+static guint32 focused_workspace_id(WMServiceExtWorkspace *self) {
+    ExtWorkspace *ws = self->last_activated;
+
+    if (!ws || !(ws->state & EXT_WORKSPACE_HANDLE_V1_STATE_ACTIVE)) return 0;
+    return ws->id;
+}
+
+// Tracks a toplevel as a WMWindow.
+//
+// Windows are placed on the focused workspace when they appear, where
+// compositors map new windows, and again whenever they are activated, since
+// only a window on a shown workspace can hold focus. A window moved to
+// another workspace without gaining focus keeps its old workspace until it is
+// activated again.
+static void on_top_level_changed(WaylandService *wayland,
+                                 GHashTable *toplevels,
+                                 WaylandWLRForeignTopLevel *toplevel,
+                                 guint changed, WMServiceExtWorkspace *self) {
+    // windows carry no output
+    if (!(changed & ~TOPLEVEL_CHANGE_OUTPUT)) return;
+
+    WMWindow *win = g_hash_table_lookup(self->windows_by_toplevel, toplevel);
+
+    if (!win) {
+        win = g_malloc0(sizeof(WMWindow));
+        win->id = ++self->next_window_id;
+        win->workspace_id = focused_workspace_id(self);
+        g_hash_table_insert(self->windows_by_toplevel, toplevel, win);
+        g_ptr_array_add(self->windows, win);
+    }
+
+    g_free(win->app_id);
+    win->app_id = g_strdup(toplevel->app_id);
+    g_free(win->title);
+    win->title = g_strdup(toplevel->title);
+
+    // the activated state is only reported when it changes, so a window
+    // keeps its focus until another one is activated.
+    if (toplevel->activated && !win->focused) {
+        for (guint i = 0; i < self->windows->len; i++)
+            ((WMWindow *)g_ptr_array_index(self->windows, i))->focused = FALSE;
+        win->focused = TRUE;
+        if (focused_workspace_id(self))
+            win->workspace_id = focused_workspace_id(self);
+    }
+
+    g_signal_emit(self, service_signals[windows_changed], 0, self->windows);
+}
+
+static void on_top_level_removed(WaylandService *wayland,
+                                 WaylandWLRForeignTopLevel *toplevel,
+                                 WMServiceExtWorkspace *self) {
+    WMWindow *win = g_hash_table_lookup(self->windows_by_toplevel, toplevel);
+
+    if (!win) return;
+
+    g_hash_table_remove(self->windows_by_toplevel, toplevel);
+    // frees win.
+    g_ptr_array_remove(self->windows, win);
+
+    g_signal_emit(self, service_signals[windows_changed], 0, self->windows);
+}
+
+static void on_sort_alphabetical_changed(GSettings *settings, gchar *key,
+                                         WMServiceExtWorkspace *self) {
+    g_debug(
+        "window_manager_service_ext_workspace.c:on_sort_alphabetical_changed() "
+        "sort-alphabetical setting changed, updating workspaces.");
+
+    rebuild_workspaces(self);
+    g_signal_emit(self, service_signals[workspaces_changed], 0,
+                  self->workspaces);
+}
+
+static void wm_service_ext_workspace_init(WMServiceExtWorkspace *self) {
+    struct wl_display *display = NULL;
+
+    self->wayland = wayland_service_get_global();
+    if (!self->wayland)
+        g_error(
+            "window_manager_service_ext_workspace.c:wm_service_ext_workspace_"
+            "init wayland service not initialized.");
+
+    self->groups =
+        g_ptr_array_new_with_free_func((GDestroyNotify)ext_workspace_group_free);
+    self->ext_workspaces =
+        g_ptr_array_new_with_free_func((GDestroyNotify)ext_workspace_free);
+    self->workspaces = g_ptr_array_new_full(0, free_workspace);
+    self->outputs = g_ptr_array_new_full(0, free_output);
+    self->windows = g_ptr_array_new_full(0, free_window);
+    self->windows_by_toplevel = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    // connect to 'org.ldelossa.way-shell.window-manager.workspaces' setting
+    self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
+
+    // wire into sort-alphabetical value
+    g_signal_connect(self->settings, "changed::sort-workspaces-alphabetical",
+                     G_CALLBACK(on_sort_alphabetical_changed), self);
+
+    g_signal_connect(self->wayland, "output-added",
+                     G_CALLBACK(on_output_added), self);
+    g_signal_connect(self->wayland, "output-removed",
+                     G_CALLBACK(on_output_removed), self);
+    g_signal_connect(self->wayland, "top-level-changed",
+                     G_CALLBACK(on_top_level_changed), self);
+    g_signal_connect(self->wayland, "top-level-removed",
+                     G_CALLBACK(on_top_level_removed), self);
+
+    // a registry of our own on the shared display, its events are dispatched
+    // by the WaylandService along with everything else.
+    display = wayland_service_get_display(self->wayland);
+    self->registry = wl_display_get_registry(display);
+    wl_registry_add_listener(self->registry, &registry_listener, self);
+    wl_display_flush(display);
+};
+
+GPtrArray *wm_service_ext_workspace_get_workspaces(WindowManager *wm) {
+    WMServiceExtWorkspace *self = wm->private;
+    return g_ptr_array_ref(self->workspaces);
+}
+
+GPtrArray *wm_service_ext_workspace_get_outputs(WindowManager *wm) {
+    WMServiceExtWorkspace *self = wm->private;
+    return g_ptr_array_ref(self->outputs);
+}
+
+GPtrArray *wm_service_ext_workspace_get_windows(WindowManager *wm,
+                                                WMWorkspace *ws) {
+    WMServiceExtWorkspace *self = wm->private;
+    GPtrArray *out = g_ptr_array_new();
+
+    // workspaces are inferred, see on_top_level_changed. a window whose
+    // workspace is unknown has a workspace_id of 0 and matches none.
+    for (guint i = 0; i < self->windows->len; i++) {
+        WMWindow *win = g_ptr_array_index(self->windows, i);
+        if (!ws || win->workspace_id == ws->id) g_ptr_array_add(out, win);
+    }
+
+    return out;
+}
+
+// Requests activation of `ws`, the request takes effect on the next commit.
+static int activate_workspace(WMServiceExtWorkspace *self, WMWorkspace *ws) {
+    ExtWorkspace *ext = NULL;
+
+    if (!ws || !self->manager) return -1;
+
+    for (guint i = 0; i < self->ext_workspaces->len; i++) {
+        ExtWorkspace *tmp = g_ptr_array_index(self->ext_workspaces, i);
+        if (tmp->id == ws->id) {
+            ext = tmp;
+            break;
+        }
+    }
+
+    if (!ext) {
+        g_warning(
+            "window_manager_service_ext_workspace.c:activate_workspace() "
+            "workspace %s no longer exists.",
+            ws->name);
+        return -1;
+    }
+
+    if (!(ext->capabilities &
+          EXT_WORKSPACE_HANDLE_V1_WORKSPACE_CAPABILITIES_ACTIVATE)) {
+        g_warning(
+            "window_manager_service_ext_workspace.c:activate_workspace() "
+            "workspace %s cannot be activated.",
+            ws->name);
+        return -1;
+    }
+
+    ext_workspace_handle_v1_activate(ext->handle);
+    return 0;
+}
+
+static void commit(WMServiceExtWorkspace *self) {
+    ext_workspace_manager_v1_commit(self->manager);
+    wl_display_flush(wayland_service_get_display(self->wayland));
+}
+
+int wm_service_ext_workspace_focus_workspace(WindowManager *wm,
+                                             WMWorkspace *ws) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    if (activate_workspace(self, ws) != 0) return -1;
+    commit(self);
+    return 0;
+}
+
+int wm_service_ext_workspace_rename_current_workspace(WindowManager *wm,
+                                                      const gchar *name) {
+    g_warning(
+        "window_manager_service_ext_workspace.c:wm_service_ext_workspace_"
+        "rename_current_workspace() not supported by ext-workspace-v1.");
+    return -1;
+}
+
+int wm_service_ext_workspace_current_ws_to_output(WindowManager *wm,
+                                                  WMOutput *o) {
+    g_warning(
+        "window_manager_service_ext_workspace.c:wm_service_ext_workspace_"
+        "current_ws_to_output() not supported by ext-workspace-v1.");
+    return -1;
+}
+
+int wm_service_ext_workspace_current_app_to_workspace(WindowManager *wm,
+                                                      WMWorkspace *ws) {
+    g_warning(
+        "window_manager_service_ext_workspace.c:wm_service_ext_workspace_"
+        "current_app_to_workspace() not supported by ext-workspace-v1.");
+    return -1;
+}
+
+int wm_service_ext_workspace_run_batch(WindowManager *wm, WMCommand *cmds,
+                                       guint len, wm_on_batch_done cb,
+                                       void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+    GArray *results = NULL;
+    gboolean any = FALSE;
+
+    if (!self->manager) return -1;
+
+    // the protocol only supports activation, every other command fails. all
+    // activations are applied atomically by a single commit.
+    results = g_array_sized_new(FALSE, TRUE, sizeof(gboolean), len);
+    for (guint i = 0; i < len; i++) {
+        gboolean ok = cmds[i].type == WMCOMMAND_FOCUS_WORKSPACE &&
+                      activate_workspace(self, cmds[i].workspace) == 0;
+        any |= ok;
+        g_array_append_val(results, ok);
+    }
+
+    if (any) commit(self);
+
+    if (cb) cb(data, results);
+    g_array_unref(results);
+
+    return 0;
+}
+
+guint wm_service_ext_workspace_register_on_workspaces_changed(
+    WindowManager *wm, wm_on_workspaces_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    // we use swapped here because workspaces_changed functions should not
+    // leak the private workspace service's implementation in their signatures.
+    return g_signal_connect_swapped(self, "workspaces-changed", G_CALLBACK(cb),
+                                    data);
+}
+
+guint wm_service_ext_workspace_unregister_on_workspaces_changed(
+    WindowManager *wm, wm_on_workspaces_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    return g_signal_handlers_disconnect_by_func(self, cb, data);
+}
+
+guint wm_service_ext_workspace_register_on_outputs_changed(
+    WindowManager *wm, wm_on_outputs_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    return g_signal_connect_swapped(self, "outputs-changed", G_CALLBACK(cb),
+                                    data);
+}
+
+guint wm_service_ext_workspace_unregister_on_outputs_changed(
+    WindowManager *wm, wm_on_outputs_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    return g_signal_handlers_disconnect_by_func(self, cb, data);
+}
+
+guint wm_service_ext_workspace_register_on_windows_changed(
+    WindowManager *wm, wm_on_windows_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    return g_signal_connect_swapped(self, "windows-changed", G_CALLBACK(cb),
+                                    data);
+}
+
+guint wm_service_ext_workspace_unregister_on_windows_changed(
+    WindowManager *wm, wm_on_windows_changed cb, void *data) {
+    WMServiceExtWorkspace *self = wm->private;
+
+    return g_signal_handlers_disconnect_by_func(self, cb, data);
+}
+
+WindowManager *wm_service_ext_workspace_window_manager_init() {
+    WindowManager *wm = g_malloc(sizeof(WindowManager));
+
+    WMServiceExtWorkspace *self =
+        g_object_new(WM_SERVICE_EXT_WORKSPACE_TYPE, NULL);
+
+    // write virt func table.
+    wm->private = self;
+    wm->get_workspaces = wm_service_ext_workspace_get_workspaces;
+    wm->get_outputs = wm_service_ext_workspace_get_outputs;
+    wm->focus_workspace = wm_service_ext_workspace_focus_workspace;
+    wm->rename_workspace = wm_service_ext_workspace_rename_current_workspace;
+    wm->current_ws_to_output = wm_service_ext_workspace_current_ws_to_output;
+    wm->current_app_to_workspace =
+        wm_service_ext_workspace_current_app_to_workspace;
+    wm->register_on_workspaces_changed =
+        wm_service_ext_workspace_register_on_workspaces_changed;
+    wm->unregister_on_workspaces_changed =
+        wm_service_ext_workspace_unregister_on_workspaces_changed;
+    wm->register_on_outputs_changed =
+        wm_service_ext_workspace_register_on_outputs_changed;
+    wm->unregister_on_outputs_changed =
+        wm_service_ext_workspace_unregister_on_outputs_changed;
+    wm->get_windows = wm_service_ext_workspace_get_windows;
+    wm->register_on_windows_changed =
+        wm_service_ext_workspace_register_on_windows_changed;
+    wm->unregister_on_windows_changed =
+        wm_service_ext_workspace_unregister_on_windows_changed;
+    wm->run_batch = wm_service_ext_workspace_run_batch;
+
+    return wm;
+}
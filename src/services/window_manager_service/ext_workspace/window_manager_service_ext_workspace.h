@@ -0,0 +1,16 @@
+#pragma once
+
+#include <adwaita.h>
+
+#include "../window_manager_service.h"
+
+G_BEGIN_DECLS
+
+struct _WMServiceExtWorkspace;
+#define WM_SERVICE_EXT_WORKSPACE_TYPE wm_service_ext_workspace_get_type()
+G_DECLARE_FINAL_TYPE(WMServiceExtWorkspace, wm_service_ext_workspace,
+                     WM_SERVICE, EXT_WORKSPACE, GObject);
+
+G_END_DECLS
+
+WindowManager *wm_service_ext_workspace_window_manager_init();
@@ -3,16 +3,37 @@
 #include <adwaita.h>
 #include <asm-generic/errno.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <glib-unix.h>
 #include <glob.h>
 #include <json-glib/json-glib.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <sys/un.h>
 #include <unistd.h>
 
 #include "../../window_manager_service/window_manager_service.h"
 #include "ipc.h"
+#include "sway_json.h"
+#include "sway_record.h"
+
+// capture file every received frame is teed to, see
+// sway_client_ipc_record_start.
+static FILE *record_file = NULL;
+static gint64 record_start_us = 0;
+
+// Bytes accepted by sway_client_ipc_send which the socket could not take yet.
+typedef struct _sway_client_write_backlog {
+    int socket_fd;
+    GByteArray *bytes;
+    // G_IO_OUT watch flushing `bytes`.
+    guint watch_id;
+} sway_client_write_backlog;
+
+// sway_client_write_backlog structs keyed by socket.
+static GHashTable *backlogs = NULL;
 
 WMWorkspaceEventType sway_client_event_map(char *event) {
     if (g_strcmp0(event, "init") == 0) return WMWORKSPACE_EVENT_CREATED;
@@ -87,47 +108,136 @@ SWAY_CLIENT_ERR sway_client_ipc_connect(gchar *socket_path) {
     if (connect(socket_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0)
         return -SWAY_CLIENT_ERR_SOCKET_CONNECT_FAIL;
 
+    // reads are driven by GLib's event loop and must never block it.
+    if (fcntl(socket_fd, F_SETFL, fcntl(socket_fd, F_GETFL) | O_NONBLOCK) != 0)
+        return -SWAY_CLIENT_ERR_SOCKET_CREATE_FAIL;
+
     return socket_fd;
 }
 
-static int socket_write(int socket_fd, uint8_t *buff, int size) {
-    int n = size;
-    int b = write(socket_fd, buff, n);
-    for (; n > 0; b = write(socket_fd, buff, n)) {
-        if (b < 0) {
-            if (errno == EINTR) continue;
-            if (errno) {
-                g_critical(
-                    "sway_client.c:sway_client_ipc_send() "
-                    "failed to write to socket %d %s.",
-                    errno, strerror(errno));
-                return -SWAY_CLIENT_ERR_SOCKET_WRITE;
-            }
-        }
-        n -= b;
-        b += b;
-    }
-    return size;
-}
-
-static int socket_read(int socket_fd, uint8_t *buff, int size) {
-    int n = size;
-    int b = read(socket_fd, buff, n);
-    for (; n > 0; b = read(socket_fd, buff, n)) {
-        if (b < 0) {
-            if (errno == EINTR) continue;
-            if (errno) {
-                g_critical(
-                    "sway_client.c:sway_client_ipc_send() "
-                    "failed to read from socket %d %s.",
-                    errno, strerror(errno));
-                return -SWAY_CLIENT_ERR_SOCKET_READ;
-            }
+static void backlog_free(sway_client_write_backlog *backlog) {
+    if (backlog->watch_id) g_source_remove(backlog->watch_id);
+    g_byte_array_unref(backlog->bytes);
+    g_free(backlog);
+}
+
+static sway_client_write_backlog *backlog_lookup(int socket_fd) {
+    if (!backlogs) return NULL;
+    return g_hash_table_lookup(backlogs, GINT_TO_POINTER(socket_fd));
+}
+
+static void backlog_drop(int socket_fd) {
+    if (backlogs) g_hash_table_remove(backlogs, GINT_TO_POINTER(socket_fd));
+}
+
+// Writes as much of `buff` as the socket takes without blocking.
+// Returns the number of bytes written or -SWAY_CLIENT_ERR_SOCKET_WRITE.
+static gssize socket_write_some(int socket_fd, const guint8 *buff, gsize size) {
+    gsize written = 0;
+
+    while (written < size) {
+        gssize b = write(socket_fd, buff + written, size - written);
+        if (b >= 0) {
+            written += b;
+            continue;
         }
-        n -= b;
-        b += b;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        g_critical(
+            "sway_client.c:socket_write_some() "
+            "failed to write to socket %d %s.",
+            errno, strerror(errno));
+        return -SWAY_CLIENT_ERR_SOCKET_WRITE;
+    }
+    return written;
+}
+
+static gboolean on_socket_writable(gint fd, GIOCondition condition,
+                                   sway_client_write_backlog *backlog) {
+    gssize n = 0;
+
+    if (condition & (G_IO_HUP | G_IO_ERR)) {
+        g_warning(
+            "sway_client.c:on_socket_writable() "
+            "socket %d closed with %u bytes unsent.",
+            fd, backlog->bytes->len);
+        n = -SWAY_CLIENT_ERR_SOCKET_CLOSED;
+    } else {
+        n = socket_write_some(fd, backlog->bytes->data, backlog->bytes->len);
+    }
+
+    if (n >= 0) g_byte_array_remove_range(backlog->bytes, 0, n);
+    if (n >= 0 && backlog->bytes->len > 0) return G_SOURCE_CONTINUE;
+
+    // flushed, or the connection is gone. Returning G_SOURCE_REMOVE removes
+    // the watch.
+    backlog->watch_id = 0;
+    backlog_drop(fd);
+    return G_SOURCE_REMOVE;
+}
+
+// Queues `buff` for `socket_fd` and makes sure a watch will flush it.
+static int backlog_append(int socket_fd, const guint8 *buff, gsize size) {
+    sway_client_write_backlog *backlog = backlog_lookup(socket_fd);
+
+    if (!backlogs)
+        backlogs = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                         (GDestroyNotify)backlog_free);
+
+    if (!backlog) {
+        backlog = g_malloc0(sizeof(sway_client_write_backlog));
+        backlog->socket_fd = socket_fd;
+        backlog->bytes = g_byte_array_new();
+        g_hash_table_insert(backlogs, GINT_TO_POINTER(socket_fd), backlog);
+    }
+
+    if (backlog->bytes->len + size > SWAY_CLIENT_IPC_MAX_BACKLOG) {
+        g_critical(
+            "sway_client.c:backlog_append() "
+            "socket %d is not draining, %u bytes already queued.",
+            socket_fd, backlog->bytes->len);
+        return -SWAY_CLIENT_ERR_SOCKET_WRITE;
     }
-    return size;
+
+    g_byte_array_append(backlog->bytes, buff, size);
+    if (!backlog->watch_id)
+        backlog->watch_id =
+            g_unix_fd_add(socket_fd, G_IO_OUT | G_IO_HUP | G_IO_ERR,
+                          (GUnixFDSourceFunc)on_socket_writable, backlog);
+
+    g_debug(
+        "sway_client.c:backlog_append() "
+        "socket %d is full, %u bytes queued.",
+        socket_fd, backlog->bytes->len);
+
+    return 0;
+}
+
+// Writes `buff` to the non-blocking socket, queueing whatever it can't take
+// right away. Never blocks.
+static int socket_write(int socket_fd, const guint8 *buff, gsize size) {
+    gssize n = 0;
+
+    // frames must stay in order, queue behind anything still unsent.
+    if (backlog_lookup(socket_fd))
+        return backlog_append(socket_fd, buff, size);
+
+    n = socket_write_some(socket_fd, buff, size);
+    if (n < 0) return n;
+    if ((gsize)n == size) return 0;
+
+    return backlog_append(socket_fd, buff + n, size - n);
+}
+
+gsize sway_client_ipc_backlog(int socket_fd) {
+    sway_client_write_backlog *backlog = backlog_lookup(socket_fd);
+    return backlog ? backlog->bytes->len : 0;
+}
+
+void sway_client_ipc_close(int socket_fd) {
+    if (socket_fd < 0) return;
+    backlog_drop(socket_fd);
+    close(socket_fd);
 }
 
 int sway_client_ipc_send(int socket_fd, sway_client_ipc_msg *msg) {
@@ -150,7 +260,7 @@ int sway_client_ipc_send(int socket_fd, sway_client_ipc_msg *msg) {
     // copy in payload
     if (msg->size > 0 && msg->payload) memcpy(p, msg->payload, msg->size);
 
-    // send off the buffer
+    // send off the buffer, or queue it until the socket drains.
     n = socket_write(socket_fd, buff, sizeof(buff));
     if (n < 0) return n;
 
@@ -162,43 +272,190 @@ int sway_client_ipc_send(int socket_fd, sway_client_ipc_msg *msg) {
     return 0;
 }
 
-int sway_client_ipc_recv(int socket_fd, sway_client_ipc_msg *msg) {
-    uint8_t buff[SWAY_CLIENT_IPC_HEADER_SIZE] = {0};
-    uint8_t *p = buff;
-    int n = 0;
+void sway_client_ipc_reader_init(sway_client_ipc_reader *r) {
+    r->buff = NULL;
+    r->head = 0;
+    r->tail = 0;
+    r->cap = 0;
+}
 
-    g_debug("sway_client.c:sway_client_ipc_recv() called");
+void sway_client_ipc_reader_clear(sway_client_ipc_reader *r) {
+    g_free(r->buff);
+    sway_client_ipc_reader_init(r);
+}
 
-    // read in header
-    n = socket_read(socket_fd, buff, sizeof(buff));
-    if (n < 0) return n;
+// Grows the ring to at least `cap` bytes, moving unread data to its start.
+static void reader_grow(sway_client_ipc_reader *r, gsize cap) {
+    gsize unread = r->tail - r->head;
+    gsize new_cap = r->cap ? r->cap : SWAY_CLIENT_IPC_READ_CHUNK;
+    guint8 *buff = NULL;
+
+    while (new_cap < cap) new_cap *= 2;
+    if (new_cap == r->cap) return;
+
+    buff = g_malloc(new_cap);
+    if (unread) {
+        gsize start = r->head & (r->cap - 1);
+        gsize first = MIN(unread, r->cap - start);
+        memcpy(buff, r->buff + start, first);
+        memcpy(buff + first, r->buff, unread - first);
+    }
 
-    // confirm i3-ipc magic
-    for (int i = 0; i < SWAY_CLIENT_IPC_MAGIC_SIZE; i++) {
-        if (*p != sway_client_ipc_magic[i])
-            return -SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC;
-        p++;
+    g_free(r->buff);
+    r->buff = buff;
+    r->cap = new_cap;
+    r->head = 0;
+    r->tail = unread;
+}
+
+// Copies `n` unread bytes starting `offset` bytes past the head into `dst`.
+static void reader_peek(sway_client_ipc_reader *r, gsize offset, void *dst,
+                        gsize n) {
+    gsize start = (r->head + offset) & (r->cap - 1);
+    gsize first = MIN(n, r->cap - start);
+
+    memcpy(dst, r->buff + start, first);
+    memcpy((guint8 *)dst + first, r->buff, n - first);
+}
+
+int sway_client_ipc_read(int socket_fd, sway_client_ipc_reader *r) {
+    gssize n = 0;
+
+    g_debug("sway_client.c:sway_client_ipc_read() called");
+
+    // drain the socket, GLib only wakes us once per poll iteration so grab
+    // everything which is available now.
+    for (;;) {
+        gsize unread = r->tail - r->head;
+
+        if (r->cap - unread < SWAY_CLIENT_IPC_READ_CHUNK)
+            reader_grow(r, unread + SWAY_CLIENT_IPC_READ_CHUNK);
+
+        // the free space may wrap around the end of the ring.
+        gsize start = r->tail & (r->cap - 1);
+        gsize free = r->cap - unread;
+        gsize first = MIN(free, r->cap - start);
+        struct iovec iov[2] = {
+            {.iov_base = r->buff + start, .iov_len = first},
+            {.iov_base = r->buff, .iov_len = free - first},
+        };
+
+        n = readv(socket_fd, iov, iov[1].iov_len ? 2 : 1);
+        if (n > 0) {
+            r->tail += n;
+            continue;
+        }
+        if (n == 0) return -SWAY_CLIENT_ERR_SOCKET_CLOSED;
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+
+        g_critical(
+            "sway_client.c:sway_client_ipc_read() "
+            "failed to read from socket %d %s.",
+            errno, strerror(errno));
+        return -SWAY_CLIENT_ERR_SOCKET_READ;
     }
+}
+
+int sway_client_ipc_record_start(const gchar *path) {
+    sway_record_file_header hdr = {0};
+
+    if (record_file) return 0;
+
+    record_file = fopen(path, "wb");
+    if (!record_file) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_record_start() "
+            "failed to open capture file %s: %s",
+            path, g_strerror(errno));
+        return -1;
+    }
+
+    memcpy(hdr.magic, SWAY_RECORD_MAGIC, SWAY_RECORD_MAGIC_SIZE);
+    hdr.version = SWAY_RECORD_VERSION;
+    fwrite(&hdr, sizeof(hdr), 1, record_file);
+    fflush(record_file);
+
+    record_start_us = g_get_monotonic_time();
+
+    g_info(
+        "sway_client.c:sway_client_ipc_record_start() "
+        "recording sway ipc frames to %s",
+        path);
+
+    return 0;
+}
+
+void sway_client_ipc_record_stop() {
+    if (!record_file) return;
+    fclose(record_file);
+    record_file = NULL;
+}
+
+static void sway_client_ipc_record(sway_client_ipc_msg *msg,
+                                   const guint8 *payload) {
+    sway_record_frame_header hdr = {0};
+
+    hdr.usec = g_get_monotonic_time() - record_start_us;
+    hdr.size = msg->size;
+    hdr.type = msg->type;
+
+    // flush each frame so a capture survives the shell being killed.
+    if (fwrite(&hdr, sizeof(hdr), 1, record_file) != 1 ||
+        (msg->size && fwrite(payload, msg->size, 1, record_file) != 1) ||
+        fflush(record_file) != 0) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_record() "
+            "failed to write capture, recording stopped.");
+        sway_client_ipc_record_stop();
+    }
+}
+
+int sway_client_ipc_recv(sway_client_ipc_reader *r, sway_client_ipc_msg *msg) {
+    guint8 hdr[SWAY_CLIENT_IPC_HEADER_SIZE];
+    gsize unread = r->tail - r->head;
+
+    msg->payload = NULL;
+
+    if (unread < SWAY_CLIENT_IPC_HEADER_SIZE) return 0;
+
+    reader_peek(r, 0, hdr, SWAY_CLIENT_IPC_HEADER_SIZE);
+
+    // confirm i3-ipc magic
+    if (memcmp(hdr, sway_client_ipc_magic, SWAY_CLIENT_IPC_MAGIC_SIZE) != 0)
+        return -SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC;
 
     // copy next 8 bytes to msg, will be in native endian
-    memcpy(&msg->size, p, 8);
+    memcpy(&msg->size, hdr + SWAY_CLIENT_IPC_MAGIC_SIZE, 8);
+
+    if (msg->size > SWAY_CLIENT_IPC_MAX_PAYLOAD) {
+        g_critical(
+            "sway_client.c:sway_client_ipc_recv() "
+            "frame of type %u advertises %u bytes, over the %u byte limit.",
+            msg->type, msg->size, SWAY_CLIENT_IPC_MAX_PAYLOAD);
+        return -SWAY_CLIENT_ERR_PROTOCOL_FRAME_TOO_BIG;
+    }
 
-    // rest is payload, malloc a buffer for it, read in data, and return to
-    // caller. caller is responsible for freeing this if a payload exists.
-    if (msg->size == 0) {
-        return 0;
+    // wait for the rest of the frame.
+    if (unread - SWAY_CLIENT_IPC_HEADER_SIZE < msg->size) return 0;
+
+    // caller is responsible for freeing this if a payload exists.
+    if (msg->size > 0) {
+        msg->payload = g_malloc(msg->size);
+        reader_peek(r, SWAY_CLIENT_IPC_HEADER_SIZE, msg->payload, msg->size);
     }
 
-    msg->payload = g_malloc0(msg->size);
-    n = socket_read(socket_fd, (uint8_t *)msg->payload, msg->size);
-    if (n < 0) return n;
+    if (record_file) sway_client_ipc_record(msg, (guint8 *)msg->payload);
+
+    r->head += SWAY_CLIENT_IPC_HEADER_SIZE + msg->size;
+    if (r->head == r->tail) r->head = r->tail = 0;
 
     g_debug(
         "sway_client.c:sway_client_ipc_recv() "
         "received ipc msg of type %u and size %u",
         msg->type, msg->size);
 
-    return 0;
+    return 1;
 }
 
 int sway_client_ipc_get_outputs_req(int socket_fd) {
@@ -208,60 +465,69 @@ int sway_client_ipc_get_outputs_req(int socket_fd) {
     return sway_client_ipc_send(socket_fd, &msg);
 }
 
-int sway_client_parse_output_json(JsonObject *obj, WMOutput *o) {
-    JsonNode *node = NULL;
+// Decodes an output object at the cursor into `o`.
+static int sway_client_decode_output(sway_json_cursor *c, WMOutput *o) {
+    enum { NAME = 1, MAKE = 2, MODEL = 4, SERIAL = 8, CURRENT_WS = 16 };
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    guint seen = 0;
+
+    if (!sway_json_enter_object(c)) return -1;
+
+    while (sway_json_object_next(c, &key, &key_len)) {
+        if (sway_json_key_eq(key, key_len, "name")) {
+            // output names are repeated across every message, intern them.
+            o->name = sway_json_read_interned_string(c);
+            seen |= NAME;
+        } else if (sway_json_key_eq(key, key_len, "make")) {
+            g_free(o->make);
+            o->make = sway_json_read_string(c);
+            seen |= MAKE;
+        } else if (sway_json_key_eq(key, key_len, "model")) {
+            g_free(o->model);
+            o->model = sway_json_read_string(c);
+            seen |= MODEL;
+        } else if (sway_json_key_eq(key, key_len, "serial")) {
+            g_free(o->serial);
+            o->serial = sway_json_read_string(c);
+            seen |= SERIAL;
+        } else if (sway_json_key_eq(key, key_len, "current_workspace")) {
+            g_free(o->current_workspace);
+            o->current_workspace = sway_json_read_string(c);
+            seen |= CURRENT_WS;
+        } else {
+            sway_json_skip_value(c);
+        }
+    }
+    if (c->error) return -1;
 
-    // parse name -> o.name string
-    node = json_object_get_member(obj, "name");
-    if (!node) {
+    if (!(seen & NAME))
         g_error(
-            "sway_client.c:sway_client_parse_output() "
+            "sway_client.c:sway_client_decode_output() "
             "failed to read member 'name'.");
-    }
-    o->name = g_strdup(json_node_get_string(node));
-
-    // parse make -> o.make string
-    node = json_object_get_member(obj, "make");
-    if (!node) {
+    if (!(seen & MAKE))
         g_error(
-            "sway_client.c:sway_client_parse_output() "
+            "sway_client.c:sway_client_decode_output() "
             "failed to read member 'make'.");
-    }
-    o->make = g_strdup(json_node_get_string(node));
-
-    // parse model -> o.model string
-    node = json_object_get_member(obj, "model");
-    if (!node) {
+    if (!(seen & MODEL))
         g_error(
-            "sway_client.c:sway_client_parse_output() "
+            "sway_client.c:sway_client_decode_output() "
             "failed to read member 'model'.");
-    }
-    o->model = g_strdup(json_node_get_string(node));
-
-    // parse serial -> o.serial
-    node = json_object_get_member(obj, "serial");
-    if (!node) {
+    if (!(seen & SERIAL))
         g_error(
-            "sway_client.c:sway_client_parse_output() "
+            "sway_client.c:sway_client_decode_output() "
             "failed to read member 'serial'.");
-    }
-    o->serial = g_strdup(json_node_get_string(node));
-
-    // parse current_workspace -> o.current_workspace
-    node = json_object_get_member(obj, "current_workspace");
-    if (!node) {
+    if (!(seen & CURRENT_WS))
         g_error(
-            "sway_client.c:sway_client_parse_output() "
+            "sway_client.c:sway_client_decode_output() "
             "failed to read member 'current_workspace'.");
-    }
-    o->current_workspace = g_strdup(json_node_get_string(node));
 
     return 0;
 };
 
 static void free_output(gpointer data) {
     WMOutput *o = (WMOutput *)data;
-    g_free(o->name);
+    // o->name is interned and must not be freed.
     g_free(o->make);
     g_free(o->model);
     g_free(o->serial);
@@ -270,55 +536,34 @@ static void free_output(gpointer data) {
 }
 
 GPtrArray *sway_client_ipc_get_outputs_resp(sway_client_ipc_msg *msg) {
-    GPtrArray *out = g_ptr_array_new_full(0, free_output);
-    JsonParser *parser = NULL;
-    JsonReader *reader = NULL;
-    GError *error = NULL;
-    guint outputs_n = 0;
+    GPtrArray *out = NULL;
+    sway_json_cursor c;
 
     g_debug("sway_client.c:sway_client_ipc_get_outputs_resp() called");
 
     if (msg->size == 0) return NULL;
 
-    parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, msg->payload, msg->size, &error)) {
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_array(&c)) {
         g_warning(
             "sway_client.c:sway_client_ipc_get_outputs_resp() "
-            "failed to parse json.");
+            "received non-array response.");
+        g_free(msg->payload);
         return NULL;
     }
-    reader = json_reader_new(json_parser_get_root(parser));
 
-    if (!json_reader_is_array(reader))
-        g_error(
-            "sway_client.c:sway_client_ipc_get_outputs_resp() "
-            "received non-array response.");
+    out = g_ptr_array_new_full(0, free_output);
 
-    outputs_n = json_reader_count_elements(reader);
-    g_debug(
-        "sway_client.c:sway_client_ipc_get_outputs_resp() "
-        "received response with %d outputs.",
-        outputs_n);
-
-    for (int i = 0; i < outputs_n; i++) {
-        JsonNode *node = NULL;
+    while (sway_json_array_next(&c)) {
         WMOutput *o = g_malloc0(sizeof(WMOutput));
 
-        if (!json_reader_read_element(reader, i))
-            g_error(
-                "sway_client.c:sway_client_ipc_get_outputs_resp() "
-                "failed to read element %d.",
-                i);
-
-        node = json_reader_get_current_node(reader);
-
-        if (sway_client_parse_output_json(json_node_get_object(node), o) != 0) {
-            json_reader_end_element(reader);
+        if (sway_client_decode_output(&c, o) != 0) {
             g_warning(
                 "sway_client.c:sway_client_ipc_get_outputs_resp() "
                 "failed to parse output %d.",
-                i);
-            g_free(o);
+                out->len);
+            free_output(o);
             continue;
         }
 
@@ -327,14 +572,23 @@ GPtrArray *sway_client_ipc_get_outputs_resp(sway_client_ipc_msg *msg) {
             "parsed output [%s] [%s] [%s] [%s] [%s].",
             o->name, o->make, o->model, o->serial, o->current_workspace);
 
-        json_reader_end_element(reader);
-
         // add to output array
         g_ptr_array_add(out, o);
     }
 
-    g_object_unref(reader);
-    g_object_unref(parser);
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_get_outputs_resp() "
+            "failed to parse json.");
+        g_ptr_array_unref(out);
+        out = NULL;
+    } else {
+        g_debug(
+            "sway_client.c:sway_client_ipc_get_outputs_resp() "
+            "received response with %d outputs.",
+            out->len);
+    }
+
     g_free(msg->payload);
 
     return out;
@@ -347,115 +601,142 @@ int sway_client_ipc_get_workspaces_req(int socket_fd) {
     return sway_client_ipc_send(socket_fd, &msg);
 }
 
-int sway_client_parse_workspace_json(JsonObject *obj, WMWorkspace *ws) {
-    JsonNode *node = NULL;
+// Decodes a rect object at the cursor, members other than the box are
+// skipped.
+static void sway_client_decode_rect(sway_json_cursor *c, gint32 *x,
+                                    gint32 *y, gint32 *width,
+                                    gint32 *height) {
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    gint64 v = 0;
+
+    if (!sway_json_enter_object(c)) return;
+
+    while (sway_json_object_next(c, &key, &key_len)) {
+        gint32 *field = NULL;
+        if (sway_json_key_eq(key, key_len, "x"))
+            field = x;
+        else if (sway_json_key_eq(key, key_len, "y"))
+            field = y;
+        else if (sway_json_key_eq(key, key_len, "width"))
+            field = width;
+        else if (sway_json_key_eq(key, key_len, "height"))
+            field = height;
+
+        if (!field)
+            sway_json_skip_value(c);
+        else if (sway_json_read_int(c, &v))
+            *field = v;
+    }
+}
 
-    // parse id -> ws.id
-    node = json_object_get_member(obj, "id");
-    if (!node) return -1;
-    ws->id = json_node_get_int(node);
+// Decodes a workspace object at the cursor into `ws`.
+//
+// Workspace objects found in events embed their full node tree, nested
+// members are skipped without being decoded.
+static int sway_client_decode_workspace(sway_json_cursor *c,
+                                        WMWorkspace *ws) {
+    enum { ID = 1, NUM = 2, NAME = 4, URGENT = 8, OUTPUT = 16, FOCUSED = 32 };
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    guint seen = 0;
+    gint64 v = 0;
+
+    if (!sway_json_enter_object(c)) return -1;
+
+    while (sway_json_object_next(c, &key, &key_len)) {
+        if (sway_json_key_eq(key, key_len, "id")) {
+            if (sway_json_read_int(c, &v)) ws->id = v;
+            seen |= ID;
+        } else if (sway_json_key_eq(key, key_len, "num")) {
+            if (sway_json_read_int(c, &v)) ws->num = v;
+            seen |= NUM;
+        } else if (sway_json_key_eq(key, key_len, "name")) {
+            g_free(ws->name);
+            ws->name = sway_json_read_string(c);
+            seen |= NAME;
+        } else if (sway_json_key_eq(key, key_len, "urgent")) {
+            sway_json_read_bool(c, &ws->urgent);
+            seen |= URGENT;
+        } else if (sway_json_key_eq(key, key_len, "output")) {
+            // output names are repeated across every message, intern them.
+            ws->output = sway_json_read_interned_string(c);
+            seen |= OUTPUT;
+        } else if (sway_json_key_eq(key, key_len, "focused")) {
+            sway_json_read_bool(c, &ws->focused);
+            seen |= FOCUSED;
+        } else if (sway_json_key_eq(key, key_len, "visible")) {
+            sway_json_read_bool(c, &ws->visible);
+        } else if (sway_json_key_eq(key, key_len, "rect")) {
+            sway_client_decode_rect(c, &ws->x, &ws->y, &ws->width,
+                                    &ws->height);
+        } else {
+            sway_json_skip_value(c);
+        }
+    }
+    if (c->error) return -1;
 
-    // parse num -> ws.num
-    node = json_object_get_member(obj, "num");
-    if (!node)
+    if (!(seen & ID)) return -1;
+    if (!(seen & NUM))
         g_error(
-            "sway_client.c:sway_client_parse_workspace() "
+            "sway_client.c:sway_client_decode_workspace() "
             "failed to read member 'num'.");
-    ws->num = json_node_get_int(node);
-
-    // get name
-    node = json_object_get_member(obj, "name");
-    if (!node)
+    if (!(seen & NAME))
         g_error(
-            "sway_client.c:sway_client_parse_workspace() "
+            "sway_client.c:sway_client_decode_workspace() "
             "failed to read member 'name'.");
-    ws->name = g_strdup(json_node_get_string(node));
-
-    // parse urgent boolean
-    node = json_object_get_member(obj, "urgent");
-    if (!node)
+    if (!(seen & URGENT))
         g_error(
-            "sway_client.c:sway_client_parse_workspace() "
+            "sway_client.c:sway_client_decode_workspace() "
             "failed to read member 'urgent'.");
-    ws->urgent = json_node_get_boolean(node);
-
-    // parse output
-    node = json_object_get_member(obj, "output");
-    if (!node)
+    if (!(seen & OUTPUT))
         g_error(
-            "sway_client.c:sway_client_parse_workspace() "
+            "sway_client.c:sway_client_decode_workspace() "
             "failed to read member 'output'.");
-    ws->output = g_strdup(json_node_get_string(node));
-
-    // parse focused
-    node = json_object_get_member(obj, "focused");
-    if (!node)
+    if (!(seen & FOCUSED))
         g_error(
-            "sway_client.c:sway_client_parse_workspace() "
+            "sway_client.c:sway_client_decode_workspace() "
             "failed to read member 'focused'.");
-    ws->focused = json_node_get_boolean(node);
 
     return 0;
 }
 
 static void free_workspace(gpointer data) {
     WMWorkspace *ws = (WMWorkspace *)data;
+    // ws->output is interned and must not be freed.
     g_free(ws->name);
-    g_free(ws->output);
     g_free(ws);
 }
 
 GPtrArray *sway_client_ipc_get_workspaces_resp(sway_client_ipc_msg *msg) {
-    GPtrArray *out = g_ptr_array_new_full(0, free_workspace);
-    JsonParser *parser = NULL;
-    JsonReader *reader = NULL;
-    GError *error = NULL;
-    guint workspaces_n = 0;
+    GPtrArray *out = NULL;
+    sway_json_cursor c;
 
     g_debug("sway_client.c:sway_client_ipc_get_workspaces_resp() called");
 
     if (msg->size == 0) return NULL;
 
-    parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, msg->payload, msg->size, &error)) {
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_array(&c)) {
         g_warning(
             "sway_client.c:sway_client_ipc_get_workspaces_resp() "
-            "failed to parse json.");
+            "received non-array response.");
+        g_free(msg->payload);
         return NULL;
     }
-    reader = json_reader_new(json_parser_get_root(parser));
 
-    if (!json_reader_is_array(reader))
-        g_error(
-            "sway_client.c:sway_client_ipc_get_workspaces_resp() "
-            "received non-array response.");
+    out = g_ptr_array_new_full(0, free_workspace);
 
-    workspaces_n = json_reader_count_elements(reader);
-    g_debug(
-        "sway_client.c:sway_client_ipc_get_workspaces_resp() "
-        "received response with %d workspaces.",
-        workspaces_n);
-
-    for (int i = 0; i < workspaces_n; i++) {
-        JsonNode *node;
+    while (sway_json_array_next(&c)) {
         WMWorkspace *ws = g_malloc0(sizeof(WMWorkspace));
 
-        if (!json_reader_read_element(reader, i))
-            g_error(
-                "sway_client.c:sway_client_ipc_get_workspaces_resp() "
-                "failed to read element %d.",
-                i);
-
-        node = json_reader_get_current_node(reader);
-
-        if (sway_client_parse_workspace_json(json_node_get_object(node), ws) !=
-            0) {
-            json_reader_end_element(reader);
+        if (sway_client_decode_workspace(&c, ws) != 0) {
             g_warning(
                 "sway_client.c:sway_client_ipc_get_workspaces_resp() "
                 "failed to parse workspace %d.",
-                i);
-            g_free(ws);
+                out->len);
+            free_workspace(ws);
             continue;
         }
 
@@ -471,14 +752,225 @@ GPtrArray *sway_client_ipc_get_workspaces_resp(sway_client_ipc_msg *msg) {
             ws->id, ws->num, ws->name, ws->urgent, ws->focused, ws->visible,
             ws->output);
 
-        json_reader_end_element(reader);
-
         // add to output array
         g_ptr_array_add(out, ws);
     }
 
-    g_object_unref(reader);
-    g_object_unref(parser);
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_get_workspaces_resp() "
+            "failed to parse json.");
+        g_ptr_array_unref(out);
+        out = NULL;
+    } else {
+        g_debug(
+            "sway_client.c:sway_client_ipc_get_workspaces_resp() "
+            "received response with %d workspaces.",
+            out->len);
+    }
+
+    g_free(msg->payload);
+
+    return out;
+}
+
+int sway_client_ipc_get_tree_req(int socket_fd) {
+    sway_client_ipc_msg msg = {0};
+    msg.type = IPC_GET_TREE;
+
+    return sway_client_ipc_send(socket_fd, &msg);
+}
+
+void sway_client_window_free(gpointer data) {
+    WMWindow *win = (WMWindow *)data;
+    g_free(win->app_id);
+    g_free(win->title);
+    g_free(win);
+}
+
+// Decodes the member `key` of a container into `node` if it is one a WMWindow
+// is built from, returns false otherwise and leaves the cursor alone.
+// `type` receives the container's type and `has_app` is set if it reports an
+// application.
+static gboolean sway_client_decode_window_member(sway_json_cursor *c,
+                                                 const gchar *key,
+                                                 gsize key_len,
+                                                 WMWindow *node, gchar **type,
+                                                 gboolean *has_app) {
+    gint64 v = 0;
+
+    if (sway_json_key_eq(key, key_len, "id")) {
+        if (sway_json_read_int(c, &v)) node->id = v;
+    } else if (sway_json_key_eq(key, key_len, "type")) {
+        g_free(*type);
+        *type = sway_json_read_string(c);
+    } else if (sway_json_key_eq(key, key_len, "name")) {
+        g_free(node->title);
+        node->title = sway_json_read_string(c);
+    } else if (sway_json_key_eq(key, key_len, "app_id")) {
+        gchar *app_id = sway_json_read_string(c);
+        // XWayland windows report a null app_id, keep any X11 class.
+        if (app_id) {
+            g_free(node->app_id);
+            node->app_id = app_id;
+        }
+        *has_app = true;
+    } else if (sway_json_key_eq(key, key_len, "window_properties")) {
+        if (!sway_json_peek_null(c) && sway_json_enter_object(c)) {
+            while (sway_json_object_next(c, &key, &key_len)) {
+                if (sway_json_key_eq(key, key_len, "class") && !node->app_id)
+                    node->app_id = sway_json_read_string(c);
+                else
+                    sway_json_skip_value(c);
+            }
+            *has_app = true;
+        } else {
+            sway_json_skip_value(c);
+        }
+    } else if (sway_json_key_eq(key, key_len, "focused")) {
+        sway_json_read_bool(c, &node->focused);
+    } else if (sway_json_key_eq(key, key_len, "urgent")) {
+        sway_json_read_bool(c, &node->urgent);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Whether a container of `type` without children is an application window.
+static gboolean sway_client_is_window(const gchar *type, gboolean has_app) {
+    return has_app && (g_strcmp0(type, "con") == 0 ||
+                       g_strcmp0(type, "floating_con") == 0);
+}
+
+// Decodes a node of the layout tree at the cursor.
+//
+// Application windows are leaf 'con' or 'floating_con' nodes, each one found
+// is appended to `out` tagged with `workspace_id`, the id of the closest
+// workspace ancestor.
+//
+// Sway emits a node's 'id' and 'type' members before its children, which lets
+// us tag descendants in a single pass.
+static void sway_client_decode_tree_node(sway_json_cursor *c,
+                                         guint32 workspace_id,
+                                         GPtrArray *out) {
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    gchar *type = NULL;
+    gboolean has_children = false;
+    gboolean has_app = false;
+    WMWindow node = {0};
+
+    if (!sway_json_enter_object(c)) return;
+
+    while (sway_json_object_next(c, &key, &key_len)) {
+        if (sway_client_decode_window_member(c, key, key_len, &node, &type,
+                                             &has_app)) {
+            continue;
+        } else if ((sway_json_key_eq(key, key_len, "nodes") ||
+                    sway_json_key_eq(key, key_len, "floating_nodes")) &&
+                   sway_json_enter_array(c)) {
+            guint32 child_ws = g_strcmp0(type, "workspace") == 0
+                                   ? node.id
+                                   : workspace_id;
+            while (sway_json_array_next(c)) {
+                sway_client_decode_tree_node(c, child_ws, out);
+                has_children = true;
+            }
+        } else {
+            sway_json_skip_value(c);
+        }
+    }
+
+    if (!c->error && !has_children && sway_client_is_window(type, has_app)) {
+        WMWindow *w = g_malloc0(sizeof(WMWindow));
+        node.workspace_id = workspace_id;
+        *w = node;
+        g_ptr_array_add(out, w);
+    } else {
+        g_free(node.app_id);
+        g_free(node.title);
+    }
+
+    g_free(type);
+}
+
+// Decodes the container of a window event into `event`.
+//
+// Only the container itself is described. A container holding windows, a
+// split moved as a whole, is flagged as such with just its id, its children
+// are skipped. Containers which are neither leave the window's id at 0.
+static void sway_client_decode_event_container(sway_json_cursor *c,
+                                               WMWindowEvent *event) {
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    gchar *type = NULL;
+    gboolean has_app = false;
+    WMWindow *win = &event->window;
+    gint32 x = 0, y = 0, width = 0, height = 0;
+
+    if (!sway_json_enter_object(c)) return;
+
+    while (sway_json_object_next(c, &key, &key_len)) {
+        if (sway_client_decode_window_member(c, key, key_len, win, &type,
+                                             &has_app)) {
+            continue;
+        } else if (sway_json_key_eq(key, key_len, "visible")) {
+            sway_json_read_bool(c, &event->visible);
+        } else if (sway_json_key_eq(key, key_len, "rect")) {
+            sway_client_decode_rect(c, &x, &y, &width, &height);
+        } else if ((sway_json_key_eq(key, key_len, "nodes") ||
+                    sway_json_key_eq(key, key_len, "floating_nodes")) &&
+                   sway_json_enter_array(c)) {
+            while (sway_json_array_next(c)) {
+                sway_json_skip_value(c);
+                event->container = true;
+            }
+        } else {
+            sway_json_skip_value(c);
+        }
+    }
+
+    event->x = x + width / 2;
+    event->y = y + height / 2;
+
+    if (event->container || !sway_client_is_window(type, has_app)) {
+        if (!event->container) win->id = 0;
+        g_free(win->app_id);
+        g_free(win->title);
+        win->app_id = NULL;
+        win->title = NULL;
+    }
+
+    g_free(type);
+}
+
+GPtrArray *sway_client_ipc_get_tree_resp(sway_client_ipc_msg *msg) {
+    GPtrArray *out = NULL;
+    sway_json_cursor c;
+
+    g_debug("sway_client.c:sway_client_ipc_get_tree_resp() called");
+
+    if (msg->size == 0) return NULL;
+
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    out = g_ptr_array_new_full(0, sway_client_window_free);
+    sway_client_decode_tree_node(&c, 0, out);
+
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_get_tree_resp() "
+            "failed to parse json.");
+        g_ptr_array_unref(out);
+        out = NULL;
+    } else {
+        g_debug(
+            "sway_client.c:sway_client_ipc_get_tree_resp() "
+            "received tree with %d windows.",
+            out->len);
+    }
+
     g_free(msg->payload);
 
     return out;
@@ -557,132 +1049,252 @@ int sway_client_ipc_subscribe_req(int socket_fd, int events[], guint len) {
 }
 
 gboolean sway_client_ipc_subscribe_resp(sway_client_ipc_msg *msg) {
-    JsonParser *parser = NULL;
-    JsonReader *reader = NULL;
+    sway_json_cursor c;
+    const gchar *key = NULL;
+    gsize key_len = 0;
     gboolean ok = false;
 
     if (msg->size == 0) return -1;
 
-    parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, msg->payload, msg->size, NULL)) {
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_object(&c)) {
         g_warning(
             "sway_client.c:sway_client_ipc_subscribe_resp() "
-            "failed to parse json.");
+            "received non-object response.");
+        g_free(msg->payload);
         return -1;
     }
 
-    reader = json_reader_new(json_parser_get_root(parser));
+    while (sway_json_object_next(&c, &key, &key_len)) {
+        if (sway_json_key_eq(key, key_len, "success"))
+            sway_json_read_bool(&c, &ok);
+        else
+            sway_json_skip_value(&c);
+    }
 
-    if (!json_reader_is_object(reader)) {
+    if (c.error) {
         g_warning(
             "sway_client.c:sway_client_ipc_subscribe_resp() "
-            "received non-object response.");
-        return -1;
+            "failed to parse json.");
+        ok = false;
     }
 
-    json_reader_read_member(reader, "success");
-    ok = json_reader_get_boolean_value(reader);
-
-    g_object_unref(parser);
-    g_object_unref(reader);
     g_free(msg->payload);
     return ok;
 }
 
-int sway_client_ipc_focus_workspace(int socket_fd, WMWorkspace *ws) {
-    sway_client_ipc_msg msg = {.type = IPC_COMMAND};
-    char *cmd = NULL;
-    // sway will only convert numbers up to 2147483647 to "numbered" workspaces.
-    // this requires 10 chars to represent as a string plus null byte.
-    char itoa_buff[11];
+void sway_client_cmd_batch_init(sway_client_cmd_batch *b) {
+    b->payload = g_string_new(NULL);
+    b->len = 0;
+}
 
-    if (ws == NULL) {
-        return -1;
+void sway_client_cmd_batch_clear(sway_client_cmd_batch *b) {
+    if (b->payload) g_string_free(b->payload, TRUE);
+    b->payload = NULL;
+    b->len = 0;
+}
+
+// Starts the next command of the batch.
+static void sway_client_cmd_batch_next(sway_client_cmd_batch *b) {
+    if (b->len > 0) g_string_append(b->payload, "; ");
+    b->len++;
+}
+
+// Appends `arg` double quoted, so separators within names can't split the
+// command.
+static void sway_client_cmd_batch_append_quoted(sway_client_cmd_batch *b,
+                                                const gchar *arg) {
+    g_string_append_c(b->payload, '"');
+    for (const gchar *p = arg; *p; p++) {
+        if (*p == '"' || *p == '\\') g_string_append_c(b->payload, '\\');
+        g_string_append_c(b->payload, *p);
     }
+    g_string_append_c(b->payload, '"');
+}
 
+int sway_client_cmd_batch_focus_workspace(sway_client_cmd_batch *b,
+                                          WMWorkspace *ws) {
+    if (ws == NULL) return -1;
+
+    sway_client_cmd_batch_next(b);
+    // sway will only convert numbers up to 2147483647 to "numbered"
+    // workspaces.
     if (ws->num == -1) {
-        cmd = "workspace ";
+        g_string_append(b->payload, "workspace ");
+        sway_client_cmd_batch_append_quoted(b, ws->name);
+    } else {
+        g_string_append_printf(b->payload, "workspace number %d", ws->num);
+    }
+    return 0;
+}
 
-        msg.size = strlen(cmd) + strlen(ws->name) + 1;
-        msg.payload = g_malloc0(msg.size);
+int sway_client_cmd_batch_move_ws_to_output(sway_client_cmd_batch *b,
+                                            const gchar *output) {
+    if (!output) return -1;
+    if (strlen(output) == 0) return -1;
 
-        strcpy(msg.payload, cmd);
-        strcat(msg.payload, ws->name);
-    } else {
-        cmd = "workspace number ";
+    sway_client_cmd_batch_next(b);
+    g_string_append(b->payload, "move workspace to ");
+    sway_client_cmd_batch_append_quoted(b, output);
+    return 0;
+}
 
-        snprintf(itoa_buff, sizeof(itoa_buff), "%d", ws->num);
+int sway_client_cmd_batch_move_app_to_workspace(sway_client_cmd_batch *b,
+                                                const gchar *workspace) {
+    if (!workspace) return -1;
+    if (strlen(workspace) == 0) return -1;
 
-        msg.size = strlen(cmd) + strlen(itoa_buff) + 1;
-        msg.payload = g_malloc0(msg.size);
+    sway_client_cmd_batch_next(b);
+    g_string_append(b->payload, "move window to workspace ");
+    sway_client_cmd_batch_append_quoted(b, workspace);
+    return 0;
+}
 
-        strcpy(msg.payload, cmd);
-        strcat(msg.payload, itoa_buff);
-    }
-    g_debug(
-        "sway_client.c:sway_client_ipc_focus_workspace() sending command: %s",
-        msg.payload);
+int sway_client_cmd_batch_rename_current_workspace(sway_client_cmd_batch *b,
+                                                   const gchar *name) {
+    if (!name) return -1;
+    if (strlen(name) == 0) return -1;
 
-    // send off message
-    return sway_client_ipc_send(socket_fd, &msg);
+    sway_client_cmd_batch_next(b);
+    g_string_append(b->payload, "rename workspace to ");
+    sway_client_cmd_batch_append_quoted(b, name);
+    return 0;
 }
 
-int sway_client_ipc_move_ws_to_output(int socket_fd, gchar *output) {
+int sway_client_ipc_cmd_batch_send(int socket_fd, sway_client_cmd_batch *b) {
     sway_client_ipc_msg msg = {.type = IPC_COMMAND};
-    char *cmd_prefix = "move workspace to ";
+    int ret = 0;
 
-    if (!output) return -1;
-    if (strlen(output) == 0) return -1;
+    if (b->len == 0) return -1;
 
-    msg.size = strlen(cmd_prefix) + strlen(output) + 1;
-    msg.payload = g_malloc0(msg.size);
+    g_debug(
+        "sway_client.c:sway_client_ipc_cmd_batch_send() sending %u "
+        "command(s): %s",
+        b->len, b->payload->str);
 
-    strcpy(msg.payload, cmd_prefix);
-    strcat(msg.payload, output);
+    // include the NUL terminator, as single commands always have.
+    msg.size = b->payload->len + 1;
+    msg.payload = g_string_free(b->payload, FALSE);
+    b->payload = g_string_new(NULL);
+    b->len = 0;
 
-    return sway_client_ipc_send(socket_fd, &msg);
+    ret = sway_client_ipc_send(socket_fd, &msg);
+    if (ret != 0) g_free(msg.payload);
+    return ret;
 }
 
-int sway_client_ipc_move_app_to_workspace(int socket_fd, gchar *workspace) {
-    sway_client_ipc_msg msg = {.type = IPC_COMMAND};
-    char *cmd_prefix = "move window to workspace ";
+// Sends the single command appended to `b` and clears it.
+static int sway_client_ipc_cmd_send_one(int socket_fd,
+                                        sway_client_cmd_batch *b, int ret) {
+    if (ret == 0) ret = sway_client_ipc_cmd_batch_send(socket_fd, b);
+    sway_client_cmd_batch_clear(b);
+    return ret;
+}
 
-    if (!workspace) return -1;
-    if (strlen(workspace) == 0) return -1;
+int sway_client_ipc_focus_workspace(int socket_fd, WMWorkspace *ws) {
+    sway_client_cmd_batch b;
 
-    msg.size = strlen(cmd_prefix) + strlen(workspace) + 1;
-    msg.payload = g_malloc0(msg.size);
+    sway_client_cmd_batch_init(&b);
+    return sway_client_ipc_cmd_send_one(
+        socket_fd, &b, sway_client_cmd_batch_focus_workspace(&b, ws));
+}
 
-    strcpy(msg.payload, cmd_prefix);
-    strcat(msg.payload, workspace);
+int sway_client_ipc_move_ws_to_output(int socket_fd, const gchar *output) {
+    sway_client_cmd_batch b;
 
-    return sway_client_ipc_send(socket_fd, &msg);
+    sway_client_cmd_batch_init(&b);
+    return sway_client_ipc_cmd_send_one(
+        socket_fd, &b, sway_client_cmd_batch_move_ws_to_output(&b, output));
+}
+
+int sway_client_ipc_move_app_to_workspace(int socket_fd, gchar *workspace) {
+    sway_client_cmd_batch b;
+
+    sway_client_cmd_batch_init(&b);
+    return sway_client_ipc_cmd_send_one(
+        socket_fd, &b,
+        sway_client_cmd_batch_move_app_to_workspace(&b, workspace));
 }
 
 int sway_client_ipc_rename_current_workspace(int socket_fd, const gchar *name) {
-    sway_client_ipc_msg msg = {.type = IPC_COMMAND};
-    char *cmd_prefix = "rename workspace to ";
+    sway_client_cmd_batch b;
 
-    if (!name) return -1;
-    if (strlen(name) == 0) return -1;
+    sway_client_cmd_batch_init(&b);
+    return sway_client_ipc_cmd_send_one(
+        socket_fd, &b,
+        sway_client_cmd_batch_rename_current_workspace(&b, name));
+}
 
-    msg.size = strlen(cmd_prefix) + strlen(name) + 1;
-    msg.payload = g_malloc0(msg.size);
+GArray *sway_client_ipc_command_resp(sway_client_ipc_msg *msg) {
+    sway_json_cursor c;
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    GArray *out = NULL;
 
-    strcpy(msg.payload, cmd_prefix);
-    strcat(msg.payload, name);
+    if (msg->size == 0) {
+        g_free(msg->payload);
+        return NULL;
+    }
 
-    return sway_client_ipc_send(socket_fd, &msg);
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_array(&c)) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_command_resp() "
+            "received non-array response.");
+        goto error;
+    }
+
+    out = g_array_new(FALSE, TRUE, sizeof(gboolean));
+    while (sway_json_array_next(&c)) {
+        gboolean success = FALSE;
+        gchar *err = NULL;
+
+        if (!sway_json_enter_object(&c)) break;
+        while (sway_json_object_next(&c, &key, &key_len)) {
+            if (sway_json_key_eq(key, key_len, "success")) {
+                sway_json_read_bool(&c, &success);
+            } else if (sway_json_key_eq(key, key_len, "error")) {
+                g_free(err);
+                err = sway_json_read_string(&c);
+            } else {
+                sway_json_skip_value(&c);
+            }
+        }
+        if (!success)
+            g_debug(
+                "sway_client.c:sway_client_ipc_command_resp() command %u "
+                "failed: %s",
+                out->len, err);
+        g_free(err);
+        g_array_append_val(out, success);
+    }
+
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_command_resp() "
+            "failed to parse json.");
+        goto error;
+    }
+
+    g_free(msg->payload);
+    return out;
+
+error:
+    if (out) g_array_unref(out);
+    g_free(msg->payload);
+    return NULL;
 }
 
 WMWorkspaceEvent *sway_client_ipc_event_workspace_resp(
     sway_client_ipc_msg *msg) {
-    JsonParser *parser = NULL;
-    JsonReader *reader = NULL;
-    JsonNode *ws_obj = NULL;
+    sway_json_cursor c;
+    const gchar *key = NULL;
+    gsize key_len = 0;
     WMWorkspaceEvent *ws = g_malloc0(sizeof(WMWorkspaceEvent));
-    GError *error;
-    const gchar *change;
+    gchar *change = NULL;
+    gboolean has_current = false;
 
     g_debug("sway_client.c:sway_client_ipc_event_workspace() called");
 
@@ -690,36 +1302,51 @@ WMWorkspaceEvent *sway_client_ipc_event_workspace_resp(
         goto error;
     }
 
-    parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, msg->payload, msg->size, &error)) {
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_object(&c)) {
         g_warning(
             "sway_client.c:sway_client_ipc_event_workspace() "
-            "failed to parse json.");
+            "received non-object response.");
         goto error;
     }
 
-    reader = json_reader_new(json_parser_get_root(parser));
-    if (!json_reader_is_object(reader)) {
+    // members may arrive in any order, decode 'change' and 'current' as we
+    // see them and skip the rest, including the 'old' workspace.
+    while (sway_json_object_next(&c, &key, &key_len)) {
+        if (sway_json_key_eq(key, key_len, "change")) {
+            g_free(change);
+            change = sway_json_read_string(&c);
+        } else if (sway_json_key_eq(key, key_len, "current") &&
+                   !sway_json_peek_null(&c)) {
+            if (sway_client_decode_workspace(&c, &ws->workspace) != 0) {
+                g_warning(
+                    "sway_client.c:sway_client_ipc_event_workspace() "
+                    "failed to parse 'current' member.");
+                goto error;
+            }
+            has_current = true;
+        } else {
+            sway_json_skip_value(&c);
+        }
+    }
+
+    if (c.error) {
         g_warning(
             "sway_client.c:sway_client_ipc_event_workspace() "
-            "received non-object response. error: %s",
-            json_reader_get_error(reader)->message);
+            "failed to parse json.");
         goto error;
     }
 
-    // read 'changed' member
-    if (!json_reader_read_member(reader, "change")) {
+    if (!change) {
         g_warning(
             "sway_client.c:sway_client_ipc_event_workspace() "
-            "received response without 'change' member. error: "
-            "%s",
-            json_reader_get_error(reader)->message);
+            "received response without 'change' member.");
         goto error;
     }
-    change = json_reader_get_string_value(reader);
 
     // map to domain event
-    ws->type = sway_client_event_map((gchar *)change);
+    ws->type = sway_client_event_map(change);
     if (ws->type == -1) {
         g_warning(
             "sway_client.c:sway_client_ipc_event_workspace() "
@@ -733,53 +1360,137 @@ WMWorkspaceEvent *sway_client_ipc_event_workspace_resp(
         "%s",
         change);
 
-    // done reading 'changed' member, reset cursor.
-    json_reader_end_member(reader);
-
-    // short-circuit for reload event, there is no workspace details in this
-    // event.
-    if (g_strcmp0(change, "reload") == 0) {
-        goto done;
-    }
-
-    // read 'current' member which holds workspace json node.
-    if (!json_reader_read_member(reader, "current")) {
+    // there is no workspace details in a reload event.
+    if (ws->type != WMWORKSPACE_EVENT_RELOAD && !has_current) {
         g_warning(
             "sway_client.c:sway_client_ipc_event_workspace() "
-            "received response without 'current' member. error: %s",
-            json_reader_get_error(reader)->message);
+            "received response without 'current' member.");
         goto error;
     }
 
-    // extract workspace json node
-    ws_obj = json_reader_get_current_node(reader);
-    if (!ws_obj) {
-        g_error(
-            "sway_client.c:sway_client_ipc_event_workspace() "
-            "failed to get current node: %s",
-            json_reader_get_error(reader)->message);
-        goto error;
-    }
-
-    // feed it to our json parser.
-    sway_client_parse_workspace_json(json_node_get_object(ws_obj),
-                                     &ws->workspace);
-
     g_debug(
         "sway_client.c:sway_client_ipc_event_workspace() "
         "parsed workspace event [%s] for workspace ID [%d]",
         window_manager_service_event_to_string(ws->type), ws->workspace.id);
 
-done:
-    if (parser) g_object_unref(parser);
-    if (reader) g_object_unref(reader);
+    g_free(change);
     g_free(msg->payload);
     return ws;
 
 error:
-    if (parser) g_object_unref(parser);
-    if (reader) g_object_unref(reader);
+    g_free(change);
     g_free(msg->payload);
+    g_free(ws->workspace.name);
     g_free(ws);
     return NULL;
 }
+
+gchar *sway_client_ipc_event_binding_resp(sway_client_ipc_msg *msg) {
+    sway_json_cursor c;
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    gchar *command = NULL;
+
+    g_debug("sway_client.c:sway_client_ipc_event_binding_resp() called");
+
+    if (msg->size == 0) return NULL;
+
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_object(&c)) goto done;
+
+    // we only care about 'binding.command', skip everything else.
+    while (sway_json_object_next(&c, &key, &key_len)) {
+        if (!sway_json_key_eq(key, key_len, "binding") ||
+            !sway_json_enter_object(&c)) {
+            sway_json_skip_value(&c);
+            continue;
+        }
+        while (sway_json_object_next(&c, &key, &key_len)) {
+            if (sway_json_key_eq(key, key_len, "command")) {
+                g_free(command);
+                command = sway_json_read_string(&c);
+            } else {
+                sway_json_skip_value(&c);
+            }
+        }
+    }
+
+done:
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_event_binding_resp() "
+            "failed to parse json.");
+        g_free(command);
+        command = NULL;
+    }
+    g_free(msg->payload);
+    return command;
+}
+
+static int sway_client_window_event_map(const gchar *change) {
+    if (g_strcmp0(change, "new") == 0) return WMWINDOW_EVENT_NEW;
+    if (g_strcmp0(change, "close") == 0) return WMWINDOW_EVENT_CLOSE;
+    if (g_strcmp0(change, "focus") == 0) return WMWINDOW_EVENT_FOCUS;
+    if (g_strcmp0(change, "title") == 0) return WMWINDOW_EVENT_TITLE;
+    if (g_strcmp0(change, "move") == 0) return WMWINDOW_EVENT_MOVE;
+    if (g_strcmp0(change, "urgent") == 0) return WMWINDOW_EVENT_URGENT;
+    return -1;
+}
+
+WMWindowEvent *sway_client_ipc_event_window_resp(sway_client_ipc_msg *msg) {
+    sway_json_cursor c;
+    const gchar *key = NULL;
+    gsize key_len = 0;
+    WMWindowEvent *event = g_malloc0(sizeof(WMWindowEvent));
+    gchar *change = NULL;
+    gint type = -1;
+
+    g_debug("sway_client.c:sway_client_ipc_event_window_resp() called");
+
+    if (msg->size == 0) goto error;
+
+    sway_json_cursor_init(&c, msg->payload, msg->size);
+
+    if (!sway_json_enter_object(&c)) goto error;
+
+    while (sway_json_object_next(&c, &key, &key_len)) {
+        if (sway_json_key_eq(key, key_len, "change")) {
+            g_free(change);
+            change = sway_json_read_string(&c);
+        } else if (sway_json_key_eq(key, key_len, "container")) {
+            sway_client_decode_event_container(&c, event);
+        } else {
+            sway_json_skip_value(&c);
+        }
+    }
+
+    if (c.error) {
+        g_warning(
+            "sway_client.c:sway_client_ipc_event_window_resp() "
+            "failed to parse json.");
+        goto error;
+    }
+
+    type = sway_client_window_event_map(change);
+    // ignore events we do not track, and containers which are not windows.
+    if (type == -1 || event->window.id == 0) goto error;
+    event->type = type;
+
+    g_debug(
+        "sway_client.c:sway_client_ipc_event_window_resp() "
+        "parsed window event [%s] for window ID [%u]",
+        change, event->window.id);
+
+    g_free(change);
+    g_free(msg->payload);
+    return event;
+
+error:
+    g_free(change);
+    g_free(msg->payload);
+    g_free(event->window.app_id);
+    g_free(event->window.title);
+    g_free(event);
+    return NULL;
+}
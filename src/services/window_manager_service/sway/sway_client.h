@@ -11,15 +11,26 @@ typedef enum SWAY_CLIENT_ERR {
     SWAY_CLIENT_ERR_SOCKET_CONNECT_FAIL,
     SWAY_CLIENT_ERR_SOCKET_READ,
     SWAY_CLIENT_ERR_SOCKET_WRITE,
-    SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC
+    SWAY_CLIENT_ERR_SOCKET_CLOSED,
+    SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC,
+    SWAY_CLIENT_ERR_PROTOCOL_FRAME_TOO_BIG
 } SWAY_CLIENT_ERR;
 
 // A Sway client extremely tuned for our application's needs.
 // It is assumed that the IPC socket is managed by GLib's event loop which will
 // call a callback function when the socket is ready for reading.
 //
+// The IPC socket is non-blocking. Each time GLib reports it readable
+// `sway_client_ipc_read` drains it into a per-connection ring buffer and
+// `sway_client_ipc_recv` is then called until it reports no complete frames
+// remain, a frame split across several reads simply waits in the buffer.
+//
+// Writes never block either. When sway's receive buffer is full the unsent
+// bytes are queued per socket and flushed from a GLib G_IO_OUT watch, later
+// frames queue behind them so the stream stays in order.
+//
 // Memory management rules for payloads:
-// `sway_client_ipc_rcv` returns msg.payload malloc'd internally.
+// `sway_client_ipc_recv` returns msg.payload malloc'd internally.
 // `sway_client_*_resp` methods read msg.payload and frees it.
 // `sway_client_ipc_send` frees msg.payload on successful send.
 //
@@ -40,6 +51,25 @@ typedef struct _sway_client_ipc_msg {
     guint32 type;
 } sway_client_ipc_msg;
 
+// A ring buffer reassembling frames read from a non-blocking IPC socket.
+// `head` and `tail` count the bytes consumed and read, unread bytes are
+// buff[head % cap, tail % cap), wrapping around. `cap` is a power of two.
+typedef struct _sway_client_ipc_reader {
+    guint8 *buff;
+    gsize head;
+    gsize tail;
+    gsize cap;
+} sway_client_ipc_reader;
+
+#define SWAY_CLIENT_IPC_READ_CHUNK 4096
+
+// Largest payload accepted, a corrupt header can't make us allocate more.
+// Sway's largest replies, get_tree on busy sessions, are a few megabytes.
+#define SWAY_CLIENT_IPC_MAX_PAYLOAD (64 * 1024 * 1024)
+
+// Most bytes queued for a socket sway stopped reading, further sends fail.
+#define SWAY_CLIENT_IPC_MAX_BACKLOG (8 * 1024 * 1024)
+
 gchar *sway_client_find_socket_path();
 
 SWAY_CLIENT_ERR sway_client_ipc_connect(gchar *socket_path);
@@ -50,14 +80,50 @@ WMWorkspaceEventType sway_client_event_map(char *event);
 // Send a message to the connected IPC socket.
 // Caller is responsible for freeing msg->payload once it's no longer needed
 // with g_free if a payload exists.
+//
+// Returns 0 once the frame was written or queued behind the socket's backlog,
+// which the GLib main loop flushes.
 int sway_client_ipc_send(int socket_fd, sway_client_ipc_msg *msg);
 
-// Receives a message from the connected IPC socket.
+// Returns the number of bytes queued for `socket_fd` and not yet written.
+gsize sway_client_ipc_backlog(int socket_fd);
+
+// Drops any queued bytes for `socket_fd` and closes it.
+void sway_client_ipc_close(int socket_fd);
+
+void sway_client_ipc_reader_init(sway_client_ipc_reader *r);
+
+// Frees the reader's buffer, dropping any partially received frame.
+void sway_client_ipc_reader_clear(sway_client_ipc_reader *r);
+
+// Reads everything currently available on the non-blocking socket into the
+// reader without blocking.
+//
+// Returns 0 once the socket would block, -SWAY_CLIENT_ERR_SOCKET_CLOSED if the
+// peer closed the connection and -SWAY_CLIENT_ERR_SOCKET_READ on error. Bytes
+// read before the socket closed remain available to `sway_client_ipc_recv`.
+int sway_client_ipc_read(int socket_fd, sway_client_ipc_reader *r);
+
+// Pops the next complete message from the reader's buffer.
+// Returns 1 if `msg` was filled, 0 if no complete frame is buffered yet,
+// -SWAY_CLIENT_ERR_PROTOCOL_BAD_MAGIC if the stream is corrupt and
+// -SWAY_CLIENT_ERR_PROTOCOL_FRAME_TOO_BIG if a frame advertises a payload over
+// SWAY_CLIENT_IPC_MAX_PAYLOAD.
+//
 // Caller is responsible for freeing msg->payload once it's no longer needed
 // with g_free.
 //
 // Always check that msg->payload != nil incase a reply contained no payload.
-int sway_client_ipc_recv(int socket_fd, sway_client_ipc_msg *msg);
+int sway_client_ipc_recv(sway_client_ipc_reader *r, sway_client_ipc_msg *msg);
+
+// Starts teeing every frame returned by `sway_client_ipc_recv`, on any
+// connection, to a capture file at `path` which contrib/sway-replay can serve
+// back. See sway_record.h for the file format.
+// Returns 0 on success or if already recording, -1 if the file can't be opened.
+int sway_client_ipc_record_start(const gchar *path);
+
+// Stops recording and closes the capture file.
+void sway_client_ipc_record_stop();
 
 // Commands //
 
@@ -79,6 +145,19 @@ int sway_client_ipc_get_outputs_req(int socket_fd);
 // Unref GPtrArray when finished.
 GPtrArray *sway_client_ipc_get_outputs_resp(sway_client_ipc_msg *msg);
 
+// Send a 'get_tree' request.
+// Msg details are handled internally.
+int sway_client_ipc_get_tree_req(int socket_fd);
+
+// Parses a response for a 'get_tree' request.
+// Returns a GPtrArray of WMWindow structures, one for each application window
+// in the tree, with ref of 1.
+// Unref GPtrArray when finished.
+GPtrArray *sway_client_ipc_get_tree_resp(sway_client_ipc_msg *msg);
+
+// Frees a WMWindow returned by this client.
+void sway_client_window_free(gpointer data);
+
 // Subscribes specific Sway events.
 int sway_client_ipc_subscribe_req(int socket_fd, int events[], guint len);
 
@@ -89,7 +168,7 @@ gboolean sway_client_ipc_subscribe_resp(sway_client_ipc_msg *msg);
 int sway_client_ipc_focus_workspace(int socket_fd, WMWorkspace *ws);
 
 // Move the currently focused workspace to the provided output.
-int sway_client_ipc_move_ws_to_output(int socket_fd, gchar *output);
+int sway_client_ipc_move_ws_to_output(int socket_fd, const gchar *output);
 
 // Move the current focused app to the provided workspace.
 int sway_client_ipc_move_app_to_workspace(int socket_fd, gchar *workspace);
@@ -97,6 +176,48 @@ int sway_client_ipc_move_app_to_workspace(int socket_fd, gchar *workspace);
 // Rename the current workspace to `name`
 int sway_client_ipc_rename_current_workspace(int socket_fd, const gchar *name);
 
+// Command batches //
+
+// Builds a single IPC_COMMAND payload out of several `;` separated commands.
+// Sway runs them in order and replies with one result per command, so a
+// compound action costs a single round trip.
+//
+// The helpers above are batches of one.
+typedef struct _sway_client_cmd_batch {
+    GString *payload;
+    // number of commands appended so far.
+    guint len;
+} sway_client_cmd_batch;
+
+void sway_client_cmd_batch_init(sway_client_cmd_batch *b);
+
+// Frees the batch's payload, the batch must be initialized again before reuse.
+void sway_client_cmd_batch_clear(sway_client_cmd_batch *b);
+
+// Appenders return -1 and leave the batch untouched on invalid arguments.
+int sway_client_cmd_batch_focus_workspace(sway_client_cmd_batch *b,
+                                          WMWorkspace *ws);
+
+int sway_client_cmd_batch_move_ws_to_output(sway_client_cmd_batch *b,
+                                            const gchar *output);
+
+int sway_client_cmd_batch_move_app_to_workspace(sway_client_cmd_batch *b,
+                                                const gchar *workspace);
+
+int sway_client_cmd_batch_rename_current_workspace(sway_client_cmd_batch *b,
+                                                   const gchar *name);
+
+// Sends the batch as one IPC_COMMAND message and empties it for reuse.
+// Returns -1 if the batch is empty.
+int sway_client_ipc_cmd_batch_send(int socket_fd, sway_client_cmd_batch *b);
+
+// Parses the reply to an IPC_COMMAND message.
+// Returns a GArray of gboolean, the success of each command in the order they
+// were sent, or NULL on error. Sway stops at the first command it fails to
+// parse so the array may be shorter than the batch.
+// Unref GArray when finished.
+GArray *sway_client_ipc_command_resp(sway_client_ipc_msg *msg);
+
 // Events //
 
 // Parses a workspace event and returns a WMWorkspaceEvent
@@ -110,3 +231,15 @@ int sway_client_ipc_rename_current_workspace(int socket_fd, const gchar *name);
 // in event.workspace may be nonsense.
 WMWorkspaceEvent *sway_client_ipc_event_workspace_resp(
     sway_client_ipc_msg *msg);
+
+// Parses a binding event and returns the bound command string.
+// Returns NULL on error, free the result with g_free.
+gchar *sway_client_ipc_event_binding_resp(sway_client_ipc_msg *msg);
+
+// Parses a window event and returns a WMWindowEvent, free it with g_free
+// after freeing its window's strings.
+//
+// Sway does not report a window's workspace in window events so
+// event.window.workspace_id is always 0, its the caller's responsibility to
+// place the window. Unhandled event types return NULL.
+WMWindowEvent *sway_client_ipc_event_window_resp(sway_client_ipc_msg *msg);
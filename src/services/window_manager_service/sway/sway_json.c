@@ -0,0 +1,357 @@
+#include "sway_json.h"
+
+#include <adwaita.h>
+#include <string.h>
+
+// the largest string we will intern without a heap allocation.
+#define SWAY_JSON_INTERN_BUFF_SIZE 256
+
+void sway_json_cursor_init(sway_json_cursor *c, const gchar *buf, gsize len) {
+    c->p = buf;
+    c->end = buf + len;
+    c->error = (buf == NULL);
+}
+
+static gboolean fail(sway_json_cursor *c) {
+    c->error = TRUE;
+    return FALSE;
+}
+
+// Skips whitespace and returns FALSE if the end of the buffer was hit.
+static gboolean skip_ws(sway_json_cursor *c) {
+    if (c->error) return FALSE;
+    while (c->p < c->end) {
+        switch (*c->p) {
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                c->p++;
+                continue;
+            case '\0':
+                // tolerate payloads which are NUL terminated.
+                c->p = c->end;
+                return FALSE;
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
+static gboolean expect(sway_json_cursor *c, gchar ch) {
+    if (!skip_ws(c) || *c->p != ch) return fail(c);
+    c->p++;
+    return TRUE;
+}
+
+// Scans a string starting at its opening quote.
+// On return `start` and `len` describe the raw, still escaped, contents and
+// the cursor is positioned after the closing quote.
+static gboolean scan_string(sway_json_cursor *c, const gchar **start,
+                            gsize *len, gboolean *escaped) {
+    const gchar *p = NULL;
+
+    if (!skip_ws(c) || *c->p != '"') return fail(c);
+
+    *escaped = FALSE;
+    p = c->p + 1;
+    *start = p;
+    while (p < c->end) {
+        if (*p == '\\') {
+            *escaped = TRUE;
+            p += 2;
+            continue;
+        }
+        if (*p == '"') {
+            *len = p - *start;
+            c->p = p + 1;
+            return TRUE;
+        }
+        p++;
+    }
+    return fail(c);
+}
+
+static gint hex_value(gchar ch) {
+    if (ch >= '0' && ch <= '9') return ch - '0';
+    if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+    if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+    return -1;
+}
+
+static gboolean read_hex4(const gchar *p, const gchar *end, gunichar *out) {
+    gunichar v = 0;
+    if (end - p < 4) return FALSE;
+    for (int i = 0; i < 4; i++) {
+        gint h = hex_value(p[i]);
+        if (h < 0) return FALSE;
+        v = (v << 4) | h;
+    }
+    *out = v;
+    return TRUE;
+}
+
+// Unescapes `len` bytes at `src` into `dst`, which must be at least `len` + 1
+// bytes. An escaped sequence is never shorter than its UTF-8 encoding so the
+// result always fits.
+static gboolean unescape(const gchar *src, gsize len, gchar *dst) {
+    const gchar *end = src + len;
+    gchar *out = dst;
+
+    while (src < end) {
+        if (*src != '\\') {
+            *out++ = *src++;
+            continue;
+        }
+        src++;
+        if (src >= end) return FALSE;
+        switch (*src) {
+            case '"':
+            case '\\':
+            case '/':
+                *out++ = *src;
+                break;
+            case 'b':
+                *out++ = '\b';
+                break;
+            case 'f':
+                *out++ = '\f';
+                break;
+            case 'n':
+                *out++ = '\n';
+                break;
+            case 'r':
+                *out++ = '\r';
+                break;
+            case 't':
+                *out++ = '\t';
+                break;
+            case 'u': {
+                gunichar cp = 0, low = 0;
+                if (!read_hex4(src + 1, end, &cp)) return FALSE;
+                src += 4;
+                // combine surrogate pairs into a single code point.
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - src > 6 &&
+                    src[1] == '\\' && src[2] == 'u' &&
+                    read_hex4(src + 3, end, &low) && low >= 0xDC00 &&
+                    low <= 0xDFFF) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    src += 6;
+                }
+                out += g_unichar_to_utf8(cp, out);
+                break;
+            }
+            default:
+                return FALSE;
+        }
+        src++;
+    }
+    *out = '\0';
+    return TRUE;
+}
+
+gboolean sway_json_peek_null(sway_json_cursor *c) {
+    if (!skip_ws(c)) return FALSE;
+    return (c->end - c->p >= 4) && memcmp(c->p, "null", 4) == 0;
+}
+
+gboolean sway_json_enter_object(sway_json_cursor *c) {
+    return expect(c, '{');
+}
+
+gboolean sway_json_object_next(sway_json_cursor *c, const gchar **key,
+                               gsize *key_len) {
+    gboolean escaped = FALSE;
+
+    if (!skip_ws(c)) return fail(c);
+
+    if (*c->p == '}') {
+        c->p++;
+        return FALSE;
+    }
+    if (*c->p == ',') c->p++;
+
+    if (!scan_string(c, key, key_len, &escaped)) return FALSE;
+
+    return expect(c, ':');
+}
+
+gboolean sway_json_enter_array(sway_json_cursor *c) {
+    return expect(c, '[');
+}
+
+gboolean sway_json_array_next(sway_json_cursor *c) {
+    if (!skip_ws(c)) return fail(c);
+
+    if (*c->p == ']') {
+        c->p++;
+        return FALSE;
+    }
+    if (*c->p == ',') c->p++;
+
+    return skip_ws(c) ? TRUE : fail(c);
+}
+
+static gboolean skip_scalar(sway_json_cursor *c) {
+    const gchar *start = c->p;
+    while (c->p < c->end) {
+        switch (*c->p) {
+            case ',':
+            case '}':
+            case ']':
+            case ' ':
+            case '\t':
+            case '\n':
+            case '\r':
+                return c->p != start ? TRUE : fail(c);
+        }
+        c->p++;
+    }
+    return c->p != start ? TRUE : fail(c);
+}
+
+gboolean sway_json_skip_value(sway_json_cursor *c) {
+    const gchar *start = NULL;
+    gsize len = 0;
+    gboolean escaped = FALSE;
+    gint depth = 0;
+
+    do {
+        if (!skip_ws(c)) return fail(c);
+
+        switch (*c->p) {
+            case '{':
+            case '[':
+                depth++;
+                c->p++;
+                break;
+            case '}':
+            case ']':
+                if (--depth < 0) return fail(c);
+                c->p++;
+                break;
+            case ',':
+            case ':':
+                if (depth == 0) return fail(c);
+                c->p++;
+                break;
+            case '"':
+                if (!scan_string(c, &start, &len, &escaped)) return FALSE;
+                break;
+            default:
+                if (!skip_scalar(c)) return FALSE;
+        }
+    } while (depth > 0);
+
+    return TRUE;
+}
+
+gboolean sway_json_read_int(sway_json_cursor *c, gint64 *out) {
+    gboolean neg = FALSE;
+    guint64 v = 0;
+    const gchar *start = NULL;
+
+    if (!skip_ws(c)) return fail(c);
+
+    if (*c->p == '-') {
+        neg = TRUE;
+        c->p++;
+    }
+
+    start = c->p;
+    while (c->p < c->end && *c->p >= '0' && *c->p <= '9') {
+        v = (v * 10) + (*c->p - '0');
+        c->p++;
+    }
+    if (c->p == start) return fail(c);
+
+    // tolerate a fraction or exponent, we only care about the integer part.
+    if (c->p < c->end && (*c->p == '.' || *c->p == 'e' || *c->p == 'E'))
+        if (!skip_scalar(c)) return FALSE;
+
+    *out = neg ? -(gint64)v : (gint64)v;
+    return TRUE;
+}
+
+gboolean sway_json_read_bool(sway_json_cursor *c, gboolean *out) {
+    if (!skip_ws(c)) return fail(c);
+
+    if (c->end - c->p >= 4 && memcmp(c->p, "true", 4) == 0) {
+        c->p += 4;
+        *out = TRUE;
+        return TRUE;
+    }
+    if (c->end - c->p >= 5 && memcmp(c->p, "false", 5) == 0) {
+        c->p += 5;
+        *out = FALSE;
+        return TRUE;
+    }
+    return fail(c);
+}
+
+gchar *sway_json_read_string(sway_json_cursor *c) {
+    const gchar *start = NULL;
+    gsize len = 0;
+    gboolean escaped = FALSE;
+    gchar *out = NULL;
+
+    if (sway_json_peek_null(c)) {
+        c->p += 4;
+        return NULL;
+    }
+
+    if (!scan_string(c, &start, &len, &escaped)) return NULL;
+
+    if (!escaped) return g_strndup(start, len);
+
+    out = g_malloc(len + 1);
+    if (!unescape(start, len, out)) {
+        g_free(out);
+        fail(c);
+        return NULL;
+    }
+    return out;
+}
+
+const gchar *sway_json_read_interned_string(sway_json_cursor *c) {
+    const gchar *start = NULL;
+    gsize len = 0;
+    gboolean escaped = FALSE;
+    gchar buff[SWAY_JSON_INTERN_BUFF_SIZE];
+    gchar *heap = NULL;
+    const gchar *out = NULL;
+
+    if (sway_json_peek_null(c)) {
+        c->p += 4;
+        return NULL;
+    }
+
+    if (!scan_string(c, &start, &len, &escaped)) return NULL;
+
+    // common case, small unescaped strings are interned from the stack.
+    if (len < sizeof(buff)) {
+        if (!escaped) {
+            memcpy(buff, start, len);
+            buff[len] = '\0';
+        } else if (!unescape(start, len, buff)) {
+            fail(c);
+            return NULL;
+        }
+        return g_intern_string(buff);
+    }
+
+    heap = g_malloc(len + 1);
+    if (escaped) {
+        if (!unescape(start, len, heap)) {
+            g_free(heap);
+            fail(c);
+            return NULL;
+        }
+    } else {
+        memcpy(heap, start, len);
+        heap[len] = '\0';
+    }
+    out = g_intern_string(heap);
+    g_free(heap);
+    return out;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <adwaita.h>
+
+// A minimal, pull based JSON decoder tuned for Sway's IPC payloads.
+//
+// The decoder walks the raw msg->payload buffer in place and never builds an
+// intermediate tree. Callers enter objects and arrays, iterate their members
+// and read only the values they care about, skipping everything else.
+//
+// Keys returned by `sway_json_object_next` point directly into the payload
+// buffer and are not NUL terminated, compare them with `sway_json_key_eq`.
+//
+// Any malformed input sets `cursor.error`, after which every call is a no-op
+// returning FALSE. Callers should check `cursor.error` once decoding is done.
+
+typedef struct _sway_json_cursor {
+    const gchar *p;
+    const gchar *end;
+    gboolean error;
+} sway_json_cursor;
+
+void sway_json_cursor_init(sway_json_cursor *c, const gchar *buf, gsize len);
+
+// Returns TRUE if `key` of length `len` is equal to the NUL terminated `lit`.
+static inline gboolean sway_json_key_eq(const gchar *key, gsize len,
+                                        const gchar *lit) {
+    return strlen(lit) == len && memcmp(key, lit, len) == 0;
+}
+
+// Returns TRUE if the next value is JSON `null`, the cursor is not advanced.
+gboolean sway_json_peek_null(sway_json_cursor *c);
+
+// Enters an object, returns FALSE if the next value is not an object.
+gboolean sway_json_enter_object(sway_json_cursor *c);
+
+// Advances to the next member of the current object and positions the cursor
+// at its value. Returns FALSE once the closing brace has been consumed.
+gboolean sway_json_object_next(sway_json_cursor *c, const gchar **key,
+                               gsize *key_len);
+
+// Enters an array, returns FALSE if the next value is not an array.
+gboolean sway_json_enter_array(sway_json_cursor *c);
+
+// Advances to the next element of the current array and positions the cursor
+// at its value. Returns FALSE once the closing bracket has been consumed.
+gboolean sway_json_array_next(sway_json_cursor *c);
+
+// Skips the next value, including any nested objects and arrays.
+gboolean sway_json_skip_value(sway_json_cursor *c);
+
+// Reads an integer value.
+gboolean sway_json_read_int(sway_json_cursor *c, gint64 *out);
+
+// Reads a boolean value.
+gboolean sway_json_read_bool(sway_json_cursor *c, gboolean *out);
+
+// Reads a string value into a newly allocated buffer, free with g_free.
+// Returns NULL if the value is `null` or on error.
+gchar *sway_json_read_string(sway_json_cursor *c);
+
+// Reads a string value and returns its interned representation, see
+// g_intern_string. Returns NULL if the value is `null` or on error.
+//
+// Use this for small, frequently repeated values such as output names.
+const gchar *sway_json_read_interned_string(sway_json_cursor *c);
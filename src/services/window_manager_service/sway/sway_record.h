@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+// Layout of a Sway IPC capture file, shared by the recorder in sway_client.c
+// and the replay server in contrib/sway-replay.
+//
+// A capture is a sway_record_file_header followed by one record per frame
+// received from Sway, in arrival order. Each record is a
+// sway_record_frame_header followed by `size` bytes of payload. All integers
+// are native endian, as they are on the i3-ipc wire.
+
+#define SWAY_RECORD_MAGIC "wsipcrec"
+#define SWAY_RECORD_MAGIC_SIZE 8
+#define SWAY_RECORD_VERSION 1
+
+typedef struct _sway_record_file_header {
+    char magic[SWAY_RECORD_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t reserved;
+} sway_record_file_header;
+
+typedef struct _sway_record_frame_header {
+    // microseconds since the recording started.
+    uint64_t usec;
+    // same order as the i3-ipc header.
+    uint32_t size;
+    uint32_t type;
+} sway_record_frame_header;
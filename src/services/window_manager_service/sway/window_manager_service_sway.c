@@ -4,38 +4,178 @@
 #include <glib-2.0/glib-unix.h>
 #include <string.h>
 
+#include "../../ipc_service/ipc_service.h"
 #include "glib-object.h"
 #include "glib.h"
 #include "ipc.h"
 #include "sway_client.h"
 
-enum signals { workspaces_changed, outputs_changed, signals_n };
+// Sway bindings of the form `bindsym <keys> nop way-shell <command>` are
+// executed in-process, see handle_ipc_event_binding.
+#define WM_SERVICE_SWAY_BINDING_PREFIX "nop way-shell "
+
+// When set, every frame received from sway is recorded to the capture file
+// this variable names, see contrib/sway-replay.
+#define WM_SERVICE_SWAY_RECORD_ENV "WAY_SHELL_SWAY_RECORD"
+
+enum signals {
+    workspaces_changed,
+    outputs_changed,
+    windows_changed,
+    signals_n
+};
 
 struct _WMServiceSway {
     GObject parent_instance;
     GPtrArray *workspaces;
+    // a get_workspaces request is in flight.
+    gboolean workspaces_pending;
+    // WMWorkspaceEvent received while the get_workspaces request was in
+    // flight, see handle_ipc_get_workspaces.
+    GQueue *workspace_events;
+    // as tree_refetch, for the workspace listing.
+    gboolean workspaces_refetch;
     GPtrArray *outputs;
+    // application windows in tree order, owns its WMWindow elements.
+    GPtrArray *windows;
+    // index into `windows` keyed by Sway's con id.
+    GHashTable *windows_by_id;
+    // a get_tree request is in flight.
+    gboolean tree_pending;
+    // WMWindowEvent received while the get_tree request was in flight, they
+    // are replayed over its snapshot, see handle_ipc_get_tree.
+    GQueue *tree_events;
+    // the in flight snapshot may predate a change, take another once it lands.
+    gboolean tree_refetch;
+    // destination workspace names keyed by the id of a window we asked Sway
+    // to move, see track_window_move.
+    GHashTable *window_moves;
     char *socket_path;
+    // event connection, carries the subscribe reply and subscribed events.
     int socket_fd;
+    sway_client_ipc_reader reader;
     guint poll_id;
+    // command connection, carries requests and their replies.
+    int cmd_socket_fd;
+    sway_client_ipc_reader cmd_reader;
+    guint cmd_poll_id;
+    // FIFO of SwayPendingCmd, one for each request awaiting a reply.
+    GQueue *cmd_queue;
     gboolean polling;
     gboolean subscribed;
     gchar *focused_workspace;
     GSettings *settings;
+    // bitmask of signals with changes not yet delivered, see schedule_emit.
+    guint pending_signals;
+    guint coalesce_id;
+    // per signal, changes requested and signals actually emitted.
+    guint64 coalesce_requested[signals_n];
+    guint64 coalesce_emitted[signals_n];
 };
 static guint service_signals[signals_n] = {0};
 G_DEFINE_TYPE(WMServiceSway, wm_service_sway, G_TYPE_OBJECT);
 
+// Invoked with the reply to a request sent on the command connection.
+// The callback owns msg->payload. `msg` is NULL when the request failed
+// without a usable reply, the connection closed or Sway answered out of
+// order.
+typedef void (*sway_cmd_reply_func)(WMServiceSway *self,
+                                    sway_client_ipc_msg *msg, gpointer data);
+
+// A request sent on the command connection which is awaiting its reply.
+typedef struct _SwayPendingCmd {
+    guint32 type;
+    sway_cmd_reply_func reply_cb;
+    gpointer data;
+    // frees `data` once the request completed, failed or was dropped.
+    GDestroyNotify destroy;
+} SwayPendingCmd;
+
+// Records a request just sent on the command connection, `ret` is the return
+// value of the sway_client helper which sent it. When sending failed nothing
+// is recorded and `data` remains the caller's.
+//
+// Sway answers requests on a connection strictly in order, so replies are
+// matched to the head of the FIFO. This lets any number of commands be
+// pipelined without waiting on each reply.
+static int cmd_track_full(WMServiceSway *self, int ret, guint32 type,
+                          sway_cmd_reply_func reply_cb, gpointer data,
+                          GDestroyNotify destroy) {
+    SwayPendingCmd *pending = NULL;
+
+    if (ret != 0) return ret;
+
+    pending = g_malloc0(sizeof(SwayPendingCmd));
+    pending->type = type;
+    pending->reply_cb = reply_cb;
+    pending->data = data;
+    pending->destroy = destroy;
+    g_queue_push_tail(self->cmd_queue, pending);
+
+    return ret;
+}
+
+static int cmd_track(WMServiceSway *self, int ret, guint32 type,
+                     sway_cmd_reply_func reply_cb, gpointer data) {
+    return cmd_track_full(self, ret, type, reply_cb, data, NULL);
+}
+
+// Releases a request's data without running its callback.
+static void cmd_free(SwayPendingCmd *pending) {
+    if (pending->destroy) pending->destroy(pending->data);
+    g_free(pending);
+}
+
+// Completes a request with its reply, or fails it when `msg` is NULL.
+static void cmd_complete(WMServiceSway *self, SwayPendingCmd *pending,
+                         sway_client_ipc_msg *msg) {
+    if (pending->reply_cb)
+        pending->reply_cb(self, msg, pending->data);
+    else if (msg)
+        g_free(msg->payload);
+    cmd_free(pending);
+}
+
+// Fails every request of `queue`, none will get a reply, and frees it.
+static void cmd_fail_all(WMServiceSway *self, GQueue *queue) {
+    SwayPendingCmd *pending = NULL;
+
+    while ((pending = g_queue_pop_head(queue)))
+        cmd_complete(self, pending, NULL);
+    g_queue_free(queue);
+}
+
+static void free_window_event(WMWindowEvent *event);
+static void free_workspace_event(WMWorkspaceEvent *event);
+
 static void wm_service_sway_dispose(GObject *gobject) {
     WMServiceSway *self = WM_SERVICE_SWAY(gobject);
 
-    // close socket
-    close(self->socket_fd);
+    if (self->coalesce_id) {
+        g_source_remove(self->coalesce_id);
+        self->coalesce_id = 0;
+    }
+
+    // close sockets, dropping anything still queued for them.
+    sway_client_ipc_close(self->socket_fd);
+    sway_client_ipc_reader_clear(&self->reader);
+    sway_client_ipc_close(self->cmd_socket_fd);
+    sway_client_ipc_reader_clear(&self->cmd_reader);
+    // callbacks must not run against a disposed service, only release what
+    // the requests hold.
+    g_queue_free_full(self->cmd_queue, (GDestroyNotify)cmd_free);
+    sway_client_ipc_record_stop();
 
     // g_free socket path
     g_free(self->socket_path);
 
     if (self->workspaces) g_ptr_array_unref(self->workspaces);
+    if (self->windows) g_ptr_array_unref(self->windows);
+    g_hash_table_destroy(self->windows_by_id);
+    g_queue_free_full(self->tree_events, (GDestroyNotify)free_window_event);
+    g_queue_free_full(self->workspace_events,
+                      (GDestroyNotify)free_workspace_event);
+    g_hash_table_destroy(self->window_moves);
 
     // Chain-up
     G_OBJECT_CLASS(wm_service_sway_parent_class)->dispose(gobject);
@@ -58,40 +198,143 @@ static void wm_service_sway_class_init(WMServiceSwayClass *klass) {
     service_signals[outputs_changed] = g_signal_new(
         "outputs-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0, NULL,
         NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
+
+    service_signals[windows_changed] = g_signal_new(
+        "windows-changed", G_TYPE_FROM_CLASS(klass), G_SIGNAL_RUN_LAST, 0, NULL,
+        NULL, NULL, G_TYPE_NONE, 1, G_TYPE_PTR_ARRAY);
 };
 
+static GPtrArray *signal_model(WMServiceSway *self, guint signal) {
+    switch (signal) {
+        case workspaces_changed:
+            return self->workspaces;
+        case outputs_changed:
+            return self->outputs;
+        case windows_changed:
+            return self->windows;
+    }
+    return NULL;
+}
+
+// Emits every signal with changes not yet delivered.
+static void emit_pending(WMServiceSway *self) {
+    guint pending = self->pending_signals;
+
+    self->pending_signals = 0;
+
+    for (guint i = 0; i < signals_n; i++) {
+        if (!(pending & (1 << i))) continue;
+
+        self->coalesce_emitted[i]++;
+        g_debug(
+            "window_manager_service_sway.c:emit_pending() "
+            "emitting %s, %" G_GUINT64_FORMAT
+            " changes collapsed so far.",
+            g_signal_name(service_signals[i]),
+            self->coalesce_requested[i] - self->coalesce_emitted[i]);
+
+        g_signal_emit(self, service_signals[i], 0, signal_model(self, i));
+    }
+}
+
+// Ends a coalescing window, delivering what arrived during it. A window
+// which collected changes is followed by another so a sustained burst stays
+// at one emission per window, a quiet one closes.
+static gboolean on_coalesce_flush(WMServiceSway *self) {
+    if (!self->pending_signals) {
+        self->coalesce_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    emit_pending(self);
+    return G_SOURCE_CONTINUE;
+}
+
+static gboolean on_coalesce_idle(WMServiceSway *self) {
+    self->coalesce_id = 0;
+    emit_pending(self);
+    return G_SOURCE_REMOVE;
+}
+
+// Notes that the model behind `signal` changed.
+//
+// Sway delivers bursts of events, for instance on hotplug or reload, and
+// rebuilding every listener's widgets for each would be wasteful. A change
+// arriving while no 'event-coalesce-ms' window is open is delivered at once
+// and opens one, changes arriving within it are merged and each signal is
+// emitted at most once when it ends, with the latest model. An isolated
+// change is therefore never delayed. A window of 0 instead flushes on the
+// next main loop iteration, ahead of GTK's redraw.
+static void schedule_emit(WMServiceSway *self, guint signal) {
+    guint window_ms = 0;
+
+    self->coalesce_requested[signal]++;
+    self->pending_signals |= (1 << signal);
+
+    if (self->coalesce_id) return;
+
+    window_ms = g_settings_get_uint(self->settings, "event-coalesce-ms");
+    if (window_ms == 0) {
+        self->coalesce_id =
+            g_idle_add_full(G_PRIORITY_HIGH_IDLE + 10,
+                            (GSourceFunc)on_coalesce_idle, self, NULL);
+        return;
+    }
+
+    self->coalesce_id =
+        g_timeout_add(window_ms, (GSourceFunc)on_coalesce_flush, self);
+    emit_pending(self);
+}
+
 static gint compare_workspace_name(WMWorkspace **a, WMWorkspace **b) {
     return g_strcmp0((*a)->name, (*b)->name);
 }
 
+static void request_workspaces(WMServiceSway *self);
+static gboolean apply_workspace_event(WMServiceSway *self,
+                                      WMWorkspaceEvent *event,
+                                      gboolean replay);
+
+// Installs a workspace listing, replaying the workspace events received
+// since it was requested as handle_ipc_get_tree does for windows.
 static void handle_ipc_get_workspaces(WMServiceSway *self,
-                                      sway_client_ipc_msg *msg) {
-    GPtrArray *tmp = sway_client_ipc_get_workspaces_resp(msg);
+                                      sway_client_ipc_msg *msg,
+                                      gpointer data) {
+    GPtrArray *tmp = msg ? sway_client_ipc_get_workspaces_resp(msg) : NULL;
+    WMWorkspaceEvent *event = NULL;
 
     g_debug(
         "window_manager_service_sway.c:handle_ipc_get_workspaces() "
         "called");
 
-    if (!tmp) return;
+    if (tmp) {
+        if (self->workspaces) g_ptr_array_unref(self->workspaces);
+        self->workspaces = tmp;
 
-    if (self->workspaces) {
-        g_ptr_array_unref(self->workspaces);
+        // check 'sort-alphabetical' setting and if true sort
+        if (g_settings_get_boolean(self->settings,
+                                   "sort-workspaces-alphabetical"))
+            g_ptr_array_sort(self->workspaces,
+                             (GCompareFunc)compare_workspace_name);
     }
-    self->workspaces = tmp;
 
-    // check 'sort-alphabetical' setting and if true sort
-    if (g_settings_get_boolean(self->settings, "sort-workspaces-alphabetical"))
-        g_ptr_array_sort(self->workspaces,
-                         (GCompareFunc)compare_workspace_name);
+    while ((event = g_queue_pop_head(self->workspace_events))) {
+        if (self->workspaces) apply_workspace_event(self, event, true);
+        free_workspace_event(event);
+    }
+    self->workspaces_pending = false;
+
+    if (self->workspaces) schedule_emit(self, workspaces_changed);
 
-    // emit signal
-    g_signal_emit(self, service_signals[workspaces_changed], 0,
-                  self->workspaces);
+    if (self->workspaces_refetch) {
+        self->workspaces_refetch = false;
+        request_workspaces(self);
+    }
 }
 
 static void handle_ipc_get_outputs(WMServiceSway *self,
-                                   sway_client_ipc_msg *msg) {
-    GPtrArray *tmp = sway_client_ipc_get_outputs_resp(msg);
+                                   sway_client_ipc_msg *msg, gpointer data) {
+    GPtrArray *tmp = msg ? sway_client_ipc_get_outputs_resp(msg) : NULL;
 
     g_debug(
         "window_manager_service_sway.c:handle_ipc_get_workspaces() "
@@ -104,8 +347,63 @@ static void handle_ipc_get_outputs(WMServiceSway *self,
     }
     self->outputs = tmp;
 
-    // emit signal
-    g_signal_emit(self, service_signals[outputs_changed], 0, self->outputs);
+    schedule_emit(self, outputs_changed);
+}
+
+static void request_tree(WMServiceSway *self);
+static gboolean apply_window_event(WMServiceSway *self, WMWindowEvent *event,
+                                   gboolean replay);
+
+// Installs a layout tree snapshot.
+//
+// The tree is fetched on the command connection while events keep arriving
+// on the event connection, so a snapshot may or may not include the window
+// events received since it was requested. Those were queued rather than
+// applied and are replayed over the snapshot here, in order. Replaying an
+// event the snapshot already reflects is harmless, see apply_window_event.
+static void handle_ipc_get_tree(WMServiceSway *self, sway_client_ipc_msg *msg,
+                                gpointer data) {
+    GPtrArray *tmp = msg ? sway_client_ipc_get_tree_resp(msg) : NULL;
+    WMWindowEvent *event = NULL;
+    guint replayed = 0;
+
+    g_debug(
+        "window_manager_service_sway.c:handle_ipc_get_tree() "
+        "called");
+
+    if (tmp) {
+        if (self->windows) g_ptr_array_unref(self->windows);
+        self->windows = tmp;
+
+        g_hash_table_remove_all(self->windows_by_id);
+        for (guint i = 0; i < self->windows->len; i++) {
+            WMWindow *win = g_ptr_array_index(self->windows, i);
+            g_hash_table_insert(self->windows_by_id,
+                                GUINT_TO_POINTER(win->id), win);
+        }
+    }
+
+    // without a snapshot the model we have is brought forward instead. The
+    // request stays pending while replaying, resyncs requested by replayed
+    // events only mark it for a refetch.
+    while ((event = g_queue_pop_head(self->tree_events))) {
+        if (self->windows) apply_window_event(self, event, true);
+        free_window_event(event);
+        replayed++;
+    }
+    self->tree_pending = false;
+
+    g_debug(
+        "window_manager_service_sway.c:handle_ipc_get_tree() "
+        "replayed %u window events over the snapshot.",
+        replayed);
+
+    if (self->windows) schedule_emit(self, windows_changed);
+
+    if (self->tree_refetch) {
+        self->tree_refetch = false;
+        request_tree(self);
+    }
 }
 
 static void launch_on_workspace_new_script(gchar *name) {
@@ -123,25 +421,246 @@ static void launch_on_workspace_new_script(gchar *name) {
     g_free(path);
 }
 
+static void free_workspace_event(WMWorkspaceEvent *event) {
+    if (!event) return;
+    g_free(event->workspace.name);
+    g_free(event);
+}
+
+static WMWorkspace *find_workspace_by_id(WMServiceSway *self, guint32 id,
+                                         guint *index) {
+    for (guint i = 0; i < self->workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(self->workspaces, i);
+        if (ws->id == id) {
+            if (index) *index = i;
+            return ws;
+        }
+    }
+    return NULL;
+}
+
+// Returns the position of `output` in sway's output listing, outputs we have
+// not seen yet sort last.
+static guint workspace_output_rank(WMServiceSway *self, const gchar *output) {
+    if (!self->outputs) return G_MAXUINT;
+    for (guint i = 0; i < self->outputs->len; i++) {
+        WMOutput *o = g_ptr_array_index(self->outputs, i);
+        if (g_strcmp0(o->name, output) == 0) return i;
+    }
+    return G_MAXUINT;
+}
+
+// Orders workspaces the way get_workspaces lists them: by output, then
+// numbered workspaces by number ahead of named ones, which keep the order they
+// were created in.
+static gint compare_workspace_position(WMServiceSway *self, WMWorkspace *a,
+                                       WMWorkspace *b) {
+    guint rank_a = workspace_output_rank(self, a->output);
+    guint rank_b = workspace_output_rank(self, b->output);
+
+    if (rank_a != rank_b) return rank_a < rank_b ? -1 : 1;
+    if (a->num >= 0 && b->num >= 0)
+        return (a->num > b->num) - (a->num < b->num);
+    if (a->num >= 0) return -1;
+    if (b->num >= 0) return 1;
+    return 0;
+}
+
+// Inserts `ws` where a fresh get_workspaces listing would place it, after any
+// workspace it ties with.
+static void insert_workspace_sorted(WMServiceSway *self, WMWorkspace *ws) {
+    guint i = self->workspaces->len;
+
+    while (i > 0) {
+        WMWorkspace *prev = g_ptr_array_index(self->workspaces, i - 1);
+        if (compare_workspace_position(self, prev, ws) <= 0) break;
+        i--;
+    }
+    g_ptr_array_insert(self->workspaces, i, ws);
+}
+
+// Moves `ws`, found at `index`, to where its output or number now place it.
+static void reposition_workspace(WMServiceSway *self, WMWorkspace *ws,
+                                 guint index) {
+    g_ptr_array_steal_index(self->workspaces, index);
+    insert_workspace_sorted(self, ws);
+}
+
+// Requests a workspace listing, kept to a single request in flight as
+// request_tree does.
+static void request_workspaces(WMServiceSway *self) {
+    if (self->workspaces_pending) {
+        self->workspaces_refetch = true;
+        return;
+    }
+    if (cmd_track(self,
+                  sway_client_ipc_get_workspaces_req(self->cmd_socket_fd),
+                  IPC_GET_WORKSPACES, handle_ipc_get_workspaces, NULL) == 0)
+        self->workspaces_pending = true;
+}
+
+static void request_outputs(WMServiceSway *self) {
+    cmd_track(self, sway_client_ipc_get_outputs_req(self->cmd_socket_fd),
+              IPC_GET_OUTPUTS, handle_ipc_get_outputs, NULL);
+}
+
+// Requests the layout tree, the response will replace the cached window model
+// wholesale in handle_ipc_get_tree. Only a single request is kept in flight,
+// asking again while one is pending takes one more snapshot after it lands,
+// however many times it is asked.
+static void request_tree(WMServiceSway *self) {
+    if (self->tree_pending) {
+        self->tree_refetch = true;
+        return;
+    }
+    if (cmd_track(self, sway_client_ipc_get_tree_req(self->cmd_socket_fd),
+                  IPC_GET_TREE, handle_ipc_get_tree, NULL) == 0)
+        self->tree_pending = true;
+}
+
+static void resync_windows(WMServiceSway *self, const char *reason) {
+    g_debug(
+        "window_manager_service_sway.c:resync_windows() "
+        "performing full window resync: %s",
+        reason);
+    request_tree(self);
+}
+
+// Requests a full workspace listing, the response will replace the cached
+// model wholesale in handle_ipc_get_workspaces.
+static void resync_workspaces(WMServiceSway *self, const char *reason) {
+    g_debug(
+        "window_manager_service_sway.c:resync_workspaces() "
+        "performing full workspace resync: %s",
+        reason);
+    request_workspaces(self);
+}
+
+// Takes the area of the workspace `from` reports, if it reports one.
+static void workspace_copy_rect(WMWorkspace *ws, WMWorkspace *from) {
+    if (from->width <= 0 || from->height <= 0) return;
+    ws->x = from->x;
+    ws->y = from->y;
+    ws->width = from->width;
+    ws->height = from->height;
+}
+
+// Applies a workspace event to the cached workspace model in place.
+//
+// Returns true if the model was changed and listeners should be notified.
+// If the event references a workspace we do not know about (or a created
+// workspace we already track) the model has diverged from Sway's state and a
+// full resync is requested instead, in which case false is returned and the
+// resync response will notify listeners.
+//
+// When `replay` is set the event is replayed over a listing which may already
+// reflect it, as in apply_window_event: a created workspace which exists is
+// left as listed and events for unknown workspaces, destroyed before the
+// listing was taken, are dropped.
+static gboolean apply_workspace_event(WMServiceSway *self,
+                                      WMWorkspaceEvent *event,
+                                      gboolean replay) {
+    WMWorkspace *ws = NULL;
+    guint index = 0;
+
+    if (event->type == WMWORKSPACE_EVENT_RELOAD) {
+        resync_workspaces(self, "reload");
+        return false;
+    }
+
+    ws = find_workspace_by_id(self, event->workspace.id, &index);
+
+    if (!ws && event->type != WMWORKSPACE_EVENT_CREATED) {
+        if (!replay) resync_workspaces(self, "event for unknown workspace");
+        return false;
+    }
+
+    switch (event->type) {
+        case WMWORKSPACE_EVENT_CREATED:
+            if (ws && !replay) {
+                resync_workspaces(self, "created workspace already exists");
+                return false;
+            }
+            // the listing saw it, later changes follow in the queue.
+            if (ws) return false;
+            // steal the event's name, the event is freed without it.
+            ws = g_malloc0(sizeof(WMWorkspace));
+            *ws = event->workspace;
+            ws->empty = false;
+            event->workspace.name = NULL;
+            insert_workspace_sorted(self, ws);
+            break;
+        case WMWORKSPACE_EVENT_DESTROYED:
+            g_ptr_array_remove_index(self->workspaces, index);
+            return true;
+        case WMWORKSPACE_EVENT_FOCUSED:
+            // Sway reports 'focused' on the node level which is false when a
+            // window within the workspace holds focus, so derive it here.
+            // it is also the one shown on its output now.
+            for (guint i = 0; i < self->workspaces->len; i++) {
+                WMWorkspace *w = g_ptr_array_index(self->workspaces, i);
+                w->focused = (w == ws);
+                if (g_strcmp0(w->output, ws->output) == 0)
+                    w->visible = (w == ws);
+            }
+            ws->urgent = event->workspace.urgent;
+            workspace_copy_rect(ws, &event->workspace);
+            break;
+        case WMWORKSPACE_EVENT_MOVED:
+            ws->output = event->workspace.output;
+            workspace_copy_rect(ws, &event->workspace);
+            reposition_workspace(self, ws, index);
+            break;
+        case WMWORKSPACE_EVENT_RENAMED:
+            g_free(ws->name);
+            ws->name = event->workspace.name;
+            ws->num = event->workspace.num;
+            event->workspace.name = NULL;
+            reposition_workspace(self, ws, index);
+            break;
+        case WMWORKSPACE_EVENT_URGENT:
+            ws->urgent = event->workspace.urgent;
+            break;
+        default:
+            return false;
+    }
+
+    // check 'sort-alphabetical' setting and if true sort, only name changes
+    // and new workspaces can change the order.
+    if ((event->type == WMWORKSPACE_EVENT_CREATED ||
+         event->type == WMWORKSPACE_EVENT_RENAMED) &&
+        g_settings_get_boolean(self->settings, "sort-workspaces-alphabetical"))
+        g_ptr_array_sort(self->workspaces,
+                         (GCompareFunc)compare_workspace_name);
+
+    return true;
+}
+
 static void handle_ipc_event_workspaces(WMServiceSway *self,
                                         sway_client_ipc_msg *msg) {
-    // perform get workspaces req to get latest workspace's state.
-    // this maybe slower (another round tip) but works way smoother
-    // on spam events like monitor create and deletes.
     g_debug(
         "window_manager_service_sway.c:handle_ipc_event_workspaces() "
-        "received workspace event, getting latest workspace listing.");
+        "received workspace event, applying to workspace model.");
 
-    // we still want to determine if this is a new workspace and if it is
-    // run our "on_workspace_new.sh" script.
     WMWorkspaceEvent *event = sway_client_ipc_event_workspace_resp(msg);
+    if (!event) {
+        // we could not make sense of the event, our model may now be stale.
+        resync_workspaces(self, "failed to parse workspace event");
+        return;
+    }
+
+    // determine if this is a new workspace and if it is run our
+    // "on_workspace_new.sh" script.
     if (event->type == WMWORKSPACE_EVENT_CREATED) {
         launch_on_workspace_new_script(event->workspace.name);
     }
     if (event->type == WMWORKSPACE_EVENT_URGENT &&
         g_settings_get_boolean(self->settings, "focus-urgent-workspace")) {
         // switch to workspace
-        sway_client_ipc_focus_workspace(self->socket_fd, &event->workspace);
+        cmd_track(self,
+                  sway_client_ipc_focus_workspace(self->cmd_socket_fd,
+                                                  &event->workspace),
+                  IPC_COMMAND, NULL, NULL);
     }
 
     if (event->type == WMWORKSPACE_EVENT_FOCUSED) {
@@ -149,31 +668,274 @@ static void handle_ipc_event_workspaces(WMServiceSway *self,
         self->focused_workspace = g_strdup(event->workspace.name);
     }
 
-    sway_client_ipc_get_workspaces_req(self->socket_fd);
+    // the in flight listing may or may not include this event, it is
+    // replayed once the listing lands.
+    if (self->workspaces_pending) {
+        g_queue_push_tail(self->workspace_events, event);
+        return;
+    }
+
+    if (apply_workspace_event(self, event, false))
+        schedule_emit(self, workspaces_changed);
+
+    free_workspace_event(event);
 };
 
+static void free_window_event(WMWindowEvent *event) {
+    if (!event) return;
+    g_free(event->window.app_id);
+    g_free(event->window.title);
+    g_free(event);
+}
+
+static guint32 focused_workspace_id(WMServiceSway *self) {
+    if (!self->workspaces) return 0;
+    for (guint i = 0; i < self->workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(self->workspaces, i);
+        if (ws->focused) return ws->id;
+    }
+    return 0;
+}
+
+static WMWindow *focused_window(WMServiceSway *self) {
+    if (!self->windows) return NULL;
+    for (guint i = 0; i < self->windows->len; i++) {
+        WMWindow *win = g_ptr_array_index(self->windows, i);
+        if (win->focused) return win;
+    }
+    return NULL;
+}
+
+// Records that we are asking Sway to move the focused window to `ws`.
+//
+// Sway's move events name the window but not where it went, remembering the
+// destination lets apply_window_event place the window without fetching the
+// tree. Returns the window's id, or 0 when nothing will move.
+static guint32 track_window_move(WMServiceSway *self, WMWorkspace *ws) {
+    WMWindow *win = focused_window(self);
+
+    // moving a window to its own workspace emits nothing.
+    if (!win || !ws || win->workspace_id == ws->id) return 0;
+
+    g_hash_table_replace(self->window_moves, GUINT_TO_POINTER(win->id),
+                         g_strdup(ws->name));
+    return win->id;
+}
+
+// Forgets a move which Sway refused, its window will not move.
+static void untrack_window_move(WMServiceSway *self, guint32 id) {
+    if (id) g_hash_table_remove(self->window_moves, GUINT_TO_POINTER(id));
+}
+
+static void handle_ipc_command_move(WMServiceSway *self,
+                                    sway_client_ipc_msg *msg, gpointer data) {
+    GArray *results = msg ? sway_client_ipc_command_resp(msg) : NULL;
+
+    if (!results || results->len == 0 || !g_array_index(results, gboolean, 0))
+        untrack_window_move(self, GPOINTER_TO_UINT(data));
+
+    if (results) g_array_unref(results);
+}
+
+// Places a moved window on the workspace we asked Sway to move it to.
+// Returns false if the move was not ours to know the destination of.
+static gboolean apply_window_move(WMServiceSway *self, WMWindow *win) {
+    const gchar *name = g_hash_table_lookup(self->window_moves,
+                                            GUINT_TO_POINTER(win->id));
+    WMWorkspace *ws = NULL;
+
+    if (!name || !self->workspaces) return false;
+
+    for (guint i = 0; i < self->workspaces->len && !ws; i++) {
+        WMWorkspace *w = g_ptr_array_index(self->workspaces, i);
+        if (g_strcmp0(w->name, name) == 0) ws = w;
+    }
+    g_hash_table_remove(self->window_moves, GUINT_TO_POINTER(win->id));
+    if (!ws) return false;
+
+    win->workspace_id = ws->id;
+    return true;
+}
+
+// Places a window moved by someone else from the event's own payload.
+//
+// Sway describes the moved container but not the workspace it landed on. A
+// window still visible lies on the visible workspace whose area holds its
+// center. Returns false if that does not tell, the window went to a hidden
+// workspace or its rect still lies on the workspace it left.
+static gboolean apply_window_move_visible(WMServiceSway *self, WMWindow *win,
+                                          WMWindowEvent *event) {
+    if (!event->visible || !self->workspaces) return false;
+
+    for (guint i = 0; i < self->workspaces->len; i++) {
+        WMWorkspace *ws = g_ptr_array_index(self->workspaces, i);
+        if (!ws->visible || ws->width <= 0 || ws->height <= 0) continue;
+        if (event->x < ws->x || event->x >= ws->x + ws->width ||
+            event->y < ws->y || event->y >= ws->y + ws->height)
+            continue;
+        if (ws->id == win->workspace_id) return false;
+
+        win->workspace_id = ws->id;
+        return true;
+    }
+    return false;
+}
+
+// Applies a window event to the cached window model in place.
+//
+// Returns true if the model was changed and listeners should be notified.
+// Sway's window events carry the container but not its workspace, so new
+// windows are placed on the focused workspace, where Sway maps them unless an
+// `assign` rule says otherwise. Moves we requested are placed on their
+// destination, other moves by where the window landed, see
+// apply_window_move_visible. Only moves neither places, and moves of whole
+// containers, whose windows send no events of their own, resync the tree.
+//
+// Outside of a replay an event for a window we do not know about means the
+// model diverged and requests a resync. When `replay` is set the event is
+// replayed over a snapshot which may already reflect it: a new window may
+// already exist and is updated instead, while an unknown window closed
+// before the snapshot was taken, its own close follows in the queue, so the
+// event is dropped.
+static gboolean apply_window_event(WMServiceSway *self, WMWindowEvent *event,
+                                   gboolean replay) {
+    WMWindow *win = g_hash_table_lookup(self->windows_by_id,
+                                        GUINT_TO_POINTER(event->window.id));
+
+    if (event->container) {
+        if (event->type == WMWINDOW_EVENT_MOVE)
+            resync_windows(self, "container moved");
+        return false;
+    }
+
+    if (!win && event->type != WMWINDOW_EVENT_NEW &&
+        event->type != WMWINDOW_EVENT_CLOSE &&
+        event->type != WMWINDOW_EVENT_MOVE) {
+        if (!replay) resync_windows(self, "event for unknown window");
+        return false;
+    }
+
+    switch (event->type) {
+        case WMWINDOW_EVENT_NEW:
+            if (win && !replay) {
+                resync_windows(self, "new window already exists");
+                return false;
+            }
+            if (win) {
+                // the snapshot saw it, keep its workspace.
+                g_free(win->app_id);
+                g_free(win->title);
+                win->app_id = event->window.app_id;
+                win->title = event->window.title;
+                event->window.app_id = NULL;
+                event->window.title = NULL;
+                break;
+            }
+            // steal the event's strings, the event is freed without them.
+            win = g_malloc0(sizeof(WMWindow));
+            *win = event->window;
+            win->workspace_id = focused_workspace_id(self);
+            event->window.app_id = NULL;
+            event->window.title = NULL;
+            g_ptr_array_add(self->windows, win);
+            g_hash_table_insert(self->windows_by_id, GUINT_TO_POINTER(win->id),
+                                win);
+            break;
+        case WMWINDOW_EVENT_CLOSE:
+            untrack_window_move(self, event->window.id);
+            // nothing to do, we never saw it or already dropped it.
+            if (!win) return false;
+            g_hash_table_remove(self->windows_by_id,
+                                GUINT_TO_POINTER(win->id));
+            g_ptr_array_remove(self->windows, win);
+            break;
+        case WMWINDOW_EVENT_FOCUS:
+            for (guint i = 0; i < self->windows->len; i++) {
+                WMWindow *w = g_ptr_array_index(self->windows, i);
+                w->focused = (w == win);
+            }
+            break;
+        case WMWINDOW_EVENT_TITLE:
+            g_free(win->title);
+            win->title = event->window.title;
+            event->window.title = NULL;
+            break;
+        case WMWINDOW_EVENT_URGENT:
+            win->urgent = event->window.urgent;
+            break;
+        case WMWINDOW_EVENT_MOVE:
+            if (win && (apply_window_move(self, win) ||
+                        apply_window_move_visible(self, win, event)))
+                break;
+            resync_windows(self, win ? "window moved out of sight"
+                                     : "move of unknown window");
+            return false;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+static void handle_ipc_event_window(WMServiceSway *self,
+                                    sway_client_ipc_msg *msg) {
+    WMWindowEvent *event = NULL;
+
+    g_debug(
+        "window_manager_service_sway.c:handle_ipc_event_window() "
+        "received window event, applying to window model.");
+
+    event = sway_client_ipc_event_window_resp(msg);
+    if (!event) return;
+
+    // the in flight tree may or may not include this event, it is replayed
+    // once the tree lands.
+    if (self->tree_pending) {
+        g_queue_push_tail(self->tree_events, event);
+        return;
+    }
+
+    if (apply_window_event(self, event, false))
+        schedule_emit(self, windows_changed);
+
+    free_window_event(event);
+}
+
 static void handle_ipc_event_outputs(WMServiceSway *self,
                                      sway_client_ipc_msg *msg) {
     g_debug(
         "window_manager_service_sway.c:handle_ipc_event_outputs() "
         "received output event, getting latest output listing.");
-    sway_client_ipc_get_outputs_req(self->socket_fd);
+    g_free(msg->payload);
+    request_outputs(self);
 };
 
+static void handle_ipc_event_binding(WMServiceSway *self,
+                                     sway_client_ipc_msg *msg) {
+    gchar *command = sway_client_ipc_event_binding_resp(msg);
+
+    if (!command) return;
+
+    // `nop` bindings do nothing in sway, when they carry our prefix run the
+    // remainder as a way-sh command without spawning way-sh.
+    if (g_str_has_prefix(command, WM_SERVICE_SWAY_BINDING_PREFIX)) {
+        g_debug(
+            "window_manager_service_sway.c:handle_ipc_event_binding() "
+            "executing binding: %s",
+            command);
+        ipc_service_exec_command(command +
+                                 strlen(WM_SERVICE_SWAY_BINDING_PREFIX));
+    }
+
+    g_free(command);
+}
+
 static void on_ipc_recv_dispatch(WMServiceSway *self,
                                  sway_client_ipc_msg *msg) {
     g_debug(
         "window_manager_service_sway.c:on_ipc_recv_dispatch() "
         "dispatching ipc message.");
     switch (msg->type) {
-        case IPC_GET_WORKSPACES: {
-            handle_ipc_get_workspaces(self, msg);
-            break;
-        }
-        case IPC_GET_OUTPUTS: {
-            handle_ipc_get_outputs(self, msg);
-            break;
-        }
         case IPC_SUBSCRIBE: {
             self->subscribed = sway_client_ipc_subscribe_resp(msg);
             if (!self->subscribed) {
@@ -188,10 +950,11 @@ static void on_ipc_recv_dispatch(WMServiceSway *self,
             break;
         }
         case IPC_EVENT_WORKSPACE: {
-            if (!self->workspaces) {
+            if (!self->workspaces && !self->workspaces_pending) {
                 g_debug(
                     "window_manager_service_sway.c:on_ipc_recv_dispatch() "
                     "ignoring event until initial sync.");
+                g_free(msg->payload);
                 break;
             }
             handle_ipc_event_workspaces(self, msg);
@@ -202,39 +965,174 @@ static void on_ipc_recv_dispatch(WMServiceSway *self,
                 g_debug(
                     "window_manager_service_sway.c:on_ipc_recv_dispatch() "
                     "ignoring event until initial sync.");
+                g_free(msg->payload);
                 break;
             }
             handle_ipc_event_outputs(self, msg);
             break;
         }
+        case IPC_EVENT_WINDOW: {
+            handle_ipc_event_window(self, msg);
+            break;
+        }
+        case IPC_EVENT_BINDING: {
+            handle_ipc_event_binding(self, msg);
+            break;
+        }
+        default:
+            g_free(msg->payload);
+    }
+}
+
+// Hands a reply received on the command connection to the request at the
+// head of the FIFO.
+static void on_ipc_cmd_recv_dispatch(WMServiceSway *self,
+                                     sway_client_ipc_msg *msg) {
+    SwayPendingCmd *pending = g_queue_pop_head(self->cmd_queue);
+
+    if (!pending) {
+        g_warning(
+            "window_manager_service_sway.c:on_ipc_cmd_recv_dispatch() "
+            "received reply of type %u with no pending request.",
+            msg->type);
+        g_free(msg->payload);
+        return;
+    }
+
+    if (pending->type != msg->type) {
+        g_warning(
+            "window_manager_service_sway.c:on_ipc_cmd_recv_dispatch() "
+            "expected reply of type %u but received %u.",
+            pending->type, msg->type);
+        g_free(msg->payload);
+        cmd_complete(self, pending, NULL);
+        return;
     }
+
+    cmd_complete(self, pending, msg);
 }
 
 static gboolean on_ipc_recv(gint fd, GIOCondition condition,
                             WMServiceSway *self) {
     sway_client_ipc_msg msg;
+    int read_ret = 0;
+    int ret = 0;
 
     g_debug(
         "window_manager_service_sway.c:on_ipc_recv() "
         "received ipc message.");
 
-    // TODO: implement recovery from this.
-    if (condition & G_IO_HUP || condition & G_IO_ERR) {
+    // drain whatever is available without blocking, on hangup this still
+    // collects any frames sway wrote before closing.
+    read_ret = sway_client_ipc_read(self->socket_fd, &self->reader);
+
+    // dispatch every complete frame buffered so far, partial frames wait for
+    // the next wakeup.
+    while ((ret = sway_client_ipc_recv(&self->reader, &msg)) > 0) {
+        gint64 start = g_get_monotonic_time();
+        guint32 type = msg.type;
+
+        on_ipc_recv_dispatch(self, &msg);
+
         g_debug(
+            "window_manager_service_sway.c:on_ipc_recv() "
+            "dispatched frame of type %#x in %" G_GINT64_FORMAT " us.",
+            type, g_get_monotonic_time() - start);
+    }
+
+    if (ret < 0) {
+        g_critical(
             "window_manager_service_sway.c:handle_ipc_recv() "
-            "received G_IO_HUP or G_IO_ERR, GLib polling stopped.");
+            "received malformed ipc frame, GLib polling stopped.");
         return false;
     }
 
-    // retrieve ipc msg
-    if (sway_client_ipc_recv(self->socket_fd, &msg) != 0) {
+    // TODO: implement recovery from this.
+    if (read_ret < 0 || condition & G_IO_HUP || condition & G_IO_ERR) {
         g_debug(
             "window_manager_service_sway.c:handle_ipc_recv() "
-            "failed to receive ipc message.");
+            "socket closed or errored, GLib polling stopped.");
+        return false;
+    }
+
+    return true;
+}
+
+static gboolean on_ipc_cmd_recv(gint fd, GIOCondition condition,
+                                WMServiceSway *self);
+
+// Replaces a broken command connection with a new one.
+// Requests sent on the old connection are failed, their replies went with it.
+// Their callbacks may already send requests again, which go out on the new
+// connection.
+static void cmd_reconnect(WMServiceSway *self) {
+    GQueue *stale = self->cmd_queue;
+
+    sway_client_ipc_close(self->cmd_socket_fd);
+    sway_client_ipc_reader_clear(&self->cmd_reader);
+    self->cmd_queue = g_queue_new();
+    self->cmd_poll_id = 0;
+
+    self->cmd_socket_fd = sway_client_ipc_connect(self->socket_path);
+    if (self->cmd_socket_fd < 0) {
+        g_warning(
+            "window_manager_service_sway.c:cmd_reconnect() "
+            "failed to reconnect command socket, commands are disabled.");
+    } else {
+        g_debug(
+            "window_manager_service_sway.c:cmd_reconnect() "
+            "reconnected command ipc socket: %d.",
+            self->cmd_socket_fd);
+        self->cmd_poll_id = g_unix_fd_add(
+            self->cmd_socket_fd, G_IO_IN | G_IO_HUP | G_IO_ERR,
+            (GUnixFDSourceFunc)on_ipc_cmd_recv, self);
+    }
+
+    cmd_fail_all(self, stale);
+}
+
+static gboolean on_ipc_cmd_recv(gint fd, GIOCondition condition,
+                                WMServiceSway *self) {
+    sway_client_ipc_msg msg;
+    int read_ret = 0;
+    int ret = 0;
+
+    g_debug(
+        "window_manager_service_sway.c:on_ipc_cmd_recv() "
+        "received ipc reply.");
+
+    read_ret = sway_client_ipc_read(self->cmd_socket_fd, &self->cmd_reader);
+
+    while ((ret = sway_client_ipc_recv(&self->cmd_reader, &msg)) > 0) {
+        gint64 start = g_get_monotonic_time();
+        guint32 type = msg.type;
+
+        on_ipc_cmd_recv_dispatch(self, &msg);
+
+        g_debug(
+            "window_manager_service_sway.c:on_ipc_cmd_recv() "
+            "dispatched reply of type %u in %" G_GINT64_FORMAT " us.",
+            type, g_get_monotonic_time() - start);
+    }
+
+    // replies are matched to requests by order, once a frame is lost or the
+    // connection broke the rest can not be trusted, start over on a fresh
+    // connection.
+    if (ret < 0) {
+        g_warning(
+            "window_manager_service_sway.c:on_ipc_cmd_recv() "
+            "received malformed ipc frame, reconnecting.");
+        cmd_reconnect(self);
         return false;
     }
 
-    on_ipc_recv_dispatch(self, &msg);
+    if (read_ret < 0 || condition & G_IO_HUP || condition & G_IO_ERR) {
+        g_warning(
+            "window_manager_service_sway.c:on_ipc_cmd_recv() "
+            "socket closed or errored, reconnecting.");
+        cmd_reconnect(self);
+        return false;
+    }
 
     return true;
 }
@@ -246,7 +1144,7 @@ static void on_sort_alphabetical_changed(GSettings *settings, gchar *key,
         "sort-alphabetical setting changed, updating workspaces.");
 
     // perform workspaces request
-    sway_client_ipc_get_workspaces_req(self->socket_fd);
+    request_workspaces(self);
 }
 
 static void wm_service_sway_init(WMServiceSway *self) {
@@ -261,7 +1159,11 @@ static void wm_service_sway_init(WMServiceSway *self) {
         "found socket path: %s",
         self->socket_path);
 
+    if (g_getenv(WM_SERVICE_SWAY_RECORD_ENV))
+        sway_client_ipc_record_start(g_getenv(WM_SERVICE_SWAY_RECORD_ENV));
+
     self->socket_fd = sway_client_ipc_connect(self->socket_path);
+    sway_client_ipc_reader_init(&self->reader);
     if (self->socket_fd < 0)
         g_error(
             "window_manager_service_sway.c:wm_service_sway_init "
@@ -276,6 +1178,29 @@ static void wm_service_sway_init(WMServiceSway *self) {
         g_unix_fd_add(self->socket_fd, G_IO_IN | G_IO_HUP | G_IO_ERR,
                       (GUnixFDSourceFunc)on_ipc_recv, self);
 
+    // open a second connection for commands so their replies never
+    // interleave with events.
+    self->cmd_socket_fd = sway_client_ipc_connect(self->socket_path);
+    sway_client_ipc_reader_init(&self->cmd_reader);
+    self->cmd_queue = g_queue_new();
+    self->windows_by_id = g_hash_table_new(g_direct_hash, g_direct_equal);
+    self->tree_events = g_queue_new();
+    self->workspace_events = g_queue_new();
+    self->window_moves =
+        g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, g_free);
+    if (self->cmd_socket_fd < 0)
+        g_error(
+            "window_manager_service_sway.c:wm_service_sway_init "
+            "failed to connect command socket.");
+    g_debug(
+        "window_manager_service_sway.c:wm_service_sway_init "
+        "connected to command ipc socket: %d.",
+        self->cmd_socket_fd);
+
+    self->cmd_poll_id =
+        g_unix_fd_add(self->cmd_socket_fd, G_IO_IN | G_IO_HUP | G_IO_ERR,
+                      (GUnixFDSourceFunc)on_ipc_cmd_recv, self);
+
     // connect to 'org.ldelossa.way-shell.window-manager.workspaces' setting
     self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
 
@@ -310,6 +1235,26 @@ GPtrArray *wm_service_sway_get_outputs(WindowManager *wm) {
     return g_ptr_array_ref(self->outputs);
 }
 
+GPtrArray *wm_service_sway_get_windows(WindowManager *wm, WMWorkspace *ws) {
+    WMServiceSway *self = wm->private;
+    GPtrArray *out = NULL;
+
+    if (!self->windows) {
+        g_warning(
+            "window_manager_service_sway.c:wm_service_sway_get_windows() "
+            "windows not initialized.");
+        return NULL;
+    }
+
+    out = g_ptr_array_new();
+    for (guint i = 0; i < self->windows->len; i++) {
+        WMWindow *win = g_ptr_array_index(self->windows, i);
+        if (!ws || win->workspace_id == ws->id) g_ptr_array_add(out, win);
+    }
+
+    return out;
+}
+
 int wm_service_sway_focus_workspace(WindowManager *wm, WMWorkspace *ws) {
     WMServiceSway *self = wm->private;
 
@@ -319,7 +1264,9 @@ int wm_service_sway_focus_workspace(WindowManager *wm, WMWorkspace *ws) {
             "workspaces not initialized.");
         return -1;
     }
-    return sway_client_ipc_focus_workspace(self->socket_fd, ws);
+    return cmd_track(self,
+                     sway_client_ipc_focus_workspace(self->cmd_socket_fd, ws),
+                     IPC_COMMAND, NULL, NULL);
 }
 
 int wm_service_sway_rename_current_workspace(WindowManager *wm,
@@ -328,7 +1275,10 @@ int wm_service_sway_rename_current_workspace(WindowManager *wm,
 
     if (strlen(name) == 0) return -1;
 
-    return sway_client_ipc_rename_current_workspace(self->socket_fd, name);
+    return cmd_track(
+        self,
+        sway_client_ipc_rename_current_workspace(self->cmd_socket_fd, name),
+        IPC_COMMAND, NULL, NULL);
 }
 
 int wm_service_sway_current_ws_to_output(WindowManager *wm, WMOutput *o) {
@@ -341,12 +1291,16 @@ int wm_service_sway_current_ws_to_output(WindowManager *wm, WMOutput *o) {
             "outputs not initialized.");
         return -1;
     }
-    return sway_client_ipc_move_ws_to_output(self->socket_fd, o->name);
+    return cmd_track(
+        self, sway_client_ipc_move_ws_to_output(self->cmd_socket_fd, o->name),
+        IPC_COMMAND, NULL, NULL);
 }
 
 int wm_service_sway_current_app_to_workspace(WindowManager *wm,
                                              WMWorkspace *ws) {
     WMServiceSway *self = wm->private;
+    guint32 id = 0;
+    int ret = 0;
 
     if (!ws) {
         g_warning(
@@ -355,7 +1309,130 @@ int wm_service_sway_current_app_to_workspace(WindowManager *wm,
             "workspaces not initialized.");
         return -1;
     }
-    return sway_client_ipc_move_app_to_workspace(self->socket_fd, ws->name);
+    id = track_window_move(self, ws);
+    ret = cmd_track(
+        self,
+        sway_client_ipc_move_app_to_workspace(self->cmd_socket_fd, ws->name),
+        IPC_COMMAND, handle_ipc_command_move, GUINT_TO_POINTER(id));
+    if (ret != 0) untrack_window_move(self, id);
+    return ret;
+}
+
+// A command batch awaiting its reply.
+typedef struct _SwayPendingBatch {
+    wm_on_batch_done cb;
+    void *data;
+    guint len;
+    // per command, the window a move is tracked for, see track_window_move.
+    guint32 *moves;
+    // `cb` was invoked.
+    gboolean done;
+} SwayPendingBatch;
+
+// Frees a batch. One dropped before its reply reports every command as
+// failed, so the caller can still release `data`.
+static void free_pending_batch(SwayPendingBatch *batch) {
+    if (!batch->done && batch->cb) {
+        GArray *results = g_array_new(FALSE, TRUE, sizeof(gboolean));
+        g_array_set_size(results, batch->len);
+        batch->cb(batch->data, results);
+        g_array_unref(results);
+    }
+    g_free(batch->moves);
+    g_free(batch);
+}
+
+static void handle_ipc_command_batch(WMServiceSway *self,
+                                     sway_client_ipc_msg *msg,
+                                     SwayPendingBatch *batch) {
+    GArray *results = msg ? sway_client_ipc_command_resp(msg) : NULL;
+
+    if (!results) results = g_array_new(FALSE, TRUE, sizeof(gboolean));
+
+    // sway stops at the first command it fails to parse, pad the remainder
+    // with failures.
+    g_array_set_size(results, batch->len);
+
+    for (guint i = 0; i < batch->len; i++)
+        if (!g_array_index(results, gboolean, i))
+            untrack_window_move(self, batch->moves[i]);
+
+    if (batch->cb) batch->cb(batch->data, results);
+    batch->done = true;
+
+    g_array_unref(results);
+}
+
+int wm_service_sway_run_batch(WindowManager *wm, WMCommand *cmds, guint len,
+                              wm_on_batch_done cb, void *data) {
+    WMServiceSway *self = wm->private;
+    sway_client_cmd_batch b;
+    SwayPendingBatch *batch = NULL;
+    int ret = 0;
+
+    sway_client_cmd_batch_init(&b);
+
+    for (guint i = 0; i < len && ret == 0; i++) {
+        switch (cmds[i].type) {
+            case WMCOMMAND_FOCUS_WORKSPACE:
+                ret = sway_client_cmd_batch_focus_workspace(&b,
+                                                            cmds[i].workspace);
+                break;
+            case WMCOMMAND_RENAME_WORKSPACE:
+                ret = sway_client_cmd_batch_rename_current_workspace(
+                    &b, cmds[i].name);
+                break;
+            case WMCOMMAND_WS_TO_OUTPUT:
+                ret = sway_client_cmd_batch_move_ws_to_output(
+                    &b, cmds[i].output ? cmds[i].output->name : NULL);
+                break;
+            case WMCOMMAND_APP_TO_WORKSPACE:
+                ret = sway_client_cmd_batch_move_app_to_workspace(
+                    &b, cmds[i].workspace ? cmds[i].workspace->name : NULL);
+                break;
+            default:
+                ret = -1;
+        }
+        if (ret != 0)
+            g_warning(
+                "window_manager_service_sway.c:wm_service_sway_run_batch() "
+                "invalid arguments for command %u of type %d.",
+                i, cmds[i].type);
+    }
+
+    if (ret != 0) {
+        sway_client_cmd_batch_clear(&b);
+        return ret;
+    }
+
+    batch = g_malloc0(sizeof(SwayPendingBatch));
+    batch->cb = cb;
+    batch->data = data;
+    batch->len = len;
+    batch->moves = g_new0(guint32, len);
+
+    // a move after a focus change moves some other window, only the focused
+    // window's moves are tracked.
+    for (guint i = 0; i < len; i++) {
+        if (cmds[i].type == WMCOMMAND_FOCUS_WORKSPACE) break;
+        if (cmds[i].type == WMCOMMAND_APP_TO_WORKSPACE)
+            batch->moves[i] = track_window_move(self, cmds[i].workspace);
+    }
+
+    ret = cmd_track_full(
+        self, sway_client_ipc_cmd_batch_send(self->cmd_socket_fd, &b),
+        IPC_COMMAND, (sway_cmd_reply_func)handle_ipc_command_batch, batch,
+        (GDestroyNotify)free_pending_batch);
+    sway_client_cmd_batch_clear(&b);
+
+    if (ret != 0) {
+        for (guint i = 0; i < len; i++)
+            untrack_window_move(self, batch->moves[i]);
+        // the caller learns of the failure from `ret`, not from `cb`.
+        batch->done = true;
+        free_pending_batch(batch);
+    }
+    return ret;
 }
 
 guint wm_service_sway_register_on_workspaces_changed(
@@ -394,6 +1471,23 @@ guint wm_service_sway_unregister_on_outputs_changed(WindowManager *wm,
     return g_signal_handlers_disconnect_by_func(self, cb, data);
 }
 
+guint wm_service_sway_register_on_windows_changed(WindowManager *wm,
+                                                  wm_on_windows_changed cb,
+                                                  void *data) {
+    WMServiceSway *self = wm->private;
+
+    return g_signal_connect_swapped(self, "windows-changed", G_CALLBACK(cb),
+                                    data);
+}
+
+guint wm_service_sway_unregister_on_windows_changed(WindowManager *wm,
+                                                    wm_on_windows_changed cb,
+                                                    void *data) {
+    WMServiceSway *self = wm->private;
+
+    return g_signal_handlers_disconnect_by_func(self, cb, data);
+}
+
 WindowManager *wm_service_sway_window_manager_init() {
     WindowManager *wm = g_malloc(sizeof(WindowManager));
 
@@ -415,16 +1509,28 @@ WindowManager *wm_service_sway_window_manager_init() {
         wm_service_sway_register_on_outputs_changed;
     wm->unregister_on_outputs_changed =
         wm_service_sway_unregister_on_outputs_changed;
+    wm->get_windows = wm_service_sway_get_windows;
+    wm->register_on_windows_changed =
+        wm_service_sway_register_on_windows_changed;
+    wm->unregister_on_windows_changed =
+        wm_service_sway_unregister_on_windows_changed;
+    wm->run_batch = wm_service_sway_run_batch;
 
     // subscribe to desired events
     sway_client_ipc_subscribe_req(
-        self->socket_fd, (int[]){IPC_EVENT_WORKSPACE, IPC_EVENT_OUTPUT}, 2);
+        self->socket_fd,
+        (int[]){IPC_EVENT_WORKSPACE, IPC_EVENT_OUTPUT, IPC_EVENT_WINDOW,
+                IPC_EVENT_BINDING},
+        4);
 
     // get initial listing of workspaces
-    sway_client_ipc_get_workspaces_req(self->socket_fd);
+    request_workspaces(self);
 
     // get initial listing of outputs
-    sway_client_ipc_get_outputs_req(self->socket_fd);
+    request_outputs(self);
+
+    // get initial listing of windows
+    request_tree(self);
 
     return wm;
 }
@@ -1,5 +1,6 @@
 #include "window_manager_service.h"
 
+#include "./ext_workspace/window_manager_service_ext_workspace.h"
 #include "./sway/window_manager_service_sway.h"
 
 static WindowManager *global = NULL;
@@ -17,6 +18,8 @@ int window_manager_service_init() {
 
     if (g_strcmp0(backend, "sway") == 0) {
         global = wm_service_sway_window_manager_init();
+    } else if (g_strcmp0(backend, "ext-workspace") == 0) {
+        global = wm_service_ext_workspace_window_manager_init();
     } else {
         g_warning("Unknown backend: %s", backend);
         return -1;
@@ -37,15 +37,55 @@ window_manager_service_string_to_event(char *str) {
 
 typedef struct _WMWorkspace {
     gchar *name;
-    gchar *output;
+    // interned, compare by pointer or g_strcmp0 and never free.
+    const gchar *output;
     guint32 id;
     gint32 num;
     gboolean urgent;
     gboolean focused;
     gboolean visible;
     gboolean empty;
+    // area of the workspace in layout coordinates, 0 if not reported.
+    gint32 x;
+    gint32 y;
+    gint32 width;
+    gint32 height;
 } WMWorkspace;
 
+typedef enum WMWindowEventType {
+    WMWINDOW_EVENT_NEW,
+    WMWINDOW_EVENT_CLOSE,
+    WMWINDOW_EVENT_FOCUS,
+    WMWINDOW_EVENT_TITLE,
+    WMWINDOW_EVENT_MOVE,
+    WMWINDOW_EVENT_URGENT,
+    WMWINDOW_EVENT_LEN,
+} WMWindowEventType;
+
+typedef struct _WMWindow {
+    // the Wayland app_id or, for XWayland windows, the X11 class.
+    gchar *app_id;
+    gchar *title;
+    guint32 id;
+    // the id of the WMWorkspace this window lives on, 0 if unknown.
+    guint32 workspace_id;
+    gboolean focused;
+    gboolean urgent;
+} WMWindow;
+
+typedef struct _WMWindowEvent {
+    WMWindowEventType type;
+    WMWindow window;
+    // the event is about a container of windows rather than a window, only
+    // `window.id` is set.
+    gboolean container;
+    // whether the window is on a visible workspace once the event happened,
+    // and the center of its rect in layout coordinates.
+    gboolean visible;
+    gint32 x;
+    gint32 y;
+} WMWindowEvent;
+
 typedef struct _WMWorkspaceEvent {
     WMWorkspaceEventType type;
     WMWorkspace workspace;
@@ -55,13 +95,33 @@ typedef struct _WMOutputEvent {
 } WMOutputEvent;
 
 typedef struct _WMOutput {
-    gchar *name;
+    // interned, compare by pointer or g_strcmp0 and never free.
+    const gchar *name;
     gchar *make;
     gchar *model;
     gchar *serial;
     gchar *current_workspace;
 } WMOutput;
 
+typedef enum WMCommandType {
+    WMCOMMAND_FOCUS_WORKSPACE,
+    WMCOMMAND_RENAME_WORKSPACE,
+    WMCOMMAND_WS_TO_OUTPUT,
+    WMCOMMAND_APP_TO_WORKSPACE,
+} WMCommandType;
+
+// A single operation of a command batch, see WindowManager.run_batch.
+// Only the argument `type` calls for is read:
+//  FOCUS_WORKSPACE, APP_TO_WORKSPACE: workspace
+//  RENAME_WORKSPACE: name
+//  WS_TO_OUTPUT: output
+typedef struct _WMCommand {
+    WMCommandType type;
+    WMWorkspace *workspace;
+    WMOutput *output;
+    const gchar *name;
+} WMCommand;
+
 // WinowManager is a virtual function table which abstracts an underlying
 // window manager implementation.
 //
@@ -82,10 +142,30 @@ typedef int (*wm_current_ws_to_output_func)(WindowManager *self, WMOutput *o);
 typedef int (*wm_current_app_to_workspace_func)(WindowManager *self,
                                                 WMWorkspace *ws);
 
+// Invoked once a command batch completed. `results` holds a gboolean for each
+// submitted command, in order, commands which never ran are FALSE.
+typedef void (*wm_on_batch_done)(void *data, GArray *results);
+
+typedef int (*wm_run_batch_func)(WindowManager *self, WMCommand *cmds,
+                                 guint len, wm_on_batch_done cb, void *data);
+
 typedef void (*wm_on_workspaces_changed)(void *data, GPtrArray *workspaces);
 
 typedef void (*wm_on_outputs_changed)(void *data, GPtrArray *outputs);
 
+typedef GPtrArray *(*wm_get_windows_func)(WindowManager *self,
+                                          WMWorkspace *ws);
+
+typedef void (*wm_on_windows_changed)(void *data, GPtrArray *windows);
+
+typedef guint (*wm_register_on_windows_changed)(WindowManager *self,
+                                                wm_on_windows_changed cb,
+                                                void *data);
+
+typedef guint (*wm_unregister_on_windows_changed)(WindowManager *self,
+                                                  wm_on_windows_changed cb,
+                                                  void *data);
+
 typedef guint (*wm_register_on_workspaces_changed)(WindowManager *self,
                                                    wm_on_workspaces_changed cb,
                                                    void *data);
@@ -127,6 +207,22 @@ typedef struct _WindowManager {
     wm_register_on_outputs_changed register_on_outputs_changed;
     // unregister a callback when outputs has changed.
     wm_unregister_on_outputs_changed unregister_on_outputs_changed;
+    // Provide a list of windows on the provided workspace, or all windows
+    // if `ws` is NULL. The returned array does not own its elements, unref it
+    // when finished.
+    // Only sway reports the workspace of every window. ext-workspace places a
+    // window on the focused workspace when it appears or gains focus, and
+    // misses moves which leave it unfocused.
+    wm_get_windows_func get_windows;
+    // register a callback when windows have changed.
+    // returns the GObject signal ID on success.
+    wm_register_on_windows_changed register_on_windows_changed;
+    // unregister a callback when windows have changed.
+    wm_unregister_on_windows_changed unregister_on_windows_changed;
+    // Run several commands as one request to the window manager, in order.
+    // `cb` may be NULL, it may also be invoked before run_batch returns.
+    // Returns 0 if the batch was submitted.
+    wm_run_batch_func run_batch;
 } WindowManager;
 
 // Initialize the window manager service
@@ -23,7 +23,7 @@ typedef struct _WorkspaceSwitcher {
     GObject parent_instance;
     Switcher switcher;
     enum mode mode;
-
+    GSettings *settings;
 } WorkspaceSwitcher;
 
 static guint workspace_switcher_signals[signals_n] = {0};
@@ -31,6 +31,10 @@ G_DEFINE_TYPE(WorkspaceSwitcher, workspace_switcher, G_TYPE_OBJECT);
 
 // stub out dispose, finalize, class_init and init methods.
 static void workspace_switcher_dispose(GObject *object) {
+    WorkspaceSwitcher *self = WORKSPACE_SWITCHER(object);
+
+    g_clear_object(&self->settings);
+
     G_OBJECT_CLASS(workspace_switcher_parent_class)->dispose(object);
 }
 
@@ -132,14 +136,40 @@ static void on_search_previous_match(GtkSearchEntry *entry,
     gtk_widget_grab_focus(GTK_WIDGET(next_row));
 }
 
+static void on_move_app_done(void *data, GArray *results) {
+    for (guint i = 0; i < results->len; i++)
+        if (!g_array_index(results, gboolean, i))
+            g_warning(
+                "workspace_switcher.c:on_move_app_done() "
+                "command %u of moving the focused window failed.",
+                i);
+}
+
+// Moves the focused window to `ws`, and follows it there when
+// 'move-window-follows' is set. Either way the commands go out as a single
+// batch, so the window manager applies them before the next frame and a
+// failed move is reported.
+static void move_app_to_workspace(WorkspaceSwitcher *self, WMWorkspace *ws) {
+    WindowManager *wm = window_manager_service_get_global();
+    WMCommand cmds[] = {
+        {.type = WMCOMMAND_APP_TO_WORKSPACE, .workspace = ws},
+        {.type = WMCOMMAND_FOCUS_WORKSPACE, .workspace = ws},
+    };
+    guint len = G_N_ELEMENTS(cmds);
+
+    if (!g_settings_get_boolean(self->settings, "move-window-follows"))
+        len = 1;
+
+    wm->run_batch(wm, cmds, len, on_move_app_done, NULL);
+}
+
 static void on_search_activated_app_mode(GtkSearchEntry *entry,
                                          WorkspaceSwitcher *self) {
     if (!workspace_switcher_top_choice(self)) {
         const gchar *search_text = gtk_editable_get_text(GTK_EDITABLE(entry));
         WMWorkspace ws = {.num = -1, .name = (void *)search_text};
 
-        WindowManager *wm = window_manager_service_get_global();
-        wm->current_app_to_workspace(wm, &ws);
+        move_app_to_workspace(self, &ws);
 
         workspace_switcher_hide(self);
         return;
@@ -157,9 +187,8 @@ static void on_search_activated_app_mode(GtkSearchEntry *entry,
         g_error("Workspace not found.");
     }
 
-    // switch to workspace
-    WindowManager *wm = window_manager_service_get_global();
-    wm->current_app_to_workspace(wm, ws);
+    // move the focused window to workspace
+    move_app_to_workspace(self, ws);
 
     // hide widget
     workspace_switcher_hide(self);
@@ -284,7 +313,7 @@ static void on_row_activated(GtkListBox *box, GtkListBoxRow *row,
 
     WindowManager *wm = window_manager_service_get_global();
     if (self->mode == switch_app)
-        wm->current_app_to_workspace(wm, ws);
+        move_app_to_workspace(self, ws);
     else
         wm->focus_workspace(wm, ws);
 
@@ -383,6 +412,7 @@ static void workspace_switcher_init_layout(WorkspaceSwitcher *self) {
 }
 
 static void workspace_switcher_init(WorkspaceSwitcher *self) {
+    self->settings = g_settings_new("org.ldelossa.way-shell.window-manager");
     workspace_switcher_init_layout(self);
 }
 